@@ -103,10 +103,10 @@ def generate_async_message_template(nargs):
     print
     print "private:"
     if nargs == 0:
-        print "    friend void send(mailbox_manager_t*, address_t);"
+        print "    friend void send(mailbox_manager_t*, cluster_message_lane_t, address_t);"
     else:
         print "    template<%s>" % csep("class a#_t")
-        print "    friend void send(mailbox_manager_t*,"
+        print "    friend void send(mailbox_manager_t*, cluster_message_lane_t,"
         print "                     typename mailbox_t< void(%s) >::address_t%s);" % (csep("a#_t"), cpre("const a#_t&"))
     print
     print "    std::function< void(signal_t *%s) > fun;" % cpre("arg#_t")
@@ -117,7 +117,7 @@ def generate_async_message_template(nargs):
         print "inline"
     else:
         print "template<%s>" % csep("class arg#_t")
-    print "void send(mailbox_manager_t *src,"
+    print "void send(mailbox_manager_t *src, cluster_message_lane_t lane,"
     print "          %s %s::address_t dest%s) {" % (("typename" if nargs > 0 else ""),
                                                     mailbox_t_str,
                                                     cpre("const arg#_t &arg#"))
@@ -125,7 +125,18 @@ def generate_async_message_template(nargs):
         print "    %s::write_impl_t writer;" % mailbox_t_str
     else:
         print "    typename %s::write_impl_t writer(%s);" % (mailbox_t_str, csep("arg#"))
-    print "    send_write(src, dest.addr, &writer);"
+    print "    send_write(src, dest.addr, &writer, lane);"
+    print "}"
+    print
+    if nargs == 0:
+        print "inline"
+    else:
+        print "template<%s>" % csep("class arg#_t")
+    print "void send(mailbox_manager_t *src,"
+    print "          %s %s::address_t dest%s) {" % (("typename" if nargs > 0 else ""),
+                                                    mailbox_t_str,
+                                                    cpre("const arg#_t &arg#"))
+    print "    send(src, cluster_message_lane_t::NORMAL, dest%s);" % cpre("arg#")
     print "}"
     print
 
@@ -163,10 +174,11 @@ if __name__ == "__main__":
     print "    RDB_MAKE_ME_EQUALITY_COMPARABLE_1(mailbox_addr_t<T>, addr);"
     print
     print "private:"
-    print "    friend void send(mailbox_manager_t *, mailbox_addr_t<void()>);"
+    print "    friend void send(mailbox_manager_t *, cluster_message_lane_t,"
+    print "                     mailbox_addr_t<void()>);"
     for nargs in xrange(1, 15):
         print "    template <%s>" % ncsep("class a#_t", nargs)
-        print "    friend void send(mailbox_manager_t *,"
+        print "    friend void send(mailbox_manager_t *, cluster_message_lane_t,"
         print "                     typename mailbox_t< void(%s) >::address_t%s);" % (ncsep("a#_t", nargs), ncpre("const a#_t&", nargs))
     print
     print "    raw_mailbox_t::address_t addr;"
@@ -0,0 +1,341 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/io/disk/uring.hpp"
+
+#if USE_IO_URING
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#include "arch/io/disk.hpp"
+#include "config/args.hpp"
+#include "logger.hpp"
+#include "utils.hpp"
+
+#if USE_IO_URING
+
+// Older C libraries don't know about the io_uring system calls yet. The numbers are
+// the same on every architecture we build for.
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+namespace {
+
+int sys_io_uring_setup(uint32_t entries, io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int sys_io_uring_enter(int fd, uint32_t to_submit) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, nullptr, 0);
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+uint32_t ring_entries_for(int max_concurrent_io_requests) {
+    uint32_t entries = 1;
+    while (entries < static_cast<uint32_t>(max_concurrent_io_requests)
+           && entries < URING_DISKMGR_MAX_RING_ENTRIES) {
+        entries *= 2;
+    }
+    return entries;
+}
+
+}  // namespace
+
+/* A `request_t` tracks one read or write while it's on the ring. It keeps its own copy
+of the action's I/O vectors, because the kernel may complete the operation partially
+and we then resubmit the rest. */
+struct uring_diskmgr_t::request_t {
+    explicit request_t(action_t *_action)
+        : action(_action), bytes_done(0) {
+        action->copy_vectors(&vectors);
+        remaining = vectors.data();
+        remaining_count = vectors.size();
+    }
+
+    action_t *action;
+    scoped_array_t<iovec> vectors;
+    iovec *remaining;
+    size_t remaining_count;
+    int64_t bytes_done;
+
+    DISABLE_COPYING(request_t);
+};
+
+struct uring_diskmgr_t::blocking_job_t : public blocker_pool_t::job_t {
+    blocking_job_t(uring_diskmgr_t *_parent, action_t *_action)
+        : parent(_parent), action(_action) { }
+
+    void run() {
+        action->run();
+    }
+
+    void done() {
+        parent->on_blocking_job_done(this);
+    }
+
+    uring_diskmgr_t *parent;
+    action_t *action;
+};
+
+bool uring_diskmgr_t::is_supported() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = sys_io_uring_setup(1, &params);
+    if (fd == -1) {
+        // Typically ENOSYS on kernels older than 5.1, or EPERM if a seccomp
+        // profile forbids io_uring.
+        return false;
+    }
+    int res = close(fd);
+    guarantee_err(res == 0, "Could not close io_uring file descriptor");
+    return (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+}
+
+uring_diskmgr_t::uring_diskmgr_t(linux_event_queue_t *_queue,
+                                 passive_producer_t<action_t *> *_source,
+                                 int max_concurrent_io_requests)
+    : queue_depth(std::min<int>(max_concurrent_io_requests,
+                                URING_DISKMGR_MAX_RING_ENTRIES)),
+      queue(_queue),
+      source(_source),
+      blocker_pool(URING_DISKMGR_BLOCKER_THREADS, _queue),
+      n_unsubmitted(0),
+      n_pending(0) {
+    guarantee(max_concurrent_io_requests > 0);
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = sys_io_uring_setup(ring_entries_for(max_concurrent_io_requests), &params);
+    guarantee_err(fd != -1, "Could not create io_uring");
+    ring_fd.reset(fd);
+    guarantee(params.features & IORING_FEAT_SINGLE_MMAP,
+              "The kernel's io_uring does not support IORING_FEAT_SINGLE_MMAP.");
+
+    // With IORING_FEAT_SINGLE_MMAP the submission and completion rings share one
+    // mapping.
+    ring_mem_size = std::max<size_t>(
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring_mem = mmap(nullptr, ring_mem_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd.get(), IORING_OFF_SQ_RING);
+    guarantee_err(ring_mem != MAP_FAILED, "Could not map io_uring rings");
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes_mem = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd.get(), IORING_OFF_SQES);
+    guarantee_err(sqes_mem != MAP_FAILED, "Could not map io_uring submission entries");
+    sqes = static_cast<io_uring_sqe *>(sqes_mem);
+
+    char *base = static_cast<char *>(ring_mem);
+    sq_head = reinterpret_cast<uint32_t *>(base + params.sq_off.head);
+    sq_tail = reinterpret_cast<uint32_t *>(base + params.sq_off.tail);
+    sq_array = reinterpret_cast<uint32_t *>(base + params.sq_off.array);
+    sq_mask = *reinterpret_cast<uint32_t *>(base + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    cq_head = reinterpret_cast<uint32_t *>(base + params.cq_off.head);
+    cq_tail = reinterpret_cast<uint32_t *>(base + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<uint32_t *>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+    // We never have more requests on the ring than there are submission entries, and
+    // the completion ring is at least as large, so it cannot overflow.
+    guarantee(static_cast<uint32_t>(queue_depth) <= sq_entries);
+    guarantee(params.cq_entries >= sq_entries);
+
+    // The kernel signals `completion_event` whenever it posts a completion, so the
+    // event queue wakes us up without a dedicated thread.
+    int notify_fd = completion_event.get_notify_fd();
+    int res = sys_io_uring_register(ring_fd.get(), IORING_REGISTER_EVENTFD,
+                                    &notify_fd, 1);
+    guarantee_err(res == 0, "Could not register eventfd with io_uring");
+    queue->watch_event(&completion_event, this);
+
+    if (source->available->get()) { pump(); }
+    source->available->set_callback(this);
+}
+
+uring_diskmgr_t::~uring_diskmgr_t() {
+    assert_thread();
+    rassert(n_pending == 0);
+    source->available->unset_callback();
+    queue->forget_event(&completion_event, this);
+
+    int res = munmap(sqes, sqes_size);
+    guarantee_err(res == 0, "Could not unmap io_uring submission entries");
+    res = munmap(ring_mem, ring_mem_size);
+    guarantee_err(res == 0, "Could not unmap io_uring rings");
+}
+
+void uring_diskmgr_t::on_source_availability_changed() {
+    assert_thread();
+    if (source->available->get()) pump();
+}
+
+void uring_diskmgr_t::pump() {
+    assert_thread();
+    while (source->available->get() && n_pending < queue_depth) {
+        action_t *a = source->pop();
+        n_pending++;
+        if (a->get_is_resize() || a->wrap_in_datasyncs) {
+            blocker_pool.do_job(new blocking_job_t(this, a));
+        } else {
+            prepare_sqe(new request_t(a));
+        }
+    }
+    submit_pending();
+}
+
+void uring_diskmgr_t::prepare_sqe(request_t *req) {
+    const uint32_t tail = *sq_tail;
+    guarantee(tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) < sq_entries,
+              "io_uring submission queue overflow");
+    const uint32_t index = tail & sq_mask;
+
+    action_t *a = req->action;
+    io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = a->get_is_read() ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = a->get_fd();
+    sqe->off = a->get_offset() + req->bytes_done;
+    sqe->addr = reinterpret_cast<uintptr_t>(req->remaining);
+    sqe->len = std::min<size_t>(req->remaining_count, IOV_MAX);
+    sqe->user_data = reinterpret_cast<uintptr_t>(req);
+
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++n_unsubmitted;
+}
+
+void uring_diskmgr_t::submit_pending() {
+    while (n_unsubmitted > 0) {
+        int res = sys_io_uring_enter(ring_fd.get(), n_unsubmitted);
+        if (res == -1) {
+            int errsv = get_errno();
+            if (errsv == EINTR) {
+                continue;
+            }
+            if ((errsv == EAGAIN || errsv == EBUSY)
+                && static_cast<uint32_t>(n_pending) > n_unsubmitted) {
+                // The kernel is temporarily out of resources. Other requests are
+                // still running, so we'll try again once one of them completes.
+                return;
+            }
+            guarantee_xerr(errsv == EAGAIN || errsv == EBUSY, errsv,
+                           "io_uring_enter failed");
+            continue;
+        }
+        guarantee(static_cast<uint32_t>(res) <= n_unsubmitted);
+        n_unsubmitted -= res;
+    }
+}
+
+void uring_diskmgr_t::on_event(DEBUG_VAR int events) {
+    assert_thread();
+    rassert(events == poll_event_in);
+    completion_event.consume_wakey_wakeys();
+    reap_completions();
+    submit_pending();
+}
+
+void uring_diskmgr_t::reap_completions() {
+    uint32_t head = *cq_head;
+    const uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe *cqe = &cqes[head & cq_mask];
+        request_t *req = reinterpret_cast<request_t *>(cqe->user_data);
+        const int32_t res = cqe->res;
+        ++head;
+        // Hand the slot back to the kernel before running any callbacks, since they
+        // may submit new requests.
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        on_request_complete(req, res);
+    }
+}
+
+void uring_diskmgr_t::on_request_complete(request_t *req, int32_t res) {
+    action_t *a = req->action;
+    const int64_t total_bytes = a->get_count();
+
+    if (res == -EINTR || res == -EAGAIN) {
+        prepare_sqe(req);
+        return;
+    }
+
+    if (res < 0) {
+        a->io_result = res;
+    } else if (res == 0 && a->get_is_read()) {
+        // See `pool_diskmgr_t::action_t::perform_read_write`.
+        logERR("Failed I/O: we tried to read from behind the end of the file. "
+               "Either the file got truncated, or there is a bug in RethinkDB.");
+        a->io_result = -EINVAL;
+    } else if (res == 0) {
+        logERR("Failed I/O: vectored write of %" PRIi64 " bytes stopped after "
+               "%" PRIi64 " bytes. Assuming we ran out of disk space.",
+               total_bytes, req->bytes_done);
+        a->io_result = -ENOSPC;
+    } else {
+        req->bytes_done += action_t::advance_vector(&req->remaining,
+                                                    &req->remaining_count, res);
+        if (req->bytes_done < total_bytes) {
+            // A short read or write. Submit the remainder.
+            prepare_sqe(req);
+            return;
+        }
+        a->io_result = total_bytes;
+    }
+
+    delete req;
+    finish_action(a);
+}
+
+void uring_diskmgr_t::on_blocking_job_done(blocking_job_t *job) {
+    assert_thread();
+    action_t *a = job->action;
+    delete job;
+    finish_action(a);
+}
+
+void uring_diskmgr_t::finish_action(action_t *a) {
+    n_pending--;
+    pump();
+    done_fun(a);
+}
+
+#else  // USE_IO_URING
+
+bool uring_diskmgr_t::is_supported() {
+    return false;
+}
+
+uring_diskmgr_t::uring_diskmgr_t(linux_event_queue_t *,
+                                 passive_producer_t<action_t *> *,
+                                 int) {
+    crash("This build of RethinkDB does not support io_uring.");
+}
+
+uring_diskmgr_t::~uring_diskmgr_t() { }
+
+void uring_diskmgr_t::on_source_availability_changed() {
+    unreachable();
+}
+
+void uring_diskmgr_t::on_event(int) {
+    unreachable();
+}
+
+#endif  // USE_IO_URING
@@ -0,0 +1,106 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef ARCH_IO_DISK_URING_HPP_
+#define ARCH_IO_DISK_URING_HPP_
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <functional>
+
+#include "arch/io/blocker_pool.hpp"
+#include "arch/io/disk/pool.hpp"
+#include "arch/io/io_utils.hpp"
+#include "arch/runtime/event_queue.hpp"
+#include "arch/runtime/system_event.hpp"
+#include "concurrency/queue/passive_producer.hpp"
+#include "containers/scoped.hpp"
+
+#if defined(__linux__) && !defined(NO_IO_URING) && !defined(LEGACY_LINUX) \
+    && !defined(NO_EVENTFD)
+#define USE_IO_URING 1
+#else
+#define USE_IO_URING 0
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/* The uring disk manager submits reads and writes to the kernel through an io_uring
+submission queue, and reaps their completions from the event loop of the thread that
+owns it. Unlike `pool_diskmgr_t`, no blocker pool thread hop is needed for the common
+case. Resizes and writes that are wrapped in datasyncs are rare and are not worth
+splitting into linked ring operations, so those are still run on a small blocker pool.
+
+It draws its actions from the same `passive_producer_t` as `pool_diskmgr_t`, so it can
+be plugged in under `accounting_diskmgr_t` without changing anything above it. */
+
+class uring_diskmgr_t : private availability_callback_t,
+                        public linux_event_callback_t,
+                        public home_thread_mixin_debug_only_t {
+public:
+    typedef pool_diskmgr_t::action_t action_t;
+
+    /* Returns true if the running kernel lets us create an io_uring with the features
+    we need. If this returns false, use `pool_diskmgr_t` instead. */
+    static bool is_supported();
+
+    /* The `uring_diskmgr_t` will draw actions to run from `source`. It will call
+    `done_fun` on each one when it's done. It may only be constructed if
+    `is_supported()` returned true. */
+    uring_diskmgr_t(linux_event_queue_t *queue, passive_producer_t<action_t *> *source,
+                    int max_concurrent_io_requests);
+    std::function<void(action_t *)> done_fun;
+    ~uring_diskmgr_t();
+
+private:
+    void on_source_availability_changed();
+    void on_event(int events);
+
+#if USE_IO_URING
+    struct request_t;
+    struct blocking_job_t;
+
+    void pump();
+    void prepare_sqe(request_t *req);
+    void submit_pending();
+    void reap_completions();
+    void on_request_complete(request_t *req, int32_t res);
+    void finish_action(action_t *a);
+    void on_blocking_job_done(blocking_job_t *job);
+
+    const int queue_depth;
+    linux_event_queue_t *const queue;
+    passive_producer_t<action_t *> *const source;
+
+    // Used for resizes and datasync-wrapped writes.
+    blocker_pool_t blocker_pool;
+
+    scoped_fd_t ring_fd;
+
+    // The mapping of the submission and completion rings, and of the submission
+    // queue entries.
+    void *ring_mem;
+    size_t ring_mem_size;
+    io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    uint32_t *sq_head, *sq_tail, *sq_array;
+    uint32_t sq_mask, sq_entries;
+    uint32_t *cq_head, *cq_tail;
+    uint32_t cq_mask;
+    io_uring_cqe *cqes;
+
+    // The number of SQEs we have filled in but not yet passed to `io_uring_enter`.
+    uint32_t n_unsubmitted;
+
+    // The number of actions that have been drawn from `source` but not yet passed to
+    // `done_fun`.
+    int n_pending;
+
+    system_event_t completion_event;
+#endif
+
+    DISABLE_COPYING(uring_diskmgr_t);
+};
+
+#endif  // ARCH_IO_DISK_URING_HPP_
@@ -13,11 +13,13 @@
 #include <iphlpapi.h> // NOLINT
 #else
 #include <arpa/inet.h>
+#include <limits.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 #include "utils.hpp"
@@ -524,7 +526,9 @@ linux_tcp_conn_t::write_handler_t::write_handler_t(linux_tcp_conn_t *_parent) :
 { }
 
 void linux_tcp_conn_t::write_handler_t::coro_pool_callback(write_queue_op_t *operation, UNUSED signal_t *interruptor) {
-    if (operation->buffer != nullptr) {
+    if (operation->iov != nullptr) {
+        parent->perform_writev(operation->iov, operation->iov_count);
+    } else if (operation->buffer != nullptr) {
         parent->perform_write(operation->buffer, operation->size);
         if (operation->dealloc != nullptr) {
             parent->release_write_buffer(operation->dealloc);
@@ -550,6 +554,7 @@ void linux_tcp_conn_t::internal_flush_write_buffer() {
     op->buffer = current_write_buffer->buffer;
     op->size = current_write_buffer->size;
     op->dealloc = current_write_buffer.release();
+    op->iov = nullptr;
     op->cond = nullptr;
     op->keepalive = auto_drainer_t::lock_t(drainer.get());
     current_write_buffer.init(get_write_buffer());
@@ -601,8 +606,39 @@ void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
         rassert(op.nb_bytes == size);  // TODO WINDOWS: does windows guarantee this?
     }
 #else
-    while (size > 0) {
-        ssize_t res = ::write(sock.get(), buf, size);
+    iovec vec;
+    vec.iov_base = const_cast<void *>(buf);
+    vec.iov_len = size;
+    linux_tcp_conn_t::perform_writev(&vec, 1);
+#endif
+}
+
+void linux_tcp_conn_t::perform_writev(const iovec *iov, size_t iov_count) {
+#ifdef _WIN32
+    for (size_t i = 0; i < iov_count; ++i) {
+        perform_write(iov[i].iov_base, iov[i].iov_len);
+    }
+#else
+    assert_thread();
+
+    if (write_closed.is_pulsed()) {
+        /* The write end of the connection was closed, but there are still
+           operations in the write queue; we are one of those operations. Just
+           don't do anything. */
+        return;
+    }
+
+    /* We advance through a copy of the vector on partial writes */
+    std::vector<iovec> remaining(iov, iov + iov_count);
+    iovec *vecs = remaining.data();
+    size_t count = remaining.size();
+    while (count > 0 && vecs->iov_len == 0) {
+        ++vecs;
+        --count;
+    }
+
+    while (count > 0) {
+        ssize_t res = ::writev(sock.get(), vecs, std::min<size_t>(count, IOV_MAX));
 
         if (res == -1 && (get_errno() == EAGAIN || get_errno() == EWOULDBLOCK)) {
             /* Wait for a notification from the event queue, or for an order to
@@ -640,12 +676,21 @@ void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
             break;
 
         } else {
-            rassert(res <= static_cast<ssize_t>(size));
-            buf = reinterpret_cast<const void *>(reinterpret_cast<const char *>(buf) + res);
-            size -= res;
             if (write_perfmon) {
                 write_perfmon->record(res);
             }
+            /* Skip over what has been written */
+            size_t written = res;
+            while (count > 0 && written >= vecs->iov_len) {
+                written -= vecs->iov_len;
+                ++vecs;
+                --count;
+            }
+            rassert(count > 0 || written == 0);
+            if (count > 0) {
+                vecs->iov_base = static_cast<char *>(vecs->iov_base) + written;
+                vecs->iov_len -= written;
+            }
         }
     }
 #endif
@@ -668,6 +713,7 @@ void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THR
     /* Enqueue the write so it will happen eventually */
     op.buffer = buf;
     op.size = size;
+    op.iov = nullptr;
     op.dealloc = nullptr;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -682,6 +728,34 @@ void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THR
     }
 }
 
+void linux_tcp_conn_t::write_vectored(const iovec *iov, size_t iov_count, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
+    write_op_wrapper_t sentry(this, closer);
+
+    write_queue_op_t op;
+    cond_t to_signal_when_done;
+
+    /* Flush out any data that's been buffered, so that things don't get out of order */
+    if (current_write_buffer->size > 0) {
+        internal_flush_write_buffer();
+    }
+
+    /* Like `write()`, we block until the write is done, so the buffers stay valid
+       while they are in the write queue */
+    op.buffer = nullptr;
+    op.size = 0;
+    op.iov = iov;
+    op.iov_count = iov_count;
+    op.dealloc = nullptr;
+    op.cond = &to_signal_when_done;
+    write_queue.push(&op);
+
+    to_signal_when_done.wait();
+
+    if (write_closed.is_pulsed()) {
+        throw tcp_conn_write_closed_exc_t();
+    }
+}
+
 void linux_tcp_conn_t::write_buffered(const void *vbuf, size_t size, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
     write_op_wrapper_t sentry(this, closer);
 
@@ -740,6 +814,7 @@ void linux_tcp_conn_t::flush_buffer(signal_t *closer) THROWS_ONLY(tcp_conn_write
     write_queue_op_t op;
     cond_t to_signal_when_done;
     op.buffer = nullptr;
+    op.iov = nullptr;
     op.dealloc = nullptr;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -1121,6 +1196,12 @@ void linux_secure_tcp_conn_t::perform_write(const void *buffer, size_t size) {
     }
 }
 
+void linux_secure_tcp_conn_t::perform_writev(const iovec *iov, size_t iov_count) {
+    for (size_t i = 0; i < iov_count; ++i) {
+        perform_write(iov[i].iov_base, iov[i].iov_len);
+    }
+}
+
 /* It is not possible to close only the read or write side of a TLS connection
 so we use only a single shutdown method which attempts to shutdown the TLS
 before shutting down the underlying tcp connection */
@@ -136,6 +136,12 @@ public:
     void write(const void *buf, size_t size, signal_t *closer)
         THROWS_ONLY(tcp_conn_write_closed_exc_t);
 
+    /* write_vectored() is like write(), but takes the data from `iov_count` separate
+    buffers. They are handed to the kernel together, without being copied into our
+    write buffers first. */
+    void write_vectored(const iovec *iov, size_t iov_count, signal_t *closer)
+        THROWS_ONLY(tcp_conn_write_closed_exc_t);
+
     /* write_buffered() is like write(), but it might not send the data until
     flush_buffer*() or write() is called. Internally, it bundles together the
     buffered writes; this may improve performance. */
@@ -279,6 +285,9 @@ private:
         write_buffer_t *dealloc;
         const void *buffer;
         size_t size;
+        // Used instead of `buffer` and `size` if it's not `nullptr`
+        const iovec *iov;
+        size_t iov_count;
         cond_t *cond;
         auto_drainer_t::lock_t keepalive;
     };
@@ -345,6 +354,9 @@ private:
     /* Used to actually perform a write. If the write end of the connection is open, then
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
+
+    /* Like `perform_write()`, but for the buffers in `iov`. */
+    virtual void perform_writev(const iovec *iov, size_t iov_count);
 };
 
 #ifdef ENABLE_TLS
@@ -409,6 +421,9 @@ private:
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
 
+    /* TLS can't write several buffers at once, so this writes them one by one. */
+    virtual void perform_writev(const iovec *iov, size_t iov_count);
+
     void shutdown();
     void shutdown_socket();
 
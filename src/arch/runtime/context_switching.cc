@@ -358,6 +358,12 @@ void artificial_stack_t::disable_overflow_protection() {
 #endif
 }
 
+void artificial_stack_t::release_memory() {
+    /* Like in the constructor, we keep the first page, which is where the stack
+    starts when it gets used again. */
+    madvise(stack.get(), stack_size - getpagesize(), MADV_DONTNEED);
+}
+
 bool artificial_stack_t::address_in_stack(const void *addr) const {
     return reinterpret_cast<uintptr_t>(addr) >=
             reinterpret_cast<uintptr_t>(get_stack_bound())
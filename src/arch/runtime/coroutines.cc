@@ -16,6 +16,7 @@
 #include "arch/runtime/runtime.hpp"
 #include "arch/runtime/thread_pool.hpp"
 #include "config/args.hpp"
+#include "containers/arena.hpp"
 #include "debug.hpp"
 #include "do_on_thread.hpp"
 #include "logger.hpp"
@@ -27,9 +28,15 @@
 //Default, can be set through `set_coro_stack_size()`
 size_t coro_stack_size = COROUTINE_STACK_SIZE;
 
-// How many unused coroutine stacks to keep around (at most), before they are
-// freed. This value is per thread.
-const size_t COROUTINE_FREE_LIST_SIZE = 64;
+// How many unused coroutine stacks (of all sizes) to keep around (at most), before
+// they are freed. This value is per thread.
+const size_t COROUTINE_FREE_LIST_SIZE = 256;
+
+// Unused coroutine stacks keep their memory until they take up more than this many
+// bytes on a thread. Beyond that, we release the memory of the stacks that have been
+// unused for the longest time, but keep them mapped and protected so that reusing
+// them doesn't take any more system calls than a page fault.
+const size_t COROUTINE_FREE_LIST_RESIDENT_SIZE = 8 * MEGABYTE;
 
 // In debug mode, we print a warning if more than this many coroutines have been
 // allocated on one thread.
@@ -68,8 +75,13 @@ struct coro_globals_t {
     /* The previous context. */
     coro_t *prev_coro;
 
-    /* A list of coro_t objects that are not in use. */
-    intrusive_list_t<coro_t> free_coros;
+    /* Lists of coro_t objects that are not in use, one for each stack size. The
+    most recently used ones are at the back. */
+    intrusive_list_t<coro_t> free_coros[NUM_CORO_STACK_SIZES];
+    size_t num_free_coros;
+
+    /* How many bytes of the stacks in `free_coros` haven't been released. */
+    size_t free_coros_resident_size;
 
     /* A list of coroutines that currently have protected stacks. The least recently
     used protected coroutine is always at the front of the list. */
@@ -103,6 +115,8 @@ struct coro_globals_t {
     coro_globals_t()
         : current_coro(nullptr)
         , prev_coro(nullptr)
+        , num_free_coros(0)
+        , free_coros_resident_size(0)
 #ifndef NDEBUG
         , coro_count(0)
         , printed_high_coro_count_warning(false)
@@ -120,9 +134,11 @@ struct coro_globals_t {
         rassert(!current_coro);
 
         /* Destroy remaining coroutines */
-        while (coro_t *s = free_coros.head()) {
-            free_coros.remove(s);
-            delete s;
+        for (size_t i = 0; i < NUM_CORO_STACK_SIZES; ++i) {
+            while (coro_t *s = free_coros[i].head()) {
+                free_coros[i].remove(s);
+                delete s;
+            }
         }
     }
 
@@ -133,10 +149,23 @@ TLS_with_init(coro_globals_t *, cglobals, nullptr);
 // These must be initialized after TLS_cglobals, because perfmon_multi_membership_t
 // construction depends on coro_t::coroutines_have_been_initialized() which in turn
 // depends on cglobals.
-static perfmon_counter_t pm_active_coroutines, pm_allocated_coroutines;
+static perfmon_counter_t pm_active_coroutines, pm_allocated_coroutines,
+    pm_coroutine_stack_bytes, pm_coroutine_stacks_created, pm_coroutine_stacks_reused;
 static perfmon_multi_membership_t pm_coroutines_membership(&get_global_perfmon_collection(),
     &pm_active_coroutines, "active_coroutines",
-    &pm_allocated_coroutines, "allocated_coroutines");
+    &pm_allocated_coroutines, "allocated_coroutines",
+    &pm_coroutine_stack_bytes, "coroutine_stack_bytes",
+    &pm_coroutine_stacks_created, "coroutine_stacks_created",
+    &pm_coroutine_stacks_reused, "coroutine_stacks_reused");
+
+size_t get_stack_size_bytes(coro_stack_size_t stack_size) {
+    switch (stack_size) {
+    case coro_stack_size_t::SMALL: return COROUTINE_SMALL_STACK_SIZE;
+    case coro_stack_size_t::DEFAULT: return coro_stack_size;
+    case coro_stack_size_t::LARGE: return COROUTINE_LARGE_STACK_SIZE;
+    default: unreachable();
+    }
+}
 
 coro_runtime_t::coro_runtime_t() {
     rassert(!TLS_get_cglobals(), "coro runtime initialized twice on this thread");
@@ -162,11 +191,14 @@ void coro_runtime_t::get_coroutine_counts(std::map<std::string, size_t> *dest) {
 TLS_with_init(int64_t, coro_selfname_counter, 0);
 #endif
 
-coro_t::coro_t() :
-    stack(&coro_t::run, coro_stack_size),
+coro_t::coro_t(coro_stack_size_t stack_size) :
+    stack_size_(stack_size),
+    stack_memory_released_(false),
+    stack(&coro_t::run, get_stack_size_bytes(stack_size)),
     current_thread_(linux_thread_pool_t::get_thread_id()),
     notified_(false),
     waiting_(false),
+    arena_(nullptr),
     protected_stack_lru_entry_(this)
 #ifndef NDEBUG
     , selfname_number(get_thread_id().threadnum + MAX_THREADS *
@@ -180,6 +212,8 @@ coro_t::coro_t() :
 #endif
 {
     ++pm_allocated_coroutines;
+    ++pm_coroutine_stacks_created;
+    pm_coroutine_stack_bytes += get_stack_size_bytes(stack_size_);
 
 #ifndef NDEBUG
     TLS_get_cglobals()->coro_count++;
@@ -199,13 +233,53 @@ void coro_t::return_coro_to_free_list(coro_t *coro) {
     // This is important because when we call `return_coro_to_free_list` in
     // `coro_t::run`, that coroutine is still active and must not be deleted yet.
     static_assert(COROUTINE_FREE_LIST_SIZE > 0, "COROUTINE_FREE_LIST_SIZE cannot be 0");
-    if (cglobals->free_coros.size() >= COROUTINE_FREE_LIST_SIZE) {
-        coro_t *coro_to_delete = cglobals->free_coros.tail();
-        cglobals->free_coros.remove(coro_to_delete);
+    if (cglobals->num_free_coros >= COROUTINE_FREE_LIST_SIZE) {
+        // Prefer to delete a coroutine with the same stack size, so that we don't
+        // keep allocating stacks of one size while holding on to those of another.
+        // Within a list, the front one has been unused for the longest time.
+        size_t list = static_cast<size_t>(coro->stack_size_);
+        if (cglobals->free_coros[list].empty()) {
+            list = 0;
+            while (cglobals->free_coros[list].empty()) {
+                ++list;
+            }
+        }
+        coro_t *coro_to_delete = cglobals->free_coros[list].head();
+        cglobals->free_coros[list].remove(coro_to_delete);
+        --cglobals->num_free_coros;
+        if (!coro_to_delete->stack_memory_released_) {
+            cglobals->free_coros_resident_size -=
+                get_stack_size_bytes(coro_to_delete->stack_size_);
+        }
         delete coro_to_delete;
     }
-    rassert(cglobals->free_coros.size() < COROUTINE_FREE_LIST_SIZE);
-    cglobals->free_coros.push_back(coro);
+    rassert(cglobals->num_free_coros < COROUTINE_FREE_LIST_SIZE);
+
+    cglobals->free_coros[static_cast<size_t>(coro->stack_size_)].push_back(coro);
+    ++cglobals->num_free_coros;
+    cglobals->free_coros_resident_size += get_stack_size_bytes(coro->stack_size_);
+    release_free_coro_stacks(coro);
+}
+
+void coro_t::release_free_coro_stacks(coro_t *running) {
+    coro_globals_t *cglobals = TLS_get_cglobals();
+    // We start with the largest stacks, because that takes the fewest `madvise()`
+    // calls. Within a list, the front ones have been unused for the longest time.
+    for (size_t i = NUM_CORO_STACK_SIZES; i-- > 0;) {
+        intrusive_list_t<coro_t> *free_coros = &cglobals->free_coros[i];
+        for (coro_t *c = free_coros->head(); c != nullptr; c = free_coros->next(c)) {
+            if (cglobals->free_coros_resident_size
+                    <= COROUTINE_FREE_LIST_RESIDENT_SIZE) {
+                return;
+            }
+            if (c == running || c->stack_memory_released_) {
+                continue;
+            }
+            c->stack.release_memory();
+            c->stack_memory_released_ = true;
+            cglobals->free_coros_resident_size -= get_stack_size_bytes(c->stack_size_);
+        }
+    }
 }
 
 coro_t::~coro_t() {
@@ -216,6 +290,7 @@ coro_t::~coro_t() {
     TLS_get_cglobals()->coro_count--;
 #endif
     --pm_allocated_coroutines;
+    pm_coroutine_stack_bytes -= get_stack_size_bytes(stack_size_);
 }
 
 /* Helper function for switching into a new context and making sure that the new context
@@ -286,6 +361,12 @@ void coro_t::run() {
         // Destroy the Callable object which was either allocated within the coro_t or on the heap
         coro->action_wrapper.reset();
 
+        // Arenas that outlive the coroutine mustn't serve whatever runs on this
+        // `coro_t` next.
+        if (coro->arena_ != nullptr) {
+            arena_t::detach_all(coro);
+        }
+
         coro_globals_t *cglobals_on_final_thread = TLS_get_cglobals();
 
         /* Remove the coroutine from the `protected_coros_lru` list before we return it
@@ -295,7 +376,7 @@ void coro_t::run() {
         The `protected_coros_lru` entry (if any) will be on the latest thread where it
         has been executing, so it must be removed there.
         We don't call `disable_stack_protection()` here to increase the efficiency
-        of the free list. This means that we can slightly exceed the maximum number of
+        of the free list. This means that we can exceed the maximum number of
         protected coroutines (`MAX_PROTECTED_COROS`), by at most
         `COROUTINE_FREE_LIST_SIZE` per thread. */
         if (coro->protected_stack_lru_entry_.in_a_list()) {
@@ -315,7 +396,8 @@ void coro_t::run() {
         `do_on_thread` does execute `return_coro_to_free_list` immediately if the
         `coro`'s home thread is the current thread. That too is ok though, because the
         implementation of `return_coro_to_free_list` guarantees that `coro` is not going
-        to be freed immediately. */
+        to be freed immediately, and that the memory of its stack (which we are still
+        running on) doesn't get released. */
         do_on_thread(coro->home_thread(), std::bind(&coro_t::return_coro_to_free_list, coro));
         --pm_active_coroutines;
 
@@ -514,15 +596,27 @@ bool coroutines_have_been_initialized() {
     return TLS_get_cglobals() != nullptr;
 }
 
-coro_t * coro_t::get_coro() {
+coro_t * coro_t::get_coro(coro_stack_size_t stack_size) {
     rassert(coroutines_have_been_initialized());
+    coro_globals_t *cglobals = TLS_get_cglobals();
+    intrusive_list_t<coro_t> *free_coros =
+        &cglobals->free_coros[static_cast<size_t>(stack_size)];
     coro_t *coro;
 
-    if (TLS_get_cglobals()->free_coros.size() == 0) {
-        coro = new coro_t();
+    if (free_coros->empty()) {
+        coro = new coro_t(stack_size);
     } else {
-        coro = TLS_get_cglobals()->free_coros.tail();
-        TLS_get_cglobals()->free_coros.remove(coro);
+        // The most recently used stack is the one most likely to still be in the
+        // CPU caches and TLB.
+        coro = free_coros->tail();
+        free_coros->remove(coro);
+        --cglobals->num_free_coros;
+        if (coro->stack_memory_released_) {
+            coro->stack_memory_released_ = false;
+        } else {
+            cglobals->free_coros_resident_size -= get_stack_size_bytes(stack_size);
+        }
+        ++pm_coroutine_stacks_reused;
     }
 
     rassert(!coro->intrusive_list_node_t<coro_t>::in_a_list());
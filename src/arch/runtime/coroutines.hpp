@@ -25,6 +25,7 @@
 
 threadnum_t get_thread_id();
 struct coro_globals_t;
+class arena_t;
 class coro_t;
 
 
@@ -36,6 +37,17 @@ struct coro_profiler_mixin_t {
 #endif
 };
 
+/* Coroutine stacks come in a few sizes, so that a spawn site that only runs shallow
+code can use less memory, and one that is known to recurse deeply doesn't have to
+spawn further coroutines to get more stack space. Each thread keeps a separate pool
+of unused stacks for each size. */
+enum class coro_stack_size_t {
+    SMALL = 0,    // `COROUTINE_SMALL_STACK_SIZE`
+    DEFAULT,      // `COROUTINE_STACK_SIZE`, or what `set_coroutine_stack_size()` set
+    LARGE         // `COROUTINE_LARGE_STACK_SIZE`
+};
+const size_t NUM_CORO_STACK_SIZES = 3;
+
 /* The `coro_lru_entry_t` is used to keep track of coroutines that have protected
 stacks and to eventually unprotect them using a least-recently-used strategy. */
 struct coro_lru_entry_t : public intrusive_list_node_t<coro_lru_entry_t> {
@@ -58,14 +70,18 @@ public:
     friend bool has_n_bytes_free_stack_space(size_t);
 
     template<class callable_t>
-    static void spawn_now_dangerously(callable_t &&action) {
-        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action));
+    static void spawn_now_dangerously(
+            callable_t &&action,
+            coro_stack_size_t stack_size = coro_stack_size_t::DEFAULT) {
+        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action), stack_size);
         coro->notify_now_deprecated();
     }
 
     template<class callable_t>
-    static coro_t *spawn_sometime(callable_t &&action) {
-        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action));
+    static coro_t *spawn_sometime(
+            callable_t &&action,
+            coro_stack_size_t stack_size = coro_stack_size_t::DEFAULT) {
+        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action), stack_size);
         coro->notify_sometime();
         return coro;
     }
@@ -74,8 +90,11 @@ public:
     It avoids two thread messages, since it doesn't have to run on the original
     thread first, and also doesn't switch back at the end of the coro's lifetime. */
     template<class callable_t>
-    static coro_t *spawn_on_thread(callable_t &&action, threadnum_t thread) {
-        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action));
+    static coro_t *spawn_on_thread(
+            callable_t &&action,
+            threadnum_t thread,
+            coro_stack_size_t stack_size = coro_stack_size_t::DEFAULT) {
+        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action), stack_size);
         coro->current_thread_ = thread;
         coro->notify_sometime();
         return coro;
@@ -85,8 +104,10 @@ public:
     `spawn_later_ordered()` (or `spawn_ordered()`). `spawn_later_ordered()` does not
     honor scheduler priorities. */
     template<class callable_t>
-    static coro_t *spawn_later_ordered(callable_t &&action) {
-        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action));
+    static coro_t *spawn_later_ordered(
+            callable_t &&action,
+            coro_stack_size_t stack_size = coro_stack_size_t::DEFAULT) {
+        coro_t *coro = get_and_init_coro(std::forward<callable_t>(action), stack_size);
         coro->notify_later_ordered();
         return coro;
     }
@@ -174,7 +195,7 @@ private:
 
     // Constructor sets up the stack, get_and_init_coro will load a function to be run
     //  at which point the coroutine can be notified
-    coro_t();
+    explicit coro_t(coro_stack_size_t stack_size);
 
     // Generates a spawn-time backtrace and stores it into `spawn_backtrace`.
     void grab_spawn_backtrace();
@@ -185,8 +206,8 @@ private:
 
     // If this function footprint ever changes, you may need to update the parse_coroutine_info function
     template<class callable_t>
-    static coro_t *get_and_init_coro(callable_t &&action) {
-        coro_t *coro = get_coro();
+    static coro_t *get_and_init_coro(callable_t &&action, coro_stack_size_t stack_size) {
+        coro_t *coro = get_coro(stack_size);
 #ifndef NDEBUG
         coro->parse_coroutine_type(CURRENT_FUNCTION_PRETTY);
 #endif
@@ -205,18 +226,29 @@ private:
         return coro;
     }
 
-    static coro_t *get_coro();
+    static coro_t *get_coro(coro_stack_size_t stack_size);
 
     static void return_coro_to_free_list(coro_t *coro);
 
+    /* Releases the stack memory of coroutines on the free list until the stacks
+    there that still hold memory fit into `COROUTINE_FREE_LIST_RESIDENT_SIZE`.
+    `return_coro_to_free_list()` can get called while `running` is still executing
+    on its stack (see `run()`), so this never releases the memory of `running`. */
+    static void release_free_coro_stacks(coro_t *running);
+
     NORETURN static void run();
 
     friend class coro_profiler_t;
     friend struct coro_globals_t;
+    friend class arena_t;
     ~coro_t();
 
     virtual void on_thread_switch();
 
+    coro_stack_size_t stack_size_;
+    // Set while the coroutine is on the free list and its stack memory has been
+    // released.
+    bool stack_memory_released_;
     coro_stack_t stack;
 
     threadnum_t current_thread_;
@@ -227,6 +259,10 @@ private:
 
     callable_action_wrapper_t action_wrapper;
 
+    // The innermost `arena_t` that the coroutine created and that still exists, or
+    // `nullptr`.  See `arena_t::current()`.
+    arena_t *arena_;
+
     /* Used to eventually unprotect the coroutine if it has been inactive for a while. */
     coro_lru_entry_t protected_stack_lru_entry_;
 
@@ -267,6 +303,9 @@ inline result_t call_with_enough_stack(callable_t &&fun, const size_t min_bytes_
         std::exception_ptr exception;
         bool did_block = false;
         bool done_immediately = false;
+        // We only get here if `fun` recurses deeply, so we give it a large stack
+        // to reduce the number of coroutines that further recursion is going to
+        // spawn.
         coro_t::spawn_now_dangerously([&]() {
             try {
                 res = fun();
@@ -278,7 +317,7 @@ inline result_t call_with_enough_stack(callable_t &&fun, const size_t min_bytes_
             } else {
                 done_immediately = true;
             }
-        });
+        }, coro_stack_size_t::LARGE);
         // Note that if `fun()` doesn't block, we will get here after the coroutine
         // we spawned has already finished, since we're using `spawn_now_dangerously`.
         // So ASSERT_FINITE_CORO_WAITING restrictions over `fun()` should remain
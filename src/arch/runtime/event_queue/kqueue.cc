@@ -63,8 +63,10 @@ void kqueue_event_queue_t::run() {
     // Now, start the loop
     while (!parent->should_shut_down()) {
         // Grab the events from the kqueue!
+        parent->on_wait_begin();
         nevents = call_kevent(kqueue_fd, nullptr, 0,
                               events, MAX_IO_EVENT_PROCESSING_BATCH_SIZE, nullptr);
+        parent->on_wait_end();
 
         block_pm_duration event_loop_timer(pm_eventloop_singleton_t::get());
 
@@ -15,6 +15,10 @@ struct linux_event_callback_t {
 struct linux_queue_parent_t {
     virtual void pump() = 0;
     virtual bool should_shut_down() = 0;
+    // Called around each blocking wait for events, so that the parent can tell how
+    // busy the event loop is.
+    virtual void on_wait_begin() = 0;
+    virtual void on_wait_end() = 0;
     virtual ~linux_queue_parent_t() {}
 };
 
@@ -21,6 +21,7 @@ linux_message_hub_t::linux_message_hub_t(linux_event_queue_t *queue,
                                          threadnum_t current_thread)
     : queue_(queue),
       thread_pool_(thread_pool),
+      incoming_head_(nullptr),
       is_woken_up_(false),
       current_thread_(current_thread) {
 
@@ -45,7 +46,7 @@ linux_message_hub_t::~linux_message_hub_t() {
         guarantee(get_priority_msg_list(p).empty());
     }
 
-    guarantee(incoming_messages_.empty());
+    guarantee(incoming_head_.load() == nullptr);
 }
 
 void linux_message_hub_t::do_store_message(threadnum_t nthread, linux_thread_message_t *msg) {
@@ -92,15 +93,41 @@ void linux_message_hub_t::store_message_sometime(threadnum_t nthread, linux_thre
 
 
 void linux_message_hub_t::insert_external_message(linux_thread_message_t *msg) {
-    bool do_wake_up;
-    {
-        spinlock_acq_t acq(&incoming_messages_lock_);
-        do_wake_up = !check_and_set_is_woken_up();
-        incoming_messages_.push_back(msg);
+    msg_list_t msgs;
+    msgs.push_back(msg);
+    push_incoming_messages(&msgs);
+}
+
+void linux_message_hub_t::push_incoming_messages(msg_list_t *msgs) {
+    rassert(!msgs->empty());
+
+    // Link the messages in reverse order, so that the receiver can restore the order
+    // when it reverses the whole stack.
+    linux_thread_message_t *const oldest = msgs->head();
+    linux_thread_message_t *newest = nullptr;
+    while (linux_thread_message_t *m = msgs->head()) {
+        msgs->remove(m);
+        m->next_incoming_ = newest;
+        newest = m;
     }
 
-    // Wakey wakey eggs and bakey
-    if (do_wake_up) {
+    linux_thread_message_t *head = incoming_head_.load(std::memory_order_relaxed);
+    do {
+        oldest->next_incoming_ = head;
+    } while (!incoming_head_.compare_exchange_weak(head, newest,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed));
+
+    // Wakey wakey, perhaps eggs and bakey
+    wake_up_if_needed();
+}
+
+void linux_message_hub_t::wake_up_if_needed() {
+    // This must not be reordered with the push onto `incoming_head_` that precedes
+    // it, or with the receiver's check of `incoming_head_` after it clears
+    // `is_woken_up_`. Otherwise both sides could conclude that the other one will
+    // take care of the new messages.
+    if (!is_woken_up_.exchange(true, std::memory_order_seq_cst)) {
         event_.wakey_wakey();
     }
 }
@@ -176,31 +203,32 @@ void linux_message_hub_t::on_event(int events) {
             // Place wakey_wakey and then yield to the event processing.
             // It will wake us up again immediately, but can handle a few
             // OS events (such as timers, network messages etc.) in the meantime.
-            bool do_wake_up;
-            {
-                spinlock_acq_t acq(&incoming_messages_lock_);
-                do_wake_up = !check_and_set_is_woken_up();
-            }
-            if (do_wake_up) {
-                event_.wakey_wakey();
-            }
-            break;
+            // `is_woken_up_` is still set, so no sender is going to do this for us.
+            event_.wakey_wakey();
+            return;
         }
     }
+
+    // We're about to go idle. Let senders wake us up again, unless a message arrived
+    // while we were busy, in which case we wake ourselves up to handle it.
+    is_woken_up_.store(false, std::memory_order_seq_cst);
+    if (incoming_head_.load(std::memory_order_seq_cst) != nullptr) {
+        wake_up_if_needed();
+    }
 }
 
 void linux_message_hub_t::sort_incoming_messages_by_priority() {
-    // We do this in two steps to release the spinlock faster.
-    // append_and_clear is a very cheap operation, while
-    // assigning each message to a different priority queue
-    // is more expensive.
-
-    // 1. Pull the messages
+    // 1. Pull the messages. The stack has the most recent message first, so pushing
+    // each message to the front of `new_messages` restores the order in which they
+    // were sent.
     msg_list_t new_messages;
-    {
-        spinlock_acq_t acq(&incoming_messages_lock_);
-        new_messages.append_and_clear(&incoming_messages_);
-        is_woken_up_ = false;
+    linux_thread_message_t *m = incoming_head_.exchange(nullptr,
+                                                        std::memory_order_acquire);
+    while (m != nullptr) {
+        linux_thread_message_t *next = m->next_incoming_;
+        m->next_incoming_ = nullptr;
+        new_messages.push_front(m);
+        m = next;
     }
 
     // 2. Sort the messages into their respective priority queues
@@ -219,12 +247,6 @@ void linux_message_hub_t::sort_incoming_messages_by_priority() {
     }
 }
 
-bool linux_message_hub_t::check_and_set_is_woken_up() {
-    const bool was_woken_up = is_woken_up_;
-    is_woken_up_ = true;
-    return was_woken_up;
-}
-
 // Pushes messages collected locally global lists available to all
 // threads.
 void linux_message_hub_t::push_messages() {
@@ -234,23 +256,8 @@ void linux_message_hub_t::push_messages() {
         thread_queue_t *queue = &queues_[i];
         if (!queue->msg_local_list.empty()) {
             // Transfer messages to the other core
-
-            bool do_wake_up;
-            {
-                spinlock_acq_t acq(&thread_pool_->threads[i]->message_hub.incoming_messages_lock_);
-
-                // We only need to do a wake up if we're the first people to do a
-                // wake up.
-                do_wake_up =
-                    !thread_pool_->threads[i]->message_hub.check_and_set_is_woken_up();
-
-                thread_pool_->threads[i]->message_hub.incoming_messages_.append_and_clear(&queue->msg_local_list);
-            }
-
-            // Wakey wakey, perhaps eggs and bakey
-            if (do_wake_up) {
-                thread_pool_->threads[i]->message_hub.event_.wakey_wakey();
-            }
+            thread_pool_->threads[i]->message_hub.push_incoming_messages(
+                &queue->msg_local_list);
         }
     }
 }
@@ -4,10 +4,11 @@
 
 #include <pthread.h>
 
+#include <atomic>
+
 #include "arch/runtime/event_queue.hpp"
 #include "arch/runtime/runtime_utils.hpp"
 #include "arch/runtime/system_event.hpp"
-#include "arch/spinlock.hpp"
 #include "config/args.hpp"
 #include "containers/intrusive_list.hpp"
 #include "threading.hpp"
@@ -23,7 +24,14 @@ class linux_thread_pool_t;
 /* There is one message hub per thread, NOT one message hub for the entire program.
 
 Each message hub stores messages that are going from that message hub's home thread to
-other threads. It keeps a separate queue for messages destined for each other thread. */
+other threads. It keeps a separate queue for messages destined for each other thread.
+
+Messages are handed to the receiving hub without locks: the sender pushes its whole
+batch for that thread onto the receiver's `incoming_head_` stack with a single
+compare-and-swap, and the receiver takes the entire stack with a single exchange.
+Wake-ups are coalesced through `is_woken_up_`: once a hub has been woken up, senders
+don't signal its event again until it has worked through its messages and is about to
+go back to the event loop. */
 
 class linux_message_hub_t : private linux_event_callback_t {
 public:
@@ -55,10 +63,18 @@ private:
     // debug mode.
     void do_store_message(threadnum_t nthread, linux_thread_message_t *msg);
 
-    // Moves messages from incoming_messages_ into the respective entries of
+    // Moves messages from the incoming stack into the respective entries of
     // priority_msg_lists, depending on the messages' priorities.
     void sort_incoming_messages_by_priority();
 
+    // Pushes the messages in `msgs` onto our incoming stack, keeping their order, and
+    // signals our event unless we have already been woken up. Called by other threads.
+    void push_incoming_messages(msg_list_t *msgs);
+
+    // Signals our event, unless we already have been woken up since we last cleared
+    // `is_woken_up_`.
+    void wake_up_if_needed();
+
     msg_list_t &get_priority_msg_list(int priority);
 
     linux_event_queue_t *const queue_;
@@ -68,18 +84,20 @@ private:
     struct thread_queue_t {
         //TODO this doesn't need to be a class anymore
 
-        /* Messages are cached here before being pushed to the global list so that we don't
-        have to acquire the spinlock as often */
+        /* Messages are cached here before being pushed to the other thread's incoming
+        stack, so that we only need one atomic operation per batch */
         msg_list_t msg_local_list;
     } queues_[MAX_THREADS];
 
-    // Must only be used with acquired incoming_messages_lock_
-    bool check_and_set_is_woken_up();
-    bool is_woken_up_;
-    msg_list_t incoming_messages_;
-    spinlock_t incoming_messages_lock_;
+    // Messages sent to this thread, linked through `next_incoming_`, with the most
+    // recently pushed message first.
+    std::atomic<linux_thread_message_t *> incoming_head_;
+
+    // True from the time a sender signals `event_` until we have handled all our
+    // messages and checked `incoming_head_` one last time.
+    std::atomic<bool> is_woken_up_;
 
-    // Use `sort_incoming_messages_by_priority()` to sort incoming_messages_ into
+    // Use `sort_incoming_messages_by_priority()` to sort incoming messages into
     // these lists.
     // Use `get_priority_msg_list()` to get the list for a given priority.
     // Each list contains messages of the respective priority.
@@ -90,7 +108,7 @@ private:
     void on_event(int events);
 
     // The eventfd (or pipe-based alternative) notified after the first incoming
-    // message is put onto incoming_messages_.
+    // message is put onto the incoming stack.
     system_event_t event_;
 
     /* The thread that we queue messages originating from. (Recall that there is one
@@ -24,6 +24,13 @@ int get_num_threads() {
     return linux_thread_pool_t::get_thread_pool()->n_threads;
 }
 
+double get_thread_utilization(threadnum_t thread) {
+    assert_good_thread_id(thread);
+    linux_thread_t *t =
+        linux_thread_pool_t::get_thread_pool()->threads[thread.threadnum];
+    return t == nullptr ? 0.0 : t->utilization.get();
+}
+
 #ifndef NDEBUG
 void assert_good_thread_id(threadnum_t thread) {
     if (linux_thread_pool_t::get_thread_pool() == nullptr) {
@@ -19,6 +19,7 @@
 #include "arch/timing.hpp"
 #include "errors.hpp"
 #include "logger.hpp"
+#include "perfmon/perfmon.hpp"
 #include "utils.hpp"
 
 #if !defined(VALGRIND) && !defined(_WIN32)
@@ -488,6 +489,14 @@ void linux_thread_t::pump() {
     message_hub.push_messages();
 }
 
+void linux_thread_t::on_wait_begin() {
+    utilization.on_wait_begin();
+}
+
+void linux_thread_t::on_wait_end() {
+    utilization.on_wait_end();
+}
+
 void linux_thread_t::on_event(int events) {
     // No-op. This is just to make sure that the event queue wakes up
     // so it can shut down.
@@ -521,3 +530,28 @@ void linux_thread_t::initiate_shut_down() {
     res = pthread_mutex_unlock(&do_shutdown_mutex);
     guarantee_xerr(res == 0, res, "could not unlock do_shutdown_mutex");
 }
+
+/* Reports each thread's utilization as an array indexed by thread number, so that an
+uneven distribution of load over the threads shows up in the stats. */
+class perfmon_thread_utilization_t
+    : public perfmon_perthread_t<double, std::vector<double> > {
+protected:
+    void get_thread_stat(double *stat) {
+        *stat = linux_thread_pool_t::get_thread()->utilization.get();
+    }
+    std::vector<double> combine_stats(const double *stats) {
+        return std::vector<double>(stats, stats + get_num_threads());
+    }
+    ql::datum_t output_stat(const std::vector<double> &stats) {
+        std::vector<ql::datum_t> array;
+        array.reserve(stats.size());
+        for (double stat : stats) {
+            array.push_back(ql::datum_t(stat));
+        }
+        return ql::datum_t(std::move(array), ql::configured_limits_t::unlimited);
+    }
+};
+
+static perfmon_thread_utilization_t pm_thread_utilization;
+static perfmon_membership_t pm_thread_utilization_membership(
+    &get_global_perfmon_collection(), &pm_thread_utilization, "thread_utilization");
@@ -14,8 +14,10 @@
 #include "arch/runtime/system_event.hpp"
 #include "arch/runtime/message_hub.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/thread_utilization.hpp"
 #include "arch/io/blocker_pool.hpp"
 #include "arch/io/timer_provider.hpp"
+#include "arch/spinlock.hpp"
 #include "arch/timer.hpp"
 
 class linux_thread_t;
@@ -188,8 +190,13 @@ public:
     for coroutines. */
     coro_runtime_t coro_runtime;
 
+    // Updated by the event queue; can be read from any thread.
+    thread_utilization_t utilization;
+
     void pump();   // Called by the event queue
     bool should_shut_down();   // Called by the event queue
+    void on_wait_begin();   // Called by the event queue
+    void on_wait_end();   // Called by the event queue
 #ifndef NDEBUG
     void initiate_shut_down(std::map<std::string, size_t> *coroutine_counts); // Can be called from any thread
 #else
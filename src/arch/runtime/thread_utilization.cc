@@ -0,0 +1,51 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/thread_utilization.hpp"
+
+#include <algorithm>
+
+#include "config/args.hpp"
+
+thread_utilization_t::thread_utilization_t()
+    : window(THREAD_UTILIZATION_WINDOW_MS * MILLION),
+      window_start(get_ticks()),
+      busy_in_window(0),
+      last_transition(window_start),
+      waiting(false),
+      utilization(0) { }
+
+void thread_utilization_t::on_wait_begin() {
+    transition(get_ticks(), true);
+    waiting.store(true, std::memory_order_relaxed);
+}
+
+void thread_utilization_t::on_wait_end() {
+    transition(get_ticks(), false);
+    waiting.store(false, std::memory_order_relaxed);
+}
+
+double thread_utilization_t::get() const {
+    /* A thread that has been blocked (or busy) for longer than a whole window hasn't
+    had a chance to publish a new value in the meantime, so we go by its state. */
+    ticks_t last = last_transition.load(std::memory_order_relaxed);
+    ticks_t now = get_ticks();
+    if (now > last && now - last > window) {
+        return waiting.load(std::memory_order_relaxed) ? 0.0 : 1.0;
+    }
+    return utilization.load(std::memory_order_relaxed);
+}
+
+void thread_utilization_t::transition(ticks_t now, bool was_busy) {
+    ticks_t last = last_transition.load(std::memory_order_relaxed);
+    if (was_busy && now > last) {
+        busy_in_window += now - last;
+    }
+    last_transition.store(now, std::memory_order_relaxed);
+
+    if (now > window_start && now - window_start >= window) {
+        utilization.store(
+            std::min(1.0, static_cast<double>(busy_in_window) / (now - window_start)),
+            std::memory_order_relaxed);
+        window_start = now;
+        busy_in_window = 0;
+    }
+}
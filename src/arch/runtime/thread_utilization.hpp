@@ -0,0 +1,42 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
+#define ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
+
+#include <atomic>
+
+#include "errors.hpp"
+#include "time.hpp"
+
+/* `thread_utilization_t` measures the fraction of wall-clock time that a thread's
+event loop spends doing work, as opposed to blocking while it waits for events. The
+event queue calls `on_wait_begin()` and `on_wait_end()` around its blocking wait on the
+thread that owns the tracker. `get()` may be called from any thread. */
+class thread_utilization_t {
+public:
+    thread_utilization_t();
+
+    void on_wait_begin();
+    void on_wait_end();
+
+    /* Returns the utilization over roughly the last `window` ticks, as a number between
+    0 and 1. */
+    double get() const;
+
+private:
+    void transition(ticks_t now, bool was_busy);
+
+    const ticks_t window;
+
+    // Only accessed by the owning thread.
+    ticks_t window_start;
+    ticks_t busy_in_window;
+
+    // Written by the owning thread, read by any thread.
+    std::atomic<ticks_t> last_transition;
+    std::atomic<bool> waiting;
+    std::atomic<double> utilization;
+
+    DISABLE_COPYING(thread_utilization_t);
+};
+
+#endif  // ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
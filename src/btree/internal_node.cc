@@ -2,27 +2,50 @@
 #include "btree/internal_node.hpp"
 
 #include <algorithm>
+#include <utility>
 
 #include "btree/node.hpp"
 
 //In this tree, less than or equal takes the left-hand branch and greater than takes the right hand branch
 
+/* Every internal node stores a prefix that is shared by all keys in the node's key
+range (not just by the keys that are stored in it), and its pairs only store the rest
+of each key. Because every key that can ever be inserted into the node lies in that
+range, inserts and key updates never have to change the prefix. The prefix only
+changes when pairs move between nodes: a split can make it longer, using the bounds
+of the node's range in its parent, and merging or leveling shortens it to what the two
+nodes have in common. The leftmost node on each level always has an empty prefix,
+since its range starts at the empty key. */
+
 namespace internal_node {
 
 class ibuf_t;
 
 // We can't use "internal" for internal stuff obviously.
 namespace impl {
+// The pairs of a node with their full keys. The key of the last pair is unused.
+typedef std::vector<std::pair<block_id_t, store_key_t> > expanded_pairs_t;
+
 size_t pair_size_with_key(const btree_key_t *key);
 size_t pair_size_with_key_size(uint8_t size);
 
 void delete_pair(internal_node_t *node, uint16_t offset);
-uint16_t insert_pair(internal_node_t *node, const btree_internal_pair *pair);
 uint16_t insert_pair(internal_node_t *node, block_id_t lnode, const btree_key_t *key);
+uint16_t insert_pair(internal_node_t *node, block_id_t lnode, const btree_key_t *key, int prefix_size);
 void delete_offset(internal_node_t *node, int index);
 void insert_offset(internal_node_t *node, uint16_t offset, int index);
-void make_last_pair_special(internal_node_t *node);
+void make_last_pair_special(internal_node_t *node, const btree_key_t *prefix);
 bool is_equal(const btree_key_t *key1, const btree_key_t *key2);
+
+int prefix_size(const internal_node_t *node);
+bool has_prefix(const btree_key_t *key, const btree_key_t *prefix);
+void common_prefix(const btree_key_t *key1, const btree_key_t *key2, store_key_t *out);
+void first_key(const internal_node_t *node, store_key_t *key_out);
+void get_key_from_parent(const internal_node_t *parent, const internal_node_t *node, store_key_t *key_out);
+void expand(const internal_node_t *node, expanded_pairs_t *pairs_out);
+size_t compacted_size(const expanded_pairs_t &pairs, size_t begin, size_t end, int prefix_size);
+void compact(block_size_t block_size, internal_node_t *node, const btree_key_t *prefix,
+             const expanded_pairs_t &pairs, size_t begin, size_t end);
 }  // namespace impl
 
 void init(block_size_t block_size, internal_node_t *node) {
@@ -31,17 +54,6 @@ void init(block_size_t block_size, internal_node_t *node) {
     node->frontmost_offset = block_size.value();
 }
 
-void init(block_size_t block_size, internal_node_t *node, const internal_node_t *lnode, const uint16_t *offsets, int numpairs) {
-    init(block_size, node);
-    rassert(get_pair_by_index(lnode, lnode->npairs-1)->key.size == 0);
-    for (int i = 0; i < numpairs; i++) {
-        node->pair_offsets[i] = impl::insert_pair(node, get_pair(lnode, offsets[i]));
-    }
-    node->npairs = numpairs;
-    std::sort(node->pair_offsets, node->pair_offsets+node->npairs-1, internal_key_comp(node));
-    rassert(get_pair_by_index(node, node->npairs-1)->key.size == 0);
-}
-
 block_id_t lookup(const internal_node_t *node, const btree_key_t *key) {
     int index = get_offset_index(node, key);
     return get_pair_by_index(node, index)->lnode;
@@ -58,10 +70,17 @@ bool insert(internal_node_t *node, const btree_key_t *key, block_id_t lnode, blo
         impl::insert_offset(node, special_offset, 0);
     }
 
+    guarantee(impl::has_prefix(key, get_prefix(node)),
+              "tried to insert key outside of internal node's key range");
+    const int prefix_size = impl::prefix_size(node);
+
     int index = get_offset_index(node, key);
-    rassert(!impl::is_equal(&get_pair_by_index(node, index)->key, key),
+    DEBUG_VAR const btree_key_t *existing = &get_pair_by_index(node, index)->key;
+    rassert(index == node->npairs - 1
+            || sized_strcmp(existing->contents, existing->size,
+                            key->contents + prefix_size, key->size - prefix_size) != 0,
         "tried to insert duplicate key into internal node!");
-    const uint16_t offset = impl::insert_pair(node, lnode, key);
+    const uint16_t offset = impl::insert_pair(node, lnode, key, prefix_size);
     impl::insert_offset(node, offset, index);
 
     get_pair_by_index(node, index + 1)->lnode = rnode;
@@ -70,43 +89,58 @@ bool insert(internal_node_t *node, const btree_key_t *key, block_id_t lnode, blo
 
 bool remove(block_size_t block_size, internal_node_t *node, const btree_key_t *key) {
     int index = get_offset_index(node, key);
+    const store_key_t prefix(get_prefix(node));
     impl::delete_pair(node, node->pair_offsets[index]);
     impl::delete_offset(node, index);
 
     if (index == node->npairs) {
-        impl::make_last_pair_special(node);
+        impl::make_last_pair_special(node, prefix.btree_key());
     }
 
     validate(block_size, node);
     return true;
 }
 
-void split(block_size_t block_size, internal_node_t *node, internal_node_t *rnode, btree_key_t *median) {
+void split(block_size_t block_size, internal_node_t *node, internal_node_t *rnode, btree_key_t *median,
+           const btree_key_t *left_excl_or_null, const btree_key_t *right_incl_or_null) {
     uint16_t total_pairs = block_size.value() - node->frontmost_offset;
     uint16_t first_pairs = 0;
     int index = 0;
-    while (first_pairs < total_pairs/2) { // finds the median index
+    while (first_pairs < total_pairs/2 && index < node->npairs - 1) { // finds the median index
         first_pairs += pair_size(get_pair_by_index(node, index));
         index++;
     }
     int median_index = index;
+    rassert(median_index > 0);
 
-    // Equality takes the left branch, so the median should be from this node.
-    const btree_key_t *median_key = &get_pair_by_index(node, median_index-1)->key;
-    keycpy(median, median_key);
-
-    init(block_size, rnode, node, node->pair_offsets + median_index, node->npairs - median_index);
+    impl::expanded_pairs_t pairs;
+    impl::expand(node, &pairs);
+    const store_key_t old_prefix(get_prefix(node));
 
-    // TODO: This is really slow because most pairs will likely be copied
-    // repeatedly.  There should be a better way.
-    for (index = median_index; index < node->npairs; index++) {
-        impl::delete_pair(node, node->pair_offsets[index]);
+    // Equality takes the left branch, so the median should be from this node.
+    keycpy(median, pairs[median_index - 1].second.btree_key());
+
+    // The old prefix is still shared by each half's range, but the ranges are now
+    // narrower, so their bounds may share a longer one.
+    store_key_t left_prefix = old_prefix;
+    if (left_excl_or_null != nullptr) {
+        store_key_t bounds_prefix;
+        impl::common_prefix(left_excl_or_null, median, &bounds_prefix);
+        if (bounds_prefix.size() > left_prefix.size()) {
+            left_prefix = bounds_prefix;
+        }
+    }
+    store_key_t right_prefix = old_prefix;
+    if (right_incl_or_null != nullptr) {
+        store_key_t bounds_prefix;
+        impl::common_prefix(median, right_incl_or_null, &bounds_prefix);
+        if (bounds_prefix.size() > right_prefix.size()) {
+            right_prefix = bounds_prefix;
+        }
     }
 
-    const uint16_t new_npairs = median_index;
-    node->npairs = new_npairs;
-    //make last pair special
-    impl::make_last_pair_special(node);
+    impl::compact(block_size, rnode, right_prefix.btree_key(), pairs, median_index, pairs.size());
+    impl::compact(block_size, node, left_prefix.btree_key(), pairs, 0, median_index);
 
     validate(block_size, node);
     validate(block_size, rnode);
@@ -116,23 +150,21 @@ void merge(block_size_t block_size, const internal_node_t *node, internal_node_t
     validate(block_size, node);
     validate(block_size, rnode);
     // get the key in parent which points to node
-    const btree_key_t *key_from_parent = &get_pair_by_index(parent, get_offset_index(parent, &get_pair_by_index(node, 0)->key))->key;
+    store_key_t key_from_parent;
+    impl::get_key_from_parent(parent, node, &key_from_parent);
 
-    guarantee(sizeof(internal_node_t) + (node->npairs + rnode->npairs)*sizeof(*node->pair_offsets) +
-        (block_size.value() - node->frontmost_offset) + (block_size.value() - rnode->frontmost_offset) + key_from_parent->size < block_size.value(),
-        "internal nodes too full to merge");
+    impl::expanded_pairs_t pairs;
+    impl::expand(node, &pairs);
+    pairs.back().second = key_from_parent;
+    impl::expand(rnode, &pairs);
 
-    memmove(rnode->pair_offsets + node->npairs, rnode->pair_offsets, rnode->npairs * sizeof(*rnode->pair_offsets));
+    store_key_t prefix;
+    impl::common_prefix(get_prefix(node), get_prefix(rnode), &prefix);
 
-    for (int i = 0; i < node->npairs-1; i++) { // the last pair is special
-        const uint16_t new_offset = impl::insert_pair(rnode, get_pair_by_index(node, i));
-        rnode->pair_offsets[i] = new_offset;
-    }
-    const uint16_t new_offset = impl::insert_pair(rnode, get_pair_by_index(node, node->npairs-1)->lnode, key_from_parent);
-    rnode->pair_offsets[node->npairs - 1] = new_offset;
+    guarantee(sizeof(internal_node_t) + impl::compacted_size(pairs, 0, pairs.size(), prefix.size()) < block_size.value(),
+        "internal nodes too full to merge");
 
-    const uint16_t new_npairs = rnode->npairs + node->npairs;
-    rnode->npairs = new_npairs;
+    impl::compact(block_size, rnode, prefix.btree_key(), pairs, 0, pairs.size());
 
     validate(block_size, rnode);
 }
@@ -147,91 +179,70 @@ bool level(block_size_t block_size, internal_node_t *node,
         moved_children_out->reserve(sibling->npairs);
     }
 
-    if (nodecmp(node, sibling) < 0) {
-        const btree_key_t *key_from_parent = &get_pair_by_index(parent, get_offset_index(parent, &get_pair_by_index(node, 0)->key))->key;
-        if (sizeof(internal_node_t) + (node->npairs + 1) * sizeof(*node->pair_offsets) + impl::pair_size_with_key(key_from_parent) >= node->frontmost_offset)
+    const bool node_is_left = nodecmp(node, sibling) < 0;
+    internal_node_t *left = node_is_left ? node : sibling;
+    internal_node_t *right = node_is_left ? sibling : node;
+
+    store_key_t key_from_parent;
+    impl::get_key_from_parent(parent, left, &key_from_parent);
+
+    impl::expanded_pairs_t pairs;
+    impl::expand(left, &pairs);
+    pairs.back().second = key_from_parent;
+    const size_t left_npairs = pairs.size();
+    impl::expand(right, &pairs);
+
+    // `node` takes over part of `sibling`'s range, so its prefix has to be shared by
+    // both. `sibling`'s range only shrinks, so it keeps its prefix.
+    store_key_t node_prefix;
+    impl::common_prefix(get_prefix(node), get_prefix(sibling), &node_prefix);
+    const store_key_t sibling_prefix(get_prefix(sibling));
+    const store_key_t &left_prefix = node_is_left ? node_prefix : sibling_prefix;
+    const store_key_t &right_prefix = node_is_left ? sibling_prefix : node_prefix;
+
+    // The new left node gets the first `split_index` pairs, and the right node gets
+    // the rest. `node` receives at least one pair from `sibling`, and then keeps
+    // receiving pairs for as long as it stays smaller than `sibling`.
+    auto left_size = [&](size_t split_index) {
+        return impl::compacted_size(pairs, 0, split_index, left_prefix.size());
+    };
+    auto right_size = [&](size_t split_index) {
+        return impl::compacted_size(pairs, split_index, pairs.size(), right_prefix.size());
+    };
+    size_t split_index;
+    if (node_is_left) {
+        split_index = left_npairs + 1;
+        if (split_index >= pairs.size()
+            || sizeof(internal_node_t) + left_size(split_index) >= block_size.value()) {
             return false;
-        uint16_t special_pair_offset = node->pair_offsets[node->npairs-1];
-        block_id_t last_offset = get_pair(node, special_pair_offset)->lnode;
-        uint16_t new_pair_offset = impl::insert_pair(node, last_offset, key_from_parent);
-        node->pair_offsets[node->npairs - 1] = new_pair_offset;
-
-        uint16_t new_npairs = node->npairs;
-        // This loop involves repeated memmoves (resulting in ~(n^2) work where n is
-        // the block size).  There should be a way to drastically reduce the number
-        // and increase efficiency.
-        for (;;) {
-            const btree_internal_pair *pair_to_move = get_pair_by_index(sibling, 0);
-            uint16_t size_change = sizeof(*node->pair_offsets) + pair_size(pair_to_move);
-            if (new_npairs * sizeof(*node->pair_offsets) + (block_size.value() - node->frontmost_offset) + size_change >= sibling->npairs * sizeof(*sibling->pair_offsets) + (block_size.value() - sibling->frontmost_offset) - size_change) {
-                break;
-            }
-
-            const uint16_t new_offset = impl::insert_pair(node, pair_to_move);
-            node->pair_offsets[new_npairs] = new_offset;
-            ++new_npairs;
-            if (moved_children_out != nullptr) {
-                moved_children_out->push_back(pair_to_move->lnode);
-            }
-
-            impl::delete_pair(sibling, sibling->pair_offsets[0]);
-            impl::delete_offset(sibling, 0);
         }
-
-        const btree_internal_pair *pair_for_parent = get_pair_by_index(sibling, 0);
-
-        node->pair_offsets[new_npairs] = special_pair_offset;
-        ++new_npairs;
-
-        node->npairs = new_npairs;
-
-        btree_internal_pair *special_pair = get_pair(node, special_pair_offset);
-        special_pair->lnode = pair_for_parent->lnode;
-
-        keycpy(replacement_key, &pair_for_parent->key);
-
-        if (moved_children_out != nullptr) {
-            moved_children_out->push_back(pair_for_parent->lnode);
+        while (split_index + 1 < pairs.size()
+               && left_size(split_index + 1) < right_size(split_index + 1)) {
+            ++split_index;
         }
-        impl::delete_pair(sibling, sibling->pair_offsets[0]);
-        impl::delete_offset(sibling, 0);
     } else {
-        uint16_t offset;
-        const btree_key_t *key_from_parent = &get_pair_by_index(parent, get_offset_index(parent, &get_pair_by_index(sibling, 0)->key))->key;
-        if (sizeof(internal_node_t) + (node->npairs + 1) * sizeof(*node->pair_offsets) + impl::pair_size_with_key(key_from_parent) >= node->frontmost_offset)
+        split_index = left_npairs - 1;
+        if (split_index == 0
+            || sizeof(internal_node_t) + right_size(split_index) >= block_size.value()) {
             return false;
-        block_id_t first_child = get_pair_by_index(sibling, sibling->npairs-1)->lnode;
-        offset = impl::insert_pair(node, first_child, key_from_parent);
-        impl::insert_offset(node, offset, 0);
-        if (moved_children_out != nullptr) {
-            moved_children_out->push_back(first_child);
         }
-        impl::delete_pair(sibling, sibling->pair_offsets[sibling->npairs-1]);
-        impl::delete_offset(sibling, sibling->npairs-1);
-
-        // This loop involves repeated memmoves. There should be a way to
-        // drastically reduce the number and increase efficiency.
-        for (;;) {
-            const btree_internal_pair *pair_to_move = get_pair_by_index(sibling, sibling->npairs-1);
-            uint16_t size_change = sizeof(*node->pair_offsets) + pair_size(pair_to_move);
-            if (node->npairs * sizeof(*node->pair_offsets) + (block_size.value() - node->frontmost_offset) + size_change >= sibling->npairs * sizeof(*sibling->pair_offsets) + (block_size.value() - sibling->frontmost_offset) - size_change) {
-                break;
-            }
-
-            offset = impl::insert_pair(node, pair_to_move);
-            impl::insert_offset(node, offset, 0);
-            if (moved_children_out != nullptr) {
-                moved_children_out->push_back(pair_to_move->lnode);
-            }
-
-            impl::delete_pair(sibling, sibling->pair_offsets[sibling->npairs-1]);
-            impl::delete_offset(sibling, sibling->npairs-1);
+        while (split_index > 1
+               && right_size(split_index - 1) < left_size(split_index - 1)) {
+            --split_index;
         }
+    }
 
-        keycpy(replacement_key, &get_pair_by_index(sibling, sibling->npairs-1)->key);
-
-        impl::make_last_pair_special(sibling);
+    if (moved_children_out != nullptr) {
+        const size_t moved_begin = std::min(left_npairs, split_index);
+        const size_t moved_end = std::max(left_npairs, split_index);
+        for (size_t i = moved_begin; i < moved_end; ++i) {
+            moved_children_out->push_back(pairs[i].first);
+        }
     }
+    keycpy(replacement_key, pairs[split_index - 1].second.btree_key());
+
+    impl::compact(block_size, left, left_prefix.btree_key(), pairs, 0, split_index);
+    impl::compact(block_size, right, right_prefix.btree_key(), pairs, split_index, pairs.size());
 
     validate(block_size, node);
     validate(block_size, sibling);
@@ -245,11 +256,11 @@ int sibling(const internal_node_t *node, const btree_key_t *key, block_id_t *sib
     int cmp;
     if (index > 0) {
         sib_pair = get_pair_by_index(node, index-1);
-        key_in_middle_out->assign(&sib_pair->key);
+        get_key_by_index(node, index-1, key_in_middle_out);
         cmp = 1;
     } else {
         sib_pair = get_pair_by_index(node, index+1);
-        key_in_middle_out->assign(&get_pair_by_index(node, index)->key);
+        get_key_by_index(node, index, key_in_middle_out);
         cmp = -1;
     }
 
@@ -271,24 +282,27 @@ bool is_sorted(ForwardIterator first, ForwardIterator last,
 }
 
 void update_key(internal_node_t *node, const btree_key_t *key_to_replace, const btree_key_t *replacement_key) {
+    guarantee(impl::has_prefix(replacement_key, get_prefix(node)),
+              "replacement key is outside of internal node's key range");
+    const int prefix_size = impl::prefix_size(node);
 
     const int index = get_offset_index(node, key_to_replace);
     const block_id_t tmp_lnode = get_pair_by_index(node, index)->lnode;
     impl::delete_pair(node, node->pair_offsets[index]);
 
-    guarantee(sizeof(internal_node_t) + (node->npairs) * sizeof(*node->pair_offsets) + impl::pair_size_with_key(replacement_key) < node->frontmost_offset,
+    guarantee(sizeof(internal_node_t) + (node->npairs) * sizeof(*node->pair_offsets) + impl::pair_size_with_key_size(replacement_key->size - prefix_size) < node->frontmost_offset,
         "cannot fit updated key in internal node");
 
-    const uint16_t new_offset = impl::insert_pair(node, tmp_lnode, replacement_key);
+    const uint16_t new_offset = impl::insert_pair(node, tmp_lnode, replacement_key, prefix_size);
     node->pair_offsets[index] = new_offset;
 
     rassert(is_sorted(node->pair_offsets, node->pair_offsets+node->npairs-1, internal_key_comp(node)),
             "Invalid key given to update_key: offsets no longer in sorted order");
-    rassert(get_pair_by_index(node, node->npairs-1)->key.size == 0);
 }
 
 bool is_full(const internal_node_t *node) {
-    return sizeof(internal_node_t) + (node->npairs + 1) * sizeof(*node->pair_offsets) + impl::pair_size_with_key_size(MAX_KEY_SIZE) >=  node->frontmost_offset;
+    // Every key that can be inserted starts with the node's prefix.
+    return sizeof(internal_node_t) + (node->npairs + 1) * sizeof(*node->pair_offsets) + impl::pair_size_with_key_size(MAX_KEY_SIZE - impl::prefix_size(node)) >=  node->frontmost_offset;
 }
 
 bool change_unsafe(const internal_node_t *node) {
@@ -297,6 +311,8 @@ bool change_unsafe(const internal_node_t *node) {
 
 void validate(DEBUG_VAR block_size_t block_size, DEBUG_VAR const internal_node_t *node) {
 #ifndef NDEBUG
+    rassert(node->magic == internal_node_t::expected_magic
+            || node->magic == internal_node_t::legacy_magic);
     rassert(reinterpret_cast<const char *>(&(node->pair_offsets[node->npairs])) <= reinterpret_cast<const char *>(get_pair(node, node->frontmost_offset)));
     rassert(node->frontmost_offset > 0);
     rassert(node->frontmost_offset <= block_size.value());
@@ -306,7 +322,7 @@ void validate(DEBUG_VAR block_size_t block_size, DEBUG_VAR const internal_node_t
     }
     rassert(is_sorted(node->pair_offsets, node->pair_offsets+node->npairs-1, internal_key_comp(node)),
         "Offsets no longer in sorted order");
-    rassert(get_pair_by_index(node, node->npairs-1)->key.size == 0);
+    rassert(node->magic == internal_node_t::expected_magic || impl::prefix_size(node) == 0);
 #endif
 }
 
@@ -319,17 +335,25 @@ bool is_underfull(block_size_t block_size, const internal_node_t *node) {
 }
 
 bool is_mergable(block_size_t block_size, const internal_node_t *node, const internal_node_t *sibling, const internal_node_t *parent) {
-    const btree_key_t *key_from_parent;
+    store_key_t key_from_parent;
+    impl::expanded_pairs_t pairs;
     if (nodecmp(node, sibling) < 0) {
-        key_from_parent = &get_pair_by_index(parent, get_offset_index(parent, &get_pair_by_index(node, 0)->key))->key;
+        impl::get_key_from_parent(parent, node, &key_from_parent);
+        impl::expand(node, &pairs);
+        pairs.back().second = key_from_parent;
+        impl::expand(sibling, &pairs);
     } else {
-        key_from_parent = &get_pair_by_index(parent, get_offset_index(parent, &get_pair_by_index(sibling, 0)->key))->key;
+        impl::get_key_from_parent(parent, sibling, &key_from_parent);
+        impl::expand(sibling, &pairs);
+        pairs.back().second = key_from_parent;
+        impl::expand(node, &pairs);
     }
+    store_key_t prefix;
+    impl::common_prefix(get_prefix(node), get_prefix(sibling), &prefix);
     return sizeof(internal_node_t) +
-        (node->npairs + sibling->npairs + 1)*sizeof(*node->pair_offsets) +
-        (block_size.value() - node->frontmost_offset) +
-        (block_size.value() - sibling->frontmost_offset) + key_from_parent->size +
-        impl::pair_size_with_key_size(MAX_KEY_SIZE) +
+        impl::compacted_size(pairs, 0, pairs.size(), prefix.size()) +
+        sizeof(*node->pair_offsets) +
+        impl::pair_size_with_key_size(MAX_KEY_SIZE - prefix.size()) +
         INTERNAL_EPSILON < block_size.value(); // must still have enough room for an arbitrary key  // TODO: we can't be tighter?
 }
 
@@ -357,14 +381,55 @@ btree_internal_pair *get_pair_by_index(internal_node_t *node, int index) {
 }
 
 int get_offset_index(const internal_node_t *node, const btree_key_t *key) {
-    return std::lower_bound(node->pair_offsets, node->pair_offsets+node->npairs-1, (uint16_t) internal_key_comp::faux_offset, internal_key_comp(node, key)) - node->pair_offsets;
+    if (node->npairs <= 1) {
+        return 0;
+    }
+    // A key that doesn't start with the prefix sorts before or after all keys in the
+    // node. Otherwise we only have to compare the rest of it.
+    const btree_key_t *prefix = get_prefix(node);
+    const int cmp = memcmp(key->contents, prefix->contents, std::min(key->size, prefix->size));
+    if (cmp < 0 || (cmp == 0 && key->size < prefix->size)) {
+        return 0;
+    } else if (cmp > 0) {
+        return node->npairs - 1;
+    }
+    const uint8_t *suffix = key->contents + prefix->size;
+    const int suffix_size = key->size - prefix->size;
+    int lo = 0;
+    int hi = node->npairs - 1;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const btree_key_t *mid_key = &get_pair_by_index(node, mid)->key;
+        if (sized_strcmp(mid_key->contents, mid_key->size, suffix, suffix_size) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+const btree_key_t *get_prefix(const internal_node_t *node) {
+    rassert(node->npairs > 0);
+    return &get_pair_by_index(node, node->npairs - 1)->key;
+}
+
+void get_key_by_index(const internal_node_t *node, int index, store_key_t *key_out) {
+    rassert(index < node->npairs - 1);
+    const btree_key_t *prefix = get_prefix(node);
+    const btree_key_t *suffix = &get_pair_by_index(node, index)->key;
+    key_out->set_size(prefix->size + suffix->size);
+    memcpy(key_out->contents(), prefix->contents, prefix->size);
+    memcpy(key_out->contents() + prefix->size, suffix->contents, suffix->size);
 }
 
 int nodecmp(const internal_node_t *node1, const internal_node_t *node2) {
-    const btree_key_t *key1 = &get_pair_by_index(node1, 0)->key;
-    const btree_key_t *key2 = &get_pair_by_index(node2, 0)->key;
+    store_key_t key1;
+    store_key_t key2;
+    impl::first_key(node1, &key1);
+    impl::first_key(node2, &key2);
 
-    return btree_key_cmp(key1, key2);
+    return btree_key_cmp(key1.btree_key(), key2.btree_key());
 }
 
 namespace impl {
@@ -383,9 +448,9 @@ void delete_pair(internal_node_t *node, uint16_t offset) {
     const size_t shift = pair_size(pair_to_delete);
     const size_t size = offset - node->frontmost_offset;
 
-    rassert(node->magic == internal_node_t::expected_magic);
+    const block_magic_t magic = node->magic;
     memmove(reinterpret_cast<char *>(front_pair) + shift, front_pair, size);
-    rassert(node->magic == internal_node_t::expected_magic);
+    rassert(node->magic == magic);
 
 
     node->frontmost_offset = node->frontmost_offset + shift;
@@ -401,31 +466,29 @@ void delete_pair(internal_node_t *node, uint16_t offset) {
     memcpy(node->pair_offsets, new_pair_offsets.data(), sizeof(uint16_t) * node->npairs);
 }
 
-uint16_t insert_pair(internal_node_t *node, const btree_internal_pair *pair) {
-    const uint16_t frontmost_offset = node->frontmost_offset - pair_size(pair);
-    node->frontmost_offset = frontmost_offset;
-
-    // insert contents
-    memcpy(get_pair(node, frontmost_offset), pair, pair_size(pair));
-    return frontmost_offset;
+uint16_t insert_pair(internal_node_t *node, block_id_t lnode, const btree_key_t *key) {
+    return insert_pair(node, lnode, key, 0);
 }
 
-uint16_t insert_pair(internal_node_t *node, block_id_t lnode, const btree_key_t *key) {
-    const uint16_t frontmost_offset = node->frontmost_offset - pair_size_with_key(key);
+uint16_t insert_pair(internal_node_t *node, block_id_t lnode, const btree_key_t *key, int prefix_size) {
+    rassert(prefix_size <= key->size);
+    const uint8_t suffix_size = key->size - prefix_size;
+    const uint16_t frontmost_offset = node->frontmost_offset - pair_size_with_key_size(suffix_size);
     node->frontmost_offset = frontmost_offset;
 
     btree_internal_pair *new_pair = get_pair(node, frontmost_offset);
 
     // Use a buffer to prepare the key/value pair which we can then use to generate a patch
-    scoped_array_t<char> pair_buf(pair_size_with_key(key));
+    scoped_array_t<char> pair_buf(pair_size_with_key_size(suffix_size));
     btree_internal_pair *new_buf_pair = reinterpret_cast<btree_internal_pair *>(pair_buf.data());
 
     // insert contents
     new_buf_pair->lnode = lnode;
-    keycpy(&new_buf_pair->key, key);
+    new_buf_pair->key.size = suffix_size;
+    memcpy(new_buf_pair->key.contents, key->contents + prefix_size, suffix_size);
 
     // Patch the new pair into node_buf
-    memcpy(new_pair, new_buf_pair, pair_size_with_key(key));
+    memcpy(new_pair, new_buf_pair, pair_size_with_key_size(suffix_size));
 
     return frontmost_offset;
 }
@@ -445,12 +508,10 @@ void insert_offset(internal_node_t *node, uint16_t offset, int index) {
     node->npairs += 1;
 }
 
-void make_last_pair_special(internal_node_t *node) {
+void make_last_pair_special(internal_node_t *node, const btree_key_t *prefix) {
     const int index = node->npairs - 1;
     const uint16_t old_offset = node->pair_offsets[index];
-    btree_key_t tmp;
-    tmp.size = 0;
-    const uint16_t new_offset = insert_pair(node, get_pair(node, old_offset)->lnode, &tmp);
+    const uint16_t new_offset = insert_pair(node, get_pair(node, old_offset)->lnode, prefix);
     node->pair_offsets[index] = new_offset;
     delete_pair(node, old_offset);
 }
@@ -460,7 +521,78 @@ bool is_equal(const btree_key_t *key1, const btree_key_t *key2) {
     return btree_key_cmp(key1, key2) == 0;
 }
 
+int prefix_size(const internal_node_t *node) {
+    return node->npairs == 0 ? 0 : get_prefix(node)->size;
+}
+
+bool has_prefix(const btree_key_t *key, const btree_key_t *prefix) {
+    return key->size >= prefix->size
+        && memcmp(key->contents, prefix->contents, prefix->size) == 0;
+}
+
+void common_prefix(const btree_key_t *key1, const btree_key_t *key2, store_key_t *out) {
+    int size = 0;
+    const int max_size = std::min(key1->size, key2->size);
+    while (size < max_size && key1->contents[size] == key2->contents[size]) {
+        ++size;
+    }
+    out->assign(size, key1->contents);
+}
+
+void first_key(const internal_node_t *node, store_key_t *key_out) {
+    if (node->npairs > 1) {
+        get_key_by_index(node, 0, key_out);
+    } else {
+        key_out->set_size(0);
+    }
+}
+
+void get_key_from_parent(const internal_node_t *parent, const internal_node_t *node, store_key_t *key_out) {
+    store_key_t key_in_node;
+    first_key(node, &key_in_node);
+    get_key_by_index(parent, get_offset_index(parent, key_in_node.btree_key()), key_out);
+}
+
+void expand(const internal_node_t *node, expanded_pairs_t *pairs_out) {
+    pairs_out->reserve(pairs_out->size() + node->npairs);
+    for (int i = 0; i < node->npairs; ++i) {
+        pairs_out->push_back(std::make_pair(get_pair_by_index(node, i)->lnode, store_key_t()));
+        if (i < node->npairs - 1) {
+            get_key_by_index(node, i, &pairs_out->back().second);
+        }
+    }
+}
+
+// The size of the pairs in `[begin, end)` and their offsets, once compacted.
+size_t compacted_size(const expanded_pairs_t &pairs, size_t begin, size_t end, int prefix_size) {
+    rassert(begin < end);
+    size_t size = (end - begin) * sizeof(uint16_t) + pair_size_with_key_size(prefix_size);
+    for (size_t i = begin; i < end - 1; ++i) {
+        size += pair_size_with_key_size(pairs[i].second.size() - prefix_size);
+    }
+    return size;
+}
+
+// Replaces the contents of `node` with the pairs in `[begin, end)`, storing only the
+// part of each key after `prefix`. The key of the last pair is dropped.
+void compact(block_size_t block_size, internal_node_t *node, const btree_key_t *prefix,
+             const expanded_pairs_t &pairs, size_t begin, size_t end) {
+    rassert(begin < end);
+    rassert(sizeof(internal_node_t) + compacted_size(pairs, begin, end, prefix->size) <= block_size.value());
+    init(block_size, node);
+    for (size_t i = begin; i < end; ++i) {
+        uint16_t offset;
+        if (i < end - 1) {
+            rassert(has_prefix(pairs[i].second.btree_key(), prefix));
+            offset = insert_pair(node, pairs[i].first, pairs[i].second.btree_key(), prefix->size);
+        } else {
+            offset = insert_pair(node, pairs[i].first, prefix);
+        }
+        node->pair_offsets[node->npairs] = offset;
+        ++node->npairs;
+    }
+}
+
 }  // namespace impl
 
 }  // namespace internal_node
-
@@ -17,6 +17,10 @@ struct internal_node_t;
 #define INTERNAL_EPSILON (sizeof(btree_key_t) + MAX_KEY_SIZE + sizeof(block_id_t))
 
 //Note: This struct is stored directly on disk.  Changing it invalidates old data.
+// In nodes with `internal_node_t::expected_magic`, `key` only holds the part of the
+// key that follows the node's prefix. The last pair of every node has no key of its
+// own, so it holds the prefix instead. In nodes with `internal_node_t::legacy_magic`,
+// the prefix is always empty, which makes them valid in both formats.
 ATTR_PACKED(struct btree_internal_pair {
     block_id_t lnode;
     btree_key_t key;
@@ -29,12 +33,14 @@ class internal_key_comp;
 namespace internal_node {
 
 void init(block_size_t block_size, internal_node_t *node);
-void init(block_size_t block_size, internal_node_t *node, const internal_node_t *lnode, const uint16_t *offsets, int numpairs);
 
 block_id_t lookup(const internal_node_t *node, const btree_key_t *key);
 bool insert(internal_node_t *node, const btree_key_t *key, block_id_t lnode, block_id_t rnode);
 bool remove(block_size_t block_size, internal_node_t *node, const btree_key_t *key);
-void split(block_size_t block_size, internal_node_t *node, internal_node_t *rnode, btree_key_t *median);
+// `left_excl_or_null` and `right_incl_or_null` are the bounds of `node`'s key range
+// in its parent, if known. They are used to pick longer prefixes for the two halves.
+void split(block_size_t block_size, internal_node_t *node, internal_node_t *rnode, btree_key_t *median,
+           const btree_key_t *left_excl_or_null, const btree_key_t *right_incl_or_null);
 void merge(block_size_t block_size, const internal_node_t *node, internal_node_t *rnode, const internal_node_t *parent);
 bool level(block_size_t block_size, internal_node_t *node, internal_node_t *sibling,
            btree_key_t *replacement_key, const internal_node_t *parent,
@@ -59,8 +65,16 @@ btree_internal_pair *get_pair_by_index(internal_node_t *node, int index);
 
 int get_offset_index(const internal_node_t *node, const btree_key_t *key);
 
+// The prefix shared by all keys in `node`'s key range. `node` must not be empty.
+const btree_key_t *get_prefix(const internal_node_t *node);
+
+// Reconstructs the full key of the pair at `index`, which must not be the last pair.
+void get_key_by_index(const internal_node_t *node, int index, store_key_t *key_out);
+
 }  // namespace internal_node
 
+// Compares the keys stored in pairs of the same node, i.e. the parts of the keys that
+// follow the node's prefix.
 class internal_key_comp {
     const internal_node_t *node;
     const btree_key_t *key;
@@ -1,6 +1,10 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "btree/keys.hpp"
 
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
 #include "debug.hpp"
 #include "utils.hpp"
 
@@ -20,6 +24,46 @@ int sized_strcmp(const uint8_t *str1, int len1, const uint8_t *str2, int len2) {
     return res;
 }
 
+int sized_strcmp_common_prefix(const uint8_t *str1, int len1,
+                               const uint8_t *str2, int len2,
+                               int known_common, int *common_out) {
+    const int min_len = std::min(len1, len2);
+    rassert(known_common <= min_len);
+    rassert(memcmp(str1, str2, known_common) == 0);
+    int i = known_common;
+#if defined(__SSE2__) && defined(__GNUC__)
+    // Find the first differing byte 16 bytes at a time.
+    while (i + 16 <= min_len) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str1 + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str2 + i));
+        const unsigned int diff = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xffff;
+        if (diff != 0) {
+            i += __builtin_ctz(diff);
+            *common_out = i;
+            return static_cast<int>(str1[i]) - static_cast<int>(str2[i]);
+        }
+        i += 16;
+    }
+#endif
+    while (i + 8 <= min_len) {
+        uint64_t a, b;
+        memcpy(&a, str1 + i, sizeof(a));
+        memcpy(&b, str2 + i, sizeof(b));
+        if (a != b) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < min_len && str1[i] == str2[i]) {
+        ++i;
+    }
+    *common_out = i;
+    if (i < min_len) {
+        return static_cast<int>(str1[i]) - static_cast<int>(str2[i]);
+    }
+    return len1 - len2;
+}
+
 bool unescaped_str_to_key(const char *str, int len, store_key_t *buf) {
     if (len <= MAX_KEY_SIZE) {
         memcpy(buf->contents(), str, len);
@@ -38,6 +38,14 @@ bool is_better(const T &a, const T &b, sorting_t sorting) {
 // Fast string compare
 int sized_strcmp(const uint8_t *str1, int len1, const uint8_t *str2, int len2);
 
+// Like `sized_strcmp()`, but skips the first `known_common` bytes, which the caller
+// knows to be equal, and stores the length of the strings' common prefix in
+// `*common_out`. Binary searches use this to avoid comparing the bytes that every
+// remaining candidate shares with the key they're looking for.
+int sized_strcmp_common_prefix(const uint8_t *str1, int len1,
+                               const uint8_t *str2, int len2,
+                               int known_common, int *common_out);
+
 // Note: Changing this struct changes the format of the data stored on disk.
 // If you change this struct, previous stored data will be misinterpreted.
 ATTR_PACKED(struct btree_key_t {
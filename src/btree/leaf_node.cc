@@ -1190,20 +1190,32 @@ bool find_key(const leaf_node_t *node, const btree_key_t *key, int *index_out) {
     // beg == 0 or key > *(beg - 1).
     // end == num_pairs or key < *end.
 
+    // The length of the common prefix of key and *(beg - 1), and of key and *end
+    // (0 if there is no such entry). Every key in [beg, end) shares the smaller of the
+    // two with key, because the keys are sorted, so probes can skip those bytes. This
+    // matters for secondary index keys, which tend to share long prefixes.
+    int beg_common = 0;
+    int end_common = 0;
+
     while (beg < end) {
         // when (end - beg) > 0, (end - beg) / 2 is always less than (end - beg).  So beg <= test_point < end.
         int test_point = beg + (end - beg) / 2;
 
         const btree_key_t *ek = entry_key(get_entry(node, node->pair_offsets[test_point]));
 
-        int res = btree_key_cmp(key, ek);
+        int common;
+        int res = sized_strcmp_common_prefix(key->contents, key->size,
+                                             ek->contents, ek->size,
+                                             std::min(beg_common, end_common), &common);
 
         if (res < 0) {
             // key < *test_point.
             end = test_point;
+            end_common = common;
         } else if (res > 0) {
             // key > *test_point.  Since test_point < end, we have test_point + 1 <= end.
             beg = test_point + 1;
+            beg_common = common;
         } else {
             // We found the key!
             *index_out = test_point;
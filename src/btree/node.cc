@@ -4,7 +4,8 @@
 #include "btree/leaf_node.hpp"
 #include "btree/internal_node.hpp"
 
-const block_magic_t internal_node_t::expected_magic = { { 'i', 'n', 't', 'e' } };
+const block_magic_t internal_node_t::expected_magic = { { 'i', 'n', 't', 'p' } };
+const block_magic_t internal_node_t::legacy_magic = { { 'i', 'n', 't', 'e' } };
 
 namespace node {
 
@@ -27,13 +28,15 @@ bool is_mergable(value_sizer_t *sizer, const node_t *node, const node_t *sibling
 }
 
 
-void split(value_sizer_t *sizer, node_t *node, node_t *rnode, btree_key_t *median) {
+void split(value_sizer_t *sizer, node_t *node, node_t *rnode, btree_key_t *median,
+           const btree_key_t *left_excl_or_null, const btree_key_t *right_incl_or_null) {
     if (is_leaf(node)) {
         leaf::split(sizer, reinterpret_cast<leaf_node_t *>(node),
                     reinterpret_cast<leaf_node_t *>(rnode), median);
     } else {
         internal_node::split(sizer->block_size(), reinterpret_cast<internal_node_t *>(node),
-                             reinterpret_cast<internal_node_t *>(rnode), median);
+                             reinterpret_cast<internal_node_t *>(rnode), median,
+                             left_excl_or_null, right_incl_or_null);
     }
 }
 
@@ -49,7 +52,7 @@ void validate(DEBUG_VAR value_sizer_t *sizer, DEBUG_VAR const node_t *node) {
 #ifndef NDEBUG
     if (node->magic == sizer->btree_leaf_magic()) {
         leaf::validate(sizer, reinterpret_cast<const leaf_node_t *>(node));
-    } else if (node->magic == internal_node_t::expected_magic) {
+    } else if (is_internal(node)) {
         internal_node::validate(sizer->block_size(), reinterpret_cast<const internal_node_t *>(node));
     } else {
         unreachable("Invalid leaf node type.");
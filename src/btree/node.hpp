@@ -50,6 +50,9 @@ ATTR_PACKED(struct internal_node_t {
     uint16_t pair_offsets[0];
 
     static const block_magic_t expected_magic;
+    // Nodes written before keys were stored relative to a per-node prefix. They are
+    // read as nodes with an empty prefix.
+    static const block_magic_t legacy_magic;
 });
 
 // A node_t is either a btree_internal_node or a btree_leaf_node.
@@ -60,7 +63,8 @@ ATTR_PACKED(struct node_t {
 namespace node {
 
 inline bool is_internal(const node_t *node) {
-    if (node->magic == internal_node_t::expected_magic) {
+    if (node->magic == internal_node_t::expected_magic
+        || node->magic == internal_node_t::legacy_magic) {
         return true;
     }
     return false;
@@ -77,7 +81,10 @@ bool is_mergable(value_sizer_t *sizer, const node_t *node, const node_t *sibling
 
 bool is_underfull(value_sizer_t *sizer, const node_t *node);
 
-void split(value_sizer_t *sizer, node_t *node, node_t *rnode, btree_key_t *median);
+// `left_excl_or_null` and `right_incl_or_null` are the bounds of `node`'s key range,
+// or `nullptr` if they aren't known.
+void split(value_sizer_t *sizer, node_t *node, node_t *rnode, btree_key_t *median,
+           const btree_key_t *left_excl_or_null, const btree_key_t *right_incl_or_null);
 
 void merge(value_sizer_t *sizer, node_t *node, node_t *rnode, const internal_node_t *parent);
 
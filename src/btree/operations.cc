@@ -106,13 +106,33 @@ void check_and_handle_split(value_sizer_t *sizer,
     store_key_t median_buffer;
     btree_key_t *median = median_buffer.btree_key();
 
+    // The bounds of the node's key range in its parent, which let an internal node
+    // pick longer key prefixes for the two halves.
+    store_key_t left_bound_buffer, right_bound_buffer;
+    const btree_key_t *left_excl_or_null = nullptr;
+    const btree_key_t *right_incl_or_null = nullptr;
+    if (!last_buf->empty()) {
+        buf_read_t last_read(last_buf);
+        const internal_node_t *parent
+            = static_cast<const internal_node_t *>(last_read.get_data_read());
+        int index = internal_node::get_offset_index(parent, key);
+        if (index > 0) {
+            internal_node::get_key_by_index(parent, index - 1, &left_bound_buffer);
+            left_excl_or_null = left_bound_buffer.btree_key();
+        }
+        if (index < parent->npairs - 1) {
+            internal_node::get_key_by_index(parent, index, &right_bound_buffer);
+            right_incl_or_null = right_bound_buffer.btree_key();
+        }
+    }
+
     {
         buf_write_t buf_write(buf);
         buf_write_t rbuf_write(&rbuf);
         node::split(sizer,
                     static_cast<node_t *>(buf_write.get_data_write()),
                     static_cast<node_t *>(rbuf_write.get_data_write()),
-                    median);
+                    median, left_excl_or_null, right_incl_or_null);
 
         // We must detach all entries that we have removed from `buf`.
         buf_read_t rbuf_read(&rbuf);
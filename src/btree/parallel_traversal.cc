@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "btree/parallel_traversal.hpp"
 
+#include <algorithm>
+
 #include "arch/runtime/runtime.hpp"
 #include "btree/internal_node.hpp"
 #include "btree/node.hpp"
@@ -583,6 +585,22 @@ void interesting_children_callback_t::decr_acquisition_countdown() {
 }
 
 
+ranged_block_ids_t::ranged_block_ids_t(block_size_t bs, const internal_node_t *node,
+                                       const btree_key_t *left_exclusive_or_null,
+                                       const btree_key_t *right_inclusive_or_null,
+                                       int _level)
+    : node_(bs.value()),
+      keys_(std::max(node->npairs - 1, 0)),
+      left_exclusive_or_null_(left_exclusive_or_null),
+      right_inclusive_or_null_(right_inclusive_or_null),
+      level(_level)
+{
+    memcpy(node_.get(), node, bs.value());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        internal_node::get_key_by_index(node, i, &keys_[i]);
+    }
+}
+
 int ranged_block_ids_t::num_block_ids() const {
     if (node_.has()) {
         return node_->npairs;
@@ -601,13 +619,12 @@ void ranged_block_ids_t::get_block_id_and_bounding_interval(int index,
 
         const btree_internal_pair *pair = internal_node::get_pair_by_index(node_.get(), index);
         *block_id_out = pair->lnode;
-        *right_incl_bound_out = (index == node_->npairs - 1 ? right_inclusive_or_null_ : &pair->key);
+        *right_incl_bound_out = (index == node_->npairs - 1 ? right_inclusive_or_null_ : keys_[index].btree_key());
 
         if (index == 0) {
             *left_excl_bound_out = left_exclusive_or_null_;
         } else {
-            const btree_internal_pair *left_neighbor = internal_node::get_pair_by_index(node_.get(), index - 1);
-            *left_excl_bound_out = &left_neighbor->key;
+            *left_excl_bound_out = keys_[index - 1].btree_key();
         }
     } else {
         *block_id_out = forced_block_id_;
@@ -43,14 +43,7 @@ public:
     ranged_block_ids_t(block_size_t bs, const internal_node_t *node,
                        const btree_key_t *left_exclusive_or_null,
                        const btree_key_t *right_inclusive_or_null,
-                       int _level)
-        : node_(bs.value()),
-          left_exclusive_or_null_(left_exclusive_or_null),
-          right_inclusive_or_null_(right_inclusive_or_null),
-          level(_level)
-    {
-        memcpy(node_.get(), node, bs.value());
-    }
+                       int _level);
     ranged_block_ids_t(block_id_t forced_block_id,
                        const btree_key_t *left_exclusive_or_null,
                        const btree_key_t *right_inclusive_or_null,
@@ -72,6 +65,8 @@ public:
 
 private:
     scoped_malloc_t<internal_node_t> node_;
+    // The full keys of `node_`'s pairs, which the bounds we hand out point into.
+    std::vector<store_key_t> keys_;
     block_id_t forced_block_id_;
     const btree_key_t *left_exclusive_or_null_;
     const btree_key_t *right_inclusive_or_null_;
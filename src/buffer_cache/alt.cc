@@ -115,6 +115,10 @@ cache_account_t cache_t::create_cache_account(int priority) {
     return page_cache_.create_cache_account(priority);
 }
 
+void cache_t::set_memory_bounds(uint64_t reservation, uint64_t cap) {
+    page_cache_.evicter().set_memory_bounds(reservation, cap);
+}
+
 alt_snapshot_node_t *
 cache_t::matching_snapshot_node_or_null(block_id_t block_id,
                                         block_version_t block_version) {
@@ -221,6 +225,10 @@ void txn_t::help_construct(int64_t expected_change_count,
         // To more easily detect code that assumes that transaction creation
         // does not block, we always yield in debug mode.
         DEBUG_ONLY_CODE(coro_t::yield_ordered());
+        // Creating blocks and setting recencies needs the page cache's free list
+        // and recencies, which are loaded in the background.  Read transactions
+        // don't need them.
+        cache_->page_cache_.index_loaded_signal()->wait_lazily_ordered();
     }
     throttler_acq_t throttler_acq(
         access_ == access_t::write
@@ -741,6 +749,7 @@ repli_timestamp_t buf_lock_t::get_recency() const {
     // page_cache wait for the write_acq_signal() so that a write acquirer can't see
     // its recency change before/after the write_acq_signal() gets pulsed.)
     if (access() == access_t::read) {
+        cache()->page_cache_.index_loaded_signal()->wait();
         cpa->read_acq_signal()->wait();
     } else {
         cpa->write_acq_signal()->wait();
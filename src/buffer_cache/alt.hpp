@@ -55,6 +55,10 @@ public:
     // might consider supporting a mem_cap paremeter.
     cache_account_t create_cache_account(int priority);
 
+    // Bounds the memory limit the cache balancer gives this cache. `cap` may be
+    // `UINT64_MAX` for no cap.
+    void set_memory_bounds(uint64_t reservation, uint64_t cap);
+
 private:
     friend class txn_t;
     friend class buf_read_t;
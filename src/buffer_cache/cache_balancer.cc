@@ -16,12 +16,16 @@ alt_cache_balancer_t::cache_data_t::cache_data_t(alt::evicter_t *_evicter) :
     evicter(_evicter),
     new_size(0),
     old_size(evicter->memory_limit()),
+    min_size(evicter->memory_reservation()),
+    max_size(evicter->memory_cap()),
     bytes_loaded(evicter->get_bytes_loaded()),
     access_count(evicter->access_count()) { }
 
 alt_cache_balancer_t::alt_cache_balancer_t(
-        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable) :
+        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable,
+        cache_eviction_policy_t _eviction_policy) :
     total_cache_size_watchable(_total_cache_size_watchable),
+    eviction_policy_(_eviction_policy),
     rebalance_timer(make_scoped<repeating_timer_t>(rebalance_check_interval_ms, this)),
     rebalance_timer_state(rebalance_timer_state_t::normal),
     last_rebalance_time(0),
@@ -148,8 +152,6 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
 
     // Calculate new cache sizes
     if (total_evicters > 0) {
-        uint64_t total_new_sizes = 0;
-
         for (size_t i = 0; i < cache_data.size(); ++i) {
             for (size_t j = 0; j < cache_data[i].size(); ++j) {
                 cache_data_t *data = &cache_data[i][j];
@@ -165,35 +167,15 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
                     new_size = std::max<int64_t>(new_size, 0);
 
                     data->new_size = new_size;
-                    total_new_sizes += new_size;
                 } else {
                     data->new_size = 0;
                 }
             }
         }
 
-        // Distribute any rounding error across shards
-        int64_t extra_bytes = total_cache_size - total_new_sizes;
-        while (extra_bytes != 0) {
-            int64_t delta = extra_bytes / static_cast<int64_t>(total_evicters);
-            if (delta == 0) {
-                delta = ((extra_bytes < 0) ? -1 : 1);
-            }
-            for (size_t i = 0; i < cache_data.size() && extra_bytes != 0; ++i) {
-                for (size_t j = 0; j < cache_data[i].size() && extra_bytes != 0; ++j) {
-                    cache_data_t *data = &cache_data[i][j];
-
-                    // Avoid underflow
-                    if (static_cast<int64_t>(data->new_size) + delta >= 0) {
-                        data->new_size += delta;
-                        extra_bytes -= delta;
-                    } else {
-                        extra_bytes += data->new_size;
-                        data->new_size = 0;
-                    }
-                }
-            }
-        }
+        // Distribute any rounding error across shards, and honor the shards'
+        // reservations and caps
+        apply_memory_bounds(total_cache_size, &cache_data);
 
         // Send new cache sizes to each thread
         pmap(num_threads,
@@ -213,6 +195,72 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
     }
 }
 
+void alt_cache_balancer_t::apply_memory_bounds(
+        uint64_t total_cache_size,
+        scoped_array_t<std::vector<cache_data_t> > *cache_data) {
+    // If the reservations add up to more than the total cache size, every shard gets
+    // the same fraction of its reservation.
+    uint64_t total_reserved = 0;
+    for (size_t i = 0; i < cache_data->size(); ++i) {
+        for (const cache_data_t &data : (*cache_data)[i]) {
+            total_reserved += data.min_size;
+        }
+    }
+    const double reservation_fraction = total_reserved > total_cache_size
+        ? static_cast<double>(total_cache_size) / static_cast<double>(total_reserved)
+        : 1.0;
+
+    int64_t extra_bytes = total_cache_size;
+    for (size_t i = 0; i < cache_data->size(); ++i) {
+        for (cache_data_t &data : (*cache_data)[i]) {
+            data.min_size = data.min_size * reservation_fraction;
+            data.new_size = std::min(std::max(data.new_size, data.min_size),
+                                     data.max_size);
+            extra_bytes -= data.new_size;
+        }
+    }
+
+    while (extra_bytes != 0) {
+        // Count the shards that have room to grow or shrink.
+        int64_t num_adjustable = 0;
+        for (size_t i = 0; i < cache_data->size(); ++i) {
+            for (const cache_data_t &data : (*cache_data)[i]) {
+                if (extra_bytes > 0 ? data.new_size < data.max_size
+                                    : data.new_size > data.min_size) {
+                    ++num_adjustable;
+                }
+            }
+        }
+        if (num_adjustable == 0) {
+            // All shards are at their caps, or at their reservations.
+            break;
+        }
+
+        int64_t delta = extra_bytes / num_adjustable;
+        if (delta == 0) {
+            delta = ((extra_bytes < 0) ? -1 : 1);
+        }
+        for (size_t i = 0; i < cache_data->size() && extra_bytes != 0; ++i) {
+            for (size_t j = 0;
+                 j < (*cache_data)[i].size() && extra_bytes != 0;
+                 ++j) {
+                cache_data_t *data = &(*cache_data)[i][j];
+                if (delta > 0) {
+                    uint64_t step = std::min<uint64_t>(delta,
+                                                       data->max_size - data->new_size);
+                    data->new_size += step;
+                    extra_bytes -= step;
+                } else {
+                    uint64_t step = std::min<uint64_t>(-delta,
+                                                       data->new_size - data->min_size);
+                    data->new_size -= step;
+                    extra_bytes += step;
+                }
+            }
+        }
+    }
+}
+
 void alt_cache_balancer_t::collect_stats_from_thread(
         int index,
         scoped_array_t<std::vector<cache_data_t> > *data_out,
@@ -8,6 +8,8 @@
 #include "errors.hpp"
 #include "time.hpp"
 
+#include "buffer_cache/types.hpp"
+
 #include "threading.hpp"
 #include "arch/timing.hpp"
 #include "concurrency/pump_coro.hpp"
@@ -30,6 +32,9 @@ public:
     // Tells caches whether to start read ahead initially
     virtual bool read_ahead_ok_at_start() const = 0;
 
+    // Tells caches how to pick the pages they evict
+    virtual cache_eviction_policy_t eviction_policy() const = 0;
+
     // Returns a pointer to a boolean for the given thread number (which must be the
     // current thread) which, when set to true, means you should notify the balancer
     // that it should wake up.  Stuff outside the balancer should only set it from
@@ -55,8 +60,12 @@ protected:
 // Dummy balancer that does nothing but provide the initial size of a cache
 class dummy_cache_balancer_t final : public cache_balancer_t {
 public:
-    explicit dummy_cache_balancer_t(uint64_t _base_mem_per_store)
+    explicit dummy_cache_balancer_t(
+            uint64_t _base_mem_per_store,
+            cache_eviction_policy_t _eviction_policy
+                = cache_eviction_policy_t::TWO_QUEUE)
         : base_mem_per_store_(_base_mem_per_store),
+          eviction_policy_(_eviction_policy),
           notify_activity_boolean_(false) { }
     ~dummy_cache_balancer_t() { }
 
@@ -68,6 +77,10 @@ public:
         return false;
     }
 
+    cache_eviction_policy_t eviction_policy() const final {
+        return eviction_policy_;
+    }
+
     bool *notify_activity_boolean(threadnum_t) final {
         return &notify_activity_boolean_;
     }
@@ -80,6 +93,8 @@ private:
 
     uint64_t base_mem_per_store_;
 
+    cache_eviction_policy_t eviction_policy_;
+
     bool notify_activity_boolean_;
 
     DISABLE_COPYING(dummy_cache_balancer_t);
@@ -89,8 +104,9 @@ class alt_cache_balancer_t final :
     public cache_balancer_t,
     public repeating_timer_callback_t {
 public:
-    explicit alt_cache_balancer_t(
-        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable);
+    alt_cache_balancer_t(
+        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable,
+        cache_eviction_policy_t _eviction_policy);
     ~alt_cache_balancer_t();
 
     uint64_t base_mem_per_store() const final {
@@ -101,6 +117,10 @@ public:
         return true;
     }
 
+    cache_eviction_policy_t eviction_policy() const final {
+        return eviction_policy_;
+    }
+
     bool *notify_activity_boolean(threadnum_t thread) final;
 
     void wake_up_activity_happened() final;
@@ -140,10 +160,18 @@ private:
         alt::evicter_t *evicter;
         uint64_t new_size;
         uint64_t old_size;
+        uint64_t min_size;
+        uint64_t max_size;
         int64_t bytes_loaded;
         uint64_t access_count;
     };
 
+    // Moves the caches' new sizes into their reservations and caps, while keeping
+    // their sum at `total_cache_size` if the bounds allow it
+    static void apply_memory_bounds(
+        uint64_t total_cache_size,
+        scoped_array_t<std::vector<cache_data_t> > *cache_data);
+
     // Helper function to collect stats from each thread so we don't need
     //  atomic variables slowing down normal operations
     void collect_stats_from_thread(int index,
@@ -155,6 +183,7 @@ private:
                                    bool new_read_ahead_ok);
 
     clone_ptr_t<watchable_t<uint64_t> > total_cache_size_watchable;
+    const cache_eviction_policy_t eviction_policy_;
     scoped_ptr_t<repeating_timer_t> rebalance_timer;
     enum class rebalance_timer_state_t {
         // Normal operating condition: there is a timer, and it'll ping soon.  Can
@@ -14,10 +14,16 @@ evicter_t::evicter_t()
       balancer_(nullptr),
       balancer_notify_activity_boolean_(nullptr),
       throttler_(nullptr),
+      policy_(cache_eviction_policy_t::TWO_QUEUE),
+      memory_reservation_(0),
+      memory_cap_(UINT64_MAX),
       bytes_loaded_counter_(0),
       access_count_counter_(0),
       access_time_counter_(INITIAL_ACCESS_TIME),
-      evict_if_necessary_active_(false) { }
+      page_hit_count_(0),
+      page_miss_count_(0),
+      evict_if_necessary_active_(false),
+      recently_evicted_counter_(0) { }
 
 evicter_t::~evicter_t() {
     assert_thread();
@@ -39,6 +45,7 @@ void evicter_t::initialize(page_cache_t *page_cache,
     page_cache_ = page_cache;
     throttler_ = throttler;
     balancer_ = balancer;
+    policy_ = balancer->eviction_policy();
     balancer_notify_activity_boolean_
         = balancer_->notify_activity_boolean(get_thread_id());
     balancer_->add_evicter(this);
@@ -84,6 +91,28 @@ uint64_t evicter_t::access_count() const {
     return access_count_counter_;
 }
 
+void evicter_t::set_memory_bounds(uint64_t reservation, uint64_t cap) {
+    assert_thread();
+    guarantee(initialized_);
+    guarantee(reservation <= cap);
+    memory_reservation_ = reservation;
+    memory_cap_ = cap;
+    // Get the balancer to apply the new bounds soon.
+    notify_bytes_loading(0);
+}
+
+uint64_t evicter_t::memory_reservation() const {
+    assert_thread();
+    guarantee(initialized_);
+    return memory_reservation_;
+}
+
+uint64_t evicter_t::memory_cap() const {
+    assert_thread();
+    guarantee(initialized_);
+    return memory_cap_;
+}
+
 void wake_up_balancer(cache_balancer_t *balancer,
                       UNUSED auto_drainer_t::lock_t drainer_lock) {
     on_thread_t th(balancer->home_thread());
@@ -154,7 +183,9 @@ void evicter_t::add_to_evictable_unbacked(page_t *page) {
 void evicter_t::add_to_evictable_disk_backed(page_t *page) {
     assert_thread();
     guarantee(initialized_);
-    evictable_disk_backed_.add(page, page->hypothetical_memory_usage(page_cache_));
+    eviction_bag_t *bag = correct_eviction_category(page);
+    rassert(bag == &evictable_disk_backed_ || bag == &evictable_probationary_);
+    bag->add(page, page->hypothetical_memory_usage(page_cache_));
     evict_if_necessary();
     notify_bytes_loading(page->hypothetical_memory_usage(page_cache_));
 }
@@ -166,6 +197,7 @@ void evicter_t::move_unevictable_to_evictable(page_t *page) {
     unevictable_.remove(page, page->hypothetical_memory_usage(page_cache_));
     eviction_bag_t *new_bag = correct_eviction_category(page);
     rassert(new_bag == &evictable_disk_backed_
+            || new_bag == &evictable_probationary_
             || new_bag == &evictable_unbacked_);
     new_bag->add(page, page->hypothetical_memory_usage(page_cache_));
     evict_if_necessary();
@@ -190,6 +222,10 @@ eviction_bag_t *evicter_t::correct_eviction_category(page_t *page) {
     } else if (!page->is_loaded()) {
         return &evicted_;
     } else if (page->is_disk_backed()) {
+        if (policy_ == cache_eviction_policy_t::TWO_QUEUE
+            && !page->was_reacquired()) {
+            return &evictable_probationary_;
+        }
         return &evictable_disk_backed_;
     } else {
         return &evictable_unbacked_;
@@ -209,9 +245,61 @@ uint64_t evicter_t::in_memory_size() const {
     guarantee(initialized_);
     return unevictable_.size()
         + evictable_disk_backed_.size()
+        + evictable_probationary_.size()
         + evictable_unbacked_.size();
 }
 
+bool evicter_t::take_recently_evicted(block_id_t block_id) {
+    assert_thread();
+    guarantee(initialized_);
+    return recently_evicted_.erase(block_id) != 0;
+}
+
+void evicter_t::add_recently_evicted(block_id_t block_id) {
+    ++recently_evicted_counter_;
+    recently_evicted_[block_id] = recently_evicted_counter_;
+    recently_evicted_queue_.push_back(
+        std::make_pair(block_id, recently_evicted_counter_));
+
+    const uint64_t max_entries = memory_limit_
+        / (RECENTLY_EVICTED_SHARE_DIVISOR * page_cache_->max_block_size().ser_value());
+    while (recently_evicted_queue_.size() > max_entries) {
+        const std::pair<block_id_t, uint64_t> &oldest = recently_evicted_queue_.front();
+        auto it = recently_evicted_.find(oldest.first);
+        if (it != recently_evicted_.end() && it->second == oldest.second) {
+            recently_evicted_.erase(it);
+        }
+        recently_evicted_queue_.pop_front();
+    }
+}
+
+bool evicter_t::remove_page_to_evict(page_t **page_out) {
+    // This is 2Q: probationary pages, which haven't been reacquired since they were
+    // loaded, get evicted first as long as they use more than their share of the
+    // memory limit.  Pages that do get reused thus can't be pushed out of the cache
+    // by a big scan.  The access times pick the page to evict from either bag.  (With
+    // the SAMPLED_LRU policy, evictable_probationary_ is always empty.)
+    const bool probationary_first =
+        evictable_probationary_.size() > memory_limit_ / PROBATIONARY_SHARE_DIVISOR;
+    if (probationary_first
+        && evictable_probationary_.remove_oldish(page_out, access_time_counter_,
+                                                 page_cache_)) {
+        add_recently_evicted((*page_out)->block_id());
+        return true;
+    }
+    if (evictable_disk_backed_.remove_oldish(page_out, access_time_counter_,
+                                             page_cache_)) {
+        return true;
+    }
+    if (!probationary_first
+        && evictable_probationary_.remove_oldish(page_out, access_time_counter_,
+                                                 page_cache_)) {
+        add_recently_evicted((*page_out)->block_id());
+        return true;
+    }
+    return false;
+}
+
 void evicter_t::evict_if_necessary() THROWS_NOTHING {
     assert_thread();
     guarantee(initialized_);
@@ -229,9 +317,7 @@ void evicter_t::evict_if_necessary() THROWS_NOTHING {
 
     evict_if_necessary_active_ = true;
     page_t *page;
-    while (in_memory_size() > memory_limit_
-           && evictable_disk_backed_.remove_oldish(&page, access_time_counter_,
-                                                   page_cache_)) {
+    while (in_memory_size() > memory_limit_ && remove_page_to_evict(&page)) {
         evicted_.add(page, page->hypothetical_memory_usage(page_cache_));
         page->evict_self(page_cache_);
         page_cache_->consider_evicting_current_page(page->block_id());
@@ -3,9 +3,13 @@
 
 #include <stdint.h>
 
+#include <deque>
 #include <functional>
+#include <unordered_map>
+#include <utility>
 
 #include "buffer_cache/eviction_bag.hpp"
+#include "buffer_cache/types.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/cache_line_padded.hpp"
 #include "concurrency/pubsub.hpp"
@@ -35,6 +39,12 @@ public:
     void remove_page(page_t *page);
     void reloading_page(page_t *page);
 
+    // Returns true if the block's page was evicted before it got reacquired, not too
+    // long ago, and forgets about it.  A page that gets loaded again for such a block
+    // counts as having been acquired once already.  (This is the "A1out" queue of
+    // 2Q.)
+    bool take_recently_evicted(block_id_t block_id);
+
     // Evicter will be unusable until initialize is called
     evicter_t();
     ~evicter_t();
@@ -56,12 +66,37 @@ public:
     uint64_t access_count() const;
     int64_t get_bytes_loaded() const;
 
+    // The cache balancer keeps this cache's memory limit between the reservation
+    // and the cap (unless the reservations of all caches add up to more than the
+    // total cache size).
+    void set_memory_bounds(uint64_t reservation, uint64_t cap);
+    uint64_t memory_reservation() const;
+    uint64_t memory_cap() const;
+
+    // Counts page acquisitions that did or didn't find the page in memory.
+    void note_page_acquired(bool was_loaded) {
+        if (was_loaded) {
+            ++page_hit_count_;
+        } else {
+            ++page_miss_count_;
+        }
+    }
+    uint64_t page_hit_count() const { return page_hit_count_; }
+    uint64_t page_miss_count() const { return page_miss_count_; }
+
     uint64_t in_memory_size() const;
 
     // This is decremented past UINT64_MAX to force code to be aware of access time
     // rollovers.
     static const uint64_t INITIAL_ACCESS_TIME = UINT64_MAX - 100;
 
+    // With the TWO_QUEUE policy, pages that haven't been reacquired are evicted
+    // first once they use more than 1/PROBATIONARY_SHARE_DIVISOR of the memory limit.
+    static const uint64_t PROBATIONARY_SHARE_DIVISOR = 4;
+    // We remember the block ids of about as many evicted probationary pages as
+    // 1/RECENTLY_EVICTED_SHARE_DIVISOR of the memory limit would hold.
+    static const uint64_t RECENTLY_EVICTED_SHARE_DIVISOR = 2;
+
 private:
     friend class usage_adjuster_t;
 
@@ -71,6 +106,12 @@ private:
     // Evicts any evictable pages until under the memory limit
     void evict_if_necessary() THROWS_NOTHING;
 
+    // Picks the next page to evict and removes it from its eviction bag.  Returns
+    // false if there are no evictable pages.
+    bool remove_page_to_evict(page_t **page_out);
+
+    void add_recently_evicted(block_id_t block_id);
+
     bool initialized_;
     page_cache_t *page_cache_;
     cache_balancer_t *balancer_;
@@ -78,7 +119,11 @@ private:
 
     alt_txn_throttler_t *throttler_;
 
+    cache_eviction_policy_t policy_;
+
     uint64_t memory_limit_;
+    uint64_t memory_reservation_;
+    uint64_t memory_cap_;
 
     // These are updated every time a page is loaded, created, or destroyed, and
     // cleared when cache memory limits are re-evaluated.  This value can go
@@ -89,16 +134,30 @@ private:
     // This gets incremented every time a page is accessed.
     uint64_t access_time_counter_;
 
+    uint64_t page_hit_count_;
+    uint64_t page_miss_count_;
+
     // This is set to true while `evict_if_necessary()` is active.
     // It avoids reentrant calls to that function.
     bool evict_if_necessary_active_;
 
-    // These track every page's eviction status.
+    // These track every page's eviction status.  With the TWO_QUEUE policy,
+    // disk-backed pages that haven't been reacquired since they were loaded go into
+    // evictable_probationary_ instead of evictable_disk_backed_.
     eviction_bag_t unevictable_;
     eviction_bag_t evictable_disk_backed_;
+    eviction_bag_t evictable_probationary_;
     eviction_bag_t evictable_unbacked_;
     eviction_bag_t evicted_;
 
+    // The block ids of pages that were evicted from evictable_probationary_, oldest
+    // first, each with a sequence number.  recently_evicted_ maps block ids to the
+    // sequence number of their latest entry in the queue, so that entries for block
+    // ids that got taken out of recently_evicted_ (or added again) can be skipped.
+    std::deque<std::pair<block_id_t, uint64_t> > recently_evicted_queue_;
+    std::unordered_map<block_id_t, uint64_t> recently_evicted_;
+    uint64_t recently_evicted_counter_;
+
     auto_drainer_t drainer_;
 
     DISABLE_COPYING(evicter_t);
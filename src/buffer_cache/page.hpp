@@ -55,6 +55,8 @@ public:
 
     uint32_t hypothetical_memory_usage(page_cache_t *page_cache) const;
     uint64_t access_time() const { return access_time_; }
+    // True if the page has been acquired more than once since it was loaded.
+    bool was_reacquired() const { return acquisition_count_ >= 2; }
 
     bool is_loading() const {
         return loader_ != nullptr && page_t::loader_is_loading(loader_);
@@ -132,6 +134,11 @@ private:
 
     uint64_t access_time_;
 
+    // How many times the page has been acquired, saturating at 2.  This may only
+    // change while the page is unevictable, because the evicter uses it to pick the
+    // page's eviction bag.
+    uint8_t acquisition_count_;
+
     // How many page_ptr_t's point at this page, expecting nothing to modify it,
     // other than themselves.
     size_t snapshot_refcount_;
@@ -146,7 +153,8 @@ private:
     // if loader_ is non-null:  unevictable_pages_
     // else if waiters_ is non-empty: unevictable_pages_
     // else if buf_ is null: evicted_pages_ (and block_token_ is non-null)
-    // else if block_token_ is non-null: evictable_disk_backed_pages_
+    // else if block_token_ is non-null: evictable_disk_backed_pages_ (or
+    //   evictable_probationary_pages_, if it hasn't been reacquired)
     // else: evictable_unbacked_pages_ (buf_ is non-null, block_token_ is null)
     //
     // So, when loader_, waiters_, buf_, or block_token_ is touched, we might
@@ -206,7 +206,6 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
                            alt_txn_throttler_t *throttler)
     : max_block_size_(_serializer->max_block_size()),
       serializer_(_serializer),
-      free_list_(_serializer),
       evicter_(),
       read_ahead_cb_(nullptr),
       drainer_(make_scoped<auto_drainer_t>()) {
@@ -225,7 +224,6 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
         default_reads_account_.init(_serializer->home_thread(),
                                     _serializer->make_io_account(CACHE_READS_IO_PRIORITY));
         index_write_sink_.init(new page_cache_index_write_sink_t);
-        recencies_ = _serializer->get_all_recencies();
     }
 
     ASSERT_NO_CORO_WAITING;
@@ -237,6 +235,31 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
     // more likely to trip an assertion.
     evicter_.initialize(this, balancer, throttler);
     read_ahead_cb_ = local_read_ahead_cb;
+
+    coro_t::spawn_sometime(std::bind(&page_cache_t::load_index, this,
+                                     drainer_->lock()));
+}
+
+void page_cache_t::load_index(auto_drainer_t::lock_t) {
+    // Both of these block until the serializer has loaded its index.  If we get
+    // destroyed in the meantime, `~page_cache_t` waits for them.
+    segmented_vector_t<repli_timestamp_t> recencies;
+    {
+        on_thread_t thread_switcher(serializer_->home_thread());
+        recencies = serializer_->get_all_recencies();
+    }
+    scoped_ptr_t<free_list_t> free_list(new free_list_t(serializer_));
+
+    ASSERT_NO_CORO_WAITING;
+    // Write transactions wait for `index_loaded_`, so nobody has set a recency or
+    // used the free list yet, and the recencies are still those on disk.
+    rassert(recencies_.size() == 0);
+    recencies_ = std::move(recencies);
+    free_list_ = std::move(free_list);
+    for (auto &&pair : current_pages_) {
+        pair.second->pulse_snapshotted_acquirers();
+    }
+    index_loaded_.pulse();
 }
 
 page_cache_t::~page_cache_t() {
@@ -348,7 +371,7 @@ current_page_t *page_cache_t::page_for_block_id(block_id_t block_id) {
 
     auto page_it = current_pages_.find(block_id);
     if (page_it == current_pages_.end()) {
-        rassert(is_aux_block_id(block_id) ||
+        rassert(is_aux_block_id(block_id) || !index_loaded_.is_pulsed() ||
                 recency_for_block_id(block_id) != repli_timestamp_t::invalid,
                 "Expected block %" PR_BLOCK_ID " not to be deleted "
                 "(should you have used alt_create_t::create?).",
@@ -369,10 +392,10 @@ current_page_t *page_cache_t::page_for_new_block_id(
     block_id_t block_id;
     switch (block_type) {
     case block_type_t::aux:
-        block_id = free_list_.acquire_aux_block_id();
+        block_id = free_list()->acquire_aux_block_id();
         break;
     case block_type_t::normal:
-        block_id = free_list_.acquire_block_id();
+        block_id = free_list()->acquire_block_id();
         break;
     default:
         unreachable();
@@ -385,7 +408,7 @@ current_page_t *page_cache_t::page_for_new_block_id(
 current_page_t *page_cache_t::page_for_new_chosen_block_id(block_id_t block_id) {
     assert_thread();
     // Tell the free list this block id is taken.
-    free_list_.acquire_chosen_block_id(block_id);
+    free_list()->acquire_chosen_block_id(block_id);
     return internal_page_for_new_chosen(block_id);
 }
 
@@ -601,6 +624,8 @@ repli_timestamp_t current_page_acq_t::recency() {
     // so that we can't see the recency change before/after the write_cond_ is
     // pulsed.
     if (access_ == access_t::read) {
+        // Write acquirers can only exist once the index is loaded.
+        page_cache_->index_loaded_signal()->wait();
         read_cond_.wait();
     } else {
         write_cond_.wait();
@@ -853,7 +878,13 @@ void current_page_t::pulse_pulsables(current_page_acq_t *const acq) {
         }
     }
 
-    const repli_timestamp_t current_recency = help.page_cache->recency_for_block_id(help.block_id);
+    // Until the page cache has loaded the recencies, snapshotted acquirers stay in
+    // the queue like other readers.  There are no write acquirers to make way for
+    // yet, and `page_cache_t::load_index` kicks them out afterwards.
+    const bool index_loaded = help.page_cache->index_loaded_signal()->is_pulsed();
+    const repli_timestamp_t current_recency = index_loaded
+        ? help.page_cache->recency_for_block_id(help.block_id)
+        : repli_timestamp_t::invalid;
 
     // It's time to pulse the pulsables.
     current_page_acq_t *cur = acq;
@@ -864,7 +895,7 @@ void current_page_t::pulse_pulsables(current_page_acq_t *const acq) {
 
         if (cur->access_ == access_t::read) {
             current_page_acq_t *next = acquirers_.next(cur);
-            if (cur->declared_snapshotted_) {
+            if (cur->declared_snapshotted_ && index_loaded) {
                 // Snapshotters get kicked out of the queue, to make way for
                 // write-acquirers.
 
@@ -893,6 +924,18 @@ void current_page_t::pulse_pulsables(current_page_acq_t *const acq) {
     }
 }
 
+void current_page_t::pulse_snapshotted_acquirers() {
+    for (current_page_acq_t *acq = acquirers_.head();
+         acq != nullptr;
+         acq = acquirers_.next(acq)) {
+        if (acq->declared_snapshotted_) {
+            // This handles the acquirers after `acq` as well.
+            pulse_pulsables(acq);
+            return;
+        }
+    }
+}
+
 void current_page_t::add_keepalive() {
     ++num_keepalives_;
 }
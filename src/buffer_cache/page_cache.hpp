@@ -101,6 +101,9 @@ private:
     void add_acquirer(current_page_acq_t *acq);
     void remove_acquirer(current_page_acq_t *acq);
     void pulse_pulsables(current_page_acq_t *acq);
+    // Called once the page cache has loaded the recencies, for the acquirers that
+    // were declared snapshotted before that.
+    void pulse_snapshotted_acquirers();
     void add_keepalive();
     void remove_keepalive();
 
@@ -372,6 +375,12 @@ public:
     auto_drainer_t::lock_t drainer_lock() { return drainer_->lock(); }
     serializer_t *serializer() { return serializer_; }
 
+    // The page cache loads the recencies and the free list from the serializer in
+    // the background, since they need the serializer's whole index.  Reads don't
+    // wait for this, but write transactions do (see `txn_t`), and so do
+    // `current_page_acq_t::recency()` calls.
+    const signal_t *index_loaded_signal() const { return &index_loaded_; }
+
 private:
     friend class page_read_ahead_cb_t;
     void add_read_ahead_buf(block_id_t block_id,
@@ -380,6 +389,8 @@ private:
 
     void read_ahead_cb_is_destroyed();
 
+    void load_index(auto_drainer_t::lock_t lock);
+
 
     current_page_t *internal_page_for_new_chosen(block_id_t block_id);
 
@@ -421,6 +432,7 @@ private:
 
     friend class current_page_acq_t;
     repli_timestamp_t recency_for_block_id(block_id_t id) {
+        rassert(index_loaded_.is_pulsed());
         // This `if` is redundant, since `recencies_.size()` will always be smaller
         // than any aux block ID. It's probably a good idea to be explicit about this
         // though.
@@ -433,6 +445,7 @@ private:
     }
 
     void set_recency_for_block_id(block_id_t id, repli_timestamp_t recency) {
+        rassert(index_loaded_.is_pulsed());
         if(is_aux_block_id(id)) {
             guarantee(recency == repli_timestamp_t::invalid);
             return;
@@ -444,7 +457,10 @@ private:
     }
 
     friend class current_page_t;
-    free_list_t *free_list() { return &free_list_; }
+    free_list_t *free_list() {
+        rassert(index_loaded_.is_pulsed());
+        return free_list_.get();
+    }
 
     static void consider_evicting_all_current_pages(page_cache_t *page_cache,
                                                     auto_drainer_t::lock_t lock);
@@ -468,7 +484,9 @@ private:
 
     std::unordered_map<block_id_t, current_page_t *> current_pages_;
 
-    free_list_t free_list_;
+    // These two are set by `load_index`.
+    scoped_ptr_t<free_list_t> free_list_;
+    cond_t index_loaded_;
 
     evicter_t evicter_;
 
@@ -15,18 +15,29 @@ public:
     perfmon_collection_t cache_collection;
     perfmon_membership_t cache_membership;
 
+    // Reports a value of the cache's evicter, read on the cache's home thread.
     class perfmon_value_t : public perfmon_t {
     public:
-        explicit perfmon_value_t(alt_cache_stats_t *_parent);
+        perfmon_value_t(alt_cache_stats_t *_parent,
+                        uint64_t (alt::evicter_t::*_getter)() const);
         void *begin_stats();
         void visit_stats(void *);
         ql::datum_t end_stats(void *);
     private:
         alt_cache_stats_t *parent;
+        uint64_t (alt::evicter_t::*getter)() const;
         DISABLE_COPYING(perfmon_value_t);
     };
     perfmon_value_t in_use_bytes;
     perfmon_membership_t in_use_bytes_membership;
+    // The memory limit the cache balancer currently gives this cache.
+    perfmon_value_t share_bytes;
+    perfmon_membership_t share_bytes_membership;
+    // Page acquisitions that did or didn't find the page in memory, since startup.
+    perfmon_value_t page_hits;
+    perfmon_membership_t page_hits_membership;
+    perfmon_value_t page_misses;
+    perfmon_membership_t page_misses_membership;
 
 
     perfmon_multi_membership_t cache_collection_membership;
@@ -14,6 +14,11 @@ ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(write_durability_t, int8_t,
                                       write_durability_t::SOFT,
                                       write_durability_t::HARD);
 
+// How the page cache picks the pages it evicts.  TWO_QUEUE evicts pages that were only
+// acquired once (like the ones a table scan reads) before pages that get reused.
+// SAMPLED_LRU evicts the least recently used of a few randomly chosen pages.
+enum class cache_eviction_policy_t { TWO_QUEUE, SAMPLED_LRU };
+
 
 typedef uint32_t block_magic_comparison_t;
 
@@ -0,0 +1,209 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "client_protocol/binary.hpp"
+
+#include <sys/uio.h>
+
+#include <vector>
+
+#include "arch/io/network.hpp"
+#include "arch/timing.hpp"
+#include "client_protocol/protocols.hpp"
+#include "containers/archive/varint.hpp"
+#include "rapidjson/document.h"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/rdb_backtrace.hpp"
+#include "rdb_protocol/ql2.pb.h"
+#include "rdb_protocol/query_params.hpp"
+#include "rdb_protocol/response.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+#include "rdb_protocol/term_storage.hpp"
+#include "utils.hpp"
+
+scoped_ptr_t<ql::query_params_t> binary_protocol_t::parse_query_from_buffer(
+        const char *data, size_t size,
+        ql::query_cache_t *query_cache, int64_t token,
+        ql::response_t *error_out) {
+    rapidjson::Document doc;
+    archive_result_t deser_res = ql::datum_deserialize_to_json(data, size, &doc);
+
+    scoped_ptr_t<ql::query_params_t> res;
+    if (!bad(deser_res)) {
+        try {
+            // All the strings live in the document's allocator, so there is no
+            // original buffer to keep around.
+            res = make_scoped<ql::query_params_t>(token, query_cache,
+                    scoped_ptr_t<ql::term_storage_t>(
+                        new ql::json_term_storage_t(scoped_array_t<char>(),
+                                                    std::move(doc))));
+        } catch (const ql::bt_exc_t &ex) {
+            error_out->fill_error(Response::CLIENT_ERROR,
+                                  ex.error_type,
+                                  strprintf("Server could not parse query: %s",
+                                            ex.message.c_str()),
+                                  ex.bt_datum);
+        }
+    } else {
+        error_out->fill_error(Response::CLIENT_ERROR,
+                              Response::RESOURCE_LIMIT,
+                              wire_protocol_t::unparseable_query_message,
+                              ql::backtrace_registry_t::EMPTY_BACKTRACE);
+    }
+    return res;
+}
+
+scoped_ptr_t<ql::query_params_t> binary_protocol_t::parse_query(
+        tcp_conn_t *conn,
+        signal_t *interruptor,
+        ql::query_cache_t *query_cache) {
+    int64_t token;
+    uint32_t size;
+    conn->read_buffered(&token, sizeof(token), interruptor);
+    conn->read_buffered(&size, sizeof(size), interruptor);
+    ql::response_t error;
+
+    if (size >= wire_protocol_t::TOO_LARGE_QUERY_SIZE) {
+        error.fill_error(Response::CLIENT_ERROR,
+                         Response::RESOURCE_LIMIT,
+                         wire_protocol_t::too_large_query_message(size),
+                         ql::backtrace_registry_t::EMPTY_BACKTRACE);
+
+        if (size < wire_protocol_t::HARD_LIMIT_TOO_LARGE_QUERY_SIZE) {
+            // Ignore all the extra data that the client is trying to send, as in
+            // `json_protocol_t::parse_query()`.
+            signal_timer_t read_timeout_interruptor{wire_protocol_t::TOO_LONG_QUERY_TIME};
+            wait_any_t pop_interruptor(interruptor, &read_timeout_interruptor);
+            conn->pop(size, &pop_interruptor);
+        }
+
+        send_response(&error, token, conn, interruptor);
+        throw tcp_conn_read_closed_exc_t();
+    }
+
+    scoped_array_t<char> data(size);
+    conn->read(data.data(), size, interruptor);
+
+    scoped_ptr_t<ql::query_params_t> res =
+        parse_query_from_buffer(data.data(), size, query_cache, token, &error);
+
+    if (!res.has()) {
+        send_response(&error, token, conn, interruptor);
+    }
+    return res;
+}
+
+void serialize_key(write_message_t *wm, const char *key) {
+    ql::datum_serialize(wm, datum_string_t(key));
+}
+
+// Rows that are at least this large and are still in their on-disk format are sent
+// straight from the buffer they were read into.  Below that, an extra entry in the
+// `writev()` call costs more than copying the row.
+const size_t MIN_ZERO_COPY_ROW_SIZE = 256;
+
+// The response is written as a plain `R_OBJECT`, with the data in a plain `R_ARRAY`,
+// so that the rows can be serialized one after the other.  Large rows that are still
+// in their on-disk format are referenced rather than copied.
+bool binary_protocol_t::write_response_to_message(const ql::response_t &response,
+                                                  scatter_gather_message_t *msg_out) {
+    const bool has_error_type =
+        response.type() == Response::RUNTIME_ERROR && response.error_type();
+    const bool has_notes =
+        response.type() == Response::SUCCESS_PARTIAL ||
+        response.type() == Response::SUCCESS_SEQUENCE;
+    ql::datum_serialize_object_header(msg_out->copied(),
+        2 + (has_error_type ? 1 : 0)
+          + (response.backtrace() ? 1 : 0)
+          + (response.profile() ? 1 : 0)
+          + (has_notes ? 1 : 0));
+
+    // `r.minval` and `r.maxval` are internal values that the JSON protocol can't send
+    // either.
+    bool extrema_present = false;
+    auto serialize_datum = [&](const ql::datum_t &datum) {
+        ql::serialization_result_t res = ql::datum_serialize(
+            msg_out->copied(), datum, ql::check_datum_serialization_errors_t::NO);
+        if ((res & ql::serialization_result_t::EXTREMA_PRESENT) != 0) {
+            extrema_present = true;
+        }
+    };
+
+    // The keys have to be in sorted order, which is what `datum_t` expects when it
+    // deserializes the object.
+    if (response.backtrace()) {
+        serialize_key(msg_out->copied(), "b");
+        serialize_datum(*response.backtrace());
+    }
+    if (has_error_type) {
+        serialize_key(msg_out->copied(), "e");
+        serialize_datum(ql::datum_t(static_cast<double>(*response.error_type())));
+    }
+    if (has_notes) {
+        serialize_key(msg_out->copied(), "n");
+        ql::datum_serialize_array_header(msg_out->copied(), response.notes().size());
+        for (const auto &note : response.notes()) {
+            serialize_datum(ql::datum_t(static_cast<double>(note)));
+        }
+    }
+    if (response.profile()) {
+        serialize_key(msg_out->copied(), "p");
+        serialize_datum(*response.profile());
+    }
+
+    serialize_key(msg_out->copied(), "r");
+    ql::datum_serialize_array_header(msg_out->copied(), response.data().size());
+    for (const auto &item : response.data()) {
+        // Serialized rows can't contain `r.minval` or `r.maxval`, so there's nothing
+        // to check when referencing them.
+        shared_buf_ref_t<char> body;
+        size_t body_size;
+        if (ql::datum_serialize_by_reference(msg_out->copied(), item,
+                                             MIN_ZERO_COPY_ROW_SIZE,
+                                             &body, &body_size)) {
+            msg_out->append_reference(body, body_size);
+        } else {
+            serialize_datum(item);
+        }
+    }
+
+    serialize_key(msg_out->copied(), "t");
+    serialize_datum(ql::datum_t(static_cast<double>(response.type())));
+
+    return !extrema_present;
+}
+
+void binary_protocol_t::send_response(ql::response_t *response,
+                                      int64_t token,
+                                      tcp_conn_t *conn,
+                                      signal_t *interruptor) {
+    scatter_gather_message_t msg;
+    if (!write_response_to_message(*response, &msg)) {
+        response->fill_error(Response::RUNTIME_ERROR, Response::QUERY_LOGIC,
+                             "Cannot send `r.minval` or `r.maxval` to the client.",
+                             ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        send_response(response, token, conn, interruptor);
+        return;
+    }
+
+    const size_t payload_size = msg.size();
+    if (payload_size >= wire_protocol_t::TOO_LARGE_RESPONSE_SIZE) {
+        response->fill_error(Response::RUNTIME_ERROR,
+                             Response::RESOURCE_LIMIT,
+                             wire_protocol_t::too_large_response_message(payload_size),
+                             ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        send_response(response, token, conn, interruptor);
+        return;
+    }
+
+    char header[sizeof(token) + sizeof(uint32_t)];
+    const uint32_t data_size = static_cast<uint32_t>(payload_size);
+    memcpy(header, &token, sizeof(token));
+    memcpy(header + sizeof(token), &data_size, sizeof(data_size));
+
+    std::vector<iovec> iovecs;
+    iovecs.push_back(iovec{header, sizeof(header)});
+    msg.append_iovecs(&iovecs);
+
+    // This blocks until everything is written, so the buffers that `msg` points
+    // into stay alive for long enough.
+    conn->write_vectored(iovecs.data(), iovecs.size(), interruptor);
+}
@@ -0,0 +1,49 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef CLIENT_PROTOCOL_BINARY_HPP_
+#define CLIENT_PROTOCOL_BINARY_HPP_
+
+#include <stdint.h>
+
+#include "arch/types.hpp"
+#include "containers/archive/scatter_gather_message.hpp"
+#include "containers/scoped.hpp"
+
+class signal_t;
+
+namespace ql {
+class response_t;
+class query_cache_t;
+class query_params_t;
+}
+
+// The wire protocol selected by `protocol_version` 1 in the handshake.  Queries and
+// responses are framed like in `json_protocol_t`, but their payloads are datums in
+// the format of `datum_serialize()` instead of JSON text.  A query is the usual query
+// array; a response is an object with the same fields as the JSON response.  This
+// lets rows that are read from disk go out to the client without being converted to
+// JSON and back.  If the server runs with `--datum-field-index`, objects with many
+// fields can arrive as `BUF_R_OBJECT_INDEXED`, which clients may read like
+// `BUF_R_OBJECT` once they skip the field index at its end.
+class binary_protocol_t {
+public:
+    static scoped_ptr_t<ql::query_params_t> parse_query_from_buffer(
+            const char *data, size_t size,
+            ql::query_cache_t *query_cache, int64_t token,
+            ql::response_t *error_out);
+
+    static scoped_ptr_t<ql::query_params_t> parse_query(tcp_conn_t *conn,
+                                                        signal_t *interruptor,
+                                                        ql::query_cache_t *query_cache);
+
+    // Returns `false` if the response contains values that can't be sent to the
+    // client, in which case the contents of `msg_out` must be discarded.
+    static MUST_USE bool write_response_to_message(const ql::response_t &response,
+                                                   scatter_gather_message_t *msg_out);
+
+    static void send_response(ql::response_t *response,
+                              int64_t token,
+                              tcp_conn_t *conn,
+                              signal_t *interruptor);
+};
+
+#endif // CLIENT_PROTOCOL_BINARY_HPP_
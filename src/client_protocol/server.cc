@@ -191,10 +191,13 @@ query_server_t::query_server_t(rdb_context_t *_rdb_ctx,
                                int port,
                                query_handler_t *_handler,
                                uint32_t http_timeout_sec,
-                               tls_ctx_t *_tls_ctx) :
+                               tls_ctx_t *_tls_ctx,
+                               query_scheduling_t _scheduling) :
         tls_ctx(_tls_ctx),
         rdb_ctx(_rdb_ctx),
         handler(_handler),
+        scheduling(_scheduling),
+        last_migration(static_cast<ticks_t>(0)),
         http_conn_cache(http_timeout_sec),
         next_thread(0) {
     rassert(rdb_ctx != nullptr);
@@ -249,18 +252,64 @@ ql::datum_t read_datum(tcp_conn_t *connection, signal_t *interruptor) {
     }
 }
 
+threadnum_t query_server_t::least_utilized_thread(int first,
+                                                  double *utilization_out) const {
+    // We start looking at `first` so that ties don't all go to the same thread.
+    threadnum_t best_thread = threadnum_t(first);
+    double best_utilization = get_thread_utilization(best_thread);
+    for (int i = 1; i < get_num_db_threads(); ++i) {
+        threadnum_t thread = threadnum_t((first + i) % get_num_db_threads());
+        double utilization = get_thread_utilization(thread);
+        if (utilization < best_utilization) {
+            best_thread = thread;
+            best_utilization = utilization;
+        }
+    }
+    *utilization_out = best_utilization;
+    return best_thread;
+}
+
+bool query_server_t::should_migrate(threadnum_t *thread_out) {
+    if (scheduling != query_scheduling_t::BALANCED || get_num_db_threads() < 2) {
+        return false;
+    }
+    ticks_t now = get_ticks();
+    ticks_t *last = last_migration.get();
+    if (now - *last < static_cast<ticks_t>(QUERY_MIGRATION_MIN_INTERVAL_MS) * MILLION) {
+        return false;
+    }
+    const threadnum_t current_thread = get_thread_id();
+    double least_utilization;
+    threadnum_t thread = least_utilized_thread(
+        (current_thread.threadnum + 1) % get_num_db_threads(), &least_utilization);
+    if (thread == current_thread ||
+        get_thread_utilization(current_thread) - least_utilization
+            < QUERY_MIGRATION_UTILIZATION_MARGIN) {
+        return false;
+    }
+    *last = now;
+    *thread_out = thread;
+    return true;
+}
+
 void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn,
                                  auto_drainer_t::lock_t keepalive) {
     threadnum_t chosen_thread = threadnum_t(next_thread);
     next_thread = (next_thread + 1) % get_num_db_threads();
+    if (scheduling == query_scheduling_t::BALANCED) {
+        double utilization;
+        chosen_thread = least_utilized_thread(chosen_thread.threadnum, &utilization);
+    }
 
-    cross_thread_signal_t ct_keepalive(keepalive.get_drain_signal(), chosen_thread);
-    on_thread_t rethreader(chosen_thread);
+    // These are replaced if the connection moves to a different thread.
+    scoped_ptr_t<cross_thread_signal_t> ct_keepalive(
+        new cross_thread_signal_t(keepalive.get_drain_signal(), chosen_thread));
+    scoped_ptr_t<on_thread_t> rethreader(new on_thread_t(chosen_thread));
 
     scoped_ptr_t<tcp_conn_t> conn;
 
     try {
-        nconn->make_server_connection(tls_ctx, &conn, &ct_keepalive);
+        nconn->make_server_connection(tls_ctx, &conn, ct_keepalive.get());
     } catch (const interrupted_exc_t &) {
         // TLS handshake was interrupted.
         return;
@@ -271,6 +320,8 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
     }
 
     uint8_t version = 0;
+    // Set by `protocol_version` 1 in the V1_0 handshake, see `binary_protocol_t`.
+    bool binary_protocol = false;
     std::unique_ptr<auth::base_authenticator_t> authenticator;
     uint32_t error_code = 0;
     std::string error_message;
@@ -279,7 +330,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
 
         int32_t client_magic_number;
         conn->read_buffered(
-            &client_magic_number, sizeof(client_magic_number), &ct_keepalive);
+            &client_magic_number, sizeof(client_magic_number), ct_keepalive.get());
 
         switch (client_magic_number) {
             case VersionDummy::V0_1:
@@ -314,14 +365,15 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                 new auth::plaintext_authenticator_t(rdb_ctx->get_auth_watchable()));
 
             uint32_t auth_key_size;
-            conn->read_buffered(&auth_key_size, sizeof(uint32_t), &ct_keepalive);
+            conn->read_buffered(&auth_key_size, sizeof(uint32_t), ct_keepalive.get());
             if (auth_key_size > 2048) {
                 throw client_protocol::client_server_error_t(
                     -1, "Client provided an authorization key that is too long.");
             }
 
             scoped_array_t<char> auth_key_buffer(auth_key_size);
-            conn->read_buffered(auth_key_buffer.data(), auth_key_size, &ct_keepalive);
+            conn->read_buffered(
+                auth_key_buffer.data(), auth_key_size, ct_keepalive.get());
 
             try {
                 authenticator->next_message(
@@ -333,7 +385,8 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
             }
 
             int32_t wire_protocol;
-            conn->read_buffered(&wire_protocol, sizeof(wire_protocol), &ct_keepalive);
+            conn->read_buffered(
+                &wire_protocol, sizeof(wire_protocol), ct_keepalive.get());
             switch (wire_protocol) {
                 case VersionDummy::JSON:
                     break;
@@ -349,7 +402,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
             }
 
             char const *success_msg = "SUCCESS";
-            conn->write(success_msg, strlen(success_msg) + 1, &ct_keepalive);
+            conn->write(success_msg, strlen(success_msg) + 1, ct_keepalive.get());
         } else {
             authenticator.reset(
                 new auth::scram_authenticator_t(rdb_ctx->get_auth_watchable()));
@@ -357,7 +410,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
             {
                 ql::datum_object_builder_t datum_object_builder;
                 datum_object_builder.overwrite("success", ql::datum_t::boolean(true));
-                datum_object_builder.overwrite("max_protocol_version", ql::datum_t(0.0));
+                datum_object_builder.overwrite("max_protocol_version", ql::datum_t(1.0));
                 datum_object_builder.overwrite("min_protocol_version", ql::datum_t(0.0));
                 datum_object_builder.overwrite(
                     "server_version", ql::datum_t(RETHINKDB_VERSION));
@@ -365,11 +418,11 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                 write_datum(
                     conn.get(),
                     std::move(datum_object_builder).to_datum(),
-                    &ct_keepalive);
+                    ct_keepalive.get());
             }
 
             {
-                ql::datum_t datum = read_datum(conn.get(), &ct_keepalive);
+                ql::datum_t datum = read_datum(conn.get(), ct_keepalive.get());
 
                 ql::datum_t protocol_version =
                     datum.get_field("protocol_version", ql::NOTHROW);
@@ -377,7 +430,9 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                     throw client_protocol::client_server_error_t(
                         1, "Expected a number for `protocol_version`.");
                 }
-                if (protocol_version.as_num() != 0.0) {
+                if (protocol_version.as_num() == 1.0) {
+                    binary_protocol = true;
+                } else if (protocol_version.as_num() != 0.0) {
                     throw client_protocol::client_server_error_t(
                         2, "Unsupported `protocol_version`.");
                 }
@@ -410,11 +465,11 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                 write_datum(
                     conn.get(),
                     std::move(datum_object_builder).to_datum(),
-                    &ct_keepalive);
+                    ct_keepalive.get());
             }
 
             {
-                ql::datum_t datum = read_datum(conn.get(), &ct_keepalive);
+                ql::datum_t datum = read_datum(conn.get(), ct_keepalive.get());
 
                 ql::datum_t authentication =
                     datum.get_field("authentication", ql::NOTHROW);
@@ -433,7 +488,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                 write_datum(
                     conn.get(),
                     std::move(datum_object_builder).to_datum(),
-                    &ct_keepalive);
+                    ct_keepalive.get());
             }
         }
 
@@ -441,21 +496,53 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
         UNUSED bool peer_res = conn->getpeername(&client_addr_port);
 
         guarantee(authenticator != nullptr);
-        ql::query_cache_t query_cache(
-            rdb_ctx,
-            client_addr_port,
-            (version < 4)
-                ? ql::return_empty_normal_batches_t::YES
-                : ql::return_empty_normal_batches_t::NO,
-            auth::user_context_t(authenticator->get_authenticated_username()));
-
-        connection_loop<json_protocol_t>(
-            conn.get(),
-            (version < 4)
-                ? 1
-                : 1024,
-            &query_cache,
-            &ct_keepalive);
+        while (true) {
+            threadnum_t migrate_to = INVALID_THREAD;
+            {
+                ql::query_cache_t query_cache(
+                    rdb_ctx,
+                    client_addr_port,
+                    (version < 4)
+                        ? ql::return_empty_normal_batches_t::YES
+                        : ql::return_empty_normal_batches_t::NO,
+                    auth::user_context_t(authenticator->get_authenticated_username()));
+
+                if (binary_protocol) {
+                    connection_loop<binary_protocol_t>(
+                        conn.get(), 1024, &query_cache, ct_keepalive.get(),
+                        &migrate_to);
+                } else {
+                    connection_loop<json_protocol_t>(
+                        conn.get(),
+                        (version < 4)
+                            ? 1
+                            : 1024,
+                        &query_cache,
+                        ct_keepalive.get(),
+                        &migrate_to);
+                }
+            }
+            if (migrate_to == INVALID_THREAD) {
+                break;
+            }
+
+            // The connection is idle and the query cache was empty, so nothing else
+            // refers to this thread. We go back through the listener's thread so that
+            // the `cross_thread_signal_t` is created and destroyed there.
+            // TODO: Only idle connections are moved. A connection that runs a long
+            // CPU-bound query, or keeps cursors open, stays on its thread however busy
+            // that thread gets. Moving it at a batch boundary would mean moving its
+            // `query_cache_t` entries, and with them their streams, feed subscriptions
+            // and `env_t`s, none of which can be used from another thread today.
+            conn->rethread(INVALID_THREAD);
+            rethreader.reset();
+            ct_keepalive.reset();
+            ct_keepalive.init(
+                new cross_thread_signal_t(keepalive.get_drain_signal(), migrate_to));
+            rethreader.init(new on_thread_t(migrate_to));
+            conn->rethread(get_thread_id());
+            ++rdb_ctx->stats.client_connections_migrated;
+        }
     } catch (client_protocol::client_server_error_t const &error) {
         // We can't write the response here due to coroutine switching inside an
         // exception handler
@@ -484,7 +571,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
         try {
             if (version < 10) {
                 std::string error = "ERROR: " + error_message + "\n";
-                conn->write(error.c_str(), error.length() + 1, &ct_keepalive);
+                conn->write(error.c_str(), error.length() + 1, ct_keepalive.get());
             } else {
                 ql::datum_object_builder_t datum_object_builder;
                 datum_object_builder.overwrite("success", ql::datum_t::boolean(false));
@@ -495,7 +582,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                 write_datum(
                     conn.get(),
                     std::move(datum_object_builder).to_datum(),
-                    &ct_keepalive);
+                    ct_keepalive.get());
             }
 
             conn->shutdown_write();
@@ -553,7 +640,8 @@ template <class protocol_t>
 void query_server_t::connection_loop(tcp_conn_t *conn,
                                      size_t max_concurrent_queries,
                                      ql::query_cache_t *query_cache,
-                                     signal_t *drain_signal) {
+                                     signal_t *drain_signal,
+                                     threadnum_t *migrate_to_out) {
     std::exception_ptr err;
     std::string err_str;
     cond_t abort;
@@ -570,7 +658,23 @@ void query_server_t::connection_loop(tcp_conn_t *conn,
 
     new_semaphore_t sem(max_concurrent_queries);
     auto_drainer_t coro_drainer;
+    size_t running_queries = 0;
     while (!err) {
+        if (scheduling == query_scheduling_t::BALANCED
+                && running_queries == 0
+                && query_cache->begin() == query_cache->end()) {
+            // This is a safe point to move the connection to a less busy thread. We
+            // wait for the next query first, since the load may have changed by then.
+            const_charslice buffered = conn->peek();
+            if (buffered.beg == buffered.end) {
+                conn->read_more_buffered(&interruptor);
+            }
+            if (running_queries == 0
+                    && query_cache->begin() == query_cache->end()
+                    && should_migrate(migrate_to_out)) {
+                break;
+            }
+        }
         scoped_ptr_t<ql::query_params_t> outer_query =
             protocol_t::parse_query(conn, &interruptor, query_cache);
         if (outer_query.has()) {
@@ -580,6 +684,7 @@ void query_server_t::connection_loop(tcp_conn_t *conn,
             coro_t::spawn_now_dangerously([&]() {
                 // We grab this right away while it's still valid.
                 scoped_ptr_t<ql::query_params_t> query = std::move(outer_query);
+                ++running_queries;
                 // Since we `spawn_now_dangerously` it's always safe to acquire this.
                 auto_drainer_t::lock_t coro_drainer_lock(&coro_drainer);
                 wait_any_t cb_interruptor(coro_drainer_lock.get_drain_signal(),
@@ -605,6 +710,7 @@ void query_server_t::connection_loop(tcp_conn_t *conn,
                                                   conn, &cb_interruptor);
                     }
                 });
+                --running_queries;
             });
             guarantee(!outer_query.has());
             // Since we're using `spawn_now_dangerously` above, we need to yield
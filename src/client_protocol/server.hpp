@@ -16,10 +16,12 @@
 #include "arch/timing.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/cross_thread_signal.hpp"
+#include "concurrency/one_per_thread.hpp"
 #include "containers/archive/archive.hpp"
 #include "containers/counted.hpp"
 #include "http/http.hpp"
 #include "perfmon/perfmon.hpp"
+#include "time.hpp"
 #include "utils.hpp"
 
 class auth_key_t;
@@ -85,6 +87,14 @@ private:
     uint32_t http_timeout_sec;
 };
 
+/* How `query_server_t` assigns client connections to threads. With `ROUND_ROBIN`, a
+connection stays on the thread it was assigned when it was opened. With `BALANCED`, new
+connections go to the least utilized thread, and a connection whose thread is much
+busier than another one moves to that thread between queries. Queries are never moved
+while they are running, and neither are connections with open cursors or changefeeds,
+because their state can only be used on the thread that created it. */
+enum class query_scheduling_t { ROUND_ROBIN, BALANCED };
+
 class new_semaphore_in_line_t;
 class query_handler_t {
 public:
@@ -103,7 +113,8 @@ public:
         int port,
         query_handler_t *_handler,
         uint32_t http_timeout_sec,
-        tls_ctx_t* tls_ctx);
+        tls_ctx_t* tls_ctx,
+        query_scheduling_t scheduling);
     ~query_server_t();
 
     int get_port() const;
@@ -118,12 +129,19 @@ private:
     void handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn,
                      auto_drainer_t::lock_t);
 
-    // This is templatized based on the wire protocol requested by the client
+    // This is templatized based on the wire protocol requested by the client. Returns
+    // normally either when the connection should move to `*migrate_to_out` or, if it
+    // stays `INVALID_THREAD`, when the connection is done.
     template<class protocol_t>
     void connection_loop(tcp_conn_t *conn,
                          size_t max_concurrent_queries,
                          ql::query_cache_t *query_cache,
-                         signal_t *interruptor);
+                         signal_t *interruptor,
+                         threadnum_t *migrate_to_out);
+
+    // For `query_scheduling_t::BALANCED`
+    threadnum_t least_utilized_thread(int first, double *utilization_out) const;
+    bool should_migrate(threadnum_t *thread_out);
 
     // For HTTP server
     void handle(const http_req_t &request,
@@ -133,6 +151,10 @@ private:
     tls_ctx_t *tls_ctx;
     rdb_context_t *const rdb_ctx;
     query_handler_t *const handler;
+    const query_scheduling_t scheduling;
+
+    // When a connection last moved away from each thread
+    one_per_thread_t<ticks_t> last_migration;
 
     /* WARNING: The order here is fragile. */
     auto_drainer_t drainer;
@@ -17,6 +17,9 @@ const uuid_u jobs_manager_t::base_sindex_id =
 const uuid_u jobs_manager_t::base_disk_compaction_id =
     str_to_uuid("b8766ece-d15c-4f96-bee5-c0edacf10c9c");
 
+const uuid_u jobs_manager_t::base_disk_scrub_id =
+    str_to_uuid("3f0c6e2a-9d51-4b7e-8a26-c4e1f57d90b3");
+
 const uuid_u jobs_manager_t::base_backfill_id =
     str_to_uuid("a5e1b38d-c712-42d7-ab4c-f177a3fb0d20");
 
@@ -51,6 +54,7 @@ void jobs_manager_t::on_get_job_reports(
         const business_card_t::return_mailbox_t::address_t &reply_address) {
     std::vector<query_job_report_t> query_job_reports;
     std::vector<disk_compaction_job_report_t> disk_compaction_job_reports;
+    std::vector<disk_scrub_job_report_t> disk_scrub_job_reports;
     std::vector<index_construction_job_report_t> index_construction_job_reports;
     std::vector<backfill_job_report_t> backfill_job_reports;
 
@@ -62,6 +66,7 @@ void jobs_manager_t::on_get_job_reports(
              reply_address,
              query_job_reports,
              disk_compaction_job_reports,
+             disk_scrub_job_reports,
              index_construction_job_reports,
              backfill_job_reports);
         return;
@@ -115,6 +120,19 @@ void jobs_manager_t::on_get_job_reports(
             server_id);
     }
 
+    scrub_progress_t scrub_progress;
+    if (table_persistence_interface != nullptr &&
+            table_persistence_interface->get_scrub_progress(&scrub_progress)) {
+        // Like "disk_compaction" jobs, "disk_scrub" jobs do not have a duration.
+        disk_scrub_job_reports.emplace_back(
+            uuid_u::from_hash(base_disk_scrub_id, uuid_to_str(server_id.get_uuid())),
+            -1,
+            server_id,
+            scrub_progress.blocks_done,
+            scrub_progress.blocks_total,
+            scrub_progress.errors);
+    }
+
     try {
         multi_table_manager->visit_tables(interruptor, access_t::read,
         [&](const namespace_id_t &table_id,
@@ -173,6 +191,7 @@ void jobs_manager_t::on_get_job_reports(
              reply_address,
              query_job_reports,
              disk_compaction_job_reports,
+             disk_scrub_job_reports,
              index_construction_job_reports,
              backfill_job_reports);
     } catch (const interrupted_exc_t &) {
@@ -45,6 +45,55 @@ bool disk_compaction_job_report_t::info_derived(
 RDB_IMPL_SERIALIZABLE_4_FOR_CLUSTER(
     disk_compaction_job_report_t, type, id, duration, servers);
 
+disk_scrub_job_report_t::disk_scrub_job_report_t()
+    : job_report_base_t<disk_scrub_job_report_t>() { }
+
+disk_scrub_job_report_t::disk_scrub_job_report_t(
+        uuid_u const &_id,
+        double _duration,
+        server_id_t const &_server_id,
+        double _progress_numerator,
+        double _progress_denominator,
+        uint64_t _errors)
+    : job_report_base_t<disk_scrub_job_report_t>(
+        "disk_scrub", _id, _duration, _server_id),
+      progress_numerator(_progress_numerator),
+      progress_denominator(_progress_denominator),
+      errors(_errors) { }
+
+void disk_scrub_job_report_t::merge_derived(
+        disk_scrub_job_report_t const &job_report) {
+    progress_numerator += job_report.progress_numerator;
+    progress_denominator += job_report.progress_denominator;
+    errors += job_report.errors;
+}
+
+bool disk_scrub_job_report_t::info_derived(
+        UNUSED admin_identifier_format_t identifier_format,
+        UNUSED server_config_client_t *server_config_client,
+        UNUSED table_meta_client_t *table_meta_client,
+        UNUSED cluster_semilattice_metadata_t const &metadata,
+        ql::datum_object_builder_t *info_builder_out) const {
+    info_builder_out->overwrite("progress",
+        ql::datum_t(progress_denominator == 0
+            ? 0
+            : progress_numerator / progress_denominator));
+    info_builder_out->overwrite("errors",
+        ql::datum_t(static_cast<double>(errors)));
+
+    return true;
+}
+
+RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
+    disk_scrub_job_report_t,
+    type,
+    id,
+    duration,
+    servers,
+    progress_numerator,
+    progress_denominator,
+    errors);
+
 backfill_job_report_t::backfill_job_report_t()
     : job_report_base_t<backfill_job_report_t>() { }
 
@@ -100,6 +100,33 @@ public:
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(disk_compaction_job_report_t);
 
+class disk_scrub_job_report_t
+    : public job_report_base_t<disk_scrub_job_report_t> {
+public:
+    disk_scrub_job_report_t();
+    disk_scrub_job_report_t(
+            uuid_u const &id,
+            double duration,
+            server_id_t const &server_id,
+            double progress_numerator,
+            double progress_denominator,
+            uint64_t errors);
+
+    void merge_derived(disk_scrub_job_report_t const &job_report);
+
+    bool info_derived(
+            admin_identifier_format_t identifier_format,
+            server_config_client_t *server_config_client,
+            table_meta_client_t *table_meta_client,
+            cluster_semilattice_metadata_t const &metadata,
+            ql::datum_object_builder_t *info_builder_out) const;
+
+    double progress_numerator;
+    double progress_denominator;
+    uint64_t errors;
+};
+RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(disk_scrub_job_report_t);
+
 class index_construction_job_report_t
     : public job_report_base_t<index_construction_job_report_t> {
 public:
@@ -161,6 +188,7 @@ class jobs_manager_business_card_t {
 public:
     typedef mailbox_t<void(std::vector<query_job_report_t>,
                            std::vector<disk_compaction_job_report_t>,
+                           std::vector<disk_scrub_job_report_t>,
                            std::vector<index_construction_job_report_t>,
                            std::vector<backfill_job_report_t>)> return_mailbox_t;
     typedef mailbox_t<void(return_mailbox_t::address_t)> get_job_reports_mailbox_t;
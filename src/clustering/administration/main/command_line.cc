@@ -64,6 +64,7 @@
 #include "containers/scoped.hpp"
 #include "crypto/random.hpp"
 #include "logger.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
 
 #define RETHINKDB_EXPORT_SCRIPT "rethinkdb-export"
 #define RETHINKDB_IMPORT_SCRIPT "rethinkdb-import"
@@ -1045,6 +1046,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
                           boost::optional<uint64_t> total_cache_size,
                           const file_direct_io_mode_t direct_io_mode,
                           const int max_concurrent_io_requests,
+                          const file_io_backend_t io_backend,
                           bool *const result_out) {
     server_id_t our_server_id = server_id_t::generate_server_id();
 
@@ -1058,7 +1060,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
     server_config.config.cache_size_bytes = total_cache_size;
     server_config.version = 1;
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, io_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -1139,6 +1141,7 @@ void run_rethinkdb_serve(const base_path_t &base_path,
                          const std::string &initial_password,
                          const file_direct_io_mode_t direct_io_mode,
                          const int max_concurrent_io_requests,
+                         const file_io_backend_t io_backend,
                          const boost::optional<boost::optional<uint64_t> >
                             &total_cache_size,
                          const server_id_t *our_server_id,
@@ -1156,7 +1159,7 @@ void run_rethinkdb_serve(const base_path_t &base_path,
 
     logNTC("Loading data from directory %s\n", base_path.path().c_str());
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, io_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -1284,6 +1287,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
                              const std::string &initial_password,
                              const file_direct_io_mode_t direct_io_mode,
                              const int max_concurrent_io_requests,
+                             const file_io_backend_t io_backend,
                              const boost::optional<boost::optional<uint64_t> >
                                 &total_cache_size,
                              const bool new_directory,
@@ -1292,7 +1296,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
                              bool *const result_out) {
     if (!new_directory) {
         run_rethinkdb_serve(base_path, serve_info, initial_password, direct_io_mode,
-                            max_concurrent_io_requests, total_cache_size,
+                            max_concurrent_io_requests, io_backend, total_cache_size,
                             nullptr, nullptr, nullptr, data_directory_lock,
                             result_out);
     } else {
@@ -1328,7 +1332,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
         server_config.version = 1;
 
         run_rethinkdb_serve(base_path, serve_info, initial_password, direct_io_mode,
-                            max_concurrent_io_requests,
+                            max_concurrent_io_requests, io_backend,
                             boost::optional<boost::optional<uint64_t> >(),
                             &our_server_id, &server_config, &cluster_metadata,
                             data_directory_lock, result_out);
@@ -1412,11 +1416,43 @@ options::help_section_t get_file_options(std::vector<options::option_t> *options
     options_out->push_back(options::option_t(options::names_t("--direct-io"),
                                              options::OPTIONAL_NO_PARAMETER));
     help.add("--direct-io", "use direct I/O for file access");
+    options_out->push_back(options::option_t(options::names_t("--io-backend"),
+                                             options::OPTIONAL,
+                                             "pool"));
+    help.add("--io-backend pool|uring",
+             "how to submit disk I/O to the kernel: through a pool of threads making "
+             "blocking calls, or through io_uring (falls back to 'pool' if unsupported)");
 #endif
     options_out->push_back(options::option_t(options::names_t("--cache-size"),
                                              options::OPTIONAL));
     help.add("--cache-size mb", "total cache size (in megabytes) for the process. Can "
         "be 'auto'.");
+    options_out->push_back(options::option_t(options::names_t("--cache-eviction"),
+                                             options::OPTIONAL,
+                                             "2q"));
+    help.add("--cache-eviction 2q|sampled",
+             "how the cache picks pages to evict: protecting pages that get reused from "
+             "pages that are only read once (as by table scans), or evicting the least "
+             "recently used of a few random pages");
+    options_out->push_back(options::option_t(options::names_t("--block-compression"),
+                                             options::OPTIONAL,
+                                             "none"));
+    help.add("--block-compression none|zlib",
+             "compress the blocks of table files that are written from now on; blocks "
+             "are only stored compressed if that saves space");
+    options_out->push_back(options::option_t(options::names_t("--gc-temperature-tiers"),
+                                             options::OPTIONAL,
+                                             "1"));
+    help.add("--gc-temperature-tiers n",
+             strprintf("into how many groups the garbage collector of table files "
+                       "sorts the blocks it moves, by how recently they were "
+                       "written (between 1 and %d)", MAX_GC_TEMPERATURE_TIERS));
+    options_out->push_back(options::option_t(options::names_t("--datum-field-index"),
+                                             options::OPTIONAL_NO_PARAMETER));
+    help.add("--datum-field-index",
+             "store documents with many fields with an index that speeds up access to "
+             "single fields; servers older than 2.5 can't read tables that contain such "
+             "documents, and neither can old clients of the binary protocol");
     return help;
 }
 
@@ -1616,6 +1652,20 @@ options::help_section_t get_network_options(const bool join_required, std::vecto
     help.add("--join-delay seconds", "hold the TCP connection open for these many "
              "seconds before joining with another server");
 
+    options_out->push_back(options::option_t(options::names_t("--cluster-compression"),
+                                             options::OPTIONAL,
+                                             "none"));
+    help.add("--cluster-compression none|zlib", "compress the messages sent to other "
+             "servers that support it");
+
+    options_out->push_back(options::option_t(options::names_t("--cluster-connections"),
+                                             options::OPTIONAL,
+                                             "1"));
+    help.add("--cluster-connections n", "the number of TCP connections to open to "
+             "each other server; large messages use the additional connections so "
+             "that they don't delay small ones, which means that a large message can "
+             "arrive after a small one that was sent after it");
+
     options_out->push_back(options::option_t(options::names_t("--cluster-reconnect-timeout"),
                                              options::OPTIONAL,
                                              strprintf("%d", cluster_defaults::reconnect_timeout)));
@@ -1633,6 +1683,14 @@ options::help_section_t get_cpu_options(std::vector<options::option_t> *options_
                                              options::OPTIONAL,
                                              strprintf("%d", get_cpu_count())));
     help.add("-c [ --cores ] n", "the number of cores to use");
+    options_out->push_back(options::option_t(options::names_t("--query-scheduling"),
+                                             options::OPTIONAL,
+                                             "round-robin"));
+    help.add("--query-scheduling round-robin|balanced",
+             "how client connections are spread over the cores: each connection stays "
+             "on the core it was assigned to, or idle connections move from busy cores "
+             "to idle ones between queries (a running query, or a connection with open "
+             "cursors, always stays on its core)");
     return help;
 }
 
@@ -1899,6 +1957,109 @@ file_direct_io_mode_t parse_direct_io_mode_option(const std::map<std::string, op
         file_direct_io_mode_t::buffered_desired;
 }
 
+MUST_USE bool parse_io_backend_option(const std::map<std::string, options::values_t> &opts,
+                                      file_io_backend_t *io_backend_out) {
+#ifdef _WIN32
+    *io_backend_out = file_io_backend_t::pool;
+    return true;
+#else
+    const std::string io_backend = get_single_option(opts, "--io-backend");
+    if (io_backend == "pool") {
+        *io_backend_out = file_io_backend_t::pool;
+    } else if (io_backend == "uring") {
+        *io_backend_out = file_io_backend_t::uring_desired;
+    } else {
+        fprintf(stderr, "ERROR: io-backend must be either 'pool' or 'uring'\n");
+        return false;
+    }
+    return true;
+#endif
+}
+
+MUST_USE bool parse_query_scheduling_option(
+        const std::map<std::string, options::values_t> &opts,
+        query_scheduling_t *query_scheduling_out) {
+    const std::string scheduling = get_single_option(opts, "--query-scheduling");
+    if (scheduling == "round-robin") {
+        *query_scheduling_out = query_scheduling_t::ROUND_ROBIN;
+    } else if (scheduling == "balanced") {
+        *query_scheduling_out = query_scheduling_t::BALANCED;
+    } else {
+        fprintf(stderr,
+                "ERROR: query-scheduling must be either 'round-robin' or 'balanced'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_cache_eviction_option(
+        const std::map<std::string, options::values_t> &opts,
+        cache_eviction_policy_t *eviction_policy_out) {
+    const std::string eviction = get_single_option(opts, "--cache-eviction");
+    if (eviction == "2q") {
+        *eviction_policy_out = cache_eviction_policy_t::TWO_QUEUE;
+    } else if (eviction == "sampled") {
+        *eviction_policy_out = cache_eviction_policy_t::SAMPLED_LRU;
+    } else {
+        fprintf(stderr, "ERROR: cache-eviction must be either '2q' or 'sampled'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_block_compression_option(
+        const std::map<std::string, options::values_t> &opts,
+        block_compression_t *block_compression_out) {
+    const std::string compression = get_single_option(opts, "--block-compression");
+    if (compression == "none") {
+        *block_compression_out = block_compression_t::NONE;
+    } else if (compression == "zlib") {
+        *block_compression_out = block_compression_t::ZLIB;
+    } else {
+        fprintf(stderr, "ERROR: block-compression must be either 'none' or 'zlib'\n");
+        return false;
+    }
+    return true;
+}
+
+MUST_USE bool parse_gc_temperature_tiers_option(
+        const std::map<std::string, options::values_t> &opts,
+        int32_t *gc_temperature_tiers_out) {
+    const std::string tiers_opt = get_single_option(opts, "--gc-temperature-tiers");
+    uint64_t tiers;
+    if (!strtou64_strict(tiers_opt, 10, &tiers)
+        || tiers < 1 || tiers > MAX_GC_TEMPERATURE_TIERS) {
+        fprintf(stderr, "ERROR: gc-temperature-tiers must be a number between 1 and "
+                "%d\n", MAX_GC_TEMPERATURE_TIERS);
+        return false;
+    }
+    *gc_temperature_tiers_out = static_cast<int32_t>(tiers);
+    return true;
+}
+
+MUST_USE bool parse_cluster_connection_options(
+        const std::map<std::string, options::values_t> &opts,
+        cluster_connection_config_t *config_out) {
+    const std::string compression = get_single_option(opts, "--cluster-compression");
+    if (compression == "none") {
+        config_out->compression = cluster_compression_t::NONE;
+    } else if (compression == "zlib") {
+        config_out->compression = cluster_compression_t::ZLIB;
+    } else {
+        fprintf(stderr, "ERROR: cluster-compression must be either 'none' or 'zlib'\n");
+        return false;
+    }
+
+    int connections = get_single_int(opts, "--cluster-connections");
+    if (connections < 1 || connections > MAX_CLUSTER_CONNECTIONS_PER_PEER) {
+        fprintf(stderr, "ERROR: cluster-connections must be between 1 and %d\n",
+                MAX_CLUSTER_CONNECTIONS_PER_PEER);
+        return false;
+    }
+    config_out->connections_per_peer = connections;
+    return true;
+}
+
 int main_rethinkdb_create(int argc, char *argv[]) {
     std::vector<options::option_t> options;
     std::vector<options::help_section_t> help;
@@ -1929,6 +2090,11 @@ int main_rethinkdb_create(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        file_io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
         const int num_workers = get_cpu_count();
 
         bool is_new_directory = false;
@@ -1958,6 +2124,7 @@ int main_rethinkdb_create(int argc, char *argv[]) {
                                      total_cache_size,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      &result),
                            num_workers);
 
@@ -2057,12 +2224,43 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        file_io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
+        cache_eviction_policy_t cache_eviction_policy;
+        if (!parse_cache_eviction_option(opts, &cache_eviction_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        block_compression_t block_compression;
+        if (!parse_block_compression_option(opts, &block_compression)) {
+            return EXIT_FAILURE;
+        }
+
+        int32_t gc_temperature_tiers;
+        if (!parse_gc_temperature_tiers_option(opts, &gc_temperature_tiers)) {
+            return EXIT_FAILURE;
+        }
+
+        ql::set_datum_field_index_enabled(exists_option(opts, "--datum-field-index"));
+
+        query_scheduling_t query_scheduling;
+        if (!parse_query_scheduling_option(opts, &query_scheduling)) {
+            return EXIT_FAILURE;
+        }
+
         update_check_t do_update_checking = parse_update_checking_option(opts);
 
         boost::optional<boost::optional<uint64_t> > total_cache_size =
             parse_total_cache_size_option(opts);
 
         boost::optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
+        cluster_connection_config_t cluster_connection_config;
+        if (!parse_cluster_connection_options(opts, &cluster_connection_config)) {
+            return EXIT_FAILURE;
+        }
         boost::optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
 
@@ -2109,7 +2307,12 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
-                                tls_configs);
+                                tls_configs,
+                                cache_eviction_policy,
+                                block_compression,
+                                gc_temperature_tiers,
+                                query_scheduling,
+                                cluster_connection_config);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
 
@@ -2120,6 +2323,7 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                      initial_password,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      total_cache_size,
                                      static_cast<server_id_t*>(nullptr),
                                      static_cast<server_config_versioned_t *>(nullptr),
@@ -2167,6 +2371,10 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
         }
 
         boost::optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
+        cluster_connection_config_t cluster_connection_config;
+        if (!parse_cluster_connection_options(opts, &cluster_connection_config)) {
+            return EXIT_FAILURE;
+        }
         boost::optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
 
@@ -2214,7 +2422,12 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
-                                tls_configs);
+                                tls_configs,
+                                cache_eviction_policy_t::TWO_QUEUE,
+                                block_compression_t::NONE,
+                                1,
+                                query_scheduling_t::ROUND_ROBIN,
+                                cluster_connection_config);
 
         bool result;
         run_in_thread_pool(
@@ -2332,9 +2545,40 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        file_io_backend_t io_backend;
+        if (!parse_io_backend_option(opts, &io_backend)) {
+            return EXIT_FAILURE;
+        }
+
+        cache_eviction_policy_t cache_eviction_policy;
+        if (!parse_cache_eviction_option(opts, &cache_eviction_policy)) {
+            return EXIT_FAILURE;
+        }
+
+        block_compression_t block_compression;
+        if (!parse_block_compression_option(opts, &block_compression)) {
+            return EXIT_FAILURE;
+        }
+
+        int32_t gc_temperature_tiers;
+        if (!parse_gc_temperature_tiers_option(opts, &gc_temperature_tiers)) {
+            return EXIT_FAILURE;
+        }
+
+        ql::set_datum_field_index_enabled(exists_option(opts, "--datum-field-index"));
+
+        query_scheduling_t query_scheduling;
+        if (!parse_query_scheduling_option(opts, &query_scheduling)) {
+            return EXIT_FAILURE;
+        }
+
         update_check_t do_update_checking = parse_update_checking_option(opts);
 
         boost::optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
+        cluster_connection_config_t cluster_connection_config;
+        if (!parse_cluster_connection_options(opts, &cluster_connection_config)) {
+            return EXIT_FAILURE;
+        }
         boost::optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
 
@@ -2406,7 +2650,12 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
-                                tls_configs);
+                                tls_configs,
+                                cache_eviction_policy,
+                                block_compression,
+                                gc_temperature_tiers,
+                                query_scheduling,
+                                cluster_connection_config);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
 
@@ -2418,6 +2667,7 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                      initial_password,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     io_backend,
                                      total_cache_size,
                                      is_new_directory,
                                      &serve_info,
@@ -11,6 +11,9 @@
 #include "clustering/administration/metadata.hpp"
 #include "clustering/administration/persist/file.hpp"
 #include "clustering/administration/main/version_check.hpp"
+#include "client_protocol/server.hpp"
+#include "rpc/connectivity/cluster.hpp"
+#include "serializer/log/config.hpp"
 #include "arch/address.hpp"
 #include "arch/io/openssl.hpp"
 
@@ -120,7 +123,12 @@ public:
                  std::vector<std::string> &&_argv,
                  const int _join_delay_secs,
                  const int _node_reconnect_timeout_secs,
-                 tls_configs_t _tls_configs) :
+                 tls_configs_t _tls_configs,
+                 cache_eviction_policy_t _cache_eviction_policy,
+                 block_compression_t _block_compression,
+                 int32_t _gc_temperature_tiers,
+                 query_scheduling_t _query_scheduling,
+                 cluster_connection_config_t _cluster_connection_config) :
         joins(std::move(_joins)),
         reql_http_proxy(std::move(_reql_http_proxy)),
         web_assets(std::move(_web_assets)),
@@ -129,7 +137,12 @@ public:
         config_file(_config_file),
         argv(std::move(_argv)),
         join_delay_secs(_join_delay_secs),
-        node_reconnect_timeout_secs(_node_reconnect_timeout_secs)
+        node_reconnect_timeout_secs(_node_reconnect_timeout_secs),
+        cache_eviction_policy(_cache_eviction_policy),
+        block_compression(_block_compression),
+        gc_temperature_tiers(_gc_temperature_tiers),
+        query_scheduling(_query_scheduling),
+        cluster_connection_config(_cluster_connection_config)
     {
         tls_configs = _tls_configs;
     }
@@ -151,6 +164,11 @@ public:
     int join_delay_secs;
     int node_reconnect_timeout_secs;
     tls_configs_t tls_configs;
+    cache_eviction_policy_t cache_eviction_policy;
+    block_compression_t block_compression;
+    int32_t gc_temperature_tiers;
+    query_scheduling_t query_scheduling;
+    cluster_connection_config_t cluster_connection_config;
 };
 
 /* This has been factored out from `command_line.hpp` because it takes a very
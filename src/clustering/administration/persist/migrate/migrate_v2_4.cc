@@ -0,0 +1,25 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "clustering/administration/persist/migrate/migrate_v2_4.hpp"
+
+#include "clustering/administration/metadata.hpp"
+#include "clustering/administration/persist/file_keys.hpp"
+#include "clustering/administration/persist/migrate/rewrite.hpp"
+#include "clustering/administration/persist/raft_storage_interface.hpp"
+#include "clustering/table_manager/table_metadata.hpp"
+
+void migrate_metadata_v2_4_to_v2_5(metadata_file_t::write_txn_t *txn,
+                                   signal_t *interruptor) {
+    const cluster_version_t W = cluster_version_t::v2_4;
+    rewrite_metadata_values<W>(mdkey_cluster_semilattices(), txn, interruptor);
+    rewrite_metadata_values<W>(mdkey_auth_semilattices(), txn, interruptor);
+    rewrite_metadata_values<W>(mdkey_heartbeat_semilattices(), txn, interruptor);
+    rewrite_metadata_values<W>(mdkey_server_id(), txn, interruptor);
+    rewrite_metadata_values<W>(mdkey_server_config(), txn, interruptor);
+
+    rewrite_metadata_values<W>(mdprefix_table_active(), txn, interruptor);
+    rewrite_metadata_values<W>(mdprefix_table_inactive(), txn, interruptor);
+    rewrite_metadata_values<W>(mdprefix_table_raft_header(), txn, interruptor);
+    rewrite_metadata_values<W>(mdprefix_table_raft_snapshot(), txn, interruptor);
+    rewrite_metadata_values<W>(mdprefix_table_raft_log(), txn, interruptor);
+    rewrite_metadata_values<W>(mdprefix_branch_birth_certificate(), txn, interruptor);
+}
@@ -0,0 +1,12 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_ADMINISTRATION_PERSIST_MIGRATE_MIGRATE_V2_4_HPP_
+#define CLUSTERING_ADMINISTRATION_PERSIST_MIGRATE_MIGRATE_V2_4_HPP_
+
+#include "clustering/administration/persist/file.hpp"
+
+// This will rewrite all metadata from v2_4 in the v2_5 format, which adds the cache
+// configuration to `table_config_t`.
+void migrate_metadata_v2_4_to_v2_5(metadata_file_t::write_txn_t *txn,
+                                   signal_t *interruptor);
+
+#endif /* CLUSTERING_ADMINISTRATION_PERSIST_MIGRATE_MIGRATE_V2_4_HPP_ */
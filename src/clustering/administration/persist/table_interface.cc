@@ -24,6 +24,8 @@ public:
             const base_path_t &base_path,
             io_backender_t *io_backender,
             cache_balancer_t *cache_balancer,
+            block_compression_t block_compression,
+            int32_t gc_temperature_tiers,
             rdb_context_t *rdb_context,
             perfmon_collection_t *perfmon_collection_serializers,
             scoped_ptr_t<thread_allocation_t> &&serializer_thread,
@@ -62,8 +64,11 @@ public:
         // TODO: Could we handle failure when loading the serializer?  Right
         // now, we don't.
 
+        log_serializer_t::dynamic_config_t serializer_config;
+        serializer_config.block_compression = block_compression;
+        serializer_config.gc_temperature_tiers = gc_temperature_tiers;
         scoped_ptr_t<serializer_t> inner_serializer(new log_serializer_t(
-            log_serializer_t::dynamic_config_t(),
+            serializer_config,
             &file_opener,
             perfmon_collection_serializers));
         serializer.init(new merger_serializer_t(
@@ -296,6 +301,8 @@ void real_table_persistence_interface_t::load_multistore(
         base_path,
         io_backender,
         cache_balancer,
+        block_compression,
+        gc_temperature_tiers,
         rdb_context,
         perfmon_collection_serializers,
         std::move(serializer_thread),
@@ -361,3 +368,39 @@ bool real_table_persistence_interface_t::is_gc_active() const {
 
     return false;
 }
+
+bool real_table_persistence_interface_t::get_scrub_progress(
+        scrub_progress_t *progress_out) const {
+    bool any_active = false;
+    *progress_out = scrub_progress_t();
+    for (int thread = 0; thread < get_num_db_threads(); ++thread) {
+        std::map<serializer_t *, auto_drainer_t::lock_t> serializers_copy;
+
+        // As in `is_gc_active()`, the copy in the loop below is intentional.
+        for (auto real_multistore : real_multistores) {
+            serializer_t *serializer =
+                real_multistore.second.first->get_serializer();
+            if (serializer == nullptr ||
+                    serializer->home_thread() != threadnum_t(thread)) {
+                continue;
+            }
+            serializers_copy.insert(
+                std::make_pair(serializer, real_multistore.second.second));
+        }
+
+        {
+            on_thread_t on_thread((threadnum_t(thread)));
+            for (auto const &serializer : serializers_copy) {
+                scrub_progress_t progress;
+                if (serializer.first->get_scrub_progress(&progress)) {
+                    any_active = true;
+                    progress_out->blocks_done += progress.blocks_done;
+                    progress_out->blocks_total += progress.blocks_total;
+                    progress_out->errors += progress.errors;
+                }
+            }
+        }
+    }
+
+    return any_active;
+}
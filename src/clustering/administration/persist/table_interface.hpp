@@ -5,6 +5,8 @@
 #include "clustering/administration/perfmon_collection_repo.hpp"
 #include "clustering/administration/persist/raft_storage_interface.hpp"
 #include "clustering/table_manager/table_metadata.hpp"
+#include "serializer/log/config.hpp"
+#include "serializer/serializer.hpp"
 
 class cache_balancer_t;
 class metadata_file_t;
@@ -19,12 +21,16 @@ public:
             cache_balancer_t *_cache_balancer,
             const base_path_t &_base_path,
             rdb_context_t *_rdb_context,
-            metadata_file_t *_metadata_file) :
+            metadata_file_t *_metadata_file,
+            block_compression_t _block_compression,
+            int32_t _gc_temperature_tiers) :
         io_backender(_io_backender),
         cache_balancer(_cache_balancer),
         base_path(_base_path),
         rdb_context(_rdb_context),
         metadata_file(_metadata_file),
+        block_compression(_block_compression),
+        gc_temperature_tiers(_gc_temperature_tiers),
         /* We assign threads from the lowest thread number upwards. This is to reduce
         the potential for conflicting with cluster connection threads, which are
         assigned from the highest thread number downwards. */
@@ -72,6 +78,9 @@ public:
 
     bool is_gc_active() const;
 
+    // Adds up the progress of the tables whose serializers are currently scrubbing.
+    bool get_scrub_progress(scrub_progress_t *progress_out) const;
+
 private:
     serializer_filepath_t file_name_for(const namespace_id_t &table_id);
     threadnum_t pick_thread();
@@ -81,6 +90,8 @@ private:
     base_path_t const base_path;
     rdb_context_t * const rdb_context;
     metadata_file_t * const metadata_file;
+    block_compression_t const block_compression;
+    int32_t const gc_temperature_tiers;
 
     std::map<
         namespace_id_t, std::pair<real_multistore_ptr_t *, auto_drainer_t::lock_t>
@@ -689,6 +689,7 @@ void real_reql_cluster_interface_t::reconfigure_internal(
     new_config.config.sindexes = old_config.config.sindexes;
     new_config.config.write_ack_config = old_config.config.write_ack_config;
     new_config.config.durability = old_config.config.durability;
+    new_config.config.cache = old_config.config.cache;
 
     calculate_split_points_intelligently(
         table_id,
@@ -31,6 +31,9 @@ const char *table_server_stats_request_t::table_server_request_type = "table_ser
     (BUILDER).overwrite(#NAME, ql::datum_t( \
         (STATS).accumulate_server(SERVER, &parsed_stats_t::table_stats_t::NAME)));
 
+parsed_stats_t::lane_stats_t::lane_stats_t() :
+    queue_depth(0), messages_per_sec(0), latency_avg_ms(0) { }
+
 parsed_stats_t::server_stats_t::server_stats_t() :
     responsive(false),
     queries_per_sec(0), queries_total(0),
@@ -39,7 +42,8 @@ parsed_stats_t::server_stats_t::server_stats_t() :
 parsed_stats_t::table_stats_t::table_stats_t() :
     read_docs_per_sec(0), read_docs_total(0),
     written_docs_per_sec(0), written_docs_total(0),
-    in_use_bytes(0), metadata_bytes(0), data_bytes(0),
+    in_use_bytes(0), share_bytes(0), page_hits(0), page_misses(0),
+    metadata_bytes(0), data_bytes(0),
     garbage_bytes(0), preallocated_bytes(0),
     read_bytes_per_sec(0), read_bytes_total(0),
     written_bytes_per_sec(0), written_bytes_total(0) { }
@@ -65,6 +69,12 @@ parsed_stats_t::parsed_stats_t(const std::vector<ql::datum_t> &stats) {
             std::pair<datum_string_t, ql::datum_t> perf_pair = s.get_pair(i);
             if (perf_pair.first == "query_engine") {
                 store_query_engine_stats(perf_pair.second, &serv_stats);
+            } else if (perf_pair.first == "connectivity") {
+                ql::datum_t lanes_perf = perf_pair.second.get_field(
+                    "lanes", ql::throw_bool_t::NOTHROW);
+                if (lanes_perf.has()) {
+                    store_lane_stats(lanes_perf, &serv_stats);
+                }
             } else {
                 namespace_id_t table_id;
                 res = str_to_uuid(perf_pair.first.to_std(), &table_id);
@@ -125,6 +135,12 @@ void parsed_stats_t::store_shard_values(const ql::datum_t &shard_perf,
                 } else if (key == "cache") {
                     add_perfmon_value(sub_pair.second, "in_use_bytes",
                                       &stats_out->in_use_bytes);
+                    add_perfmon_value(sub_pair.second, "share_bytes",
+                                      &stats_out->share_bytes);
+                    add_perfmon_value(sub_pair.second, "page_hits",
+                                      &stats_out->page_hits);
+                    add_perfmon_value(sub_pair.second, "page_misses",
+                                      &stats_out->page_misses);
                 }
             }
         }
@@ -169,6 +185,29 @@ void parsed_stats_t::store_query_engine_stats(const ql::datum_t &qe_perf,
     store_perfmon_value(qe_perf, "clients_active", &stats_out->clients_active);
 }
 
+void parsed_stats_t::store_lane_stats(const ql::datum_t &lanes_perf,
+                                      server_stats_t *stats_out) {
+    r_sanity_check(lanes_perf.get_type() == ql::datum_t::R_OBJECT);
+    for (size_t i = 0; i < lanes_perf.obj_size(); ++i) {
+        std::pair<datum_string_t, ql::datum_t> pair = lanes_perf.get_pair(i);
+        r_sanity_check(pair.second.get_type() == ql::datum_t::R_OBJECT);
+        lane_stats_t &lane_stats = stats_out->lanes[pair.first.to_std()];
+        store_perfmon_value(pair.second, "queue_depth", &lane_stats.queue_depth);
+
+        ql::datum_t latency = pair.second.get_field("latency",
+                                                    ql::throw_bool_t::NOTHROW);
+        if (latency.has()) {
+            r_sanity_check(latency.get_type() == ql::datum_t::R_OBJECT);
+            store_perfmon_value(latency, "per_sec", &lane_stats.messages_per_sec);
+            // The average is `null` if no messages were sent recently
+            ql::datum_t avg = latency.get_field("avg", ql::throw_bool_t::NOTHROW);
+            if (avg.has() && avg.get_type() == ql::datum_t::R_NUM) {
+                lane_stats.latency_avg_ms = avg.as_num() * 1000.0;
+            }
+        }
+    }
+}
+
 void parsed_stats_t::store_table_stats(const namespace_id_t &table_id,
                                        const ql::datum_t &table_perf,
                                        server_stats_t *stats_out) {
@@ -253,6 +292,7 @@ bool add_table_fields(const namespace_id_t &table_id,
 std::set<std::vector<std::string> > stats_request_t::global_stats_filter() {
     return std::set<std::vector<std::string> >(
         { {"query_engine"},
+          {"connectivity", "lanes"},
           {"[0-9A-Fa-f-]+", "serializers" } });
 }
 
@@ -407,6 +447,7 @@ server_stats_request_t::server_stats_request_t(const server_id_t &_server_id) :
 std::set<std::vector<std::string> > server_stats_request_t::get_filter() const {
     return std::set<std::vector<std::string> >(
         { {"query_engine"},
+          {"connectivity", "lanes"},
           {".*", "serializers", "shard_[0-9]+", "btree-.*" } });
 }
 
@@ -457,6 +498,17 @@ bool server_stats_request_t::to_datum(const parsed_stats_t &stats,
         ADD_SERVER_STAT(qe_builder, stats, server_id, written_docs_per_sec);
         ADD_SERVER_STAT(qe_builder, stats, server_id, written_docs_total);
         row_builder.overwrite("query_engine", std::move(qe_builder).to_datum());
+
+        ql::datum_object_builder_t lanes_builder;
+        for (auto const &lane_pair : server_stats.lanes) {
+            ql::datum_object_builder_t lane_builder;
+            ADD_STAT(lane_builder, lane_pair.second, queue_depth);
+            ADD_STAT(lane_builder, lane_pair.second, messages_per_sec);
+            ADD_STAT(lane_builder, lane_pair.second, latency_avg_ms);
+            lanes_builder.overwrite(lane_pair.first.c_str(),
+                                    std::move(lane_builder).to_datum());
+        }
+        row_builder.overwrite("cluster_lanes", std::move(lanes_builder).to_datum());
     }
     *result_out = std::move(row_builder).to_datum();
     return true;
@@ -552,6 +604,13 @@ bool table_server_stats_request_t::to_datum(const parsed_stats_t &stats,
 
         ql::datum_object_builder_t se_cache_builder;
         ADD_STAT(se_cache_builder, table_stats, in_use_bytes);
+        ADD_STAT(se_cache_builder, table_stats, share_bytes);
+        // The fraction of page acquisitions since startup that found the page in
+        // memory, or `null` if the table's cache hasn't been used yet.
+        double page_accesses = table_stats.page_hits + table_stats.page_misses;
+        se_cache_builder.overwrite("hit_rate", page_accesses > 0
+            ? ql::datum_t(table_stats.page_hits / page_accesses)
+            : ql::datum_t::null());
 
         ql::datum_object_builder_t se_disk_space_builder;
         ADD_STAT(se_disk_space_builder, table_stats, metadata_bytes);
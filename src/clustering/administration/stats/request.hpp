@@ -28,6 +28,9 @@ public:
         double written_docs_per_sec;
         double written_docs_total;
         double in_use_bytes;
+        double share_bytes;
+        double page_hits;
+        double page_misses;
         double metadata_bytes;
         double data_bytes;
         double garbage_bytes;
@@ -38,6 +41,15 @@ public:
         double written_bytes_total;
     };
 
+    // Stats for one of the lanes that intra-cluster messages are sent in
+    struct lane_stats_t {
+        lane_stats_t();
+
+        double queue_depth;
+        double messages_per_sec;
+        double latency_avg_ms;
+    };
+
     struct server_stats_t {
         server_stats_t();
 
@@ -47,6 +59,7 @@ public:
         double client_connections;
         double clients_active;
 
+        std::map<std::string, lane_stats_t> lanes;
         std::map<namespace_id_t, table_stats_t> tables;
     };
 
@@ -90,6 +103,9 @@ private:
     void store_query_engine_stats(const ql::datum_t &qe_perf,
                                   server_stats_t *stats_out);
 
+    void store_lane_stats(const ql::datum_t &lanes_perf,
+                          server_stats_t *stats_out);
+
     void store_table_stats(const namespace_id_t &table_id,
                            const ql::datum_t &table_perf,
                            server_stats_t *stats_out);
@@ -227,6 +227,91 @@ bool convert_durability_from_datum(
     return true;
 }
 
+ql::datum_t convert_cache_config_to_datum(
+        const table_cache_config_t &config) {
+    ql::datum_object_builder_t builder;
+    builder.overwrite("reserved_mb",
+        ql::datum_t(static_cast<double>(config.reserved_bytes) / MEGABYTE));
+    if (static_cast<bool>(config.limit_bytes)) {
+        builder.overwrite("limit_mb",
+            ql::datum_t(static_cast<double>(*config.limit_bytes) / MEGABYTE));
+    } else {
+        builder.overwrite("limit_mb", ql::datum_t::null());
+    }
+    return std::move(builder).to_datum();
+}
+
+bool convert_cache_size_mb_from_datum(
+        const ql::datum_t &datum,
+        uint64_t *bytes_out,
+        admin_err_t *error_out) {
+    if (datum.get_type() != ql::datum_t::R_NUM) {
+        *error_out = admin_err_t{
+            "Expected a number, got " + datum.print(),
+            query_state_t::FAILED};
+        return false;
+    }
+    double size_mb = datum.as_num();
+    if (size_mb * MEGABYTE > static_cast<double>(std::numeric_limits<int64_t>::max())) {
+        *error_out = admin_err_t{"Value is too big.", query_state_t::FAILED};
+        return false;
+    }
+    if (size_mb < 0) {
+        *error_out = admin_err_t{"Cache size cannot be negative.",
+                                 query_state_t::FAILED};
+        return false;
+    }
+    *bytes_out = size_mb * MEGABYTE;
+    return true;
+}
+
+bool convert_cache_config_from_datum(
+        const ql::datum_t &datum,
+        table_cache_config_t *config_out,
+        admin_err_t *error_out) {
+    converter_from_datum_object_t converter;
+    if (!converter.init(datum, error_out)) {
+        return false;
+    }
+
+    ql::datum_t reserved_datum;
+    converter.get_optional("reserved_mb", &reserved_datum);
+    if (reserved_datum.has()) {
+        if (!convert_cache_size_mb_from_datum(reserved_datum,
+                &config_out->reserved_bytes, error_out)) {
+            error_out->msg = "In `reserved_mb`: " + error_out->msg;
+            return false;
+        }
+    } else {
+        config_out->reserved_bytes = 0;
+    }
+
+    ql::datum_t limit_datum;
+    converter.get_optional("limit_mb", &limit_datum);
+    if (limit_datum.has() && limit_datum.get_type() != ql::datum_t::R_NULL) {
+        uint64_t limit_bytes;
+        if (!convert_cache_size_mb_from_datum(limit_datum, &limit_bytes, error_out)) {
+            error_out->msg = "In `limit_mb`: " + error_out->msg;
+            return false;
+        }
+        if (limit_bytes < config_out->reserved_bytes) {
+            *error_out = admin_err_t{
+                "`limit_mb` cannot be smaller than `reserved_mb`.",
+                query_state_t::FAILED};
+            return false;
+        }
+        config_out->limit_bytes = boost::optional<uint64_t>(limit_bytes);
+    } else {
+        config_out->limit_bytes = boost::optional<uint64_t>();
+    }
+
+    if (!converter.check_no_extra_keys(error_out)) {
+        return false;
+    }
+
+    return true;
+}
+
 ql::datum_t convert_table_config_shard_to_datum(
         const table_config_t::shard_t &shard,
         admin_identifier_format_t identifier_format,
@@ -410,6 +495,7 @@ ql::datum_t convert_table_config_to_datum(
         convert_write_ack_config_to_datum(config.write_ack_config));
     builder.overwrite("durability",
         convert_durability_to_datum(config.durability));
+    builder.overwrite("cache", convert_cache_config_to_datum(config.cache));
     return std::move(builder).to_datum();
 }
 
@@ -603,6 +689,24 @@ bool convert_table_config_and_name_from_datum(
         config_out->durability = write_durability_t::HARD;
     }
 
+    /* Unlike the fields above, `cache` may be left out when replacing the row of an
+    existing table, since tables created before it existed don't have it. */
+    if (converter.has("cache")) {
+        ql::datum_t cache_datum;
+        if (!converter.get("cache", &cache_datum, error_out)) {
+            return false;
+        }
+        if (!convert_cache_config_from_datum(cache_datum, &config_out->cache,
+                                             error_out)) {
+            error_out->msg = "In `cache`: " + error_out->msg;
+            return false;
+        }
+    } else if (existed_before) {
+        config_out->cache = old_config.config.cache;
+    } else {
+        config_out->cache = table_cache_config_t();
+    }
+
     if (converter.has("write_hook")) {
         ql::datum_t write_hook_datum;
         if (!converter.get("write_hook", &write_hook_datum, error_out)) {
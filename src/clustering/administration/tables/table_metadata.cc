@@ -18,6 +18,11 @@ RDB_IMPL_SERIALIZABLE_3_SINCE_v2_1(table_config_t::shard_t,
 RDB_IMPL_EQUALITY_COMPARABLE_3(table_config_t::shard_t,
     all_replicas, nonvoting_replicas, primary_replica);
 
+RDB_IMPL_SERIALIZABLE_2_SINCE_v2_5(table_cache_config_t,
+    reserved_bytes, limit_bytes);
+RDB_IMPL_EQUALITY_COMPARABLE_2(table_cache_config_t,
+    reserved_bytes, limit_bytes);
+
 template <cluster_version_t W>
 void serialize(write_message_t *wm, const table_config_t &tc) {
     table_basic_config_t basic = tc.basic;
@@ -37,6 +42,9 @@ void serialize(write_message_t *wm, const table_config_t &tc) {
 
     write_durability_t durability = tc.durability;
     serialize<W>(wm, durability);
+
+    table_cache_config_t cache = tc.cache;
+    serialize<W>(wm, cache);
 }
 
 INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(table_config_t);
@@ -75,8 +83,8 @@ archive_result_t deserialize_table_config_pre_v2_4(
     return res;
 }
 
-template <cluster_version_t  W>
-archive_result_t deserialize(
+template <cluster_version_t W>
+archive_result_t deserialize_table_config_pre_v2_5(
     read_stream_t *s, table_config_t *tc) {
     archive_result_t res;
 
@@ -104,13 +112,25 @@ archive_result_t deserialize(
     res = deserialize<W>(s, &durability);
     if (bad(res)) { return res; }
 
+    // Tables from before v2_5 don't have a cache reservation or limit.
     *tc = table_config_t{std::move(basic),
                          std::move(shards),
                          std::move(sindexes),
                          std::move(write_hook),
                          std::move(write_ack_config),
-                         std::move(durability)};
+                         std::move(durability),
+                         table_cache_config_t()};
+
+    return res;
+}
+
+template <cluster_version_t W>
+archive_result_t deserialize(
+    read_stream_t *s, table_config_t *tc) {
+    archive_result_t res = deserialize_table_config_pre_v2_5<W>(s, tc);
+    if (bad(res)) { return res; }
 
+    res = deserialize<W>(s, &tc->cache);
     return res;
 }
 
@@ -132,11 +152,17 @@ archive_result_t deserialize<cluster_version_t::v2_3>(
     return deserialize_table_config_pre_v2_4<cluster_version_t::v2_4>(s, tc);
 }
 
-template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(
+template <>
+archive_result_t deserialize<cluster_version_t::v2_4>(
+    read_stream_t *s, table_config_t *tc) {
+    return deserialize_table_config_pre_v2_5<cluster_version_t::v2_4>(s, tc);
+}
+
+template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(
     read_stream_t *, table_config_t *);
 
-RDB_IMPL_EQUALITY_COMPARABLE_6(table_config_t,
-    basic, shards, write_hook, sindexes, write_ack_config, durability);
+RDB_IMPL_EQUALITY_COMPARABLE_7(table_config_t,
+    basic, shards, write_hook, sindexes, write_ack_config, durability, cache);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_16(table_shard_scheme_t, split_points);
 RDB_IMPL_EQUALITY_COMPARABLE_1(table_shard_scheme_t, split_points);
@@ -46,6 +46,23 @@ ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(
     write_ack_config_t::SINGLE,
     write_ack_config_t::MAJORITY);
 
+/* `table_cache_config_t` bounds the share of each server's cache that the cache
+balancer gives to the table. Both bounds are per server, and are split evenly across
+the table's CPU shards. */
+class table_cache_config_t {
+public:
+    table_cache_config_t() : reserved_bytes(0) { }
+
+    /* The balancer won't shrink the table's share below this, unless the reservations
+    of all tables together exceed the total cache size. */
+    uint64_t reserved_bytes;
+    /* The balancer won't grow the table's share above this. */
+    boost::optional<uint64_t> limit_bytes;
+};
+
+RDB_DECLARE_SERIALIZABLE(table_cache_config_t);
+RDB_DECLARE_EQUALITY_COMPARABLE(table_cache_config_t);
+
 /* `table_config_t` describes the complete contents of the `rethinkdb.table_config`
 artificial table. */
 
@@ -74,6 +91,7 @@ public:
     boost::optional<write_hook_config_t> write_hook;
     write_ack_config_t write_ack_config;
     write_durability_t durability;
+    table_cache_config_t cache;
 };
 
 RDB_DECLARE_EQUALITY_COMPARABLE(table_config_t);
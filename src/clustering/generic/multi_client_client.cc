@@ -35,7 +35,9 @@ multi_client_client_t<request_type>::multi_client_client_t(
 template <class request_type>
 void multi_client_client_t<request_type>::spawn_request(
         const request_type &request) {
-    send(mailbox_manager, intro_promise.wait(), request);
+    /* The requests are primary queries, which someone is waiting on. */
+    send(mailbox_manager, cluster_message_lane_t::INTERACTIVE, intro_promise.wait(),
+         request);
 }
 
 template <class request_type>
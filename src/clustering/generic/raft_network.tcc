@@ -46,7 +46,8 @@ bool raft_networked_member_t<state_t>::send_rpc(
             *reply_out = reply;
             got_reply.pulse();
         });
-    send(mailbox_manager, bcard->rpc, request, reply_mailbox.get_address());
+    send(mailbox_manager, cluster_message_lane_t::INTERACTIVE, bcard->rpc, request,
+         reply_mailbox.get_address());
     wait_any_t waiter(&watcher, &got_reply);
     wait_interruptible(&waiter, interruptor);
     return got_reply.is_pulsed();
@@ -79,7 +80,7 @@ void raft_networked_member_t<state_t>::on_rpc(
         const mailbox_t<void(raft_rpc_reply_t)>::address_t &reply_addr) {
     raft_rpc_reply_t reply;
     member.on_rpc(request, &reply);
-    send(mailbox_manager, reply_addr, reply);
+    send(mailbox_manager, cluster_message_lane_t::INTERACTIVE, reply_addr, reply);
 }
 
 #endif   /* CLUSTERING_GENERIC_RAFT_NETWORK_TCC_ */
@@ -0,0 +1,38 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved
+#include "clustering/table_manager/cache_reservation_manager.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "buffer_cache/alt.hpp"
+#include "rdb_protocol/store.hpp"
+
+cache_reservation_manager_t::cache_reservation_manager_t(
+        multistore_ptr_t *multistore_,
+        const clone_ptr_t<watchable_t<table_config_t> > &table_config_) :
+    multistore(multistore_), table_config(table_config_),
+    update_pumper([this](signal_t *interruptor) { update_blocking(interruptor); }),
+    table_config_subs([this]() { update_pumper.notify(); })
+{
+    watchable_t<table_config_t>::freeze_t freeze(table_config);
+    table_config_subs.reset(table_config, &freeze);
+    update_pumper.notify();
+}
+
+void cache_reservation_manager_t::update_blocking(UNUSED signal_t *interruptor) {
+    table_cache_config_t goal;
+    table_config->apply_read([&](const table_config_t *config) {
+        goal = config->cache;
+    });
+
+    const uint64_t reservation = goal.reserved_bytes / CPU_SHARDING_FACTOR;
+    const uint64_t cap = static_cast<bool>(goal.limit_bytes)
+        ? std::max(*goal.limit_bytes / CPU_SHARDING_FACTOR, reservation)
+        : std::numeric_limits<uint64_t>::max();
+
+    for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
+        store_t *store = multistore->get_underlying_store(i);
+        on_thread_t thread_switcher(store->home_thread());
+        store->cache->set_memory_bounds(reservation, cap);
+    }
+}
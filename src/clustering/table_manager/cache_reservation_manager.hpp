@@ -0,0 +1,32 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_TABLE_MANAGER_CACHE_RESERVATION_MANAGER_HPP_
+#define CLUSTERING_TABLE_MANAGER_CACHE_RESERVATION_MANAGER_HPP_
+
+#include "clustering/table_contract/cpu_sharding.hpp"
+#include "clustering/administration/tables/table_metadata.hpp"
+#include "concurrency/pump_coro.hpp"
+#include "concurrency/watchable.hpp"
+
+/* The `cache_reservation_manager_t` is responsible for reading the cache bounds from
+the `table_config_t` and applying them to the caches of the `store_t`s, so that the
+cache balancer honors them. The bounds are split evenly across the CPU shards. */
+
+class cache_reservation_manager_t {
+public:
+    cache_reservation_manager_t(
+        multistore_ptr_t *multistore,
+        const clone_ptr_t<watchable_t<table_config_t> > &table_config);
+
+private:
+    void update_blocking(signal_t *interruptor);
+
+    multistore_ptr_t *const multistore;
+    clone_ptr_t<watchable_t<table_config_t> > const table_config;
+
+    /* Destructor order matters, see `sindex_manager_t`. */
+    pump_coro_t update_pumper;
+
+    watchable_t<table_config_t>::subscription_t table_config_subs;
+};
+
+#endif /* CLUSTERING_TABLE_MANAGER_CACHE_RESERVATION_MANAGER_HPP_ */
@@ -5,6 +5,7 @@
 #include "clustering/table_contract/coordinator/coordinator.hpp"
 #include "clustering/table_contract/executor/executor.hpp"
 #include "clustering/table_manager/backfill_progress_tracker.hpp"
+#include "clustering/table_manager/cache_reservation_manager.hpp"
 #include "clustering/table_manager/server_name_cache_updater.hpp"
 #include "clustering/table_manager/sindex_manager.hpp"
 #include "clustering/table_manager/table_metadata.hpp"
@@ -182,6 +183,10 @@ private:
     `multistore_ptr` according to what it sees. */
     sindex_manager_t sindex_manager;
 
+    /* The `cache_reservation_manager` watches the `table_config_t` and bounds the
+    cache sizes of `multistore_ptr` according to what it sees. */
+    cache_reservation_manager_t cache_reservation_manager;
+
     auto_drainer_t drainer;
 
     watchable_map_t<std::pair<peer_id_t, namespace_id_t>, table_manager_bcard_t>
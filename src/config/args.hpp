@@ -44,6 +44,15 @@
 // useful.
 #define DEFAULT_IO_BATCH_FACTOR                   1
 
+// The number of blocker pool threads that the io_uring disk manager keeps for the
+// operations it doesn't submit through the ring (file resizes and writes that are
+// wrapped in datasyncs). These are rare, so a couple of threads are plenty.
+#define URING_DISKMGR_BLOCKER_THREADS             2
+
+// The io_uring disk manager never asks for a ring with more submission queue
+// entries than this, regardless of the number of concurrent I/O requests allowed.
+#define URING_DISKMGR_MAX_RING_ENTRIES            4096
+
 // I/O priority of index writes in the log serializer
 #define INDEX_WRITE_IO_PRIORITY                   128
 
@@ -135,6 +144,17 @@
 // How many LBA structures to have for each file
 #define LBA_SHARD_FACTOR                          4
 
+// I/O priority for the serializer's scrub, which reads back all blocks to verify their
+// checksums, and how often it runs by default
+#define SERIALIZER_SCRUB_IO_PRIORITY              1
+#define DEFAULT_SERIALIZER_SCRUB_INTERVAL_SECS    (24 * 60 * 60)
+
+// How many block ids should the scrub look at before reading the blocks?
+#define SERIALIZER_SCRUB_BATCH_SIZE               1024
+
+// The most temperature tiers the data block GC can sort the blocks it moves into
+#define MAX_GC_TEMPERATURE_TIERS                  4
+
 // How much space to reserve in the metablock to store inline LBA entries
 // Make sure that it fits into METABLOCK_SIZE, including all other meta data
 // TODO (daniel): Tune
@@ -153,6 +173,55 @@
 
 #define COROUTINE_STACK_SIZE                      131072
 
+// Coroutines can be spawned with a smaller or larger stack than `COROUTINE_STACK_SIZE`
+// (see `coro_stack_size_t`).
+#define COROUTINE_SMALL_STACK_SIZE                32768
+#define COROUTINE_LARGE_STACK_SIZE                524288
+
+// Each thread's utilization (the fraction of time its event loop isn't waiting for
+// events) is averaged over windows of this length.
+#define THREAD_UTILIZATION_WINDOW_MS              1000
+
+// With `--query-scheduling balanced`, an idle client connection (one with no running
+// queries and no open cursors) is moved to another thread when its thread's
+// utilization exceeds that of the least utilized thread by at least
+// `QUERY_MIGRATION_UTILIZATION_MARGIN`. At most one connection is moved away from each
+// thread every `QUERY_MIGRATION_MIN_INTERVAL_MS`, so that the utilization numbers can
+// catch up before we move more. Connections that are busy with a query are never
+// moved, so these settings can't help with a single long-running query.
+#define QUERY_MIGRATION_UTILIZATION_MARGIN        0.3
+#define QUERY_MIGRATION_MIN_INTERVAL_MS           250
+
+// The changefeed `server_t` sends the changes for each client in batches.  A batch is
+// sent once it holds `CHANGEFEED_BATCH_MAX_MSGS` messages, or at the latest
+// `CHANGEFEED_BATCH_DELAY_MS` after its first message was added (rounded up to the
+// timer granularity).
+#define CHANGEFEED_BATCH_MAX_MSGS                 128
+#define CHANGEFEED_BATCH_DELAY_MS                 2
+
+// A primary index scan on a shard collects rows for its `map` and `filter`
+// transformations until it has `RGET_EVAL_BATCH_MAX_ROWS` of them or their serialized
+// values add up to `RGET_EVAL_BATCH_MAX_SIZE` bytes, and then evaluates the
+// transformations on all of them at once.
+#define RGET_EVAL_BATCH_MAX_ROWS                  64
+#define RGET_EVAL_BATCH_MAX_SIZE                  MEGABYTE
+
+// With `--cluster-connections`, messages in the bulk lane are sent over the additional
+// TCP connections to a peer. An additional TCP connection gives up if the primary
+// connection to the peer doesn't show up on our side within
+// `CLUSTER_BULK_STREAM_ATTACH_TIMEOUT_MS` (plus the join delay).
+#define MAX_CLUSTER_CONNECTIONS_PER_PEER          16
+#define CLUSTER_BULK_STREAM_ATTACH_TIMEOUT_MS     30000
+
+// Messages that are at least `CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE` bytes large go into
+// the bulk lane, no matter which lane they were sent in. Messages are written in
+// fragments of at most `CLUSTER_MESSAGE_FRAGMENT_SIZE` bytes, so that the lanes can
+// interleave. A lane that had to let `CLUSTER_LANE_MAX_BYPASSES` fragments from
+// higher-priority lanes go first gets to send the next fragment.
+#define CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE        (64 * KILOBYTE)
+#define CLUSTER_MESSAGE_FRAGMENT_SIZE             (32 * KILOBYTE)
+#define CLUSTER_LANE_MAX_BYPASSES                 8
+
 
 /**
  * Message scheduler configuration
@@ -190,6 +259,7 @@
 #define CORO_PRIORITY_RESET_DATA                (-2)
 #define CORO_PRIORITY_DIRECTORY_CHANGES         (-2)
 #define CORO_PRIORITY_LBA_GC                    (-2)
+#define CORO_PRIORITY_SERIALIZER_SCRUB          (-2)
 
 #endif  // CONFIG_ARGS_HPP_
 
@@ -0,0 +1,54 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "containers/archive/scatter_gather_message.hpp"
+
+#include <sys/uio.h>
+
+write_message_t *scatter_gather_message_t::copied() {
+    if (pieces_.empty() || !pieces_.back().copied.has()) {
+        pieces_.emplace_back();
+        pieces_.back().copied.init(new write_message_t);
+        pieces_.back().reference_size = 0;
+    }
+    return pieces_.back().copied.get();
+}
+
+void scatter_gather_message_t::append_reference(const shared_buf_ref_t<char> &ref,
+                                                size_t size) {
+    ref.guarantee_in_boundary(size);
+    if (!pieces_.empty() && pieces_.back().copied.has()) {
+        size_ += pieces_.back().copied->size();
+    }
+    pieces_.emplace_back();
+    pieces_.back().reference = ref;
+    pieces_.back().reference_size = size;
+    size_ += size;
+}
+
+size_t scatter_gather_message_t::size() const {
+    size_t res = size_;
+    // The last piece can still grow, so it isn't counted in `size_` yet.
+    if (!pieces_.empty() && pieces_.back().copied.has()) {
+        res += pieces_.back().copied->size();
+    }
+    return res;
+}
+
+void scatter_gather_message_t::append_iovecs(std::vector<iovec> *iovecs_out) {
+    for (piece_t &piece : pieces_) {
+        if (piece.copied.has()) {
+            intrusive_list_t<write_buffer_t> *buffers =
+                piece.copied->unsafe_expose_buffers();
+            for (write_buffer_t *b = buffers->head(); b != nullptr; b = buffers->next(b)) {
+                iovec vec;
+                vec.iov_base = b->data;
+                vec.iov_len = b->size;
+                iovecs_out->push_back(vec);
+            }
+        } else if (piece.reference_size > 0) {
+            iovec vec;
+            vec.iov_base = const_cast<char *>(piece.reference.get());
+            vec.iov_len = piece.reference_size;
+            iovecs_out->push_back(vec);
+        }
+    }
+}
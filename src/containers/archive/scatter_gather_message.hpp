@@ -0,0 +1,48 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_ARCHIVE_SCATTER_GATHER_MESSAGE_HPP_
+#define CONTAINERS_ARCHIVE_SCATTER_GATHER_MESSAGE_HPP_
+
+#include <vector>
+
+#include "containers/archive/archive.hpp"
+#include "containers/scoped.hpp"
+#include "containers/shared_buffer.hpp"
+
+struct iovec;
+
+// A message that is built up like a `write_message_t`, but that can also refer to
+// pieces of existing shared buffers instead of copying them.  The whole message can
+// then be handed to a single `writev()`.
+class scatter_gather_message_t {
+public:
+    scatter_gather_message_t() : size_(0) { }
+
+    // Serialize small things into the returned `write_message_t`; they are copied.
+    // The pointer is invalidated by the next call to `append_reference()`.
+    write_message_t *copied();
+
+    // Appends `size` bytes starting at `ref` to the message, keeping a reference to
+    // the underlying buffer rather than copying the bytes.
+    void append_reference(const shared_buf_ref_t<char> &ref, size_t size);
+
+    size_t size() const;
+
+    // Appends the pieces of the message to `iovecs_out`, in order.  They point into
+    // the message, so they are only valid as long as it isn't changed or destroyed.
+    void append_iovecs(std::vector<iovec> *iovecs_out);
+
+private:
+    struct piece_t {
+        // Exactly one of `copied` and `reference` is set.
+        scoped_ptr_t<write_message_t> copied;
+        shared_buf_ref_t<char> reference;
+        size_t reference_size;
+    };
+
+    std::vector<piece_t> pieces_;
+    size_t size_;
+
+    DISABLE_COPYING(scatter_gather_message_t);
+};
+
+#endif  // CONTAINERS_ARCHIVE_SCATTER_GATHER_MESSAGE_HPP_
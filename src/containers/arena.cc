@@ -0,0 +1,156 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "containers/arena.hpp"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#include "arch/runtime/coroutines.hpp"
+#include "config/args.hpp"
+#include "math.hpp"
+#include "thread_local.hpp"
+#include "utils.hpp"
+
+// Chunks are small enough that an object which outlives its query doesn't hold on to
+// much memory, and allocations that would fill a good part of one are left to malloc.
+const size_t ARENA_CHUNK_SIZE = 16 * KILOBYTE;
+const size_t MAX_ARENA_ALLOCATION_SIZE = KILOBYTE;
+
+// Every allocation is preceded by a pointer to its chunk, or `nullptr` if it came from
+// `rmalloc()`.
+const size_t ARENA_HEADER_SIZE = sizeof(arena_chunk_t *);
+const size_t ARENA_ALIGNMENT = 8;
+
+struct arena_chunk_t {
+    // The number of allocations in the chunk, plus one while its arena still
+    // allocates from it.
+    std::atomic<intptr_t> refcount;
+};
+
+static_assert(sizeof(arena_chunk_t) % ARENA_ALIGNMENT == 0,
+              "The data of an arena chunk must be aligned.");
+
+// The innermost arena of code that doesn't run in a coroutine.
+TLS_with_init(arena_t *, arena_outside_coro, nullptr);
+
+void release_arena_chunk(arena_chunk_t *chunk) {
+    if (--chunk->refcount == 0) {
+        free(chunk);
+    }
+}
+
+void *arena_allocate(size_t size) {
+    arena_t *arena = arena_t::current();
+    if (arena != nullptr) {
+        void *res = arena->allocate(size);
+        if (res != nullptr) {
+            return res;
+        }
+    }
+    char *block = static_cast<char *>(rmalloc(ARENA_HEADER_SIZE + size));
+    *reinterpret_cast<arena_chunk_t **>(block) = nullptr;
+    return block + ARENA_HEADER_SIZE;
+}
+
+void arena_free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    char *block = static_cast<char *>(ptr) - ARENA_HEADER_SIZE;
+    arena_chunk_t *chunk = *reinterpret_cast<arena_chunk_t **>(block);
+    if (chunk == nullptr) {
+        free(block);
+    } else {
+        release_arena_chunk(chunk);
+    }
+}
+
+arena_t::arena_t()
+    : owner_(coro_t::self()),
+      thread_(get_thread_id()),
+      chunk_(nullptr),
+      chunk_next_(nullptr),
+      chunk_end_(nullptr),
+      bytes_allocated_(0),
+      bytes_allocated_in_chunks_(0),
+      outer_(innermost(owner_)),
+      detached_(false) {
+    set_innermost(owner_, this);
+}
+
+arena_t::~arena_t() {
+    assert_thread();
+    if (!detached_) {
+        arena_t *inner = innermost(owner_);
+        if (inner == this) {
+            set_innermost(owner_, outer_);
+        } else {
+            // An arena that was created after this one is still around.
+            while (inner->outer_ != this) {
+                inner = inner->outer_;
+            }
+            inner->outer_ = outer_;
+        }
+    }
+    release_chunk();
+}
+
+arena_t *arena_t::current() {
+    arena_t *arena = innermost(coro_t::self());
+    return arena != nullptr && arena->thread_ == get_thread_id() ? arena : nullptr;
+}
+
+arena_t *arena_t::innermost(coro_t *owner) {
+    return owner != nullptr ? owner->arena_ : TLS_get_arena_outside_coro();
+}
+
+void arena_t::set_innermost(coro_t *owner, arena_t *arena) {
+    if (owner != nullptr) {
+        owner->arena_ = arena;
+    } else {
+        TLS_set_arena_outside_coro(arena);
+    }
+}
+
+void arena_t::detach_all(coro_t *coro) {
+    arena_t *arena = coro->arena_;
+    while (arena != nullptr) {
+        arena_t *outer = arena->outer_;
+        arena->detached_ = true;
+        arena->outer_ = nullptr;
+        arena = outer;
+    }
+    coro->arena_ = nullptr;
+}
+
+void *arena_t::allocate(size_t size) {
+    bytes_allocated_ += size;
+    const size_t block_size =
+        ceil_aligned(ARENA_HEADER_SIZE + size, ARENA_ALIGNMENT);
+    if (block_size > MAX_ARENA_ALLOCATION_SIZE) {
+        return nullptr;
+    }
+    if (static_cast<size_t>(chunk_end_ - chunk_next_) < block_size) {
+        release_chunk();
+        chunk_ = static_cast<arena_chunk_t *>(rmalloc(ARENA_CHUNK_SIZE));
+        new (&chunk_->refcount) std::atomic<intptr_t>(1);
+        chunk_next_ = reinterpret_cast<char *>(chunk_) + sizeof(arena_chunk_t);
+        chunk_end_ = reinterpret_cast<char *>(chunk_) + ARENA_CHUNK_SIZE;
+    }
+    char *block = chunk_next_;
+    chunk_next_ += block_size;
+    ++chunk_->refcount;
+    *reinterpret_cast<arena_chunk_t **>(block) = chunk_;
+    bytes_allocated_in_chunks_ += size;
+    return block + ARENA_HEADER_SIZE;
+}
+
+void arena_t::release_chunk() {
+    if (chunk_ != nullptr) {
+        release_arena_chunk(chunk_);
+        chunk_ = nullptr;
+        chunk_next_ = nullptr;
+        chunk_end_ = nullptr;
+    }
+}
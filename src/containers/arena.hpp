@@ -0,0 +1,96 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_ARENA_HPP_
+#define CONTAINERS_ARENA_HPP_
+
+#include <stddef.h>
+
+#include <utility>
+
+#include "containers/counted.hpp"
+#include "threading.hpp"
+
+class coro_t;
+struct arena_chunk_t;
+
+/* Allocates memory for short-lived objects. If the calling coroutine has an `arena_t`
+on the current thread, the memory comes from that; otherwise it comes from `rmalloc()`.
+Either way it must be released with `arena_free()`, on any thread. The memory is aligned
+to 8 bytes. */
+void *arena_allocate(size_t size);
+void arena_free(void *ptr);
+
+/* An `arena_t` serves the `arena_allocate()` calls of the coroutine that created it, for
+as long as it exists. It hands out memory from large chunks by bumping a pointer, so the
+thousands of small buffers that a query creates and drops again don't each go through
+the general-purpose allocator. Allocations that are too large for that, and those made
+by other coroutines or on other threads, go to `rmalloc()` as usual.
+
+Memory from an arena doesn't have to be freed before the arena is destroyed. Each chunk
+counts the allocations in it and is only freed together with the last of them. So
+objects that escape the arena, such as rows in a response or a stream's buffer, stay
+valid without being copied. In exchange they keep their whole chunk alive. */
+class arena_t : public home_thread_mixin_debug_only_t {
+public:
+    arena_t();
+    ~arena_t();
+
+    // The bytes requested through `arena_allocate()` while this arena was in charge,
+    // and how many of them it served from its chunks.
+    size_t bytes_allocated() const { return bytes_allocated_; }
+    size_t bytes_allocated_in_chunks() const { return bytes_allocated_in_chunks_; }
+
+private:
+    friend void *arena_allocate(size_t size);
+    friend class coro_t;
+
+    // Returns the arena of the current coroutine, or `nullptr`. The innermost arena
+    // of each coroutine is stored in its `coro_t`, so this doesn't depend on how
+    // many arenas there are.
+    static arena_t *current();
+    // The innermost arena of `owner`, or of code that doesn't run in a coroutine if
+    // `owner` is `nullptr`.
+    static arena_t *innermost(coro_t *owner);
+    static void set_innermost(coro_t *owner, arena_t *arena);
+    // Called when `coro` finishes, for the arenas it leaves behind.
+    static void detach_all(coro_t *coro);
+
+    void *allocate(size_t size);
+    void release_chunk();
+
+    coro_t *const owner_;
+    const threadnum_t thread_;
+
+    arena_chunk_t *chunk_;
+    char *chunk_next_;
+    char *chunk_end_;
+
+    size_t bytes_allocated_;
+    size_t bytes_allocated_in_chunks_;
+
+    // The arena that was in charge when this one was created.
+    arena_t *outer_;
+    // Whether `owner_` has finished, so that this arena no longer serves anyone.
+    bool detached_;
+
+    DISABLE_COPYING(arena_t);
+};
+
+// Like `countable_wrapper_t`, but allocated with `arena_allocate()`.
+template <class T>
+class arena_countable_wrapper_t
+    : public T,
+      public slow_atomic_countable_t<arena_countable_wrapper_t<T> > {
+public:
+    template <class... Args>
+    explicit arena_countable_wrapper_t(Args &&... args)
+        : T(std::forward<Args>(args)...) { }
+
+    static void *operator new(size_t size) {
+        return arena_allocate(size);
+    }
+    static void operator delete(void *ptr) {
+        arena_free(ptr);
+    }
+};
+
+#endif  // CONTAINERS_ARENA_HPP_
@@ -94,11 +94,11 @@ public:
     }
 
     T *next(T *elem) const {
-        return null_if_self(elem->next_);
+        return null_if_self(static_cast<intrusive_list_node_t<T> *>(elem)->next_);
     }
 
     T *prev(T *elem) const {
-        return null_if_self(elem->prev_);
+        return null_if_self(static_cast<intrusive_list_node_t<T> *>(elem)->prev_);
     }
 
     void push_front(T *node) {
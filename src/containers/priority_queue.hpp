@@ -54,6 +54,11 @@ public:
     void remove(entry_t *);
     T pop();
     void update(int);
+
+    /* \brief rebuild() restores the order in the queue after a change that
+     * affects the priority of all of the elements at once
+     */
+    void rebuild();
 public:
     void validate();
 
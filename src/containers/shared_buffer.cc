@@ -1,14 +1,12 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "containers/shared_buffer.hpp"
 
-#include <stdlib.h>
-
-#include "utils.hpp"
+#include "containers/arena.hpp"
 
 counted_t<shared_buf_t> shared_buf_t::create(size_t size) {
     // This allocates size bytes for the data_ field (which is declared as char[1])
     size_t memory_size = sizeof(shared_buf_t) + size - 1;
-    void *raw_result = ::rmalloc(memory_size);
+    void *raw_result = arena_allocate(memory_size);
     shared_buf_t *result = static_cast<shared_buf_t *>(raw_result);
     result->refcount_ = 0;
     result->size_ = size;
@@ -16,7 +14,7 @@ counted_t<shared_buf_t> shared_buf_t::create(size_t size) {
 }
 
 void shared_buf_t::operator delete(void *p) {
-    ::free(p);
+    arena_free(p);
 }
 
 char *shared_buf_t::data(size_t offset) {
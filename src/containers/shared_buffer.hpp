@@ -9,7 +9,7 @@
 
 /* A `shared_buffer_t` is a reference counted binary buffer.
 You can have multiple `shared_buf_ref_t`s pointing to different offsets in
-the same `shared_buffer_t`. */
+the same `shared_buffer_t`. The memory comes from `arena_allocate()`. */
 class shared_buf_t {
 public:
     shared_buf_t() = delete;
@@ -922,6 +922,23 @@ public:
     }
     template <typename SourceAllocator> ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const { return const_cast<GenericValue&>(*this).FindMember(name); }
 
+    // RethinkDB patch: Backported from a later version of rapidjson, so objects that
+    // aren't built by the parser don't have to start out with the default capacity.
+    //! Request the object to have enough capacity to store members.
+    /*! \param newCapacity  The capacity that the object at least need to have.
+        \param allocator    Allocator for reallocating memory. It must be the same one as used before. Commonly use GenericDocument::GetAllocator().
+        \return The value itself for fluent API.
+        \note Linear time complexity.
+    */
+    GenericValue& MemberReserve(SizeType newCapacity, Allocator &allocator) {
+        RAPIDJSON_ASSERT(IsObject());
+        if (newCapacity > data_.o.capacity) {
+            data_.o.members = reinterpret_cast<Member*>(allocator.Realloc(data_.o.members, data_.o.capacity * sizeof(Member), newCapacity * sizeof(Member)));
+            data_.o.capacity = newCapacity;
+        }
+        return *this;
+    }
+
     //! Add a member (name-value pair) to the object.
     /*! \param name A string value as name of member.
         \param value Value of any type.
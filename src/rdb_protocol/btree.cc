@@ -691,6 +691,10 @@ public:
         THROWS_ONLY(interrupted_exc_t);
     void finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t);
 private:
+    // Applies the transformations to `pending_rows` and passes the rows on to the
+    // accumulator.
+    continue_bool_t handle_pending_rows() THROWS_ONLY(interrupted_exc_t);
+
     const rget_io_data_t io; // How do get data in/out.
     job_data_t job; // What to do next (stateful).
     const boost::optional<rget_sindex_data_t> sindex; // Optional sindex information.
@@ -702,6 +706,19 @@ private:
     boost::optional<std::string> last_truncated_secondary_for_abort;
     scoped_ptr_t<profile::disabler_t> disabler;
     scoped_ptr_t<profile::sampler_t> sampler;
+
+    // If all the transformations can be applied to many rows at once (see
+    // `op_t::can_apply_to_rows`), a primary index scan collects the rows in
+    // `pending_rows` and transforms them in batches, so that simple functions get
+    // evaluated on a whole batch at a time.
+    struct pending_row_t {
+        store_key_t key;
+        ql::datum_t val;
+        size_t copies;
+    };
+    bool batch_rows;
+    std::vector<pending_row_t> pending_rows;
+    int64_t pending_rows_size;
 };
 
 // This is the interface the btree code expects, but our actual callback needs a
@@ -735,7 +752,9 @@ rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
     : io(std::move(_io)),
       job(std::move(_job)),
       sindex(std::move(_sindex)),
-      bad_init(false) {
+      bad_init(false),
+      batch_rows(false),
+      pending_rows_size(0) {
 
     if (sindex) {
         // Secondary index functions are deterministic (so no need for an
@@ -752,12 +771,82 @@ rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
     disabler.init(new profile::disabler_t(job.env->trace));
     sampler.init(new profile::sampler_t("Range traversal doc evaluation.",
                                         job.env->trace));
+
+    // Functions aren't evaluated in batches while profiling anyway.
+    batch_rows = !sindex
+        && !job.transformers.empty()
+        && job.env->profile() == profile_bool_t::DONT_PROFILE
+        && std::all_of(job.transformers.begin(), job.transformers.end(),
+                       [](const scoped_ptr_t<ql::op_t> &op) {
+                           return op->can_apply_to_rows();
+                       });
 }
 
 void rget_cb_t::finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t) {
+    // After an abort, the accumulator has already seen the last row it wants.
+    if (last_cb == continue_bool_t::CONTINUE && !pending_rows.empty()) {
+        try {
+            last_cb = handle_pending_rows();
+        } catch (const ql::exc_t &e) {
+            io.response->result = e;
+            last_cb = continue_bool_t::ABORT;
+        } catch (const ql::datum_exc_t &e) {
+#ifndef NDEBUG
+            unreachable();
+#else
+            io.response->result = ql::exc_t(e, ql::backtrace_id_t::empty());
+            last_cb = continue_bool_t::ABORT;
+#endif // NDEBUG
+        }
+    }
     job.accumulator->finish(last_cb, &io.response->result);
 }
 
+continue_bool_t rget_cb_t::handle_pending_rows() THROWS_ONLY(interrupted_exc_t) {
+    std::vector<pending_row_t> rows;
+    rows.swap(pending_rows);
+    pending_rows_size = 0;
+
+    std::vector<ql::datums_t> lists;
+    lists.reserve(rows.size());
+    for (const pending_row_t &row : rows) {
+        lists.push_back(ql::datums_t(row.copies, row.val));
+    }
+    bool row_by_row = false;
+    try {
+        for (auto it = job.transformers.begin(); it != job.transformers.end(); ++it) {
+            (*it)->apply_to_rows(job.env, &lists);
+        }
+    } catch (const ql::base_exc_t &) {
+        // We go through the rows again one at a time, so that we report the error of
+        // the same row as we would have otherwise, and don't report an error at all if
+        // the accumulator stops before that row.  (The transformations are
+        // deterministic, so this doesn't change any results.)
+        row_by_row = true;
+    }
+
+    auto no_sindex_val = []() { return ql::datum_t(); };
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ql::groups_t data;
+        if (row_by_row) {
+            data = {{ql::datum_t(), ql::datums_t(rows[i].copies, rows[i].val)}};
+            for (auto it = job.transformers.begin();
+                 it != job.transformers.end();
+                 ++it) {
+                (**it)(job.env, &data, no_sindex_val);
+            }
+        } else if (!lists[i].empty()) {
+            // The transformations erase groups that end up empty.
+            data = {{ql::datum_t(), std::move(lists[i])}};
+        }
+        if ((*job.accumulator)(job.env, &data, rows[i].key, no_sindex_val)
+            == continue_bool_t::ABORT) {
+            return continue_bool_t::ABORT;
+        }
+    }
+    return continue_bool_t::CONTINUE;
+}
+
 // Handle a keyvalue pair.  Returns whether or not we're done early.
 continue_bool_t rget_cb_t::handle_pair(
     scoped_key_value_t &&keyvalue,
@@ -784,6 +873,9 @@ continue_bool_t rget_cb_t::handle_pair(
     // Count stats whether or not we deserialize the value
     io.slice->stats.pm_keys_read.record();
     io.slice->stats.pm_total_keys_read += 1;
+    int64_t value_size = batch_rows
+        ? static_cast<const rdb_value_t *>(keyvalue.value())->value_size()
+        : 0;
     // We only load the value if we actually use it (`count` does not).
     if (job.accumulator->uses_val() || job.transformers.size() != 0 || sindex) {
         val = row.get();
@@ -971,6 +1063,16 @@ continue_bool_t rget_cb_t::handle_pair(
             }
         }
 
+        if (batch_rows) {
+            pending_rows.push_back(pending_row_t{key, val, copies});
+            pending_rows_size += value_size;
+            if (pending_rows.size() < RGET_EVAL_BATCH_MAX_ROWS
+                && pending_rows_size < RGET_EVAL_BATCH_MAX_SIZE) {
+                return continue_bool_t::CONTINUE;
+            }
+            return handle_pending_rows();
+        }
+
         ql::groups_t data = {{ql::datum_t(), ql::datums_t(copies, val)}};
 
         for (auto it = job.transformers.begin(); it != job.transformers.end(); ++it) {
@@ -1656,7 +1758,8 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1:
     case cluster_version_t::v2_2:
     case cluster_version_t::v2_3:
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4:
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_reql_version(
                 &read_stream,
                 &info_out->mapping_version_info.original_reql_version,
@@ -1693,7 +1796,8 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1: // fallthru
     case cluster_version_t::v2_2: // fallthru
     case cluster_version_t::v2_3: // fallthru
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4: // fallthru
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_for_version(cluster_version, &read_stream, &info_out->geo);
         throw_if_bad_deserialization(success, "sindex description");
         break;
@@ -1,8 +1,7 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/changefeed.hpp"
 
-#include <queue>
-
+#include "arch/timing.hpp"
 #include "boost_utils.hpp"
 #include "btree/reql_specific.hpp"
 #include "clustering/administration/auth/user_context.hpp"
@@ -10,6 +9,8 @@
 #include "concurrency/cross_thread_signal.hpp"
 #include "concurrency/interruptor.hpp"
 #include "containers/archive/boost_types.hpp"
+#include "containers/archive/vector_stream.hpp"
+#include "perfmon/perfmon.hpp"
 #include "rdb_protocol/artificial_table/backend.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/env.hpp"
@@ -314,9 +315,234 @@ boost::optional<datum_t> apply_ops(
     }
 }
 
+// How many times a row with secondary index value `sindex_key` shows up in a range
+// changefeed on `spec`.
+size_t sindex_copies(const keyspec_t::range_t &spec, const datum_t &sindex_key) {
+    guarantee(spec.sindex);
+    if (spec.intersect_geometry) {
+        try {
+            if (!geo_does_intersect(*spec.intersect_geometry, sindex_key)) {
+                return 0;
+            }
+        } catch (const geo_exception_t &) {
+            return 0;
+        } catch (const base_exc_t &) {
+            return 0;
+        }
+    }
+    return spec.datumspec.copies(sindex_key);
+}
+
+// How many times the row with primary key `pkey` shows up in a range changefeed
+// whose datumspec has the given `primary_key_map` (or, if it has none, the given
+// covering range).
+size_t primary_copies(const boost::optional<std::map<store_key_t, uint64_t> > &keys,
+                      const boost::optional<key_range_t> &range,
+                      const store_key_t &pkey) {
+    if (keys) {
+        auto it = keys->find(pkey);
+        return it != keys->end() ? it->second : 0;
+    } else {
+        guarantee(range);
+        return range->contains_key(pkey) ? 1 : 0;
+    }
+}
+
+// Whether `transforms` always produce the same output for the same input, which
+// also means that evaluating them never blocks.
+class transform_determinism_visitor_t : public boost::static_visitor<bool> {
+public:
+    bool operator()(const map_wire_func_t &f) const {
+        return is_deterministic(f);
+    }
+    bool operator()(const concatmap_wire_func_t &f) const {
+        return is_deterministic(f);
+    }
+    bool operator()(const filter_wire_func_t &f) const {
+        return is_deterministic(f.filter_func)
+            && (!f.default_filter_val || is_deterministic(*f.default_filter_val));
+    }
+    // These keep state across rows, so a change can't be judged on its own.
+    bool operator()(const group_wire_func_t &) const { return false; }
+    bool operator()(const distinct_wire_func_t &) const { return false; }
+    bool operator()(const zip_wire_func_t &) const { return false; }
+private:
+    static bool is_deterministic(const wire_func_t &f) {
+        return f.compile_wire_func()->is_deterministic() == deterministic_t::always;
+    }
+};
+
+bool transforms_are_deterministic(const std::vector<transform_variant_t> &transforms) {
+    for (const auto &transform : transforms) {
+        if (!boost::apply_visitor(transform_determinism_visitor_t(), transform)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+change_filter_t::change_filter_t(rdb_context_t *ctx, const changefeed_filter_t &filter)
+    : pkey(filter.pkey), spec(filter.range) {
+    if (!spec) {
+        guarantee(pkey);
+        return;
+    }
+    if (!spec->sindex) {
+        store_keys = spec->datumspec.primary_key_map();
+        if (!store_keys) {
+            store_key_range = spec->datumspec.covering_range().to_primary_keyrange();
+        }
+    }
+    // Anything else (e.g. a `r.js` or a table read in a `filter`) could block
+    // `send_all` or give a different answer than on the client, so we let the
+    // client evaluate it.
+    if (spec->transforms.size() != 0
+        && transforms_are_deterministic(spec->transforms)) {
+        // This is to support the unit tests, which don't have a context.
+        env = ctx == nullptr
+            ? make_scoped<env_t>(&non_interruptor,
+                                 return_empty_normal_batches_t::NO,
+                                 reql_version_t::LATEST)
+            : make_scoped<env_t>(ctx,
+                                 return_empty_normal_batches_t::NO,
+                                 &non_interruptor,
+                                 filter.serializable_env,
+                                 nullptr/*don't profile*/);
+        for (const auto &transform : spec->transforms) {
+            ops.push_back(make_op(transform));
+        }
+    }
+}
+
+change_filter_t::~change_filter_t() { }
+
+auto_drainer_t::lock_t change_filter_t::get_keepalive() {
+    return drainer.lock();
+}
+
+bool change_filter_t::accepts(const msg_t::change_t &change,
+                              const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    if (pkey) {
+        return change.pkey == *pkey;
+    }
+    if (spec->sindex) {
+        bool in_range = false;
+        for (const index_vals_t *idxs : {&change.old_indexes, &change.new_indexes}) {
+            auto it = idxs->find(*spec->sindex);
+            if (it != idxs->end()) {
+                for (const auto &idx : it->second) {
+                    in_range = in_range || sindex_copies(*spec, idx.first) != 0;
+                }
+            }
+        }
+        if (!in_range) {
+            return false;
+        }
+    } else if (primary_copies(store_keys, store_key_range, change.pkey) == 0) {
+        return false;
+    }
+    if (ops.size() == 0) {
+        return true;
+    }
+
+    datum_t null = datum_t::null();
+    datum_t old_val = null, new_val = null;
+    if (change.new_val.has()) {
+        if (boost::optional<datum_t> d = apply_ops(change.new_val, ops, env.get(),
+                                                   datum_t())) {
+            new_val = *d;
+        }
+    }
+    if (change.old_val.has()) {
+        if (boost::optional<datum_t> d = apply_ops(change.old_val, ops, env.get(),
+                                                   datum_t())) {
+            old_val = *d;
+        }
+    }
+    // A secondary index change can still turn into an add or a remove if its old
+    // and new index values don't pair up, but only if one of its values survived.
+    return spec->sindex
+        ? (old_val != null || new_val != null)
+        : old_val != new_val;
+}
+
+// Subscriptions with the same filter spec share a `change_filter_t`.  We compare the
+// specs by serializing them, like `sindex_config_t::operator==` does for functions.
+std::vector<char> filter_key(const changefeed_filter_t &filter) {
+    write_message_t wm;
+    serialize<cluster_version_t::CLUSTER>(&wm, filter.range);
+    serialize<cluster_version_t::CLUSTER>(&wm, filter.pkey);
+    if (filter.range && filter.range->transforms.size() != 0) {
+        // The environment only matters if there are transforms to evaluate.
+        serialize<cluster_version_t::CLUSTER>(&wm, filter.serializable_env);
+    }
+    vector_stream_t stream;
+    stream.reserve(wm.size());
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    return stream.vector();
+}
+
+change_filters_t::change_filters_t() : generation(0) { }
+
+void change_filters_t::add(rdb_context_t *ctx, const changefeed_filter_t &filter) {
+    if (sub_filters.count(filter.sub) != 0) {
+        return;
+    }
+    std::vector<char> key = filter_key(filter);
+    auto *entry = &filters[key];
+    if (!entry->first.has()) {
+        entry->first = make_scoped<change_filter_t>(ctx, filter);
+        ++generation;
+    }
+    entry->second.insert(filter.sub);
+    sub_filters[filter.sub] = std::move(key);
+}
+
+scoped_ptr_t<change_filter_t> change_filters_t::remove(const uuid_u &sub) {
+    scoped_ptr_t<change_filter_t> removed;
+    auto sub_it = sub_filters.find(sub);
+    if (sub_it != sub_filters.end()) {
+        auto filter_it = filters.find(sub_it->second);
+        guarantee(filter_it != filters.end());
+        filter_it->second.second.erase(sub);
+        if (filter_it->second.second.empty()) {
+            removed = std::move(filter_it->second.first);
+            filters.erase(filter_it);
+        }
+        sub_filters.erase(sub_it);
+    }
+    return removed;
+}
+
+std::vector<change_filter_t *> change_filters_t::get_filters(
+        std::vector<auto_drainer_t::lock_t> *keepalives_out) {
+    std::vector<change_filter_t *> ret;
+    ret.reserve(filters.size());
+    for (auto &&pair : filters) {
+        ret.push_back(pair.second.first.get());
+        keepalives_out->push_back(pair.second.first->get_keepalive());
+    }
+    return ret;
+}
+
+static perfmon_counter_t pm_changefeed_changes_sent;
+static perfmon_membership_t pm_changefeed_changes_sent_membership(
+    &get_global_perfmon_collection(),
+    &pm_changefeed_changes_sent,
+    "changefeed_changes_sent");
+static perfmon_counter_t pm_changefeed_changes_filtered;
+static perfmon_membership_t pm_changefeed_changes_filtered_membership(
+    &get_global_perfmon_collection(),
+    &pm_changefeed_changes_filtered,
+    "changefeed_changes_filtered");
+
 server_t::client_info_t::client_info_t()
     : limit_clients(&opt_lt<std::string>),
-      limit_clients_lock(new rwlock_t()) { }
+      limit_clients_lock(new rwlock_t()),
+      batch_stamp(0),
+      flush_scheduled(false) { }
 
 server_t::server_t(mailbox_manager_t *_manager, store_t *_parent)
     : uuid(generate_uuid()),
@@ -325,7 +551,9 @@ server_t::server_t(mailbox_manager_t *_manager, store_t *_parent)
       stop_mailbox(manager,
                    std::bind(&server_t::stop_mailbox_cb, this, ph::_1, ph::_2)),
       limit_stop_mailbox(manager, std::bind(&server_t::limit_stop_mailbox_cb,
-                                            this, ph::_1, ph::_2, ph::_3, ph::_4)) { }
+                                            this, ph::_1, ph::_2, ph::_3, ph::_4)),
+      filter_stop_mailbox(manager, std::bind(&server_t::filter_stop_mailbox_cb,
+                                             this, ph::_1, ph::_2, ph::_3)) { }
 
 server_t::~server_t() { }
 
@@ -391,6 +619,26 @@ void server_t::limit_stop_mailbox_cb(signal_t *,
     }
 }
 
+void server_t::filter_stop_mailbox_cb(signal_t *,
+                                      client_t::addr_t addr,
+                                      uuid_u sub) {
+    auto_drainer_t::lock_t lock(&drainer);
+    // Destroying the filter waits for any `send_all` that is still evaluating it,
+    // so we do that after releasing the lock.
+    scoped_ptr_t<change_filter_t> removed;
+    {
+        rwlock_acq_t client_acq(&clients_lock, access_t::read);
+        auto it = clients.find(addr);
+        // The filter might never have been registered, e.g. if the subscription's
+        // stamp read failed.  If this message overtakes the read that registers the
+        // filter, the filter stays around until the client goes away; that only
+        // costs us some changes that the client will throw away.
+        if (it != clients.end()) {
+            removed = it->second.filters.remove(sub);
+        }
+    }
+}
+
 void server_t::add_client(
         const client_t::addr_t &addr,
         region_t region,
@@ -492,18 +740,31 @@ void server_t::add_client_cb(
     guarantee(erased == 1);
 }
 
-struct stamped_msg_t {
-    stamped_msg_t() { }
-    stamped_msg_t(uuid_u _server_uuid, uint64_t _stamp, msg_t _submsg)
-        : server_uuid(std::move(_server_uuid)),
-          stamp(_stamp),
-          submsg(std::move(_submsg)) { }
-    uuid_u server_uuid;
-    uint64_t stamp;
-    msg_t submsg;
-};
+void stamped_msg_queue_t::push(stamped_msgs_t &&msgs) {
+    guarantee(msgs.first_stamp >= next);
+    for (size_t i = 0; i < msgs.msgs.size(); ++i) {
+        map.push(stamped_msg_t(msgs.server_uuid,
+                               msgs.first_stamp + i,
+                               std::move(msgs.msgs[i])));
+    }
+}
+
+void stamped_msg_queue_t::push(stamped_msg_t &&msg) {
+    map.push(std::move(msg));
+}
 
-RDB_MAKE_SERIALIZABLE_3(stamped_msg_t, server_uuid, stamp, submsg);
+const stamped_msg_t *stamped_msg_queue_t::peek() const {
+    if (map.size() != 0 && map.top().stamp == next) {
+        return &map.top();
+    }
+    return nullptr;
+}
+
+void stamped_msg_queue_t::pop() {
+    guarantee(peek() != nullptr);
+    map.pop();
+    next += 1;
+}
 
 // This function takes a `lock_t` to make sure you have one.  (We can't just
 // always acquire a drainer lock before sending because we sometimes send a
@@ -514,14 +775,58 @@ void server_t::send_one_with_lock(
         msg_t msg,
         const auto_drainer_t::lock_t &keepalive) {
     keepalive.assert_is_holding(&drainer);
-    uint64_t stamp;
-    {
-        // We don't need a write lock as long as we make sure the coroutine
-        // doesn't block between reading and updating the stamp.
-        ASSERT_NO_CORO_WAITING;
-        stamp = client->second.stamp++;
+    // This sends along anything that's still waiting in the batch.
+    batch_with_lock(client, std::move(msg), keepalive);
+    send(manager, client->first, take_batch(&client->second));
+}
+
+void server_t::batch_with_lock(
+        std::pair<const client_t::addr_t, client_info_t> *client,
+        msg_t msg,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    // We don't need a write lock as long as we make sure the coroutine doesn't
+    // block between reading and updating the stamp.  This also makes sure the
+    // stamps in the batch are consecutive.
+    ASSERT_NO_CORO_WAITING;
+    client_info_t *info = &client->second;
+    uint64_t stamp = info->stamp++;
+    if (info->batch.empty()) {
+        info->batch_stamp = stamp;
+    }
+    guarantee(info->batch_stamp + info->batch.size() == stamp);
+    info->batch.push_back(std::move(msg));
+    if (!info->flush_scheduled) {
+        info->flush_scheduled = true;
+        coro_t::spawn_sometime(
+            std::bind(&server_t::flush_batch_cb, this, client->first, keepalive));
+    }
+}
+
+stamped_msgs_t server_t::take_batch(client_info_t *info) {
+    stamped_msgs_t ret(uuid, info->batch_stamp, std::move(info->batch));
+    info->batch.clear();
+    return ret;
+}
+
+void server_t::flush_batch_cb(client_t::addr_t addr, auto_drainer_t::lock_t keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    try {
+        nap(CHANGEFEED_BATCH_DELAY_MS, keepalive.get_drain_signal());
+    } catch (const interrupted_exc_t &) {
+        // `add_client_cb` sends whatever is left along with the `stop_t`.
+        return;
+    }
+    rwlock_in_line_t spot(&clients_lock, access_t::read);
+    spot.read_signal()->wait_lazily_unordered();
+    auto it = clients.find(addr);
+    // If the client is gone, its batch went out with the `stop_t` message.
+    if (it != clients.end()) {
+        it->second.flush_scheduled = false;
+        if (!it->second.batch.empty()) {
+            send(manager, addr, take_batch(&it->second));
+        }
     }
-    send(manager, client->first, stamped_msg_t(uuid, stamp, std::move(msg)));
 }
 
 void server_t::send_all(
@@ -531,24 +836,83 @@ void server_t::send_all(
         const auto_drainer_t::lock_t &keepalive) {
     keepalive.assert_is_holding(&drainer);
     stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
-    stamp_spot->write_signal()->wait_lazily_unordered();
 
+    // Changes are only sent to clients with a subscription that might be
+    // interested in them.  Clients that aren't sent a change mustn't use up a stamp
+    // for it, since `real_feed_t` waits for every stamp in order.  Evaluating the
+    // filters can take a while, so we do it before we get the stamp lock and
+    // without holding `clients_lock`, keeping the filters alive with their
+    // drainers.  A filter that is added in the meantime wasn't evaluated, so a
+    // client that got one is sent the change regardless.
+    const msg_t::change_t *change = boost::get<msg_t::change_t>(&msg.op);
+    struct evaluated_client_t {
+        uint64_t generation;
+        bool accepted;
+    };
+    std::map<client_t::addr_t, evaluated_client_t> evaluated;
+    if (change != nullptr) {
+        std::vector<std::pair<client_t::addr_t, std::vector<change_filter_t *> > >
+            client_filters;
+        std::vector<auto_drainer_t::lock_t> filter_keepalives;
+        {
+            rwlock_acq_t acq(&clients_lock, access_t::read);
+            for (auto &&pair : clients) {
+                if (std::any_of(pair.second.regions.begin(),
+                                pair.second.regions.end(),
+                                std::bind(&region_contains_key,
+                                          ph::_1, std::cref(key)))) {
+                    evaluated[pair.first] = evaluated_client_t{
+                        pair.second.filters.get_generation(), false};
+                    client_filters.emplace_back(
+                        pair.first,
+                        pair.second.filters.get_filters(&filter_keepalives));
+                }
+            }
+        }
+        size_t keepalive_index = 0;
+        for (const auto &client : client_filters) {
+            bool *accepted = &evaluated[client.first].accepted;
+            for (change_filter_t *f : client.second) {
+                const auto_drainer_t::lock_t &filter_keepalive =
+                    filter_keepalives[keepalive_index++];
+                *accepted = *accepted || f->accepts(*change, filter_keepalive);
+            }
+        }
+    }
+
+    stamp_spot->write_signal()->wait_lazily_unordered();
     rwlock_acq_t acq(&clients_lock, access_t::read);
-    std::map<client_t::addr_t, uint64_t> stamps;
+    std::vector<std::pair<const client_t::addr_t, client_info_t> *> recipients;
     for (auto &&pair : clients) {
-        // We don't need a write lock as long as we make sure the coroutine
-        // doesn't block between reading and updating the stamp.
-        ASSERT_NO_CORO_WAITING;
         if (std::any_of(pair.second.regions.begin(),
                         pair.second.regions.end(),
                         std::bind(&region_contains_key, ph::_1, std::cref(key)))) {
-            stamps[pair.first] = pair.second.stamp++;
+            if (change != nullptr) {
+                auto it = evaluated.find(pair.first);
+                if (it != evaluated.end()
+                    && it->second.generation == pair.second.filters.get_generation()
+                    && !it->second.accepted) {
+                    ++pm_changefeed_changes_filtered;
+                    continue;
+                }
+                ++pm_changefeed_changes_sent;
+            }
+            recipients.push_back(&pair);
+        }
+    }
+    // Batches that filled up.  The rest get sent by `flush_batch_cb`.
+    std::vector<std::pair<client_t::addr_t, stamped_msgs_t> > full_batches;
+    for (auto *client : recipients) {
+        batch_with_lock(client, msg, keepalive);
+        if (client->second.batch.size() >= CHANGEFEED_BATCH_MAX_MSGS) {
+            full_batches.push_back(
+                std::make_pair(client->first, take_batch(&client->second)));
         }
     }
     acq.reset();
     stamp_spot->reset(); // Done stamping, no need to hold onto it while we send.
-    for (const auto &pair : stamps) {
-        send(manager, pair.first, stamped_msg_t(uuid, pair.second, msg));
+    for (const auto &pair : full_batches) {
+        send(manager, pair.first, pair.second);
     }
 }
 
@@ -560,8 +924,14 @@ server_t::limit_addr_t server_t::get_limit_stop_addr() {
     return limit_stop_mailbox.get_address();
 }
 
+server_t::filter_addr_t server_t::get_filter_stop_addr() {
+    return filter_stop_mailbox.get_address();
+}
+
 boost::optional<uint64_t> server_t::get_stamp(
         const client_t::addr_t &addr,
+        const changefeed_filter_t *filter,
+        rdb_context_t *ctx,
         const auto_drainer_t::lock_t &keepalive) {
     keepalive.assert_is_holding(&drainer);
     rwlock_acq_t stamp_acq(&parent->cfeed_stamp_lock, access_t::read);
@@ -570,6 +940,12 @@ boost::optional<uint64_t> server_t::get_stamp(
     if (it == clients.end()) {
         return boost::none;
     } else {
+        // We register the filter while holding the stamp lock so that every change
+        // after the stamp we return goes through it.  (With oversharding we can get
+        // here more than once for the same subscription.)
+        if (filter != nullptr) {
+            it->second.filters.add(ctx, *filter);
+        }
         return it->second.stamp;
     }
 }
@@ -1663,6 +2039,8 @@ protected:
 private:
     virtual void maybe_remove_feed() = 0;
     virtual void stop_limit_sub(limit_sub_t *sub) = 0;
+    // Tells the servers to drop the filter of a range or point subscription.
+    virtual void stop_filter(const uuid_u &sub_uuid) = 0;
 
     void add_sub_with_lock(
         rwlock_t *rwlock, const std::function<void()> &f) THROWS_NOTHING;
@@ -1748,28 +2126,24 @@ public:
 private:
     virtual void maybe_remove_feed() { client->maybe_remove_feed(client_lock, table_id); }
     virtual void stop_limit_sub(limit_sub_t *sub);
+    virtual void stop_filter(const uuid_u &sub_uuid);
 
-    void mailbox_cb(signal_t *interruptor, stamped_msg_t msg);
+    void mailbox_cb(signal_t *interruptor, stamped_msgs_t msgs);
     void constructor_cb();
 
     auto_drainer_t::lock_t client_lock;
     client_t *client;
     namespace_id_t table_id;
     mailbox_manager_t *manager;
-    mailbox_t<void(stamped_msg_t)> mailbox;
+    mailbox_t<void(stamped_msgs_t)> mailbox;
     std::vector<server_t::addr_t> stop_addrs;
+    std::vector<server_t::filter_addr_t> filter_stop_addrs;
     std::vector<scoped_ptr_t<disconnect_watcher_t> > disconnect_watchers;
 
     struct queue_t {
-        explicit queue_t(uint64_t _next) : next(_next) { }
+        explicit queue_t(uint64_t next) : msgs(next) { }
         rwlock_t lock;
-        uint64_t next;
-        struct lt_t {
-            bool operator()(const stamped_msg_t &left, const stamped_msg_t &right) {
-                return left.stamp > right.stamp; // We want the min val to be on top.
-            }
-        };
-        std::priority_queue<stamped_msg_t, std::vector<stamped_msg_t>, lt_t> map;
+        stamped_msg_queue_t msgs;
     };
     // Maps from a `server_t`'s uuid_u.  We don't need a lock for this because
     // the set of `uuid_u`s never changes after it's initialized.
@@ -1813,6 +2187,7 @@ real_feed_t::real_feed_t(auto_drainer_t::lock_t _client_lock,
         for (auto it = resp->addrs.begin(); it != resp->addrs.end(); ++it) {
             stop_addrs.push_back(std::move(*it));
         }
+        filter_stop_addrs.assign(resp->filter_addrs.begin(), resp->filter_addrs.end());
 
         std::set<peer_id_t> peers;
         for (auto it = stop_addrs.begin(); it != stop_addrs.end(); ++it) {
@@ -1833,7 +2208,7 @@ real_feed_t::real_feed_t(auto_drainer_t::lock_t _client_lock,
             // generally ordered right now).
 #ifndef NDEBUG
             for (size_t i = 0; i < queues.size()-1; ++i) {
-                res.first->second->map.push(
+                res.first->second->msgs.push(
                     stamped_msg_t(
                         server_uuid,
                         std::numeric_limits<uint64_t>::max() - i,
@@ -1996,6 +2371,7 @@ public:
                      _squash,
                      _include_states,
                      _include_types),
+          uuid(generate_uuid()),
           pkey(std::move(_pkey)),
           stamp(0),
           started(false),
@@ -2071,7 +2447,14 @@ public:
         read_response_t read_resp;
         nif->read(
             env->get_user_context(),
-            read_t(changefeed_point_stamp_t{addr, store_key_t(pkey.print_primary())},
+            read_t(changefeed_point_stamp_t{
+                       addr,
+                       store_key_t(pkey.print_primary()),
+                       changefeed_filter_t{
+                           uuid,
+                           boost::none,
+                           store_key_t(pkey.print_primary()),
+                           serializable_env_t()}},
                    profile_bool_t::DONT_PROFILE, read_mode_t::SINGLE),
             &read_resp,
             order_token_t::ignore,
@@ -2143,6 +2526,9 @@ public:
 
         return make_counted<stream_t<subscription_t> >(std::move(self), bt);
     }
+
+    // Identifies the subscription's filter on the `server_t`.
+    const uuid_u uuid;
 private:
     datum_t pkey;
     boost::optional<change_val_t> initial_val;
@@ -2186,6 +2572,7 @@ public:
                      _squash,
                      _include_states,
                      _include_types),
+          uuid(generate_uuid()),
           spec(std::move(_spec)),
           state(state_t::READY),
           sent_state(state_t::NONE),
@@ -2206,30 +2593,11 @@ public:
     }
     boost::optional<std::string> sindex() const { return spec.sindex; }
     size_t copies(const datum_t &sindex_key) const {
-        guarantee(spec.sindex);
-        if (spec.intersect_geometry) {
-            try {
-                if (!geo_does_intersect(*spec.intersect_geometry, sindex_key)) {
-                    return 0;
-                }
-            } catch (const geo_exception_t &) {
-                return 0;
-            } catch (const base_exc_t &) {
-                return 0;
-            }
-        }
-        return spec.datumspec.copies(sindex_key);
+        return sindex_copies(spec, sindex_key);
     }
     size_t copies(const store_key_t &pkey) const {
         guarantee(!spec.sindex);
-        if (store_keys) {
-            guarantee(store_keys);
-            auto it = store_keys->find(pkey);
-            return it != store_keys->end() ? it->second : 0;
-        } else {
-            guarantee(store_key_range);
-            return store_key_range->contains_key(pkey) ? 1 : 0;
-        }
+        return primary_copies(store_keys, store_key_range, pkey);
     }
 
     bool has_ops() { return ops.size() != 0; }
@@ -2318,7 +2686,16 @@ public:
         // Note that we use the `outer_env`'s interruptor for the read.
         nif->read(
             outer_env->get_user_context(),
-            read_t(changefeed_stamp_t(addr),
+            read_t(changefeed_stamp_t(
+                       addr,
+                       changefeed_filter_t{
+                           uuid,
+                           spec,
+                           boost::none,
+                           serializable_env_t{
+                               outer_env->get_all_optargs(),
+                               outer_env->get_user_context(),
+                               outer_env->get_deterministic_time()}}),
                    profile_bool_t::DONT_PROFILE,
                    read_mode_t::SINGLE),
             &read_resp, order_token_t::ignore, outer_env->interruptor);
@@ -2390,6 +2767,9 @@ public:
     }
     const std::map<uuid_u, uint64_t> &get_next_stamps() { return next_stamps; }
     const std::map<uuid_u, uint64_t> &get_orig_stamps() { return orig_stamps; }
+
+    // Identifies the subscription's filters on the `server_t`s.
+    const uuid_u uuid;
 private:
     scoped_ptr_t<env_t> make_env(env_t *outer_env) {
         // This is to support fake environments from the unit tests that don't
@@ -2821,6 +3201,12 @@ void real_feed_t::stop_limit_sub(limit_sub_t *sub) {
     }
 }
 
+void real_feed_t::stop_filter(const uuid_u &sub_uuid) {
+    for (const auto &addr : filter_stop_addrs) {
+        send(manager, addr, mailbox.get_address(), sub_uuid);
+    }
+}
+
 class msg_visitor_t : public boost::static_visitor<void> {
 public:
     msg_visitor_t(feed_t *_feed, const auto_drainer_t::lock_t *_lock,
@@ -2976,7 +3362,7 @@ void msg_visit(feed_t *feed,
     feed->update_stamps(server_uuid, stamp);
 }
 
-void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
+void real_feed_t::mailbox_cb(signal_t *, stamped_msgs_t msgs) {
     // We stop receiving messages when detached (we're only receiving
     // messages because we haven't managed to get a message to the
     // stop mailboxes for some of the primary replicas yet).  This also stops
@@ -2993,7 +3379,7 @@ void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
         if (!lock.get_drain_signal()->is_pulsed()) {
             // We don't need a lock for this because the set of `uuid_u`s never
             // changes after it's initialized.
-            auto it = queues.find(msg.server_uuid);
+            auto it = queues.find(msgs.server_uuid);
             guarantee(it != queues.end());
             queue_t *queue = it->second.get();
             guarantee(queue != NULL);
@@ -3003,17 +3389,15 @@ void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
             if (detached) return;
 
             // Add us to the queue.
-            guarantee(msg.stamp >= queue->next);
-            queue->map.push(std::move(msg));
+            queue->msgs.push(std::move(msgs));
 
             // Read as much as we can from the queue (this enforces ordering.)
-            while (queue->map.size() != 0 && queue->map.top().stamp == queue->next) {
+            const stamped_msg_t *curmsg;
+            while ((curmsg = queue->msgs.peek()) != nullptr) {
                 if (detached) return;
-                const stamped_msg_t &curmsg = queue->map.top();
                 msg_visit(this, &lock,
-                          curmsg.server_uuid, curmsg.stamp, curmsg.submsg.op);
-                queue->map.pop();
-                queue->next += 1;
+                          curmsg->server_uuid, curmsg->stamp, curmsg->submsg.op);
+                queue->msgs.pop();
             }
         }
     }
@@ -3523,6 +3907,7 @@ void feed_t::add_point_sub(point_sub_t *sub, const store_key_t &key) THROWS_NOTH
 // Can't throw because it's called in a destructor.
 void feed_t::del_point_sub(point_sub_t *sub, const store_key_t &key) THROWS_NOTHING {
     del_sub_with_lock(&point_subs_lock, [this, sub, &key]() {
+            stop_filter(sub->uuid);
             return map_del_sub(&point_subs, key, sub);
         });
 }
@@ -3538,6 +3923,7 @@ void feed_t::add_range_sub(range_sub_t *sub) THROWS_NOTHING {
 // Can't throw because it's called in a destructor.
 void feed_t::del_range_sub(range_sub_t *sub) THROWS_NOTHING {
     del_sub_with_lock(&range_subs_lock, [this, sub]() {
+            stop_filter(sub->uuid);
             return range_subs[sub->home_thread().threadnum].erase(sub);
         });
 }
@@ -4008,6 +4394,8 @@ public:
     NORETURN virtual void stop_limit_sub(limit_sub_t *) {
         crash("Limit subscriptions are not supported on artificial feeds.");
     }
+    // Artificial feeds don't filter changes.
+    virtual void stop_filter(const uuid_u &) { }
 private:
     artificial_t *parent;
     auto_drainer_t drainer;
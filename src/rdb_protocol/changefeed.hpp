@@ -6,6 +6,8 @@
 #include <exception>
 #include <functional>
 #include <map>
+#include <queue>
+#include <set>
 #include <string>
 #include <vector>
 #include <utility>
@@ -15,6 +17,7 @@
 
 #include "btree/keys.hpp"
 #include "clustering/administration/auth/user_context.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "concurrency/promise.hpp"
 #include "concurrency/rwlock.hpp"
@@ -41,6 +44,7 @@ class namespace_interface_access_t;
 class name_resolver_t;
 class real_superblock_t;
 class sindex_superblock_t;
+struct changefeed_filter_t;
 struct rdb_modification_report_t;
 struct sindex_disk_info_t;
 
@@ -125,10 +129,61 @@ struct msg_t {
 
 RDB_DECLARE_SERIALIZABLE(msg_t);
 
+struct stamped_msg_t {
+    stamped_msg_t() { }
+    stamped_msg_t(uuid_u _server_uuid, uint64_t _stamp, msg_t _submsg)
+        : server_uuid(std::move(_server_uuid)),
+          stamp(_stamp),
+          submsg(std::move(_submsg)) { }
+    uuid_u server_uuid;
+    uint64_t stamp;
+    msg_t submsg;
+};
+
+RDB_MAKE_SERIALIZABLE_3(stamped_msg_t, server_uuid, stamp, submsg);
+
+// What actually goes over the wire: all the messages a `server_t` has for a client
+// since the last batch, so that a burst of changes doesn't cost one mailbox message
+// per change.  The messages have consecutive stamps starting at `first_stamp`.
+struct stamped_msgs_t {
+    stamped_msgs_t() { }
+    stamped_msgs_t(uuid_u _server_uuid, uint64_t _first_stamp, std::vector<msg_t> _msgs)
+        : server_uuid(std::move(_server_uuid)),
+          first_stamp(_first_stamp),
+          msgs(std::move(_msgs)) { }
+    uuid_u server_uuid;
+    uint64_t first_stamp;
+    std::vector<msg_t> msgs;
+};
+
+RDB_MAKE_SERIALIZABLE_3(stamped_msgs_t, server_uuid, first_stamp, msgs);
+
+// The messages a `real_feed_t` has received from one `server_t`, put back in stamp
+// order since batches can arrive out of order.  Exposed for unit tests.
+class stamped_msg_queue_t {
+public:
+    explicit stamped_msg_queue_t(uint64_t _next) : next(_next) { }
+    // Unpacks `msgs` into one `stamped_msg_t` per message.
+    void push(stamped_msgs_t &&msgs);
+    void push(stamped_msg_t &&msg);
+    // The message with the stamp after the last one popped, or `nullptr` if it
+    // hasn't arrived yet.
+    const stamped_msg_t *peek() const;
+    void pop();
+    uint64_t get_next() const { return next; }
+private:
+    struct gt_t {
+        bool operator()(const stamped_msg_t &left, const stamped_msg_t &right) const {
+            return left.stamp > right.stamp; // We want the min val to be on top.
+        }
+    };
+    uint64_t next;
+    std::priority_queue<stamped_msg_t, std::vector<stamped_msg_t>, gt_t> map;
+};
+
 class real_feed_t;
-struct stamped_msg_t;
 
-typedef mailbox_addr_t<void(stamped_msg_t)> client_addr_t;
+typedef mailbox_addr_t<void(stamped_msgs_t)> client_addr_t;
 
 struct keyspec_t {
     struct range_t {
@@ -390,6 +445,71 @@ struct sindex_ref_t {
 };
 
 class server_t;
+
+// The server-side half of a range or point subscription.  `server_t::send_all`
+// uses it to skip changes that the subscription would throw away anyway; it
+// mirrors what `msg_visitor_t` does with a `msg_t::change_t` on the client.
+// Only deterministic transforms are evaluated here, so that `accepts` never waits
+// on anything; a subscription with other transforms only has its range checked.
+class change_filter_t {
+public:
+    change_filter_t(rdb_context_t *ctx, const changefeed_filter_t &filter);
+    ~change_filter_t();
+    // `send_all` calls this without holding any of the `server_t`'s locks, so the
+    // caller must keep the filter alive with a lock from `get_keepalive`.
+    bool accepts(const msg_t::change_t &change,
+                 const auto_drainer_t::lock_t &keepalive);
+    auto_drainer_t::lock_t get_keepalive();
+    // Whether the transforms are evaluated, as opposed to only the range.
+    bool evaluates_transforms() const { return ops.size() != 0; }
+private:
+    boost::optional<store_key_t> pkey;
+    boost::optional<keyspec_t::range_t> spec;
+    boost::optional<std::map<store_key_t, uint64_t> > store_keys;
+    boost::optional<key_range_t> store_key_range;
+
+    // The evaluations don't block, so we let them finish instead of interrupting
+    // them when the filter goes away.
+    cond_t non_interruptor;
+    scoped_ptr_t<env_t> env;
+    std::vector<scoped_ptr_t<op_t> > ops;
+
+    auto_drainer_t drainer;
+};
+
+// The filters of the range and point subscriptions on one client's feed.  This
+// only deduplicates the filters: identical subscriptions (e.g. many queries
+// opening the same `table.changes()`) share one reference-counted
+// `change_filter_t`, which is kept until its last subscription is removed.  Each
+// subscription still has its own queue on the client.
+class change_filters_t {
+public:
+    change_filters_t();
+    // Does nothing if `filter.sub` is already registered.
+    void add(rdb_context_t *ctx, const changefeed_filter_t &filter);
+    // Returns the filter if `sub` was the last subscription using it, so that the
+    // caller can destroy it after releasing its locks.
+    scoped_ptr_t<change_filter_t> remove(const uuid_u &sub);
+
+    // Returns every filter, along with a keepalive for each of them.
+    std::vector<change_filter_t *> get_filters(
+        std::vector<auto_drainer_t::lock_t> *keepalives_out);
+    size_t num_filters() const { return filters.size(); }
+    size_t num_subs() const { return sub_filters.size(); }
+    // Bumped whenever a filter is added, so that `send_all` can tell whether the
+    // filters it evaluated are still all of them.
+    uint64_t get_generation() const { return generation; }
+private:
+    // Keyed by the serialized filter spec, together with the subscriptions using
+    // each filter.
+    std::map<std::vector<char>,
+             std::pair<scoped_ptr_t<change_filter_t>, std::set<uuid_u> > > filters;
+    std::map<uuid_u, std::vector<char> > sub_filters;
+    uint64_t generation;
+
+    DISABLE_COPYING(change_filters_t);
+};
+
 class limit_manager_t {
 public:
     // Make sure you have a lock in the `server_t` (e.g. the lock provided by
@@ -464,6 +584,7 @@ public:
     typedef server_addr_t addr_t;
     typedef mailbox_addr_t<void(client_t::addr_t, boost::optional<std::string>, uuid_u)>
         limit_addr_t;
+    typedef mailbox_addr_t<void(client_t::addr_t, uuid_u)> filter_addr_t;
     explicit server_t(mailbox_manager_t *_manager, store_t *_parent);
     ~server_t();
     void add_client(
@@ -491,8 +612,14 @@ public:
         const auto_drainer_t::lock_t &keepalive);
     addr_t get_stop_addr();
     limit_addr_t get_limit_stop_addr();
+    filter_addr_t get_filter_stop_addr();
+    // If `filter` is non-NULL the subscription it describes is registered with the
+    // client, which from then on is only sent the changes that one of its
+    // registered subscriptions might be interested in.
     boost::optional<uint64_t> get_stamp(
         const client_t::addr_t &addr,
+        const changefeed_filter_t *filter, // NULL if none
+        rdb_context_t *ctx,
         const auto_drainer_t::lock_t &keepalive);
     uuid_u get_uuid();
     // `f` will be called with a read lock on `clients` and a write lock on the
@@ -517,6 +644,9 @@ private:
                                client_t::addr_t addr,
                                boost::optional<std::string> sindex,
                                uuid_u uuid);
+    void filter_stop_mailbox_cb(signal_t *interruptor,
+                                client_t::addr_t addr,
+                                uuid_u sub);
     void add_client_cb(
         signal_t *stopped,
         client_t::addr_t addr,
@@ -541,6 +671,14 @@ private:
                      bool(const boost::optional<std::string> &,
                           const boost::optional<std::string> &)> > limit_clients;
         scoped_ptr_t<rwlock_t> limit_clients_lock;
+        // Only changes that pass at least one of the filters are sent.
+        change_filters_t filters;
+        // Messages that have been stamped but not sent yet.  `batch_stamp` is the
+        // stamp of the first one; the others follow consecutively.
+        std::vector<msg_t> batch;
+        uint64_t batch_stamp;
+        // Whether a `flush_batch_cb` is going to send `batch`.
+        bool flush_scheduled;
     };
     std::map<client_t::addr_t, client_info_t> clients;
 
@@ -554,6 +692,12 @@ private:
     void send_one_with_lock(std::pair<const client_t::addr_t, client_info_t> *client,
                             msg_t msg,
                             const auto_drainer_t::lock_t &lock);
+    // Stamps `msg` and adds it to the client's batch.  Doesn't block.
+    void batch_with_lock(std::pair<const client_t::addr_t, client_info_t> *client,
+                         msg_t msg,
+                         const auto_drainer_t::lock_t &lock);
+    stamped_msgs_t take_batch(client_info_t *info);
+    void flush_batch_cb(client_t::addr_t addr, auto_drainer_t::lock_t keepalive);
 
     // Controls access to `clients`.  A `server_t` needs to read `clients` when:
     // * `send_all` is called
@@ -578,6 +722,9 @@ private:
     // changefeed.
     mailbox_t<void(client_t::addr_t, boost::optional<std::string>, uuid_u)>
         limit_stop_mailbox;
+    // Clients send a message to this mailbox when a range or point subscription
+    // goes away, so that its filter can be dropped.
+    mailbox_t<void(client_t::addr_t, uuid_u)> filter_stop_mailbox;
 };
 
 class artificial_feed_t;
@@ -0,0 +1,262 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rdb_protocol/compiled_func.hpp"
+
+#include "concurrency/interruptor.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/op.hpp"
+#include "rdb_protocol/term.hpp"
+
+namespace ql {
+
+// Subterms nested deeper than this are left to the interpreter, which makes sure that
+// it has enough stack space before it recurses.
+const int MAX_COMPILED_TERM_DEPTH = 32;
+
+void compiled_term_bail_out() {
+    throw compiled_term_bailout_exc_t();
+}
+
+compiled_func_env_t::compiled_func_env_t(env_t *_env,
+                                         const std::vector<datum_t> *_args,
+                                         const var_scope_t *_captured_scope,
+                                         const std::vector<sym_t> *_arg_names)
+    : env_(_env),
+      args(_args),
+      captured_scope(_captured_scope),
+      arg_names(_arg_names) { }
+
+compiled_func_env_t::~compiled_func_env_t() { }
+
+scope_env_t *compiled_func_env_t::scope_env() {
+    if (!scope_env_.has()) {
+        // This has to match what `reql_func_t::call()` does.
+        var_scope_t scope = arg_names->size() == 0
+            ? *captured_scope
+            : captured_scope->with_func_arg_list(*arg_names, *args);
+        scope_env_.init(new scope_env_t(env_, std::move(scope)));
+    }
+    return scope_env_.get();
+}
+
+compiled_batch_t::compiled_batch_t(env_t *_env,
+                                   const std::vector<datum_t> *_rows,
+                                   const var_scope_t *_captured_scope,
+                                   const std::vector<sym_t> *_arg_names)
+    : env_(_env),
+      rows(_rows),
+      captured_scope(_captured_scope),
+      arg_names(_arg_names),
+      row_args(1),
+      bailed_out_(_rows->size(), false) { }
+
+datum_t compiled_batch_t::eval_row(const compiled_term_t *term, size_t i) {
+    row_args[0] = row(i);
+    compiled_func_env_t row_env(env_, &row_args, captured_scope, arg_names);
+    try {
+        return term->eval(&row_env);
+    } catch (const compiled_term_bailout_exc_t &) {
+    } catch (const base_exc_t &) {
+        // This also catches `datum_exc_t`. The row might not even have got this far
+        // without batching; see the comment on `compiled_batch_t`.
+    }
+    bail_out(i);
+    return datum_t();
+}
+
+void compiled_term_t::eval_batch(compiled_batch_t *batch,
+                                 const batch_selection_t &selection,
+                                 std::vector<datum_t> *out) const {
+    for (uint32_t i : selection) {
+        (*out)[i] = batch->eval_row(this, i);
+    }
+}
+
+batch_selection_t remaining_rows(const compiled_batch_t *batch,
+                                 const batch_selection_t &selection) {
+    batch_selection_t res;
+    res.reserve(selection.size());
+    for (uint32_t i : selection) {
+        if (!batch->bailed_out(i)) {
+            res.push_back(i);
+        }
+    }
+    return res;
+}
+
+class compiled_constant_t : public compiled_term_t {
+public:
+    explicit compiled_constant_t(datum_t _value) : value(std::move(_value)) { }
+    datum_t eval(compiled_func_env_t *) const {
+        return value;
+    }
+    void eval_batch(compiled_batch_t *,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        for (uint32_t i : selection) {
+            (*out)[i] = value;
+        }
+    }
+private:
+    const datum_t value;
+};
+
+class compiled_arg_t : public compiled_term_t {
+public:
+    explicit compiled_arg_t(size_t _index) : index(_index) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        return env->arg(index);
+    }
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        // Only one-argument functions are evaluated in batches.
+        r_sanity_check(index == 0);
+        for (uint32_t i : selection) {
+            (*out)[i] = batch->row(i);
+        }
+    }
+private:
+    const size_t index;
+};
+
+class compiled_interpreted_term_t : public compiled_term_t {
+public:
+    explicit compiled_interpreted_term_t(counted_t<const term_t> _term)
+        : term(std::move(_term)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        scoped_ptr_t<val_t> v = term->eval(env->scope_env());
+        if (!v->get_type().is_convertible(val_t::type_t::DATUM)) {
+            // Let the interpreter deal with grouped data, sequences and so on.
+            compiled_term_bail_out();
+        }
+        return v->as_datum();
+    }
+private:
+    const counted_t<const term_t> term;
+};
+
+func_compiler_t::func_compiler_t(const var_scope_t *_captured_scope,
+                                 const std::vector<sym_t> *_arg_names)
+    : captured_scope(_captured_scope),
+      arg_names(_arg_names),
+      depth(0),
+      saw_nondeterministic_(false) { }
+
+scoped_ptr_t<const compiled_term_t> func_compiler_t::lower_arg(
+        const counted_t<const term_t> &arg) {
+    if (arg->get_src().type() == Term::ARGS) {
+        // `r.args` splices its elements into the argument list.
+        return scoped_ptr_t<const compiled_term_t>();
+    }
+    if (depth < MAX_COMPILED_TERM_DEPTH) {
+        ++depth;
+        scoped_ptr_t<const compiled_term_t> res = arg->lower(this);
+        --depth;
+        if (res.has()) {
+            return res;
+        }
+    }
+    if (arg->is_deterministic() == deterministic_t::no) {
+        saw_nondeterministic_ = true;
+    }
+    return make_scoped<compiled_interpreted_term_t>(arg);
+}
+
+bool func_compiler_t::lower_args(const std::vector<counted_t<const term_t> > &args,
+                                 compiled_terms_t *out) {
+    out->reserve(args.size());
+    for (const auto &arg : args) {
+        scoped_ptr_t<const compiled_term_t> lowered = lower_arg(arg);
+        if (!lowered.has()) {
+            return false;
+        }
+        out->push_back(std::move(lowered));
+    }
+    return true;
+}
+
+scoped_ptr_t<const compiled_term_t> func_compiler_t::lower_var(sym_t varname) const {
+    // `var_scope_t::with_func_arg_list()` doesn't overwrite captured variables, and
+    // the first of two arguments with the same name wins.
+    if (captured_scope->contains_var(varname)) {
+        return make_compiled_constant(captured_scope->lookup_var(varname));
+    }
+    for (size_t i = 0; i < arg_names->size(); ++i) {
+        if ((*arg_names)[i].value == varname.value) {
+            return make_scoped<compiled_arg_t>(i);
+        }
+    }
+    return scoped_ptr_t<const compiled_term_t>();
+}
+
+scoped_ptr_t<const compiled_term_t> func_compiler_t::lower_implicit_var() const {
+    // If the function doesn't introduce the implicit variable itself, it comes from
+    // the captured scope, and we leave that rare case to the interpreter.
+    if (function_emits_implicit_variable(*arg_names)) {
+        return make_scoped<compiled_arg_t>(0);
+    }
+    return scoped_ptr_t<const compiled_term_t>();
+}
+
+scoped_ptr_t<const compiled_term_t> make_compiled_constant(datum_t d) {
+    return make_scoped<compiled_constant_t>(std::move(d));
+}
+
+scoped_ptr_t<const compiled_term_t> compile_func_body(
+        const var_scope_t &captured_scope,
+        const std::vector<sym_t> &arg_names,
+        const term_t *body) {
+    func_compiler_t compiler(&captured_scope, &arg_names);
+    scoped_ptr_t<const compiled_term_t> res = body->lower(&compiler);
+    if (compiler.saw_nondeterministic()) {
+        // A bailout would evaluate the non-deterministic subterm a second time.
+        return scoped_ptr_t<const compiled_term_t>();
+    }
+    return res;
+}
+
+bool eval_compiled_func(const compiled_term_t *compiled_body,
+                        compiled_func_env_t *env,
+                        datum_t *out) {
+    // These are what `runtime_term_t::eval()` does for every term.
+    env->env()->do_eval_callback();
+    if (env->env()->interruptor->is_pulsed()) {
+        throw interrupted_exc_t();
+    }
+    env->env()->maybe_yield();
+
+    try {
+        *out = compiled_body->eval(env);
+        return true;
+    } catch (const compiled_term_bailout_exc_t &) {
+        return false;
+    } catch (const datum_exc_t &) {
+        // The interpreter will raise this again, with the right backtrace.
+        return false;
+    }
+}
+
+void eval_compiled_func_batch(const compiled_term_t *compiled_body,
+                              compiled_batch_t *batch,
+                              std::vector<datum_t> *out) {
+    env_t *env = batch->env();
+    env->do_eval_callback();
+    if (env->interruptor->is_pulsed()) {
+        throw interrupted_exc_t();
+    }
+    env->maybe_yield();
+
+    batch_selection_t all_rows(batch->size());
+    for (size_t i = 0; i < batch->size(); ++i) {
+        all_rows[i] = i;
+    }
+    out->assign(batch->size(), datum_t());
+    compiled_body->eval_batch(batch, all_rows, out);
+    for (size_t i = 0; i < batch->size(); ++i) {
+        if (batch->bailed_out(i)) {
+            (*out)[i].reset();
+        }
+    }
+}
+
+}  // namespace ql
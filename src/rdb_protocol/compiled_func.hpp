@@ -0,0 +1,189 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_COMPILED_FUNC_HPP_
+#define RDB_PROTOCOL_COMPILED_FUNC_HPP_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "containers/counted.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/sym.hpp"
+#include "rdb_protocol/var_types.hpp"
+
+namespace ql {
+
+class env_t;
+class scope_env_t;
+class term_t;
+
+/* The bodies of `map` and `filter` functions are usually small expressions such as
+`row('a').gt(5).and(row('b').eq('x'))`, and walking the `term_t` tree for them costs more
+than the work they do: every term allocates a `val_t`, builds an `args_t`, checks for
+grouped data and stack space, and every variable is looked up in a `std::map`.
+
+So when a `reql_func_t` is created, its body is lowered into a tree of
+`compiled_term_t`s. Each of them evaluates straight to a `datum_t`, and variables are
+resolved to argument slots or constants up front. A term opts into this by overriding
+`term_t::lower()`; subterms that don't are wrapped in a node that evaluates them with the
+interpreter.
+
+Compiled terms only handle the common case. Whenever one runs into anything unusual (a
+type it doesn't handle, a missing field, anything that would raise an error), it throws
+`compiled_term_bailout_exc_t` and the whole function is evaluated again by the
+interpreter, which then produces exactly the result or the error that it always would
+have. This is why we refuse to compile bodies that contain non-deterministic terms. */
+
+class compiled_term_bailout_exc_t {
+public:
+    compiled_term_bailout_exc_t() { }
+};
+
+NORETURN void compiled_term_bail_out();
+
+// The state of a single call of a compiled function.
+class compiled_func_env_t {
+public:
+    compiled_func_env_t(env_t *_env,
+                        const std::vector<datum_t> *_args,
+                        const var_scope_t *_captured_scope,
+                        const std::vector<sym_t> *_arg_names);
+    ~compiled_func_env_t();
+
+    env_t *env() const { return env_; }
+
+    const datum_t &arg(size_t i) const {
+        return (*args)[i];
+    }
+
+    // Builds the scope in which the interpreter evaluates the subterms that couldn't
+    // be lowered. This is done lazily, since it costs as much as we're trying to save.
+    scope_env_t *scope_env();
+
+private:
+    env_t *const env_;
+    const std::vector<datum_t> *const args;
+    const var_scope_t *const captured_scope;
+    const std::vector<sym_t> *const arg_names;
+    scoped_ptr_t<scope_env_t> scope_env_;
+
+    DISABLE_COPYING(compiled_func_env_t);
+};
+
+class compiled_term_t;
+
+/* Indexes into a batch, in increasing order. */
+typedef std::vector<uint32_t> batch_selection_t;
+
+/* The state of evaluating a compiled one-argument function on a whole batch of rows at
+once (see `func_t::filter_batch()`). The terms evaluate column by column, which
+amortizes the dispatch over the batch and lets comparisons of numbers run in tight
+loops. Rows for which anything unusual happens are marked as bailed out, and the caller
+evaluates them one at a time afterwards.
+
+Unlike for single rows, a compiled term must not let an error escape in batch mode:
+`and`, `or` and comparison chains may evaluate an argument for a row that `call()`
+wouldn't have evaluated it for. */
+class compiled_batch_t {
+public:
+    compiled_batch_t(env_t *_env,
+                     const std::vector<datum_t> *_rows,
+                     const var_scope_t *_captured_scope,
+                     const std::vector<sym_t> *_arg_names);
+
+    env_t *env() const { return env_; }
+    size_t size() const { return rows->size(); }
+    const datum_t &row(size_t i) const { return (*rows)[i]; }
+
+    void bail_out(size_t i) { bailed_out_[i] = true; }
+    bool bailed_out(size_t i) const { return bailed_out_[i]; }
+
+    // Evaluates `term` on the single row `i`. Marks the row as bailed out and returns
+    // an empty datum if that fails.
+    datum_t eval_row(const compiled_term_t *term, size_t i);
+
+private:
+    env_t *const env_;
+    const std::vector<datum_t> *const rows;
+    const var_scope_t *const captured_scope;
+    const std::vector<sym_t> *const arg_names;
+    std::vector<datum_t> row_args;
+    std::vector<bool> bailed_out_;
+
+    DISABLE_COPYING(compiled_batch_t);
+};
+
+class compiled_term_t {
+public:
+    virtual ~compiled_term_t() { }
+    virtual datum_t eval(compiled_func_env_t *env) const = 0;
+
+    // Sets `(*out)[i]` for every row `i` in `selection` that doesn't bail out. `out`
+    // has one entry for every row of the batch. The default implementation evaluates
+    // the rows one by one.
+    virtual void eval_batch(compiled_batch_t *batch,
+                            const batch_selection_t &selection,
+                            std::vector<datum_t> *out) const;
+};
+
+typedef std::vector<scoped_ptr_t<const compiled_term_t> > compiled_terms_t;
+
+/* Passed to `term_t::lower()`. Knows where the function's variables come from. */
+class func_compiler_t {
+public:
+    func_compiler_t(const var_scope_t *captured_scope,
+                    const std::vector<sym_t> *arg_names);
+
+    // Lowers an argument of the term that is being lowered. If the argument can't be
+    // lowered itself, it gets evaluated by the interpreter. Returns an empty pointer if
+    // the argument can't be used in a compiled term at all, for example because it's
+    // an `r.args` term.
+    scoped_ptr_t<const compiled_term_t> lower_arg(const counted_t<const term_t> &arg);
+
+    // Lowers all of `args`, or returns `false` if one of them can't be.
+    MUST_USE bool lower_args(const std::vector<counted_t<const term_t> > &args,
+                             compiled_terms_t *out);
+
+    scoped_ptr_t<const compiled_term_t> lower_var(sym_t varname) const;
+    scoped_ptr_t<const compiled_term_t> lower_implicit_var() const;
+
+    // Whether some subterm that is evaluated by the interpreter isn't deterministic.
+    bool saw_nondeterministic() const { return saw_nondeterministic_; }
+
+private:
+    const var_scope_t *const captured_scope;
+    const std::vector<sym_t> *const arg_names;
+    int depth;
+    bool saw_nondeterministic_;
+
+    DISABLE_COPYING(func_compiler_t);
+};
+
+scoped_ptr_t<const compiled_term_t> make_compiled_constant(datum_t d);
+
+/* Returns an empty pointer if there is nothing to gain from compiling `body`. */
+scoped_ptr_t<const compiled_term_t> compile_func_body(
+        const var_scope_t &captured_scope,
+        const std::vector<sym_t> &arg_names,
+        const term_t *body);
+
+/* Evaluates a compiled function. Returns `false` if the compiled terms bailed out, in
+which case the caller has to use the interpreter. */
+MUST_USE bool eval_compiled_func(const compiled_term_t *compiled_body,
+                                 compiled_func_env_t *env,
+                                 datum_t *out);
+
+/* Evaluates a compiled one-argument function on every row of `batch`. `out` gets an
+empty datum for the rows that bailed out. */
+void eval_compiled_func_batch(const compiled_term_t *compiled_body,
+                              compiled_batch_t *batch,
+                              std::vector<datum_t> *out);
+
+/* Returns the rows of `selection` that haven't bailed out. */
+batch_selection_t remaining_rows(const compiled_batch_t *batch,
+                                 const batch_selection_t &selection);
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_COMPILED_FUNC_HPP_
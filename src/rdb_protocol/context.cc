@@ -66,6 +66,9 @@ rdb_context_t::stats_t::stats_t(perfmon_collection_t *global_stats)
     : qe_stats_membership(global_stats, &qe_stats_collection, rql_perfmon_name),
       client_connections_membership(&qe_stats_collection,
                                     &client_connections, "client_connections"),
+      client_connections_migrated_membership(&qe_stats_collection,
+                                             &client_connections_migrated,
+                                             "client_connections_migrated"),
       clients_active_membership(&qe_stats_collection,
                                 &clients_active, "clients_active"),
       queries_per_sec(secs_to_ticks(1)),
@@ -489,6 +489,8 @@ public:
         perfmon_membership_t qe_stats_membership;
         perfmon_counter_t client_connections;
         perfmon_membership_t client_connections_membership;
+        perfmon_counter_t client_connections_migrated;
+        perfmon_membership_t client_connections_migrated_membership;
         perfmon_counter_t clients_active;
         perfmon_membership_t clients_active_membership;
         perfmon_rate_monitor_t queries_per_sec;
@@ -107,12 +107,12 @@ datum_t::data_wrapper_t::data_wrapper_t(const char *cstr) :
     r_str(cstr), internal_type(internal_type_t::R_STR) { }
 
 datum_t::data_wrapper_t::data_wrapper_t(std::vector<datum_t> &&array) :
-    r_array(new countable_wrapper_t<std::vector<datum_t> >(std::move(array))),
+    r_array(new arena_countable_wrapper_t<std::vector<datum_t> >(std::move(array))),
     internal_type(internal_type_t::R_ARRAY) { }
 
 datum_t::data_wrapper_t::data_wrapper_t(
         std::vector<std::pair<datum_string_t, datum_t> > &&object) :
-    r_object(new countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > >(
+    r_object(new arena_countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > >(
         std::move(object))),
     internal_type(internal_type_t::R_OBJECT) {
 
@@ -154,9 +154,15 @@ datum_t::data_wrapper_t::data_wrapper_t(type_t type, shared_buf_ref_t<char> &&_b
     }
 }
 
+datum_t::data_wrapper_t::data_wrapper_t(construct_indexed_object_t,
+                                        shared_buf_ref_t<char> &&_buf_ref) {
+    internal_type = internal_type_t::BUF_R_OBJECT_INDEXED;
+    new(&buf_ref) shared_buf_ref_t<char>(std::move(_buf_ref));
+}
+
 datum_t::data_wrapper_t::~data_wrapper_t() {
     // An optimization similar to what we do in `call_with_enough_stack_datum`,
-    // except that we can also ignore recursion for BUF_R_ARRAY and BUF_R_OBJECT.
+    // except that we can also ignore recursion for the BUF_R_* types.
     if (internal_type == internal_type_t::R_ARRAY ||
         internal_type == internal_type_t::R_OBJECT) {
         call_with_enough_stack([&] { destruct(); }, MIN_DATUM_RECURSION_STACK_SPACE);
@@ -189,6 +195,8 @@ datum_t::type_t datum_t::data_wrapper_t::get_type() const {
         return type_t::R_ARRAY;
     case internal_type_t::BUF_R_OBJECT:
         return type_t::R_OBJECT;
+    case internal_type_t::BUF_R_OBJECT_INDEXED:
+        return type_t::R_OBJECT;
     case internal_type_t::MAXVAL:
         return type_t::MAXVAL;
     default:
@@ -212,13 +220,14 @@ void datum_t::data_wrapper_t::destruct() {
         r_str.~datum_string_t();
     } break;
     case internal_type_t::R_ARRAY: {
-        r_array.~counted_t<countable_wrapper_t<std::vector<datum_t> > >();
+        r_array.~counted_t<arena_countable_wrapper_t<std::vector<datum_t> > >();
     } break;
     case internal_type_t::R_OBJECT: {
-        r_object.~counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >();
+        r_object.~counted_t<arena_countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >();
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
-    case internal_type_t::BUF_R_OBJECT: {
+    case internal_type_t::BUF_R_OBJECT: // fallthru
+    case internal_type_t::BUF_R_OBJECT_INDEXED: {
         buf_ref.~shared_buf_ref_t<char>();
     } break;
     default: unreachable();
@@ -244,14 +253,15 @@ void datum_t::data_wrapper_t::assign_copy(const datum_t::data_wrapper_t &copyee)
         new(&r_str) datum_string_t(copyee.r_str);
     } break;
     case internal_type_t::R_ARRAY: {
-        new(&r_array) counted_t<countable_wrapper_t<std::vector<datum_t> > >(copyee.r_array);
+        new(&r_array) counted_t<arena_countable_wrapper_t<std::vector<datum_t> > >(copyee.r_array);
     } break;
     case internal_type_t::R_OBJECT: {
-        new(&r_object) counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
+        new(&r_object) counted_t<arena_countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
             copyee.r_object);
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
-    case internal_type_t::BUF_R_OBJECT: {
+    case internal_type_t::BUF_R_OBJECT: // fallthru
+    case internal_type_t::BUF_R_OBJECT_INDEXED: {
         new(&buf_ref) shared_buf_ref_t<char>(copyee.buf_ref);
     } break;
     default: unreachable();
@@ -276,15 +286,16 @@ void datum_t::data_wrapper_t::assign_move(datum_t::data_wrapper_t &&movee) noexc
         new(&r_str) datum_string_t(std::move(movee.r_str));
     } break;
     case internal_type_t::R_ARRAY: {
-        new(&r_array) counted_t<countable_wrapper_t<std::vector<datum_t> > >(
+        new(&r_array) counted_t<arena_countable_wrapper_t<std::vector<datum_t> > >(
             std::move(movee.r_array));
     } break;
     case internal_type_t::R_OBJECT: {
-        new(&r_object) counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
+        new(&r_object) counted_t<arena_countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
             std::move(movee.r_object));
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
-    case internal_type_t::BUF_R_OBJECT: {
+    case internal_type_t::BUF_R_OBJECT: // fallthru
+    case internal_type_t::BUF_R_OBJECT_INDEXED: {
         new(&buf_ref) shared_buf_ref_t<char>(std::move(movee.buf_ref));
     } break;
     default: unreachable();
@@ -300,6 +311,9 @@ datum_t::datum_t() : data() { }
 datum_t::datum_t(type_t type, shared_buf_ref_t<char> &&buf_ref)
     : data(type, std::move(buf_ref)) { }
 
+datum_t::datum_t(construct_indexed_object_t, shared_buf_ref_t<char> &&buf_ref)
+    : data(construct_indexed_object_t(), std::move(buf_ref)) { }
+
 datum_t::datum_t(datum_t::construct_minval_t dummy) : data(dummy) { }
 
 datum_t::datum_t(datum_t::construct_maxval_t dummy) : data(dummy) { }
@@ -511,13 +525,18 @@ datum_t to_datum(const rapidjson::Value &json, const configured_limits_t &limits
 
 const shared_buf_ref_t<char> *datum_t::get_buf_ref() const {
     if (data.get_internal_type() == internal_type_t::BUF_R_ARRAY
-        || data.get_internal_type() == internal_type_t::BUF_R_OBJECT) {
+        || data.get_internal_type() == internal_type_t::BUF_R_OBJECT
+        || data.get_internal_type() == internal_type_t::BUF_R_OBJECT_INDEXED) {
         return &data.buf_ref;
     } else {
         return NULL;
     }
 }
 
+bool datum_t::buf_ref_has_field_index() const {
+    return data.get_internal_type() == internal_type_t::BUF_R_OBJECT_INDEXED;
+}
+
 datum_t::type_t datum_t::get_type() const { return data.get_type(); }
 
 bool datum_t::is_ptype() const {
@@ -1456,7 +1475,8 @@ datum_t datum_t::unchecked_get(size_t index) const {
 
 size_t datum_t::obj_size() const {
     check_type(R_OBJECT);
-    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT) {
+    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT
+        || data.get_internal_type() == internal_type_t::BUF_R_OBJECT_INDEXED) {
         return datum_get_array_size(data.buf_ref);
     } else {
         r_sanity_check(data.get_internal_type() == internal_type_t::R_OBJECT);
@@ -1471,7 +1491,8 @@ std::pair<datum_string_t, datum_t> datum_t::get_pair(size_t index) const {
 }
 
 std::pair<datum_string_t, datum_t> datum_t::unchecked_get_pair(size_t index) const {
-    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT) {
+    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT
+        || data.get_internal_type() == internal_type_t::BUF_R_OBJECT_INDEXED) {
         const size_t offset = datum_get_element_offset(data.buf_ref, index);
         return datum_deserialize_pair_from_buf(data.buf_ref, offset);
     } else {
@@ -1481,18 +1502,44 @@ std::pair<datum_string_t, datum_t> datum_t::unchecked_get_pair(size_t index) con
 }
 
 datum_t datum_t::get_field(const datum_string_t &key, throw_bool_t throw_bool) const {
-    // Use binary search on top of unchecked_get_pair()
+    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT_INDEXED) {
+        size_t offset;
+        if (datum_find_field_in_index(data.buf_ref, key, &offset)) {
+            return datum_deserialize_from_buf(data.buf_ref,
+                                              offset + datum_serialized_size(key));
+        }
+        return field_not_found(key, throw_bool);
+    }
+
+    // Use binary search over the keys. If the object is backed by a buffer, only the
+    // keys are read during the search, and only the value that we're looking for gets
+    // deserialized.
     size_t range_beg = 0;
     // The obj_size() also makes sure that this has the right type (R_OBJECT)
     size_t range_end = obj_size();
+    const bool is_buf = data.get_internal_type() == internal_type_t::BUF_R_OBJECT;
     while (range_beg < range_end) {
         const size_t center = range_beg + ((range_end - range_beg) / 2);
-        auto center_pair = unchecked_get_pair(center);
-        const int cmp_res = key.compare(center_pair.first);
-        if (cmp_res == 0) {
-            // Found it
-            return center_pair.second;
-        } else if (cmp_res < 0) {
+        int cmp_res;
+        if (is_buf) {
+            const size_t offset = datum_get_element_offset(data.buf_ref, center);
+            const datum_string_t center_key =
+                datum_deserialize_key_from_buf(data.buf_ref, offset);
+            cmp_res = key.compare(center_key);
+            if (cmp_res == 0) {
+                // Found it
+                return datum_deserialize_from_buf(
+                    data.buf_ref, offset + datum_serialized_size(center_key));
+            }
+        } else {
+            const auto &center_pair = (*data.r_object)[center];
+            cmp_res = key.compare(center_pair.first);
+            if (cmp_res == 0) {
+                // Found it
+                return center_pair.second;
+            }
+        }
+        if (cmp_res < 0) {
             range_end = center;
         } else {
             range_beg = center + 1;
@@ -1500,7 +1547,11 @@ datum_t datum_t::get_field(const datum_string_t &key, throw_bool_t throw_bool) c
         rassert(range_beg <= range_end);
     }
 
-    // Didn't find it
+    return field_not_found(key, throw_bool);
+}
+
+datum_t datum_t::field_not_found(const datum_string_t &key,
+                                 throw_bool_t throw_bool) const {
     if (throw_bool == THROW) {
         rfail(base_exc_t::NON_EXISTENCE,
               "No attribute `%s` in object:\n%s", key.to_std().c_str(), print().c_str());
@@ -1765,6 +1816,16 @@ int derived_cmp(T a, T b) {
 }
 
 int datum_t::cmp_unchecked_stack(const datum_t &rhs) const {
+    // Rows that were read from disk are usually backed by their serialization. If
+    // both serializations are the same, we don't need to look at the elements.
+    const shared_buf_ref_t<char> *buf_ref = get_buf_ref();
+    const shared_buf_ref_t<char> *rhs_buf_ref = rhs.get_buf_ref();
+    if (buf_ref != nullptr && rhs_buf_ref != nullptr
+        && data.get_internal_type() == rhs.data.get_internal_type()
+        && datum_bufs_identical(*buf_ref, *rhs_buf_ref)) {
+        return 0;
+    }
+
     bool lhs_ptype = is_ptype() && !pseudo_compares_as_obj();
     bool rhs_ptype = rhs.is_ptype() && !rhs.pseudo_compares_as_obj();
     if (lhs_ptype && rhs_ptype) {
@@ -2039,6 +2100,9 @@ datum_t stats_merge(UNUSED const datum_string_t &key,
 
 datum_object_builder_t::datum_object_builder_t(const datum_t &copy_from) {
     const size_t copy_from_sz = copy_from.obj_size();
+    if (copy_from.get_buf_ref() != nullptr) {
+        note_full_datum_deserialization();
+    }
     for (size_t i = 0; i < copy_from_sz; ++i) {
         map.insert(copy_from.get_pair(i));
     }
@@ -2166,6 +2230,9 @@ datum_array_builder_t::datum_array_builder_t(const datum_t &copy_from,
                                              const configured_limits_t &_limits)
     : limits(_limits) {
     const size_t copy_from_sz = copy_from.arr_size();
+    if (copy_from.get_buf_ref() != nullptr) {
+        note_full_datum_deserialization();
+    }
     vector.reserve(copy_from_sz);
     for (size_t i = 0; i < copy_from_sz; ++i) {
         vector.push_back(copy_from.get(i));
@@ -2300,6 +2367,9 @@ void debug_print(printf_buffer_t *buf, const datum_t &d) {
     case datum_t::internal_type_t::BUF_R_OBJECT:
         buf->appendf("d/buf_r_object(...)");
         break;
+    case datum_t::internal_type_t::BUF_R_OBJECT_INDEXED:
+        buf->appendf("d/buf_r_object_indexed(...)");
+        break;
     default:
         buf->appendf("datum/garbage{internal_type=%d}", static_cast<int>(d.data.get_internal_type()));
         break;
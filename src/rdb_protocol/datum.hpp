@@ -17,6 +17,7 @@
 #include "btree/keys.hpp"
 #include "cjson/json.hpp"
 #include "containers/archive/archive.hpp"
+#include "containers/arena.hpp"
 #include "containers/counted.hpp"
 #include "rdb_protocol/datum_string.hpp"
 #include "rapidjson/document.h"
@@ -123,6 +124,7 @@ private:
         R_STR,
         BUF_R_ARRAY,
         BUF_R_OBJECT,
+        BUF_R_OBJECT_INDEXED,
         MAXVAL
     };
 public:
@@ -164,6 +166,12 @@ public:
     // prefixed serialized size.
     datum_t(type_t type, shared_buf_ref_t<char> &&buf_ref);
 
+    // Construct an R_OBJECT from a shared buffer like above, for a serialization
+    // that ends in a hash index over the keys. `get_field()` uses that index instead
+    // of a binary search.
+    enum class construct_indexed_object_t { };
+    datum_t(construct_indexed_object_t, shared_buf_ref_t<char> &&buf_ref);
+
     // Strongly prefer datum_t::minval().
     enum class construct_minval_t { };
     explicit datum_t(construct_minval_t);
@@ -349,9 +357,11 @@ public:
                               datum_t orig_key,
                               const datum_string_t &pkey) const;
 
-    // Used by skey_version code. Returns a pointer to the buf_ref, if
-    // the datum is currently backed by one, or NULL otherwise.
+    // Used by skey_version code and for comparisons. Returns a pointer to the
+    // buf_ref, if the datum is currently backed by one, or NULL otherwise.
     const shared_buf_ref_t<char> *get_buf_ref() const;
+    // Whether the buf_ref holds an object with a field index.
+    bool buf_ref_has_field_index() const;
 
 private:
     // We have a special version of `call_with_enough_stack` for datums that only uses
@@ -380,6 +390,9 @@ private:
     std::pair<datum_string_t, datum_t> unchecked_get_pair(size_t index) const;
     datum_t unchecked_get(size_t) const;
 
+    // The end of `get_field()` if there is no such field.
+    datum_t field_not_found(const datum_string_t &key, throw_bool_t throw_bool) const;
+
     datum_t default_merge_unchecked_stack(const datum_t &rhs) const;
     datum_t custom_merge_unchecked_stack(const datum_t &rhs,
                                          merge_resoluter_t f,
@@ -437,6 +450,7 @@ private:
         explicit data_wrapper_t(
                 std::vector<std::pair<datum_string_t, datum_t> > &&object);
         data_wrapper_t(type_t type, shared_buf_ref_t<char> &&_buf_ref);
+        data_wrapper_t(construct_indexed_object_t, shared_buf_ref_t<char> &&_buf_ref);
 
         ~data_wrapper_t();
 
@@ -447,8 +461,8 @@ private:
             bool r_bool;
             double r_num;
             datum_string_t r_str;
-            counted_t<countable_wrapper_t<std::vector<datum_t> > > r_array;
-            counted_t<countable_wrapper_t<std::vector< //NOLINT(whitespace/operators)
+            counted_t<arena_countable_wrapper_t<std::vector<datum_t> > > r_array;
+            counted_t<arena_countable_wrapper_t<std::vector< //NOLINT(whitespace/operators)
                 std::pair<datum_string_t, datum_t> > > > r_object;
             shared_buf_ref_t<char> buf_ref;
         };
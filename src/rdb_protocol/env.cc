@@ -122,6 +122,13 @@ env_t::env_t(signal_t *_interruptor,
 
 env_t::~env_t() { }
 
+void env_t::use_arena() {
+    assert_thread();
+    if (!arena_.has()) {
+        arena_.init(new arena_t());
+    }
+}
+
 void env_t::maybe_yield() {
     if (++evals_since_yield_ > EVALS_BEFORE_YIELD) {
         evals_since_yield_ = 0;
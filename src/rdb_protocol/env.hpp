@@ -13,6 +13,7 @@
 
 #include "clustering/administration/auth/user_context.hpp"
 #include "concurrency/one_per_thread.hpp"
+#include "containers/arena.hpp"
 #include "containers/counted.hpp"
 #include "containers/lru_cache.hpp"
 #include "extproc/js_runner.hpp"
@@ -133,6 +134,14 @@ public:
 
     reql_version_t reql_version() const { return reql_version_; }
 
+    // Makes the datums that the current coroutine creates while this environment
+    // exists come from an arena (see `containers/arena.hpp`). The query cache does
+    // this for every batch that it evaluates.
+    void use_arena();
+
+    // `nullptr` unless `use_arena()` was called.
+    const arena_t *arena() const { return arena_.get_or_null(); }
+
 private:
     serializable_env_t serializable;
 
@@ -170,6 +179,8 @@ private:
 
     eval_callback_t *eval_callback_;
 
+    scoped_ptr_t<arena_t> arena_;
+
     DISABLE_COPYING(env_t);
 };
 
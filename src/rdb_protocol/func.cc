@@ -3,6 +3,7 @@
 
 #include "pprint/js_pprint.hpp"
 #include "pprint/pprint.hpp"
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/pseudo_literal.hpp"
@@ -45,7 +46,8 @@ reql_func_t::reql_func_t(const var_scope_t &_captured_scope,
     : func_t(_body->backtrace()),
       captured_scope(_captured_scope),
       arg_names(std::move(_arg_names)),
-      body(std::move(_body)) { }
+      body(std::move(_body)),
+      compiled_body(compile_func_body(captured_scope, arg_names, body.get())) { }
 
 reql_func_t::reql_func_t(scoped_ptr_t<term_storage_t> &&_storage,
                          const var_scope_t &_captured_scope,
@@ -55,7 +57,8 @@ reql_func_t::reql_func_t(scoped_ptr_t<term_storage_t> &&_storage,
       captured_scope(_captured_scope),
       arg_names(std::move(_arg_names)),
       term_storage(std::move(_storage)),
-      body(std::move(_body)) { }
+      body(std::move(_body)),
+      compiled_body(compile_func_body(captured_scope, arg_names, body.get())) { }
 
 reql_func_t::~reql_func_t() { }
 
@@ -75,6 +78,17 @@ scoped_ptr_t<val_t> reql_func_t::call(env_t *env,
                          arg_names.size(),
                          (arg_names.size() == 1 ? "" : "s")));
 
+        // The compiled body doesn't know about literals, nor about profiling.
+        if (compiled_body.has()
+            && eval_flags == NO_FLAGS
+            && env->profile() == profile_bool_t::DONT_PROFILE) {
+            compiled_func_env_t compiled_env(env, &args, &captured_scope, &arg_names);
+            datum_t res;
+            if (eval_compiled_func(compiled_body.get(), &compiled_env, &res)) {
+                return make_scoped<val_t>(std::move(res), body->backtrace());
+            }
+        }
+
         var_scope_t new_scope = arg_names.size() == 0
             ? captured_scope
             : captured_scope.with_func_arg_list(arg_names, args);
@@ -99,6 +113,19 @@ bool reql_func_t::is_simple_selector() const {
     return body->is_simple_selector();
 }
 
+void reql_func_t::eval_batch(env_t *env,
+                             const std::vector<datum_t> &rows,
+                             std::vector<datum_t> *results_out) const {
+    if (!compiled_body.has()
+        || arg_names.size() != 1
+        || env->profile() == profile_bool_t::PROFILE) {
+        func_t::eval_batch(env, rows, results_out);
+        return;
+    }
+    compiled_batch_t batch(env, &rows, &captured_scope, &arg_names);
+    eval_compiled_func_batch(compiled_body.get(), &batch, results_out);
+}
+
 js_func_t::js_func_t(const std::string &_js_source,
                      uint64_t timeout_ms,
                      backtrace_id_t _backtrace)
@@ -361,6 +388,65 @@ bool func_t::filter_call(env_t *env, datum_t arg, counted_t<const func_t> defaul
     std::rethrow_exception(saved_exception);
 }
 
+// Smaller batches aren't worth setting up a batch evaluation for.
+const size_t MIN_EVAL_BATCH_SIZE = 4;
+
+void func_t::eval_batch(env_t *,
+                        const std::vector<datum_t> &rows,
+                        std::vector<datum_t> *results_out) const {
+    results_out->assign(rows.size(), datum_t());
+}
+
+void func_t::filter_batch(env_t *env,
+                          std::vector<datum_t> *batch,
+                          counted_t<const func_t> default_filter_val) const {
+    std::vector<bool> matches;
+    match_batch(env, *batch, default_filter_val, &matches);
+    auto loc = batch->begin();
+    for (size_t i = 0; i < batch->size(); ++i) {
+        if (matches[i]) {
+            std::swap(*loc, (*batch)[i]);
+            ++loc;
+        }
+    }
+    batch->erase(loc, batch->end());
+}
+
+void func_t::match_batch(env_t *env,
+                         const std::vector<datum_t> &batch,
+                         counted_t<const func_t> default_filter_val,
+                         std::vector<bool> *matches_out) const {
+    std::vector<datum_t> results;
+    if (batch.size() >= MIN_EVAL_BATCH_SIZE) {
+        eval_batch(env, batch, &results);
+    } else {
+        results.assign(batch.size(), datum_t());
+    }
+    matches_out->resize(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        // Objects are matched against the row by `filter_helper`.
+        (*matches_out)[i] = results[i].has() && results[i].get_type() != datum_t::R_OBJECT
+            ? results[i].as_bool()
+            : filter_call(env, batch[i], default_filter_val);
+    }
+}
+
+void func_t::map_batch(env_t *env, std::vector<datum_t> *batch) const {
+    std::vector<datum_t> results;
+    if (batch->size() >= MIN_EVAL_BATCH_SIZE) {
+        eval_batch(env, *batch, &results);
+    } else {
+        results.assign(batch->size(), datum_t());
+    }
+    for (size_t i = 0; i < batch->size(); ++i) {
+        if (results[i].has()) {
+            (*batch)[i] = std::move(results[i]);
+        } else {
+            (*batch)[i] = call(env, (*batch)[i])->as_datum();
+        }
+    }
+}
+
 counted_t<const func_t> new_constant_func(datum_t obj, backtrace_id_t bt) {
     minidriver_t r(bt);
     compile_env_t empty_compile_env((var_visibility_t()));
@@ -25,6 +25,7 @@ class js_runner_t;
 
 namespace ql {
 
+class compiled_term_t;
 class func_visitor_t;
 
 class func_t : public slow_atomic_countable_t<func_t>, public bt_rcheckable_t {
@@ -56,6 +57,19 @@ public:
                      datum_t arg,
                      counted_t<const func_t> default_filter_val) const;
 
+    // These do the same as calling `filter_call` or `call` on every element of `batch`
+    // in order, except that they evaluate simple functions on the whole batch at once.
+    // `filter_batch` removes the elements that don't match, `match_batch` says which
+    // ones match, and `map_batch` replaces every element with its result.
+    void filter_batch(env_t *env,
+                      std::vector<datum_t> *batch,
+                      counted_t<const func_t> default_filter_val) const;
+    void match_batch(env_t *env,
+                     const std::vector<datum_t> &batch,
+                     counted_t<const func_t> default_filter_val,
+                     std::vector<bool> *matches_out) const;
+    void map_batch(env_t *env, std::vector<datum_t> *batch) const;
+
     // These are simple, they call the vector version of call.
     scoped_ptr_t<val_t> call(env_t *env, eval_flags_t eval_flags = NO_FLAGS) const;
     scoped_ptr_t<val_t> call(env_t *env,
@@ -73,6 +87,13 @@ public:
 protected:
     explicit func_t(backtrace_id_t bt);
 
+    // Evaluates a one-argument function on every row of `rows` at once. Leaves an empty
+    // datum in `results_out` for the rows that have to be evaluated one at a time. The
+    // default implementation does that for all of them.
+    virtual void eval_batch(env_t *env,
+                            const std::vector<datum_t> &rows,
+                            std::vector<datum_t> *results_out) const;
+
 private:
     virtual bool filter_helper(env_t *env, datum_t arg) const = 0;
 
@@ -113,6 +134,9 @@ public:
 private:
     template <cluster_version_t> friend class wire_func_serialization_visitor_t;
     bool filter_helper(env_t *env, datum_t arg) const;
+    void eval_batch(env_t *env,
+                    const std::vector<datum_t> &rows,
+                    std::vector<datum_t> *results_out) const;
 
     // Only contains the parts of the scope that `body` uses.
     var_scope_t captured_scope;
@@ -127,6 +151,10 @@ private:
     // The body of the function, which gets ->eval(...) called when call(...) is called.
     counted_t<const term_t> body;
 
+    // `body` lowered into a closure tree that `call(...)` tries first, if it could be
+    // lowered.  See `compiled_func.hpp`.
+    scoped_ptr_t<const compiled_term_t> compiled_body;
+
     DISABLE_COPYING(reql_func_t);
 };
 
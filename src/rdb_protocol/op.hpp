@@ -140,6 +140,8 @@ protected:
 
     const std::vector<counted_t<const term_t> > &get_original_args() const;
 
+    bool has_optargs() const { return !optargs.empty(); }
+
     virtual deterministic_t is_deterministic() const;
 
     bool recursive_is_simple_selector() const {
@@ -78,6 +78,18 @@ ql::datum_t construct_sample(
     return ql::datum_t();
 }
 
+ql::datum_t construct_allocations(
+        size_t bytes_allocated, size_t bytes_allocated_in_arena) {
+    std::map<datum_string_t, ql::datum_t> res;
+    res[datum_string_t("description")] =
+        ql::datum_t(datum_string_t("Allocate temporary datums."));
+    res[datum_string_t("bytes_allocated")] =
+        ql::datum_t(static_cast<double>(bytes_allocated));
+    res[datum_string_t("bytes_allocated_in_arena")] =
+        ql::datum_t(static_cast<double>(bytes_allocated_in_arena));
+    return ql::datum_t(std::move(res));
+}
+
 ql::datum_t construct_datum(
         event_log_t::const_iterator *begin,
         event_log_t::const_iterator end,
@@ -292,15 +304,30 @@ void disabler_t::init(trace_t *parent) {
 }
 
 trace_t::trace_t()
-    : redirected_event_log_(NULL), disabled_ref_count_(0) { }
+    : redirected_event_log_(NULL), disabled_ref_count_(0),
+      has_allocation_stats_(false), bytes_allocated_(0),
+      bytes_allocated_in_arena_(0) { }
 
 ql::datum_t trace_t::as_datum() const {
     guarantee(!redirected_event_log_);
     event_log_t::const_iterator begin = event_log_.begin();
     // Again, use defaults, as there's no predicting where this could
     // come in response to user requests.
-    return construct_datum(&begin, event_log_.end(),
-                           ql::configured_limits_t());
+    ql::configured_limits_t limits;
+    ql::datum_t events = construct_datum(&begin, event_log_.end(), limits);
+    if (!has_allocation_stats_) {
+        return events;
+    }
+    ql::datum_array_builder_t res(events, limits);
+    res.add(construct_allocations(bytes_allocated_, bytes_allocated_in_arena_));
+    return std::move(res).to_datum();
+}
+
+void trace_t::set_allocation_stats(size_t bytes_allocated,
+                                   size_t bytes_allocated_in_arena) {
+    has_allocation_stats_ = true;
+    bytes_allocated_ = bytes_allocated;
+    bytes_allocated_in_arena_ = bytes_allocated_in_arena;
 }
 
 event_log_t trace_t::extract_event_log() RVALUE_THIS {
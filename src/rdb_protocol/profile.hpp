@@ -75,6 +75,10 @@ public:
     trace_t();
     ql::datum_t as_datum() const;
     event_log_t extract_event_log() RVALUE_THIS;
+
+    /* Records how much memory the query allocated for temporary datums (see
+     * `env_t::use_arena()`), which `as_datum()` reports after the events. */
+    void set_allocation_stats(size_t bytes_allocated, size_t bytes_allocated_in_arena);
 private:
     friend class starter_t;
     friend class splitter_t;
@@ -100,6 +104,10 @@ private:
     size_t disabled_ref_count_;
     bool disabled();
 
+    bool has_allocation_stats_;
+    size_t bytes_allocated_;
+    size_t bytes_allocated_in_arena_;
+
     DISABLE_COPYING(trace_t);
 };
 
@@ -732,6 +732,9 @@ void rdb_r_unshard_visitor_t::operator()(const changefeed_subscribe_t &) {
         for (auto it = res->addrs.begin(); it != res->addrs.end(); ++it) {
             out->addrs.insert(std::move(*it));
         }
+        for (auto it = res->filter_addrs.begin(); it != res->filter_addrs.end(); ++it) {
+            out->filter_addrs.insert(std::move(*it));
+        }
         for (auto it = res->server_uuids.begin();
              it != res->server_uuids.end(); ++it) {
             out->server_uuids.insert(std::move(*it));
@@ -1471,8 +1474,8 @@ RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
     rget_read_response_t, stamp_response, result, reql_version);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(nearest_geo_read_response_t, results_or_error);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(distribution_read_response_t, region, key_counts);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
-    changefeed_subscribe_response_t, server_uuids, addrs);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
+    changefeed_subscribe_response_t, server_uuids, addrs, filter_addrs);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
     changefeed_limit_subscribe_response_t, shards, limit_addrs);
 RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
@@ -1489,6 +1492,8 @@ RDB_IMPL_SERIALIZABLE_0_FOR_CLUSTER(dummy_read_response_t);
 
 RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
     serializable_env_t, global_optargs, user_context, deterministic_time);
+RDB_IMPL_SERIALIZABLE_4_FOR_CLUSTER(
+    changefeed_filter_t, sub, range, pkey, serializable_env);
 
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(point_read_t, key);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(dummy_read_t, region);
@@ -1550,8 +1555,8 @@ RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
     serializable_env,
     region,
     current_shard);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(changefeed_stamp_t, addr, region);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(changefeed_point_stamp_t, addr, key);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(changefeed_stamp_t, addr, region, filter);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(changefeed_point_stamp_t, addr, key, filter);
 
 RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(read_t, read, profile, read_mode);
 
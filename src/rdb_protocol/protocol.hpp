@@ -168,6 +168,7 @@ struct changefeed_subscribe_response_t {
     changefeed_subscribe_response_t() { }
     std::set<uuid_u> server_uuids;
     std::set<ql::changefeed::server_t::addr_t> addrs;
+    std::set<ql::changefeed::server_t::filter_addr_t> filter_addrs;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_subscribe_response_t);
 
@@ -219,6 +220,20 @@ struct serializable_env_t {
 
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(serializable_env_t);
 
+// Sent along with the stamp read of a range or point subscription.  The changefeed
+// `server_t` uses it to avoid sending the subscription's feed changes that the
+// subscription would throw away anyway (see `server_t::send_all`).
+struct changefeed_filter_t {
+    uuid_u sub;
+    // Exactly one of `range` and `pkey` is set.
+    boost::optional<ql::changefeed::keyspec_t::range_t> range;
+    boost::optional<store_key_t> pkey;
+    // Used to evaluate the transforms in `range`.
+    serializable_env_t serializable_env;
+};
+
+RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_filter_t);
+
 struct read_response_t {
     typedef boost::variant<point_read_response_t,
                            rget_read_response_t,
@@ -285,10 +300,16 @@ RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(sindex_rangespec_t);
 
 struct changefeed_stamp_t {
     changefeed_stamp_t() : region(region_t::universe()) { }
-    explicit changefeed_stamp_t(ql::changefeed::client_t::addr_t _addr)
-        : addr(std::move(_addr)), region(region_t::universe()) { }
+    explicit changefeed_stamp_t(
+        ql::changefeed::client_t::addr_t _addr,
+        boost::optional<changefeed_filter_t> _filter = boost::none)
+        : addr(std::move(_addr)),
+          region(region_t::universe()),
+          filter(std::move(_filter)) { }
     ql::changefeed::client_t::addr_t addr;
     region_t region;
+    // Only set for the read that starts a subscription.
+    boost::optional<changefeed_filter_t> filter;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_stamp_t);
 
@@ -477,6 +498,7 @@ RDB_DECLARE_SERIALIZABLE(changefeed_limit_subscribe_t);
 struct changefeed_point_stamp_t {
     ql::changefeed::client_t::addr_t addr;
     store_key_t key;
+    boost::optional<changefeed_filter_t> filter;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_point_stamp_t);
 
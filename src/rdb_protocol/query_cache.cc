@@ -207,6 +207,7 @@ void query_cache_t::ref_t::fill_response(response_t *res) {
             &combined_interruptor,
             serializable,
             trace.get_or_null());
+        env.use_arena();
 
         if (entry->state == entry_t::state_t::START) {
             run(&env, res);
@@ -218,6 +219,8 @@ void query_cache_t::ref_t::fill_response(response_t *res) {
         }
 
         if (trace.has()) {
+            trace->set_allocation_stats(env.arena()->bytes_allocated(),
+                                        env.arena()->bytes_allocated_in_chunks());
             res->set_profile(trace->as_datum());
         }
     } catch (const interrupted_exc_t &ex) {
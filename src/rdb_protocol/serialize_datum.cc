@@ -1,6 +1,9 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/serialize_datum.hpp"
 
+#include <string.h>
+
+#include <atomic>
 #include <cmath>
 #include <functional>
 #include <limits>
@@ -8,14 +11,17 @@
 #include <vector>
 
 #include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/runtime.hpp"
 #include "containers/archive/buffer_stream.hpp"
 #include "containers/archive/stl_types.hpp"
 #include "containers/archive/versioned.hpp"
 #include "containers/counted.hpp"
 #include "containers/shared_buffer.hpp"
+#include "perfmon/perfmon.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/error.hpp"
+#include "rdb_protocol/pseudo_binary.hpp"
 
 namespace ql {
 
@@ -38,6 +44,7 @@ enum class datum_serialized_type_t {
     UNINITIALIZED = 12,
     MINVAL = 13,
     MAXVAL = 14,
+    BUF_R_OBJECT_INDEXED = 15,
 };
 
 // Objects and arrays use different word sizes for storing offsets,
@@ -74,7 +81,21 @@ struct size_tree_node_t {
 
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(datum_serialized_type_t, int8_t,
                                       datum_serialized_type_t::R_ARRAY,
-                                      datum_serialized_type_t::MAXVAL);
+                                      datum_serialized_type_t::BUF_R_OBJECT_INDEXED);
+
+static perfmon_counter_t pm_datum_full_deserializations;
+static perfmon_membership_t pm_datum_full_deserializations_membership(
+    &get_global_perfmon_collection(),
+    &pm_datum_full_deserializations,
+    "datum_full_deserializations");
+
+void note_full_datum_deserialization() {
+    // Datums are also deserialized outside of the thread pool, for example when
+    // loading the metadata, and there is nowhere to count that.
+    if (get_thread_id().threadnum >= 0) {
+        ++pm_datum_full_deserializations;
+    }
+}
 
 serialization_result_t datum_serialize(write_message_t *wm,
                                        datum_serialized_type_t type) {
@@ -109,6 +130,97 @@ serialization_result_t datum_serialize(
 // about whether datum serialization has changed from cluster version to cluster
 // version.
 
+/* The field index of BUF_R_OBJECT_INDEXED objects. Their serialization is the same
+as that of a BUF_R_OBJECT, except that a hash table over the keys follows the pairs:
+     varint ser_size
+     varint num_pairs
+     uint*_t offsets[num_pairs - 1]
+     pair data[num_pairs]
+     uint32_t slots[num_slots]
+Each slot holds the index of a pair, or FIELD_INDEX_EMPTY_SLOT. Keys are placed with
+linear probing, and `num_slots` follows from `num_pairs`. */
+
+// Freshly serialized objects with at least this many pairs get a field index. For
+// smaller ones, a binary search over the offset table is about as fast.
+const size_t MIN_INDEXED_OBJECT_PAIRS = 64;
+
+const uint32_t FIELD_INDEX_EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+std::atomic<bool> field_index_enabled(false);
+
+void set_datum_field_index_enabled(bool enabled) {
+    field_index_enabled.store(enabled);
+}
+
+bool datum_field_index_enabled() {
+    return field_index_enabled.load(std::memory_order_relaxed);
+}
+
+bool object_gets_field_index(size_t num_pairs) {
+    return datum_field_index_enabled()
+        && num_pairs >= MIN_INDEXED_OBJECT_PAIRS
+        && num_pairs < FIELD_INDEX_EMPTY_SLOT;
+}
+
+// Whether we can copy the existing serialization of the buffer-backed object `datum`.
+// We can't if it has a field index that we aren't allowed to write.
+bool reuse_object_serialization(const datum_t &datum,
+                                check_datum_serialization_errors_t check_errors) {
+    return datum.get_buf_ref() != NULL
+        && check_errors == check_datum_serialization_errors_t::NO
+        && (datum_field_index_enabled() || !datum.buf_ref_has_field_index());
+}
+
+// This is part of the serialization format, so it must never change. It's 32 bit
+// FNV-1a.
+uint32_t field_index_hash(const char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// A power of two with room for at least twice as many keys, so that the probe
+// sequences stay short.
+size_t field_index_num_slots(size_t num_pairs) {
+    size_t num_slots = 1;
+    while (num_slots < num_pairs * 2) {
+        num_slots *= 2;
+    }
+    return num_slots;
+}
+
+size_t field_index_serialized_size(size_t num_pairs) {
+    return field_index_num_slots(num_pairs) * serialize_universal_size_t<uint32_t>::value;
+}
+
+void serialize_field_index(write_message_t *wm, const std::vector<uint32_t> &key_hashes) {
+    std::vector<uint32_t> slots(field_index_num_slots(key_hashes.size()),
+                                FIELD_INDEX_EMPTY_SLOT);
+    const size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < key_hashes.size(); ++i) {
+        size_t slot = key_hashes[i] & mask;
+        while (slots[slot] != FIELD_INDEX_EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = static_cast<uint32_t>(i);
+    }
+    for (uint32_t pair_index : slots) {
+        serialize_universal(wm, pair_index);
+    }
+}
+
+// Whether `datum_object_serialize()` writes `datum` with a field index.
+bool datum_object_has_field_index(const datum_t &datum,
+                                  check_datum_serialization_errors_t check_errors) {
+    if (reuse_object_serialization(datum, check_errors)) {
+        return datum.buf_ref_has_field_index();
+    }
+    return object_gets_field_index(datum.obj_size());
+}
+
 /* Helper functions shared by datum_array_* and datum_object_* */
 
 // Keep in sync with offset_table_serialized_size
@@ -231,10 +343,11 @@ size_t offset_table_serialized_size(size_t num_elements,
 size_t datum_array_inner_serialized_size(
         const datum_t &datum,
         const std::vector<size_tree_node_t> &child_sizes,
+        size_t field_index_sz,
         datum_offset_size_t *offset_size_out) {
 
-    // The size of all (keys/)values
-    size_t elem_sz = 0;
+    // The size of all (keys/)values, and of the field index that follows them
+    size_t elem_sz = field_index_sz;
     for (size_t i = 0; i < child_sizes.size(); ++i) {
         elem_sz += child_sizes[i].size;
     }
@@ -275,7 +388,7 @@ size_t datum_array_serialized_size(const datum_t &datum,
             elem_sizes.push_back(std::move(elem_size));
         }
         datum_offset_size_t offset_size;
-        sz += datum_array_inner_serialized_size(datum, elem_sizes, &offset_size);
+        sz += datum_array_inner_serialized_size(datum, elem_sizes, 0, &offset_size);
 
         if (element_sizes_out != NULL) {
             *element_sizes_out = std::move(elem_sizes);
@@ -311,7 +424,7 @@ serialization_result_t datum_array_serialize(
     // The inner serialized size
     datum_offset_size_t offset_size;
     serialize_varint_uint64(wm,
-        datum_array_inner_serialized_size(datum, precomputed_sizes.child_sizes,
+        datum_array_inner_serialized_size(datum, precomputed_sizes.child_sizes, 0,
                                           &offset_size));
 
     serialize_offset_table(wm, datum.get_type(), precomputed_sizes.child_sizes,
@@ -363,8 +476,7 @@ size_t datum_object_serialized_size(const datum_t &datum,
 
     // Can we use an existing serialization?
     const shared_buf_ref_t<char> *existing_buf_ref = datum.get_buf_ref();
-    if (existing_buf_ref != NULL
-        && check_errors == check_datum_serialization_errors_t::NO) {
+    if (reuse_object_serialization(datum, check_errors)) {
 
         // We don't initialize element_sizes_out, but that's ok. We don't need it
         // if there already is a serialization.
@@ -382,8 +494,12 @@ size_t datum_object_serialized_size(const datum_t &datum,
             child_sizes.push_back(std::move(key_size));
             child_sizes.push_back(std::move(val_size));
         }
+        const size_t field_index_sz = object_gets_field_index(datum.obj_size())
+            ? field_index_serialized_size(datum.obj_size())
+            : 0;
         datum_offset_size_t offset_size;
-        sz += datum_array_inner_serialized_size(datum, child_sizes, &offset_size);
+        sz += datum_array_inner_serialized_size(datum, child_sizes, field_index_sz,
+                                                &offset_size);
 
         if (child_sizes_out != NULL) {
             *child_sizes_out = std::move(child_sizes);
@@ -408,8 +524,7 @@ serialization_result_t datum_object_serialize(
 
     // Can we use an existing serialization?
     const shared_buf_ref_t<char> *existing_buf_ref = datum.get_buf_ref();
-    if (existing_buf_ref != NULL
-        && check_errors == check_datum_serialization_errors_t::NO) {
+    if (reuse_object_serialization(datum, check_errors)) {
 
         // Subtract 1 for the type byte, which we don't have to rewrite
         wm->append(existing_buf_ref->get(), precomputed_sizes.size - 1);
@@ -417,10 +532,13 @@ serialization_result_t datum_object_serialize(
     }
 
     // The inner serialized size
+    const bool with_field_index = object_gets_field_index(datum.obj_size());
     datum_offset_size_t offset_size;
     serialize_varint_uint64(wm,
-        datum_array_inner_serialized_size(datum, precomputed_sizes.child_sizes,
-                                          &offset_size));
+        datum_array_inner_serialized_size(
+            datum, precomputed_sizes.child_sizes,
+            with_field_index ? field_index_serialized_size(datum.obj_size()) : 0,
+            &offset_size));
 
     serialize_offset_table(wm, datum.get_type(), precomputed_sizes.child_sizes,
                            offset_size);
@@ -428,11 +546,22 @@ serialization_result_t datum_object_serialize(
     // The pairs
     serialization_result_t res = serialization_result_t::SUCCESS;
     rassert(precomputed_sizes.child_sizes.size() == datum.obj_size() * 2);
+    std::vector<uint32_t> key_hashes;
+    if (with_field_index) {
+        key_hashes.reserve(datum.obj_size());
+    }
     for (size_t i = 0; i < datum.obj_size(); ++i) {
         auto pair = datum.get_pair(i);
         const size_tree_node_t &val_size = precomputed_sizes.child_sizes[i*2+1];
         res = res | datum_serialize(wm, pair.first);
         res = res | datum_serialize(wm, pair.second, check_errors, val_size);
+        if (with_field_index) {
+            key_hashes.push_back(field_index_hash(pair.first.data(), pair.first.size()));
+        }
+    }
+
+    if (with_field_index) {
+        serialize_field_index(wm, key_hashes);
     }
 
     return res;
@@ -585,7 +714,9 @@ serialization_result_t datum_serialize(
         }
     } break;
     case datum_t::R_OBJECT: {
-        res = res | datum_serialize(wm, datum_serialized_type_t::BUF_R_OBJECT);
+        res = res | datum_serialize(wm, datum_object_has_field_index(datum, check_errors)
+                                        ? datum_serialized_type_t::BUF_R_OBJECT_INDEXED
+                                        : datum_serialized_type_t::BUF_R_OBJECT);
         res = res | call_with_enough_stack<serialization_result_t>([&] () {
                 return datum_object_serialize(wm,
                                               datum,
@@ -652,6 +783,7 @@ archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum) {
         if (bad(res)) {
             return res;
         }
+        note_full_datum_deserialization();
         try {
             *datum = datum_t(std::move(value), limits);
         } catch (const base_exc_t &) {
@@ -729,6 +861,7 @@ archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum) {
         if (bad(res)) {
             return res;
         }
+        note_full_datum_deserialization();
         try {
             *datum = datum_t(std::move(value));
         } catch (const base_exc_t &) {
@@ -748,7 +881,8 @@ archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum) {
         }
     } break;
     case datum_serialized_type_t::BUF_R_ARRAY: // fallthru
-    case datum_serialized_type_t::BUF_R_OBJECT:
+    case datum_serialized_type_t::BUF_R_OBJECT: // fallthru
+    case datum_serialized_type_t::BUF_R_OBJECT_INDEXED:
     {
         // First read the serialized size of the buffer
         uint64_t ser_size;
@@ -775,11 +909,16 @@ archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum) {
         }
 
         // ...from which we create the datum_t
-        datum_t::type_t dtype = type == datum_serialized_type_t::BUF_R_ARRAY
-                                ? datum_t::R_ARRAY
-                                : datum_t::R_OBJECT;
         try {
-            *datum = datum_t(dtype, shared_buf_ref_t<char>(std::move(buf), 0));
+            if (type == datum_serialized_type_t::BUF_R_OBJECT_INDEXED) {
+                *datum = datum_t(datum_t::construct_indexed_object_t(),
+                                 shared_buf_ref_t<char>(std::move(buf), 0));
+            } else {
+                datum_t::type_t dtype = type == datum_serialized_type_t::BUF_R_ARRAY
+                                        ? datum_t::R_ARRAY
+                                        : datum_t::R_OBJECT;
+                *datum = datum_t(dtype, shared_buf_ref_t<char>(std::move(buf), 0));
+            }
         } catch (const base_exc_t &) {
             return archive_result_t::RANGE_ERROR;
         }
@@ -826,6 +965,11 @@ datum_t datum_deserialize_from_buf(const shared_buf_ref_t<char> &buf, size_t at_
         const size_t data_offset = at_offset + static_cast<size_t>(read_stream.tell());
         return datum_t(datum_t::R_OBJECT, buf.make_child(data_offset));
     }
+    case datum_serialized_type_t::BUF_R_OBJECT_INDEXED: {
+        const size_t data_offset = at_offset + static_cast<size_t>(read_stream.tell());
+        return datum_t(datum_t::construct_indexed_object_t(),
+                       buf.make_child(data_offset));
+    }
     case datum_serialized_type_t::R_BINARY: {
         const size_t data_offset = at_offset + static_cast<size_t>(read_stream.tell());
         return datum_t(datum_t::construct_binary_t(),
@@ -853,9 +997,14 @@ datum_t datum_deserialize_from_buf(const shared_buf_ref_t<char> &buf, size_t at_
     }
 }
 
+datum_string_t datum_deserialize_key_from_buf(const shared_buf_ref_t<char> &buf,
+                                              size_t at_offset) {
+    return datum_string_t(buf.make_child(at_offset));
+}
+
 std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
         const shared_buf_ref_t<char> &buf, size_t at_offset) {
-    datum_string_t key(buf.make_child(at_offset));
+    datum_string_t key = datum_deserialize_key_from_buf(buf, at_offset);
     // Relies on the fact that the datum_string_t serialization format hasn't
     // changed, specifically that we would still get the same size if we re-serialized
     // the datum_string_t now.
@@ -866,6 +1015,55 @@ std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
     return std::make_pair(std::move(key), std::move(value));
 }
 
+bool datum_find_field_in_index(const shared_buf_ref_t<char> &object,
+                               const datum_string_t &key,
+                               size_t *offset_out) {
+    const size_t inner_size = read_inner_serialized_size_from_buf(object);
+    const size_t num_pairs = datum_get_array_size(object);
+    const size_t num_slots = field_index_num_slots(num_pairs);
+    const size_t slot_size = serialize_universal_size_t<uint32_t>::value;
+    const size_t index_end = varint_uint64_serialized_size(inner_size) + inner_size;
+    guarantee(inner_size >= num_slots * slot_size, "Corrupted datum field index.");
+    object.guarantee_in_boundary(index_end);
+    const size_t index_offset = index_end - num_slots * slot_size;
+
+    const size_t mask = num_slots - 1;
+    size_t slot = field_index_hash(key.data(), key.size()) & mask;
+    for (size_t probes = 0; probes < num_slots; ++probes) {
+        buffer_read_stream_t read_stream(object.get() + index_offset + slot * slot_size,
+                                         slot_size);
+        uint32_t pair_index;
+        guarantee_deserialization(deserialize_universal(&read_stream, &pair_index),
+                                  "datum field index");
+        if (pair_index == FIELD_INDEX_EMPTY_SLOT) {
+            return false;
+        }
+        guarantee(pair_index < num_pairs, "Corrupted datum field index.");
+        const size_t offset = datum_get_element_offset(object, pair_index);
+        if (key.compare(datum_deserialize_key_from_buf(object, offset)) == 0) {
+            *offset_out = offset;
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+/* The format of `lhs` and `rhs` is:
+     varint ser_size
+     char data[ser_size] */
+bool datum_bufs_identical(const shared_buf_ref_t<char> &lhs,
+                          const shared_buf_ref_t<char> &rhs) {
+    const size_t inner_size = read_inner_serialized_size_from_buf(lhs);
+    if (inner_size != read_inner_serialized_size_from_buf(rhs)) {
+        return false;
+    }
+    const size_t size = varint_uint64_serialized_size(inner_size) + inner_size;
+    lhs.guarantee_in_boundary(size);
+    rhs.guarantee_in_boundary(size);
+    return lhs.get() == rhs.get() || memcmp(lhs.get(), rhs.get(), size) == 0;
+}
+
 /* The format of `array` is:
      varint ser_size
      varint num_elements
@@ -1006,4 +1204,255 @@ MUST_USE archive_result_t datum_deserialize(
     return archive_result_t::SUCCESS;
 }
 
+void datum_serialize_array_header(write_message_t *wm, size_t num_elements) {
+    datum_serialize(wm, datum_serialized_type_t::R_ARRAY);
+    serialize_varint_uint64(wm, num_elements);
+}
+
+void datum_serialize_object_header(write_message_t *wm, size_t num_pairs) {
+    datum_serialize(wm, datum_serialized_type_t::R_OBJECT);
+    serialize_varint_uint64(wm, num_pairs);
+}
+
+bool datum_serialize_by_reference(write_message_t *wm, const datum_t &datum,
+                                  size_t min_body_size,
+                                  shared_buf_ref_t<char> *body_out,
+                                  size_t *body_size_out) {
+    const shared_buf_ref_t<char> *existing_buf_ref = datum.get_buf_ref();
+    if (existing_buf_ref == nullptr
+        || (datum.get_type() == datum_t::R_OBJECT
+            && !reuse_object_serialization(
+                datum, check_datum_serialization_errors_t::NO))) {
+        return false;
+    }
+    const size_t inner_size = read_inner_serialized_size_from_buf(*existing_buf_ref);
+    const size_t body_size = varint_uint64_serialized_size(inner_size) + inner_size;
+    if (body_size < min_body_size) {
+        return false;
+    }
+    existing_buf_ref->guarantee_in_boundary(body_size);
+
+    datum_serialize(wm, datum.get_type() == datum_t::R_ARRAY
+                        ? datum_serialized_type_t::BUF_R_ARRAY
+                        : datum.buf_ref_has_field_index()
+                          ? datum_serialized_type_t::BUF_R_OBJECT_INDEXED
+                          : datum_serialized_type_t::BUF_R_OBJECT);
+    *body_out = *existing_buf_ref;
+    *body_size_out = body_size;
+    return true;
+}
+
+// A cursor over a serialized datum that was sent by a client.  Queries are decoded
+// byte by byte, so this reads straight from the buffer rather than going through
+// `read_stream_t`, and checks every length against the bytes that are actually left
+// before anything is allocated.
+class json_deserialization_cursor_t {
+public:
+    json_deserialization_cursor_t(const char *data, size_t size)
+        : pos_(data), end_(data + size) { }
+
+    size_t bytes_left() const { return end_ - pos_; }
+
+    MUST_USE archive_result_t read(void *out, size_t n) {
+        if (n > bytes_left()) {
+            return archive_result_t::SOCK_EOF;
+        }
+        memcpy(out, pos_, n);
+        pos_ += n;
+        return archive_result_t::SUCCESS;
+    }
+
+    MUST_USE archive_result_t read_varint(uint64_t *value_out) {
+        uint64_t value = 0;
+        for (int offset = 0; pos_ != end_; offset += 7) {
+            const uint64_t x = static_cast<uint8_t>(*pos_) & ((1 << 7) - 1);
+            const bool last = (static_cast<uint8_t>(*pos_) & (1 << 7)) == 0;
+            ++pos_;
+            if (offset == 63 && (!last || x > 1)) {
+                return archive_result_t::RANGE_ERROR;
+            }
+            value |= x << offset;
+            if (last) {
+                *value_out = value;
+                return archive_result_t::SUCCESS;
+            }
+        }
+        return archive_result_t::SOCK_EOF;
+    }
+
+    // Reads a serialized `datum_string_t` into memory owned by `allocator`.
+    MUST_USE archive_result_t read_string(rapidjson::Document::AllocatorType *allocator,
+                                          const char **str_out,
+                                          rapidjson::SizeType *length_out) {
+        uint64_t length;
+        archive_result_t res = read_varint(&length);
+        if (bad(res)) { return res; }
+        if (length > bytes_left()) {
+            return archive_result_t::SOCK_EOF;
+        }
+        if (length >= std::numeric_limits<rapidjson::SizeType>::max()) {
+            return archive_result_t::RANGE_ERROR;
+        }
+        char *str = static_cast<char *>(allocator->Malloc(length + 1));
+        memcpy(str, pos_, length);
+        str[length] = '\0';
+        pos_ += length;
+        *str_out = str;
+        *length_out = static_cast<rapidjson::SizeType>(length);
+        return archive_result_t::SUCCESS;
+    }
+
+private:
+    const char *pos_;
+    const char *end_;
+};
+
+MUST_USE archive_result_t json_deserialize_value(
+        json_deserialization_cursor_t *cursor,
+        rapidjson::Document::AllocatorType *allocator,
+        rapidjson::Value *out);
+
+// Arrays and objects recurse, so they make sure that there is enough stack left.
+MUST_USE archive_result_t json_deserialize_nested_value(
+        json_deserialization_cursor_t *cursor,
+        rapidjson::Document::AllocatorType *allocator,
+        rapidjson::Value *out) {
+    return call_with_enough_stack<archive_result_t>([&] () {
+            return json_deserialize_value(cursor, allocator, out);
+        }, MIN_DATUM_SERIALIZATION_STACK_SPACE);
+}
+
+archive_result_t json_deserialize_value(
+        json_deserialization_cursor_t *cursor,
+        rapidjson::Document::AllocatorType *allocator,
+        rapidjson::Value *out) {
+    int8_t type;
+    archive_result_t res = cursor->read(&type, sizeof(type));
+    if (bad(res)) { return res; }
+
+    switch (static_cast<datum_serialized_type_t>(type)) {
+    case datum_serialized_type_t::R_NULL: {
+        out->SetNull();
+    } break;
+    case datum_serialized_type_t::R_BOOL: {
+        int8_t value;
+        res = cursor->read(&value, sizeof(value));
+        if (bad(res)) { return res; }
+        if (value != 0 && value != 1) {
+            return archive_result_t::RANGE_ERROR;
+        }
+        out->SetBool(value == 1);
+    } break;
+    case datum_serialized_type_t::DOUBLE: {
+        double value;
+        res = cursor->read(&value, sizeof(value));
+        if (bad(res)) { return res; }
+        if (!std::isfinite(value)) {
+            return archive_result_t::RANGE_ERROR;
+        }
+        out->SetDouble(value);
+    } break;
+    case datum_serialized_type_t::INT_NEGATIVE:  // fall through
+    case datum_serialized_type_t::INT_POSITIVE: {
+        uint64_t unsigned_value;
+        res = cursor->read_varint(&unsigned_value);
+        if (bad(res)) { return res; }
+        if (unsigned_value > max_dbl_int) {
+            return archive_result_t::RANGE_ERROR;
+        }
+        // The term parser expects integral numbers to be rapidjson integers, just
+        // like it gets them from the JSON parser.
+        const int64_t value = static_cast<int64_t>(unsigned_value);
+        if (static_cast<datum_serialized_type_t>(type)
+                == datum_serialized_type_t::INT_POSITIVE) {
+            out->SetInt64(value);
+        } else if (value == 0) {
+            out->SetDouble(-0.0);
+        } else {
+            out->SetInt64(-value);
+        }
+    } break;
+    case datum_serialized_type_t::R_STR: {
+        const char *str;
+        rapidjson::SizeType length;
+        res = cursor->read_string(allocator, &str, &length);
+        if (bad(res)) { return res; }
+        out->SetString(rapidjson::StringRef(str, length));
+    } break;
+    case datum_serialized_type_t::R_BINARY: {
+        const char *str;
+        rapidjson::SizeType length;
+        res = cursor->read_string(allocator, &str, &length);
+        if (bad(res)) { return res; }
+        rapidjson::Value ptype =
+            pseudo::encode_base64_ptype(datum_string_t(length, str), allocator);
+        out->Swap(ptype);
+    } break;
+    case datum_serialized_type_t::R_ARRAY: {
+        uint64_t num_elements;
+        res = cursor->read_varint(&num_elements);
+        if (bad(res)) { return res; }
+        // Every element takes up at least one byte.
+        if (num_elements > cursor->bytes_left()) {
+            return archive_result_t::SOCK_EOF;
+        }
+        out->SetArray();
+        out->Reserve(static_cast<rapidjson::SizeType>(num_elements), *allocator);
+        for (uint64_t i = 0; i < num_elements; ++i) {
+            rapidjson::Value element;
+            res = json_deserialize_nested_value(cursor, allocator, &element);
+            if (bad(res)) { return res; }
+            out->PushBack(element, *allocator);
+        }
+    } break;
+    case datum_serialized_type_t::R_OBJECT: {
+        uint64_t num_pairs;
+        res = cursor->read_varint(&num_pairs);
+        if (bad(res)) { return res; }
+        if (num_pairs > cursor->bytes_left()) {
+            return archive_result_t::SOCK_EOF;
+        }
+        out->SetObject();
+        out->MemberReserve(static_cast<rapidjson::SizeType>(num_pairs), *allocator);
+        for (uint64_t i = 0; i < num_pairs; ++i) {
+            const char *key;
+            rapidjson::SizeType key_length;
+            res = cursor->read_string(allocator, &key, &key_length);
+            if (bad(res)) { return res; }
+            rapidjson::Value value;
+            res = json_deserialize_nested_value(cursor, allocator, &value);
+            if (bad(res)) { return res; }
+            rapidjson::Value key_value(rapidjson::StringRef(key, key_length));
+            out->AddMember(key_value, value, *allocator);
+        }
+    } break;
+    case datum_serialized_type_t::BUF_R_ARRAY:  // fall through
+    case datum_serialized_type_t::BUF_R_OBJECT:  // fall through
+    case datum_serialized_type_t::BUF_R_OBJECT_INDEXED:  // fall through
+    case datum_serialized_type_t::UNINITIALIZED:  // fall through
+    case datum_serialized_type_t::MINVAL:  // fall through
+    case datum_serialized_type_t::MAXVAL:  // fall through
+    default:
+        return archive_result_t::RANGE_ERROR;
+    }
+
+    return archive_result_t::SUCCESS;
+}
+
+archive_result_t datum_deserialize_to_json(const char *data, size_t size,
+                                           rapidjson::Document *doc_out) {
+    json_deserialization_cursor_t cursor(data, size);
+    rapidjson::Value value;
+    archive_result_t res =
+        json_deserialize_nested_value(&cursor, &doc_out->GetAllocator(), &value);
+    if (bad(res)) {
+        return res;
+    }
+    if (cursor.bytes_left() != 0) {
+        return archive_result_t::RANGE_ERROR;
+    }
+    doc_out->Swap(value);
+    return archive_result_t::SUCCESS;
+}
+
 }  // namespace ql
@@ -7,6 +7,7 @@
 #include "containers/archive/buffer_group_stream.hpp"
 #include "containers/counted.hpp"
 #include "containers/shared_buffer.hpp"
+#include "rapidjson/document.h"
 #include "rdb_protocol/datum_string.hpp"
 
 namespace ql {
@@ -50,6 +51,8 @@ serialization_result_t datum_serialize(write_message_t *wm, const datum_t &datum
 archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum);
 
 datum_t datum_deserialize_from_buf(const shared_buf_ref_t<char> &buf, size_t at_offset);
+datum_string_t datum_deserialize_key_from_buf(const shared_buf_ref_t<char> &buf,
+                                              size_t at_offset);
 std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
         const shared_buf_ref_t<char> &buf, size_t at_offset);
 
@@ -57,12 +60,61 @@ std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
 size_t datum_get_element_offset(const shared_buf_ref_t<char> &array, size_t index);
 // Reads the number of elements in the array stored in the buffer
 size_t datum_get_array_size(const shared_buf_ref_t<char> &array);
+// Looks `key` up in the field index of a serialized object that has one (see
+// `datum_t::construct_indexed_object_t`). Returns `false` if the object has no such
+// field, and otherwise the offset of the pair through `offset_out`.
+MUST_USE bool datum_find_field_in_index(const shared_buf_ref_t<char> &object,
+                                        const datum_string_t &key,
+                                        size_t *offset_out);
+
+// Whether freshly serialized objects with many fields get a field index, making them
+// `BUF_R_OBJECT_INDEXED` instead of `BUF_R_OBJECT`. Servers and binary protocol
+// clients from before 2.5 can't read those, so this is off unless it's turned on with
+// `--datum-field-index`. Set it before any datums get serialized. Either way, objects
+// with an index can always be read.
+void set_datum_field_index_enabled(bool enabled);
+bool datum_field_index_enabled();
+
+// Whether the two buffers hold the same serialized array or object. If they do, the
+// datums are equal without having to look at their elements.
+bool datum_bufs_identical(const shared_buf_ref_t<char> &lhs,
+                          const shared_buf_ref_t<char> &rhs);
+
+// Counts an array or object that got all of its elements deserialized at once, rather
+// than read from its serialization when they are accessed. These show up in the
+// `datum_full_deserializations` stat, so we can check that hot paths stay lazy.
+void note_full_datum_deserialization();
 
 size_t datum_serialized_size(const datum_string_t &s);
 serialization_result_t datum_serialize(write_message_t *wm, const datum_string_t &s);
 
 MUST_USE archive_result_t datum_deserialize(read_stream_t *s, datum_string_t *out);
 
+// Write the prefix of an array or object in the plain (R_ARRAY / R_OBJECT) format,
+// which must then be followed by `num_elements` serialized datums or `num_pairs`
+// serialized `datum_string_t` keys and datum values.  This lets the client protocol
+// stream out a response without building an array datum and its offset table first.
+void datum_serialize_array_header(write_message_t *wm, size_t num_elements);
+void datum_serialize_object_header(write_message_t *wm, size_t num_pairs);
+
+// If `datum` is an array or object that is still backed by its serialization, as
+// rows are that were read from disk, and the serialization is at least
+// `min_body_size` bytes long, writes its type prefix to `wm` and returns the rest of
+// the serialization through `body_out` and `body_size_out` instead of copying it.
+// Returns `false` and writes nothing otherwise.
+MUST_USE bool datum_serialize_by_reference(write_message_t *wm, const datum_t &datum,
+                                           size_t min_body_size,
+                                           shared_buf_ref_t<char> *body_out,
+                                           size_t *body_size_out);
+
+// Decodes a serialized datum that was sent by a client straight into a rapidjson
+// document, the same representation that the JSON client protocol parses queries
+// into.  Only the self-contained formats are accepted: the offset tables of
+// buffer-backed arrays and objects are trusted whenever they are read, so they must
+// not come from the outside.  Fails unless all of `size` bytes are consumed.
+MUST_USE archive_result_t datum_deserialize_to_json(const char *data, size_t size,
+                                                    rapidjson::Document *doc_out);
+
 // The versioned serialization functions.
 template <cluster_version_t W>
 size_t serialized_size(const datum_t &datum) {
@@ -981,6 +981,21 @@ private:
     backtrace_id_t bt;
 };
 
+// Puts the elements of all the lists in `rows` into a single list, for
+// `op_t::apply_to_rows`.
+datums_t concat_rows(const std::vector<datums_t> &rows) {
+    size_t size = 0;
+    for (const datums_t &row : rows) {
+        size += row.size();
+    }
+    datums_t ret;
+    ret.reserve(size);
+    for (const datums_t &row : rows) {
+        ret.insert(ret.end(), row.begin(), row.end());
+    }
+    return ret;
+}
+
 class map_trans_t : public ungrouped_op_t {
 public:
     explicit map_trans_t(const map_wire_func_t &_f)
@@ -989,13 +1004,24 @@ private:
     virtual void lst_transform(
         env_t *env, datums_t *lst, const std::function<datum_t()> &) {
         try {
-            for (auto it = lst->begin(); it != lst->end(); ++it) {
-                *it = f->call(env, *it)->as_datum();
-            }
+            f->map_batch(env, lst);
         } catch (const datum_exc_t &e) {
             throw exc_t(e, f->backtrace(), 1);
         }
     }
+    virtual bool can_apply_to_rows() const {
+        return f->is_deterministic() == deterministic_t::always;
+    }
+    virtual void apply_to_rows(env_t *env, std::vector<datums_t> *rows) {
+        datums_t all = concat_rows(*rows);
+        lst_transform(env, &all, std::function<datum_t()>());
+        auto it = all.begin();
+        for (datums_t &row : *rows) {
+            for (datum_t &el : row) {
+                el = std::move(*it++);
+            }
+        }
+    }
     counted_t<const func_t> f;
 };
 
@@ -1041,19 +1067,35 @@ public:
 private:
     virtual void lst_transform(
         env_t *env, datums_t *lst, const std::function<datum_t()> &) {
-        auto it = lst->begin();
-        auto loc = it;
         try {
-            for (it = lst->begin(); it != lst->end(); ++it) {
-                if (f->filter_call(env, *it, default_val)) {
+            f->filter_batch(env, lst, default_val);
+        } catch (const datum_exc_t &e) {
+            throw exc_t(e, f->backtrace(), 1);
+        }
+    }
+    virtual bool can_apply_to_rows() const {
+        return f->is_deterministic() == deterministic_t::always
+            && (!default_val.has()
+                || default_val->is_deterministic() == deterministic_t::always);
+    }
+    virtual void apply_to_rows(env_t *env, std::vector<datums_t> *rows) {
+        std::vector<bool> matches;
+        try {
+            f->match_batch(env, concat_rows(*rows), default_val, &matches);
+        } catch (const datum_exc_t &e) {
+            throw exc_t(e, f->backtrace(), 1);
+        }
+        size_t i = 0;
+        for (datums_t &row : *rows) {
+            auto loc = row.begin();
+            for (auto it = row.begin(); it != row.end(); ++it, ++i) {
+                if (matches[i]) {
                     std::swap(*loc, *it);
                     ++loc;
                 }
             }
-        } catch (const datum_exc_t &e) {
-            throw exc_t(e, f->backtrace(), 1);
+            row.erase(loc, row.end());
         }
-        lst->erase(loc, lst->end());
     }
     counted_t<const func_t> f, default_val;
 };
@@ -364,6 +364,15 @@ public:
                             groups_t *groups,
                             // Returns a datum that might be null
                             const std::function<datum_t()> &lazy_sindex_val) = 0;
+    // Whether `apply_to_rows` can be used instead.  True for the transformations that
+    // look at every row on its own, deterministically and without the secondary index
+    // value.
+    virtual bool can_apply_to_rows() const { return false; }
+    // Does the same as calling `operator()` on an ungrouped list for each element of
+    // `rows` in turn, but evaluates the functions on all the rows at once.  If this
+    // throws, `rows` is left in an unspecified state, and the error isn't necessarily
+    // the one that calling `operator()` on each of them would have run into first.
+    virtual void apply_to_rows(env_t *, std::vector<datums_t> *) { unreachable(); }
 };
 
 struct limit_read_t {
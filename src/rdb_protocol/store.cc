@@ -298,6 +298,7 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         guarantee(res != NULL);
         res->server_uuids.insert(cserver.first->get_uuid());
         res->addrs.insert(cserver.first->get_stop_addr());
+        res->filter_addrs.insert(cserver.first->get_filter_stop_addr());
     }
 
     void operator()(const changefeed_limit_subscribe_t &s) {
@@ -402,8 +403,8 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
 
         auto cserver = store->changefeed_server(s.region);
         if (cserver.first != nullptr) {
-            if (boost::optional<uint64_t> stamp
-                    = cserver.first->get_stamp(s.addr, cserver.second)) {
+            if (boost::optional<uint64_t> stamp = cserver.first->get_stamp(
+                    s.addr, s.filter ? &*s.filter : nullptr, ctx, cserver.second)) {
                 changefeed_stamp_response_t out;
                 out.stamp_infos = std::map<uuid_u, shard_stamp_info_t>();
                 (*out.stamp_infos)[cserver.first->get_uuid()] = shard_stamp_info_t{
@@ -431,8 +432,8 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         if (cserver.first != nullptr) {
             res->resp = changefeed_point_stamp_response_t::valid_response_t();
             auto *vres = &*res->resp;
-            if (boost::optional<uint64_t> stamp
-                    = cserver.first->get_stamp(s.addr, cserver.second)) {
+            if (boost::optional<uint64_t> stamp = cserver.first->get_stamp(
+                    s.addr, s.filter ? &*s.filter : nullptr, ctx, cserver.second)) {
                 vres->stamp = std::make_pair(cserver.first->get_uuid(), *stamp);
             } else {
                 // The client was removed, so no future messages are coming.
@@ -4,6 +4,7 @@
 #include "arch/address.hpp"
 #include "clustering/administration/jobs/report.hpp"
 #include "concurrency/cross_thread_watchable.hpp"
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/rdb_backtrace.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/func.hpp"
@@ -231,6 +232,10 @@ term_t::term_t(const raw_term_t &_src)
 
 term_t::~term_t() { }
 
+scoped_ptr_t<const compiled_term_t> term_t::lower(func_compiler_t *) const {
+    return scoped_ptr_t<const compiled_term_t>();
+}
+
 // Uncomment the define to enable instrumentation (you'll be able to see where
 // you are in query execution when something goes wrong).
 // #define INSTRUMENT 1
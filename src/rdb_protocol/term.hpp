@@ -21,6 +21,8 @@ class table_t;
 class table_slice_t;
 class var_captures_t;
 class compile_env_t;
+class compiled_term_t;
+class func_compiler_t;
 enum class deterministic_t;
 
 enum eval_flags_t {
@@ -67,6 +69,10 @@ public:
     // in sindex_manager.
     virtual bool is_simple_selector() const { return false; }
 
+    // Lowers this term into a `compiled_term_t` for the fast path of `reql_func_t`
+    // (see `compiled_func.hpp`), or returns an empty pointer if it doesn't support that.
+    virtual scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const;
+
 protected:
     // Union term is a friend so we can steal arguments from an array in an optarg.
     friend class union_term_t;
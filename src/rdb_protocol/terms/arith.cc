@@ -4,12 +4,80 @@
 #include <cmath>
 #include <limits>
 
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/geo/exceptions.hpp"
 #include "rdb_protocol/op.hpp"
 #include "rdb_protocol/pseudo_time.hpp"
 
 namespace ql {
 
+// Only handles numbers, and adding strings. The interpreter deals with times, arrays
+// and errors such as division by zero.
+class compiled_arith_t : public compiled_term_t {
+public:
+    compiled_arith_t(Term::TermType _type, compiled_terms_t &&_args)
+        : type(_type), args(std::move(_args)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        datum_t acc = args[0]->eval(env);
+        for (size_t i = 1; i < args.size(); ++i) {
+            acc = apply(acc, args[i]->eval(env));
+        }
+        return acc;
+    }
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        args[0]->eval_batch(batch, selection, out);
+        std::vector<datum_t> rhs(batch->size());
+        for (size_t a = 1; a < args.size(); ++a) {
+            batch_selection_t active = remaining_rows(batch, selection);
+            args[a]->eval_batch(batch, active, &rhs);
+            for (uint32_t i : active) {
+                if (batch->bailed_out(i)) {
+                    continue;
+                }
+                try {
+                    (*out)[i] = apply((*out)[i], rhs[i]);
+                } catch (const compiled_term_bailout_exc_t &) {
+                    batch->bail_out(i);
+                } catch (const base_exc_t &) {
+                    batch->bail_out(i);
+                }
+            }
+        }
+    }
+private:
+    datum_t apply(const datum_t &lhs, const datum_t &rhs) const {
+        if (lhs.get_type() == datum_t::R_NUM && rhs.get_type() == datum_t::R_NUM) {
+            double res;
+            switch (type) {
+            case Term::ADD: res = lhs.as_num() + rhs.as_num(); break;
+            case Term::SUB: res = lhs.as_num() - rhs.as_num(); break;
+            case Term::MUL: res = lhs.as_num() * rhs.as_num(); break;
+            case Term::DIV:
+                if (rhs.as_num() == 0) {
+                    compiled_term_bail_out();
+                }
+                res = lhs.as_num() / rhs.as_num();
+                break;
+            default: unreachable();
+            }
+            if (!risfinite(res)) {
+                compiled_term_bail_out();
+            }
+            return datum_t(res);
+        } else if (type == Term::ADD
+                   && lhs.get_type() == datum_t::R_STR
+                   && rhs.get_type() == datum_t::R_STR) {
+            return datum_t(concat(lhs.as_str(), rhs.as_str()));
+        }
+        compiled_term_bail_out();
+    }
+
+    const Term::TermType type;
+    const compiled_terms_t args;
+};
+
 class arith_term_t : public op_term_t {
 public:
     arith_term_t(compile_env_t *env, const raw_term_t &term)
@@ -34,6 +102,14 @@ public:
 
     virtual const char *name() const { return namestr; }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        compiled_terms_t args;
+        if (has_optargs() || !compiler->lower_args(get_original_args(), &args)) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return make_scoped<compiled_arith_t>(get_src().type(), std::move(args));
+    }
+
 private:
     datum_t add(datum_t lhs,
                 datum_t rhs,
@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/op.hpp"
@@ -13,10 +14,66 @@ namespace ql {
 // have non-boolean values that evaluate to true, but then we decided not to do
 // that.
 
+// Like the terms, these return the last argument that they evaluate.
+class compiled_and_or_t : public compiled_term_t {
+public:
+    compiled_and_or_t(bool _is_and, compiled_terms_t &&_args)
+        : is_and(_is_and), args(std::move(_args)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        datum_t v = datum_t::boolean(is_and);
+        for (size_t i = 0; i < args.size(); ++i) {
+            v = args[i]->eval(env);
+            if (v.as_bool() != is_and) break;
+        }
+        return v;
+    }
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        batch_selection_t active = selection;
+        for (uint32_t i : active) {
+            (*out)[i] = datum_t::boolean(is_and);
+        }
+        for (size_t a = 0; a < args.size() && !active.empty(); ++a) {
+            args[a]->eval_batch(batch, active, out);
+            batch_selection_t still_active;
+            still_active.reserve(active.size());
+            for (uint32_t i : active) {
+                if (!batch->bailed_out(i) && (*out)[i].as_bool() == is_and) {
+                    still_active.push_back(i);
+                }
+            }
+            active.swap(still_active);
+        }
+    }
+private:
+    const bool is_and;
+    const compiled_terms_t args;
+};
+
+scoped_ptr_t<const compiled_term_t> lower_and_or(
+        bool is_and,
+        const std::vector<counted_t<const term_t> > &original_args,
+        func_compiler_t *compiler) {
+    compiled_terms_t args;
+    if (!compiler->lower_args(original_args, &args)) {
+        return scoped_ptr_t<const compiled_term_t>();
+    }
+    return make_scoped<compiled_and_or_t>(is_and, std::move(args));
+}
+
 class and_term_t : public op_term_t {
 public:
     and_term_t(compile_env_t *env, const raw_term_t &term)
         : op_term_t(env, term, argspec_t(0, -1)) { }
+
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        if (has_optargs()) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return lower_and_or(true, get_original_args(), compiler);
+    }
+
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -34,6 +91,14 @@ class or_term_t : public op_term_t {
 public:
     or_term_t(compile_env_t *env, const raw_term_t &term)
         : op_term_t(env, term, argspec_t(0, -1)) { }
+
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        if (has_optargs()) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return lower_and_or(false, get_original_args(), compiler);
+    }
+
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
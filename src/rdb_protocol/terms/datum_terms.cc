@@ -3,6 +3,7 @@
 
 #include <string>
 
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/op.hpp"
 
 namespace ql {
@@ -22,6 +23,10 @@ public:
         return false;
     }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *) const {
+        return make_compiled_constant(datum);
+    }
+
 private:
     virtual void accumulate_captures(var_captures_t *) const { /* do nothing */ }
     virtual deterministic_t is_deterministic() const { return deterministic_t::always; }
@@ -4,6 +4,7 @@
 #include <string>
 #include <functional>
 
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/op.hpp"
@@ -272,6 +273,64 @@ private:
     virtual const char *name() const { return "has_fields"; }
 };
 
+// Field access on a plain object, shared by `get_field` and `bracket`. Sequences,
+// pseudotypes, numeric indexes and missing fields are left to the interpreter.
+class compiled_get_field_t : public compiled_term_t {
+public:
+    explicit compiled_get_field_t(compiled_terms_t &&_args)
+        : args(std::move(_args)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        datum_t obj = args[0]->eval(env);
+        datum_t key = args[1]->eval(env);
+        if (obj.get_type() != datum_t::R_OBJECT || obj.is_ptype()
+            || key.get_type() != datum_t::R_STR) {
+            compiled_term_bail_out();
+        }
+        datum_t res = obj.get_field(key.as_str(), NOTHROW);
+        if (!res.has()) {
+            compiled_term_bail_out();
+        }
+        return res;
+    }
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        args[0]->eval_batch(batch, selection, out);
+        batch_selection_t active = remaining_rows(batch, selection);
+        std::vector<datum_t> keys(batch->size());
+        args[1]->eval_batch(batch, active, &keys);
+        for (uint32_t i : active) {
+            if (batch->bailed_out(i)) {
+                continue;
+            }
+            const datum_t &obj = (*out)[i];
+            if (obj.get_type() != datum_t::R_OBJECT || obj.is_ptype()
+                || keys[i].get_type() != datum_t::R_STR) {
+                batch->bail_out(i);
+                continue;
+            }
+            datum_t res = obj.get_field(keys[i].as_str(), NOTHROW);
+            if (!res.has()) {
+                batch->bail_out(i);
+                continue;
+            }
+            (*out)[i] = std::move(res);
+        }
+    }
+private:
+    const compiled_terms_t args;
+};
+
+scoped_ptr_t<const compiled_term_t> lower_get_field(
+        const std::vector<counted_t<const term_t> > &original_args,
+        func_compiler_t *compiler) {
+    compiled_terms_t args;
+    if (!compiler->lower_args(original_args, &args)) {
+        return scoped_ptr_t<const compiled_term_t>();
+    }
+    return make_scoped<compiled_get_field_t>(std::move(args));
+}
+
 class get_field_term_t : public obj_or_seq_op_term_t {
 public:
     get_field_term_t(compile_env_t *env, const raw_term_t &term)
@@ -281,6 +340,13 @@ public:
         return recursive_is_simple_selector();
     }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        if (has_optargs()) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return lower_get_field(get_original_args(), compiler);
+    }
+
 private:
     virtual scoped_ptr_t<val_t> obj_eval(
         scope_env_t *env, args_t *args, const scoped_ptr_t<val_t> &v0) const {
@@ -301,6 +367,13 @@ public:
         return recursive_is_simple_selector();
     }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        if (has_optargs()) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return lower_get_field(get_original_args(), compiler);
+    }
+
 private:
     scoped_ptr_t<val_t> obj_eval_dereferenced(
         const scoped_ptr_t<val_t> &v0, const scoped_ptr_t<val_t> &v1) const {
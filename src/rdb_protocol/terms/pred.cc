@@ -1,6 +1,10 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/terms.hpp"
 
+#include <functional>
+#include <vector>
+
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/op.hpp"
 
 namespace ql {
@@ -28,41 +32,181 @@ bool datum_ge(const datum_t &lhs, const datum_t &rhs) {
     return lhs.cmp(rhs) >= 0;
 }
 
+// The same comparisons for numbers, in a loop that the compiler can vectorize.
+template <class cmp_t>
+void compare_numbers(const std::vector<double> &lhs,
+                     const std::vector<double> &rhs,
+                     std::vector<uint8_t> *out) {
+    cmp_t cmp;
+    const size_t n = lhs.size();
+    const double *l = lhs.data();
+    const double *r = rhs.data();
+    uint8_t *o = out->data();
+    for (size_t i = 0; i < n; ++i) {
+        o[i] = cmp(l[i], r[i]);
+    }
+}
+
+typedef void (*compare_numbers_t)(const std::vector<double> &lhs,
+                                  const std::vector<double> &rhs,
+                                  std::vector<uint8_t> *out);
+
+class compiled_predicate_t : public compiled_term_t {
+public:
+    compiled_predicate_t(bool (*_pred)(const datum_t &lhs, const datum_t &rhs),
+                         compare_numbers_t _pred_numbers,
+                         bool _invert,
+                         compiled_terms_t &&_args)
+        : pred(_pred), pred_numbers(_pred_numbers), invert(_invert),
+          args(std::move(_args)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        datum_t lhs = args[0]->eval(env);
+        for (size_t i = 1; i < args.size(); ++i) {
+            datum_t rhs = args[i]->eval(env);
+            if (!(pred)(lhs, rhs)) {
+                return datum_t::boolean(false ^ invert);
+            }
+            lhs = rhs;
+        }
+        return datum_t::boolean(true ^ invert);
+    }
+
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        std::vector<datum_t> lhs(batch->size());
+        std::vector<datum_t> rhs(batch->size());
+        std::vector<uint8_t> passed(batch->size());
+        args[0]->eval_batch(batch, selection, &lhs);
+        batch_selection_t active = remaining_rows(batch, selection);
+        for (size_t a = 1; a < args.size() && !active.empty(); ++a) {
+            args[a]->eval_batch(batch, active, &rhs);
+
+            // Pairs of numbers are compared in one go, everything else one by one.
+            batch_selection_t number_rows;
+            std::vector<double> lhs_numbers, rhs_numbers;
+            for (uint32_t i : active) {
+                if (batch->bailed_out(i)) {
+                    continue;
+                }
+                if (lhs[i].get_type() == datum_t::R_NUM
+                    && rhs[i].get_type() == datum_t::R_NUM) {
+                    number_rows.push_back(i);
+                    lhs_numbers.push_back(lhs[i].as_num());
+                    rhs_numbers.push_back(rhs[i].as_num());
+                } else {
+                    try {
+                        passed[i] = (pred)(lhs[i], rhs[i]);
+                    } catch (const base_exc_t &) {
+                        batch->bail_out(i);
+                    }
+                }
+            }
+            std::vector<uint8_t> number_results(number_rows.size());
+            (pred_numbers)(lhs_numbers, rhs_numbers, &number_results);
+            for (size_t k = 0; k < number_rows.size(); ++k) {
+                passed[number_rows[k]] = number_results[k];
+            }
+
+            batch_selection_t still_active;
+            still_active.reserve(active.size());
+            for (uint32_t i : active) {
+                if (batch->bailed_out(i)) {
+                    continue;
+                }
+                if (!passed[i]) {
+                    (*out)[i] = datum_t::boolean(false ^ invert);
+                } else {
+                    still_active.push_back(i);
+                    lhs[i] = std::move(rhs[i]);
+                }
+            }
+            active.swap(still_active);
+        }
+        for (uint32_t i : active) {
+            (*out)[i] = datum_t::boolean(true ^ invert);
+        }
+    }
+
+private:
+    bool (*const pred)(const datum_t &lhs, const datum_t &rhs);
+    const compare_numbers_t pred_numbers;
+    const bool invert;
+    const compiled_terms_t args;
+};
+
+class compiled_not_t : public compiled_term_t {
+public:
+    explicit compiled_not_t(scoped_ptr_t<const compiled_term_t> &&_arg)
+        : arg(std::move(_arg)) { }
+    datum_t eval(compiled_func_env_t *env) const {
+        return datum_t::boolean(!arg->eval(env).as_bool());
+    }
+    void eval_batch(compiled_batch_t *batch,
+                    const batch_selection_t &selection,
+                    std::vector<datum_t> *out) const {
+        arg->eval_batch(batch, selection, out);
+        for (uint32_t i : selection) {
+            if (!batch->bailed_out(i)) {
+                (*out)[i] = datum_t::boolean(!(*out)[i].as_bool());
+            }
+        }
+    }
+private:
+    const scoped_ptr_t<const compiled_term_t> arg;
+};
+
 class predicate_term_t : public op_term_t {
 public:
     predicate_term_t(compile_env_t *env, const raw_term_t &term)
         : op_term_t(env, term, argspec_t(2, -1)),
-          namestr(0), invert(false), pred(0) {
+          namestr(0), invert(false), pred(0), pred_numbers(0) {
         switch (static_cast<int>(term.type())) {
         case Term::EQ:
             namestr = "EQ";
             pred = &datum_eq;
+            pred_numbers = &compare_numbers<std::equal_to<double> >;
             break;
         case Term::NE:
             namestr = "NE";
             pred = &datum_eq;
+            pred_numbers = &compare_numbers<std::equal_to<double> >;
             invert = true; // we invert the == operator so (!= 1 2 3) makes sense
             break;
         case Term::LT:
             namestr = "LT";
             pred = &datum_lt;
+            pred_numbers = &compare_numbers<std::less<double> >;
             break;
         case Term::LE:
             namestr = "LE";
             pred = &datum_le;
+            pred_numbers = &compare_numbers<std::less_equal<double> >;
             break;
         case Term::GT:
             namestr = "GT";
             pred = &datum_gt;
+            pred_numbers = &compare_numbers<std::greater<double> >;
             break;
         case Term::GE:
             namestr = "GE";
             pred = &datum_ge;
+            pred_numbers = &compare_numbers<std::greater_equal<double> >;
             break;
         default: unreachable();
         }
-        guarantee(namestr && pred);
+        guarantee(namestr && pred && pred_numbers);
+    }
+
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        compiled_terms_t args;
+        if (has_optargs() || !compiler->lower_args(get_original_args(), &args)) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return make_scoped<compiled_predicate_t>(
+            pred, pred_numbers, invert, std::move(args));
     }
+
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -80,12 +224,22 @@ private:
     virtual const char *name() const { return namestr; }
     bool invert;
     bool (*pred)(const datum_t &lhs, const datum_t &rhs);
+    compare_numbers_t pred_numbers;
 };
 
 class not_term_t : public op_term_t {
 public:
     not_term_t(compile_env_t *env, const raw_term_t &term)
         : op_term_t(env, term, argspec_t(1)) { }
+
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        compiled_terms_t args;
+        if (has_optargs() || !compiler->lower_args(get_original_args(), &args)) {
+            return scoped_ptr_t<const compiled_term_t>();
+        }
+        return make_scoped<compiled_not_t>(std::move(args[0]));
+    }
+
 private:
     virtual scoped_ptr_t<val_t> eval_impl(scope_env_t *env, args_t *args, eval_flags_t) const {
         return new_val_bool(!args->arg(env, 0)->as_bool());
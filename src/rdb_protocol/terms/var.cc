@@ -1,6 +1,7 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/terms.hpp"
 
+#include "rdb_protocol/compiled_func.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/op.hpp"
 #include "math.hpp"
@@ -30,6 +31,10 @@ public:
         return true;
     }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        return compiler->lower_var(varname);
+    }
+
 private:
     virtual void accumulate_captures(var_captures_t *captures) const {
         captures->vars_captured.insert(varname);
@@ -63,6 +68,10 @@ public:
         return true;
     }
 
+    scoped_ptr_t<const compiled_term_t> lower(func_compiler_t *compiler) const {
+        return compiler->lower_implicit_var();
+    }
+
 private:
     virtual void accumulate_captures(var_captures_t *captures) const {
         captures->implicit_is_captured = true;
@@ -87,6 +87,10 @@ var_scope_t var_scope_t::filtered_by_captures(const var_captures_t &captures) co
     return ret;
 }
 
+bool var_scope_t::contains_var(sym_t varname) const {
+    return vars.find(varname) != vars.end();
+}
+
 datum_t var_scope_t::lookup_var(sym_t varname) const {
     auto it = vars.find(varname);
     // This is a sanity check because we should never have constructed an expression
@@ -195,5 +199,7 @@ deserialize<cluster_version_t::v2_2>(read_stream_t *s, var_scope_t *);
 template archive_result_t
 deserialize<cluster_version_t::v2_3>(read_stream_t *s, var_scope_t *);
 template archive_result_t
-deserialize<cluster_version_t::v2_4_is_latest>(read_stream_t *s, var_scope_t *);
+deserialize<cluster_version_t::v2_4>(read_stream_t *s, var_scope_t *);
+template archive_result_t
+deserialize<cluster_version_t::v2_5_is_latest>(read_stream_t *s, var_scope_t *);
 }  // namespace ql
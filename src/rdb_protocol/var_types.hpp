@@ -60,6 +60,7 @@ public:
 
     var_scope_t filtered_by_captures(const var_captures_t &captures) const;
 
+    bool contains_var(sym_t varname) const;
     datum_t lookup_var(sym_t varname) const;
     datum_t lookup_implicit() const;
 
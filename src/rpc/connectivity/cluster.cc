@@ -24,6 +24,8 @@
 #include "containers/object_buffer.hpp"
 #include "containers/uuid.hpp"
 #include "logger.hpp"
+#include "math.hpp"
+#include "rpc/connectivity/compression.hpp"
 #include "rpc/semilattice/watchable.hpp"
 #include "stl_utils.hpp"
 #include "utils.hpp"
@@ -32,11 +34,11 @@
 #define MESSAGE_HANDLER_MAX_BATCH_SIZE           16
 
 // The cluster communication protocol version.
-static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_4_is_latest,
+static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_5_is_latest,
               "We need to update CLUSTER_VERSION_STRING when we add a new cluster "
               "version.");
 
-#define CLUSTER_VERSION_STRING "2.4.0"
+#define CLUSTER_VERSION_STRING "2.5.0"
 
 const std::string connectivity_cluster_t::cluster_proto_header("RethinkDB cluster\n");
 const std::string connectivity_cluster_t::cluster_version_string(CLUSTER_VERSION_STRING);
@@ -131,30 +133,145 @@ void connectivity_cluster_t::connection_t::kill_connection() {
     }
 }
 
-connectivity_cluster_t::connection_t::connection_t(
-        run_t *_parent,
-        const peer_id_t &_peer_id,
-        const server_id_t &_server_id,
-        keepalive_tcp_conn_stream_t *_conn,
-        const peer_address_t &_peer_address) THROWS_NOTHING :
+connectivity_cluster_t::stream_t::stream_t(
+        keepalive_tcp_conn_stream_t *_conn, bool compress, bool _fragment) :
     conn(_conn),
-    peer_address(_peer_address),
+    fragment(_fragment),
     flusher([&](signal_t *) {
         guarantee(this->conn != nullptr);
         // We need to acquire the send_mutex because flushing the buffer
         // must not interleave with other writes (restriction of linux_tcp_conn_t).
-        mutex_t::acq_t acq(&this->send_mutex);
+        lane_mutex_t::acq_t acq(&this->send_mutex,
+                                cluster_message_lane_t::INTERACTIVE);
         // We ignore the return value of flush_buffer(). Closed connections
         // must be handled elsewhere.
         this->conn->flush_buffer();
-    }, 1),
+    }, 1)
+{
+    if (compress) {
+        deflater.init(new cluster_deflater_t());
+    }
+}
+
+connectivity_cluster_t::stream_t::~stream_t() {
+    drainer.drain();
+
+    /* The senders have been drained, so nothing can be holding the `send_mutex`. */
+    guarantee(!send_mutex.is_locked());
+}
+
+bool connectivity_cluster_t::stream_t::write(const void *data, size_t size,
+                                             bool end_of_unit,
+                                             size_t *wire_bytes_inout) {
+    int64_t res;
+    size_t wire_size;
+    if (deflater.has()) {
+        /* The deflater has to be used in the same order as the stream is written to,
+        which is why we compress while holding the `send_mutex`. */
+        std::vector<char> compressed;
+        deflater->compress(data, size, end_of_unit, &compressed);
+        res = conn->write_buffered(compressed.data(), compressed.size());
+        wire_size = compressed.size();
+    } else {
+        res = conn->write_buffered(data, size);
+        wire_size = size;
+    }
+    if (res == -1) {
+        /* Close the other half of the connection to make sure that
+           `connectivity_cluster_t::run_t::handle()` notices that something is up */
+        if (conn->is_read_open()) {
+            conn->shutdown_read();
+        }
+        return false;
+    }
+    guarantee(res == static_cast<int64_t>(wire_size));
+    *wire_bytes_inout += wire_size;
+    return true;
+}
+
+bool connectivity_cluster_t::stream_t::send(message_tag_t tag,
+                                            cluster_message_lane_t lane,
+                                            const std::vector<char> &message,
+                                            size_t *wire_bytes_out) {
+    rassert(get_thread_id() == conn->home_thread());
+
+    static_assert(std::is_same<message_tag_t, uint8_t>::value,
+                  "We expect to be serializing a uint8_t -- if this has "
+                  "changed, the cluster communication format has changed and "
+                  "you need to ask yourself whether live cluster upgrades work."
+                  );
+
+    *wire_bytes_out = 0;
+    if (fragment) {
+        /* Keep other messages in the same lane from getting between our fragments. */
+        mutex_t::acq_t lane_acq(&lane_mutexes[static_cast<int>(lane)], true);
+        size_t offset = 0;
+        do {
+            cluster_fragment_header_t header;
+            header.tag = tag;
+            header.lane = lane;
+            header.size = static_cast<uint32_t>(std::min<size_t>(
+                message.size() - offset, CLUSTER_MESSAGE_FRAGMENT_SIZE));
+            header.last = offset + header.size == message.size();
+            char header_buf[cluster_fragment_header_t::serialized_size];
+            header.encode(header_buf);
+
+            /* We release the `send_mutex` after every fragment, so that messages in
+            higher-priority lanes can go in between. */
+            lane_mutex_t::acq_t acq(&send_mutex, lane);
+            if (!write(header_buf, sizeof(header_buf), false, wire_bytes_out)
+                    || !write(message.data() + offset, header.size, true,
+                              wire_bytes_out)) {
+                return false;
+            }
+            offset += header.size;
+        } while (offset < message.size());
+    } else {
+        /* The other server doesn't understand fragments, so we can only pick which
+        whole message goes next. */
+        lane_mutex_t::acq_t acq(&send_mutex, lane);
+        // All cluster versions use a uint8_t tag here.
+        if (!write(&tag, sizeof(tag), false, wire_bytes_out)
+                || !write(message.data(), message.size(), true, wire_bytes_out)) {
+            return false;
+        }
+    }
+
+    flusher.notify();
+    cond_t dummy_interruptor;
+    flusher.flush(&dummy_interruptor);
+    if (!conn->is_write_open()) {
+        if (conn->is_read_open()) {
+            conn->shutdown_read();
+        }
+        return false;
+    }
+    return true;
+}
+
+connectivity_cluster_t::connection_t::connection_t(
+        run_t *_parent,
+        const peer_id_t &_peer_id,
+        const server_id_t &_server_id,
+        keepalive_tcp_conn_stream_t *_conn,
+        bool compress,
+        bool fragment,
+        int num_bulk_streams,
+        const peer_address_t &_peer_address) THROWS_NOTHING :
+    conn(_conn),
+    peer_address(_peer_address),
+    primary_stream(_conn, compress, fragment),
+    bulk_streams(num_bulk_streams, nullptr),
     pm_collection(),
     pm_bytes_sent(secs_to_ticks(1), true),
+    pm_wire_bytes_sent(secs_to_ticks(1), true),
     pm_collection_membership(
         &_parent->parent->connectivity_collection,
         &pm_collection,
         uuid_to_str(_peer_id.get_uuid())),
     pm_bytes_sent_membership(&pm_collection, &pm_bytes_sent, "bytes_sent"),
+    pm_wire_bytes_sent_membership(
+        &pm_collection, &pm_wire_bytes_sent, "wire_bytes_sent"),
     parent(_parent),
     peer_id(_peer_id),
     server_id(_server_id),
@@ -176,8 +293,29 @@ connectivity_cluster_t::connection_t::~connection_t() THROWS_NOTHING {
         drainers.get()->drain();
     });
 
-    /* The drainers have been destroyed, so nothing can be holding the `send_mutex`. */
-    guarantee(!send_mutex.is_locked());
+    /* The bulk streams hold locks on our drainers while they are attached. */
+    for (stream_t *stream : bulk_streams) {
+        guarantee(stream == nullptr);
+    }
+}
+
+connectivity_cluster_t::stream_t *connectivity_cluster_t::connection_t::choose_stream(
+        cluster_message_lane_t lane,
+        uint64_t order_key,
+        auto_drainer_t::lock_t *keepalive_out) {
+    rassert(get_thread_id() == conn->home_thread());
+    if (lane == cluster_message_lane_t::BULK && !bulk_streams.empty()) {
+        /* Move the bulk lane off the primary stream, so it doesn't hold up the other
+        lanes. We don't stripe one sender's messages over several streams, since
+        that would reorder them: each `order_key` has its own stream. Until that
+        stream is attached, its messages use the primary stream. */
+        stream_t *stream = bulk_streams[order_key % bulk_streams.size()];
+        if (stream != nullptr) {
+            *keepalive_out = auto_drainer_t::lock_t(&stream->drainer);
+            return stream;
+        }
+    }
+    return &primary_stream;
 }
 
 // Helper function for the `run_t` constructor's initialization list
@@ -224,11 +362,13 @@ connectivity_cluster_t::run_t::run_t(
             _heartbeat_sl_view,
         std::shared_ptr<semilattice_read_view_t<auth_semilattice_metadata_t> >
             _auth_sl_view,
-        tls_ctx_t *_tls_ctx)
+        tls_ctx_t *_tls_ctx,
+        const cluster_connection_config_t &_connection_config)
         THROWS_ONLY(address_in_use_exc_t, tcp_socket_exc_t) :
     parent(_parent),
     server_id(_server_id),
     tls_ctx(_tls_ctx),
+    connection_config(_connection_config),
 
     /* Create the socket to use when listening for connections from peers */
     cluster_listener_socket(new tcp_bound_socket_t(local_addresses, port)),
@@ -260,7 +400,9 @@ connectivity_cluster_t::run_t::run_t(
     `connection_map` on each thread and notifying any listeners that we're now
     connected to ourself. The destructor will remove us from the
     `connection_map` and again notify any listeners. */
-    connection_to_ourself(this, parent->me, _server_id, nullptr, routing_table[parent->me]),
+    connection_to_ourself(
+        this, parent->me, _server_id, nullptr, false, false, 0,
+        routing_table[parent->me]),
 
     heartbeat_sl_view(_heartbeat_sl_view),
     auth_sl_view(_auth_sl_view),
@@ -271,6 +413,9 @@ connectivity_cluster_t::run_t::run_t(
                  this, ph::_1, join_delay_secs, auto_drainer_t::lock_t(&drainer))))
 {
     parent->assert_thread();
+    guarantee(connection_config.connections_per_peer >= 1
+              && connection_config.connections_per_peer
+                 <= MAX_CLUSTER_CONNECTIONS_PER_PEER);
 }
 
 connectivity_cluster_t::run_t::~run_t() {
@@ -527,7 +672,8 @@ public:
                     /* This might block, so we have to run it in a sub-coroutine. */
                     connection->parent->parent->send_message(
                         connection, connection_keepalive,
-                        connectivity_cluster_t::heartbeat_tag, this);
+                        connectivity_cluster_t::heartbeat_tag, this,
+                        cluster_message_lane_t::INTERACTIVE);
                 });
         }
         if (read_done) {
@@ -739,8 +885,10 @@ enum class handshake_result_code_t {
 class handshake_result_t {
 public:
     handshake_result_t() { }
-    static handshake_result_t success() {
-        return handshake_result_t(handshake_result_code_t::SUCCESS);
+    static handshake_result_t success(const std::string &connection_options) {
+        handshake_result_t result(handshake_result_code_t::SUCCESS);
+        result.additional_info = connection_options;
+        return result;
     }
     static handshake_result_t error(handshake_result_code_t error_code,
                                     const std::string &additional_info) {
@@ -751,6 +899,11 @@ public:
         return code;
     }
 
+    /* For a successful handshake, this is the other side's `handshake_options_t` */
+    const std::string &get_additional_info() const {
+        return additional_info;
+    }
+
     std::string get_error_reason() const {
         if (code == handshake_result_code_t::UNKNOWN_ERROR) {
             return error_code_string + " (" + additional_info + ")";
@@ -837,6 +990,70 @@ archive_result_t deserialize_universal(read_stream_t *s, handshake_result_t *out
     return res;
 }
 
+/* `handshake_options_t` describes how a server would like a connection to be set up. It
+travels in the `additional_info` of the handshake result that each side sends once it's
+happy to connect. Servers that don't know about it send an empty string there, which
+parses to the defaults, and ignore whatever we send them. On the wire it's a
+space-separated list of `key=value` pairs; we ignore keys we don't recognize, so that
+newer servers can add more. */
+class handshake_options_t {
+public:
+    handshake_options_t() :
+        accepts_zlib(false), sends_zlib(false), connections(1), bulk_stream_index(0),
+        fragments(false) { }
+
+    std::string to_string() const {
+        return strprintf("accepts_zlib=%d sends_zlib=%d connections=%d bulk_stream=%d "
+                         "fragments=%d",
+                         accepts_zlib ? 1 : 0, sends_zlib ? 1 : 0, connections,
+                         bulk_stream_index, fragments ? 1 : 0);
+    }
+
+    static handshake_options_t parse(const std::string &str) {
+        handshake_options_t options;
+        for (const std::string &pair : split_string(str, ' ')) {
+            size_t equals = pair.find('=');
+            int64_t value;
+            if (equals == std::string::npos
+                    || !strtoi64_strict(pair.substr(equals + 1), 10, &value)) {
+                continue;
+            }
+            const std::string key = pair.substr(0, equals);
+            if (key == "accepts_zlib") {
+                options.accepts_zlib = value != 0;
+            } else if (key == "sends_zlib") {
+                options.sends_zlib = value != 0;
+            } else if (key == "connections") {
+                options.connections = clamp<int64_t>(
+                    value, 1, MAX_CLUSTER_CONNECTIONS_PER_PEER);
+            } else if (key == "bulk_stream") {
+                options.bulk_stream_index = clamp<int64_t>(
+                    value, 0, MAX_CLUSTER_CONNECTIONS_PER_PEER - 1);
+            } else if (key == "fragments") {
+                options.fragments = value != 0;
+            }
+        }
+        return options;
+    }
+
+    /* Whether the sender can decompress messages that were compressed with zlib */
+    bool accepts_zlib;
+
+    /* Whether the sender wants to compress the messages it sends */
+    bool sends_zlib;
+
+    /* How many TCP connections the sender wants to use for each peer */
+    int connections;
+
+    /* Zero for the primary TCP connection to a peer. Otherwise the index of the
+    additional TCP connection that the sender is opening. */
+    int bulk_stream_index;
+
+    /* Whether the sender understands messages that are cut into fragments (see
+    `cluster_fragment_header_t`). If both sides do, they send all messages that way. */
+    bool fragments;
+};
+
 void fail_handshake(keepalive_tcp_conn_stream_t *conn,
                     const char *peername,
                     const handshake_result_t &reason,
@@ -869,7 +1086,8 @@ join_result_t connectivity_cluster_t::run_t::handle(
         boost::optional<server_id_t> expected_server_id,
         auto_drainer_t::lock_t drainer_lock,
         bool *successful_join_inout,
-        const int join_delay_secs) THROWS_NOTHING
+        const int join_delay_secs,
+        int bulk_stream_index) THROWS_NOTHING
 {
     parent->assert_thread();
 
@@ -999,18 +1217,8 @@ join_result_t connectivity_cluster_t::run_t::handle(
             fail_handshake(conn, peername, reason);
             return join_result_t::PERMANENT_ERROR;
         }
-
-        if (servers.count(remote_server_id) != 0) {
-            // There currently is another connection open to the server
-            logINF("Rejected a connection from server %s since one is open already.",
-                   remote_server_id.print().c_str());
-            return join_result_t::TEMPORARY_ERROR;
-        }
     }
 
-    set_insertion_sentry_t<server_id_t> remote_server_id_sentry(
-        &servers, remote_server_id);
-
     // Check bitsize (e.g. 32bit or 64bit)
     {
         std::string remote_arch_bitsize;
@@ -1075,10 +1283,18 @@ join_result_t connectivity_cluster_t::run_t::handle(
         return join_result_t::TEMPORARY_ERROR;
     }
 
+    handshake_options_t our_options;
+    our_options.accepts_zlib = true;
+    our_options.sends_zlib =
+        connection_config.compression == cluster_compression_t::ZLIB;
+    our_options.connections = connection_config.connections_per_peer;
+    our_options.bulk_stream_index = bulk_stream_index;
+    our_options.fragments = true;
+    handshake_options_t remote_options;
     {
         // Tell the other node that we are happy to connect with it
         write_message_t wm;
-        serialize_universal(&wm, handshake_result_t::success());
+        serialize_universal(&wm, handshake_result_t::success(our_options.to_string()));
         if (send_write_message(conn, &wm)) {
             return join_result_t::TEMPORARY_ERROR; // network error.
         }
@@ -1097,6 +1313,36 @@ join_result_t connectivity_cluster_t::run_t::handle(
                 return join_result_t::TEMPORARY_ERROR;
             return join_result_t::PERMANENT_ERROR;
         }
+
+        remote_options =
+            handshake_options_t::parse(handshake_result.get_additional_info());
+    }
+
+    /* Each side compresses what it sends if it wants to and the other side can
+    decompress it. */
+    const bool compress = our_options.sends_zlib && remote_options.accepts_zlib;
+    const bool decompress = remote_options.sends_zlib && our_options.accepts_zlib;
+    const bool fragment = our_options.fragments && remote_options.fragments;
+
+    /* Either we are opening an additional TCP connection for an existing connection,
+    or the other side is. */
+    if (bulk_stream_index != 0 && remote_options.bulk_stream_index != 0) {
+        logERR("Both ends of the connection from %s claim to have opened it as an "
+               "additional connection, closing connection.", peername);
+        return join_result_t::TEMPORARY_ERROR;
+    }
+    bulk_stream_index = std::max(bulk_stream_index, remote_options.bulk_stream_index);
+
+    /* There may only be one primary connection per server. */
+    set_insertion_sentry_t<server_id_t> remote_server_id_sentry;
+    if (bulk_stream_index == 0) {
+        if (servers.count(remote_server_id) != 0) {
+            // There currently is another connection open to the server
+            logINF("Rejected a connection from server %s since one is open already.",
+                   remote_server_id.print().c_str());
+            return join_result_t::TEMPORARY_ERROR;
+        }
+        remote_server_id_sentry.reset(&servers, remote_server_id);
     }
 
     // Look up the ip addresses for the other host
@@ -1153,6 +1399,15 @@ join_result_t connectivity_cluster_t::run_t::handle(
     // Just saying that we're still on the rpc listener thread.
     parent->assert_thread();
 
+    if (bulk_stream_index != 0) {
+        /* Additional TCP connections don't exchange routing tables; they just attach
+        themselves to the primary connection. */
+        conn_closer_1.reset();
+        return handle_bulk_stream(conn, other_id, remote_server_id, bulk_stream_index,
+                                  compress, decompress, fragment, join_delay_secs,
+                                  drainer_lock);
+    }
+
     /* The trickiest case is when there are two or more parallel connections
     that are trying to be established between the same two servers. We can get
     this when e.g. server A and server B try to connect to each other at the
@@ -1276,6 +1531,25 @@ join_result_t connectivity_cluster_t::run_t::handle(
         }
     }
 
+    /* Both sides use as many TCP connections as the more conservative of them asked
+    for. The leader opens the additional ones. If we always connect from the same
+    local port, we can't open more than one. */
+    const int num_bulk_streams =
+        std::min(our_options.connections, remote_options.connections) - 1;
+    if (we_are_leader && cluster_client_port == 0
+            && !drainer_lock.get_drain_signal()->is_pulsed()) {
+        for (int i = 1; i <= num_bulk_streams; ++i) {
+            coro_t::spawn_now_dangerously(std::bind(
+                &connectivity_cluster_t::run_t::connect_bulk_stream, this,
+                *other_peer_addr.get(),
+                other_id,
+                remote_server_id,
+                i,
+                join_delay_secs,
+                drainer_lock));
+        }
+    }
+
     /* Now that we're about to switch threads, it's not safe to try to close
     the connection from this thread anymore. This is safe because we won't do
     anything that permanently blocks before setting up `conn_closer_2`. */
@@ -1320,7 +1594,9 @@ join_result_t connectivity_cluster_t::run_t::handle(
         constructor registers it in the `connectivity_cluster_t`'s connection
         map. */
         connection_t conn_structure(
-            this, other_id, remote_server_id, conn, *other_peer_addr.get());
+            this, other_id, remote_server_id, conn, compress, fragment,
+            num_bulk_streams,
+            *other_peer_addr.get());
 
         /* `heartbeat_manager` will periodically send a heartbeat message to
         other servers, and it will also close the connection if we don't
@@ -1334,42 +1610,17 @@ join_result_t connectivity_cluster_t::run_t::handle(
         /* Main message-handling loop: read messages off the connection until
         it's closed, which may be due to network events, or the other end
         shutting down, or us shutting down. */
-        try {
-            int messages_handled_since_yield = 0;
-            while (true) {
-                message_tag_t tag;
-                archive_result_t res = deserialize_universal(conn, &tag);
-                if (bad(res)) { throw fake_archive_exc_t(); }
-
-                /* Ignore messages tagged with the heartbeat tag. The
-                `keepalive_tcp_conn_stream_t` will have already notified the
-                `heartbeat_manager_t` as soon as the heartbeat arrived. */
-                if (tag != heartbeat_tag) {
-                    cluster_message_handler_t *handler = parent->message_handlers[tag];
-                    guarantee(handler != nullptr, "Got a message for an unfamiliar tag. "
-                        "Apparently we aren't compatible with the cluster on the other "
-                        "end.");
-
-                    /* If you really want to support old cluster versions, the
-                    resolved_version should be passed into the on_message() handler. */
-                    guarantee(resolved_version == cluster_version_t::CLUSTER);
-                    handler->on_message(
-                        &conn_structure,
-                        auto_drainer_t::lock_t(conn_structure.drainers.get()),
-                        conn); // might raise fake_archive_exc_t
-                }
-
-                ++messages_handled_since_yield;
-                if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
-                    coro_t::yield();
-                    messages_handled_since_yield = 0;
-                }
+        {
+            scoped_ptr_t<cluster_inflate_read_stream_t> inflater;
+            if (decompress) {
+                inflater.init(new cluster_inflate_read_stream_t(conn));
             }
-        } catch (const fake_archive_exc_t &) {
-            /* The exception broke us out of the loop, and that's what we
-            wanted. This could either be because we lost contact with the peer
-            or because the cluster is shutting down and `close_conn()` got
-            called. */
+            handle_messages(&conn_structure,
+                            auto_drainer_t::lock_t(conn_structure.drainers.get()),
+                            inflater.has()
+                                ? static_cast<read_stream_t *>(inflater.get())
+                                : conn,
+                            fragment);
         }
 
         if (conn->is_read_open()) {
@@ -1396,6 +1647,227 @@ join_result_t connectivity_cluster_t::run_t::handle(
     return join_result_t::SUCCESS;
 }
 
+void connectivity_cluster_t::run_t::connect_bulk_stream(
+        const peer_address_t &peer_address,
+        const peer_id_t &peer_id,
+        const server_id_t &peer_server_id,
+        int bulk_stream_index,
+        const int join_delay_secs,
+        auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING {
+    parent->assert_thread();
+    for (const ip_and_port_t &addr : peer_address.ips()) {
+        try {
+            keepalive_tcp_conn_stream_t conn(
+                tls_ctx, addr.ip(), addr.port().value(),
+                drainer_lock.get_drain_signal());
+            handle(&conn, peer_id, peer_address, peer_server_id, drainer_lock, nullptr,
+                   join_delay_secs, bulk_stream_index);
+            return;
+        } catch (const tcp_conn_t::connect_failed_exc_t &) {
+            /* Try the next address */
+        } catch (const crypto::openssl_error_t &) {
+            /* Try the next address */
+        } catch (const interrupted_exc_t &) {
+            return;
+        }
+    }
+    /* If we couldn't connect, the connection gets by with fewer TCP connections. */
+}
+
+join_result_t connectivity_cluster_t::run_t::handle_bulk_stream(
+        keepalive_tcp_conn_stream_t *conn,
+        const peer_id_t &peer_id,
+        const server_id_t &peer_server_id,
+        int bulk_stream_index,
+        bool compress,
+        bool decompress,
+        bool fragment,
+        const int join_delay_secs,
+        auto_drainer_t::lock_t drainer_lock) {
+    parent->assert_thread();
+
+    /* Find out which thread the primary connection lives on. It might not have been
+    set up yet on our side, for example because of `--join-delay`. */
+    threadnum_t connection_thread = INVALID_THREAD;
+    try {
+        signal_timer_t timeout;
+        timeout.start(static_cast<int64_t>(join_delay_secs) * 1000
+                      + CLUSTER_BULK_STREAM_ATTACH_TIMEOUT_MS);
+        wait_any_t interruptor(&timeout, drainer_lock.get_drain_signal());
+        parent->connections.get()->run_key_until_satisfied(peer_id,
+            [&](const connection_pair_t *pair) {
+                if (pair == nullptr) {
+                    return false;
+                }
+                connection_thread = pair->first->conn->home_thread();
+                return true;
+            },
+            &interruptor);
+    } catch (const interrupted_exc_t &) {
+        return join_result_t::TEMPORARY_ERROR;
+    }
+
+    cross_thread_signal_t connection_thread_drain_signal(
+        drainer_lock.get_drain_signal(), connection_thread);
+
+    rethread_tcp_conn_stream_t unregister_conn(conn, INVALID_THREAD);
+    on_thread_t conn_threader(connection_thread);
+    rethread_tcp_conn_stream_t reregister_conn(conn, get_thread_id());
+
+    // Make sure that if we're ordered to shut down, any pending read
+    // or write gets interrupted.
+    cluster_conn_closing_subscription_t conn_closer_2(conn);
+    conn_closer_2.reset(&connection_thread_drain_signal);
+
+    {
+        /* The primary connection might have gone away (or been replaced) while we
+        were switching threads. */
+        auto_drainer_t::lock_t connection_keepalive;
+        connection_t *connection =
+            parent->get_connection(peer_id, &connection_keepalive);
+        if (connection == nullptr
+                || connection->get_server_id() != peer_server_id
+                || connection->conn->home_thread() != get_thread_id()
+                || static_cast<size_t>(bulk_stream_index)
+                    > connection->bulk_streams.size()
+                || connection->bulk_streams[bulk_stream_index - 1] != nullptr) {
+            return join_result_t::TEMPORARY_ERROR;
+        }
+
+        /* When the primary connection goes away, so do we. */
+        cluster_conn_closing_subscription_t connection_closer(conn);
+        connection_closer.reset(connection_keepalive.get_drain_signal());
+
+        {
+            stream_t stream(conn, compress, fragment);
+            connection->bulk_streams[bulk_stream_index - 1] = &stream;
+
+            {
+                scoped_ptr_t<cluster_inflate_read_stream_t> inflater;
+                if (decompress) {
+                    inflater.init(new cluster_inflate_read_stream_t(conn));
+                }
+                handle_messages(connection,
+                                connection_keepalive,
+                                inflater.has()
+                                    ? static_cast<read_stream_t *>(inflater.get())
+                                    : conn,
+                                fragment);
+            }
+
+            connection->bulk_streams[bulk_stream_index - 1] = nullptr;
+
+            if (conn->is_read_open()) {
+                logWRN("Received invalid data on a cluster connection. Disconnecting.");
+                conn->shutdown_read();
+            }
+            if (conn->is_write_open()) {
+                conn->shutdown_write();
+            }
+
+            /* Messages that were on their way over this TCP connection may have been
+            lost, so the connection as a whole can't go on without it. This doesn't
+            block because we're on the connection's thread. */
+            connection->kill_connection();
+
+            /* The `stream` destructor waits for any `send_message()` calls that are
+            still using it. */
+        }
+    }
+
+    /* Make sure that any pending network writes have either been transmitted or
+    aborted before we destruct the `rethread_tcp_conn_stream_t`s. */
+    conn->flush_buffer();
+    return join_result_t::SUCCESS;
+}
+
+void connectivity_cluster_t::run_t::handle_messages(
+        connection_t *connection,
+        auto_drainer_t::lock_t connection_keepalive,
+        read_stream_t *stream,
+        bool fragmented) {
+    /* If the messages arrive in fragments, these hold what we have received so far of
+    the current message in each lane. */
+    std::vector<char> partial_messages[num_cluster_message_lanes];
+    bool partial_message_started[num_cluster_message_lanes] = { };
+    message_tag_t partial_message_tags[num_cluster_message_lanes] = { };
+
+    try {
+        int messages_handled_since_yield = 0;
+        while (true) {
+            message_tag_t tag;
+            /* If this is set, the message is read from it instead of `stream` */
+            scoped_ptr_t<vector_read_stream_t> reassembled_message;
+            if (fragmented) {
+                char header_buf[cluster_fragment_header_t::serialized_size];
+                cluster_fragment_header_t header;
+                if (force_read(stream, header_buf, sizeof(header_buf))
+                        != static_cast<int64_t>(sizeof(header_buf))
+                    || !header.decode(header_buf)) {
+                    throw fake_archive_exc_t();
+                }
+                const int lane = static_cast<int>(header.lane);
+                if (partial_message_started[lane]
+                        && partial_message_tags[lane] != header.tag) {
+                    throw fake_archive_exc_t();
+                }
+                partial_message_started[lane] = true;
+                partial_message_tags[lane] = header.tag;
+
+                std::vector<char> *partial = &partial_messages[lane];
+                const size_t offset = partial->size();
+                partial->resize(offset + header.size);
+                if (force_read(stream, partial->data() + offset, header.size)
+                        != static_cast<int64_t>(header.size)) {
+                    throw fake_archive_exc_t();
+                }
+                if (!header.last) {
+                    continue;
+                }
+                tag = header.tag;
+                reassembled_message.init(
+                    new vector_read_stream_t(std::move(*partial)));
+                *partial = std::vector<char>();
+                partial_message_started[lane] = false;
+            } else {
+                archive_result_t res = deserialize_universal(stream, &tag);
+                if (bad(res)) { throw fake_archive_exc_t(); }
+            }
+
+            /* Ignore messages tagged with the heartbeat tag. The
+            `keepalive_tcp_conn_stream_t` will have already notified the
+            `heartbeat_manager_t` as soon as the heartbeat arrived. */
+            if (tag != heartbeat_tag) {
+                cluster_message_handler_t *handler = parent->message_handlers[tag];
+                guarantee(handler != nullptr, "Got a message for an unfamiliar tag. "
+                    "Apparently we aren't compatible with the cluster on the other "
+                    "end.");
+
+                /* If you really want to support old cluster versions, the
+                resolved_version should be passed into the on_message() handler. For
+                now `handle()` guarantees that it is `cluster_version_t::CLUSTER`. */
+                handler->on_message(
+                    connection,
+                    connection_keepalive,
+                    reassembled_message.has()
+                        ? reassembled_message.get()
+                        : stream); // might raise fake_archive_exc_t
+            }
+
+            ++messages_handled_since_yield;
+            if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
+                coro_t::yield();
+                messages_handled_since_yield = 0;
+            }
+        }
+    } catch (const fake_archive_exc_t &) {
+        /* The exception broke us out of the loop, and that's what we
+        wanted. This could either be because we lost contact with the peer
+        or because the cluster is shutting down and `close_conn()` got
+        called. */
+    }
+}
+
 connectivity_cluster_t::connectivity_cluster_t() THROWS_NOTHING :
     me(peer_id_t(generate_uuid())),
     /* We assign threads from the highest thread number downwards. This is to reduce the
@@ -1406,11 +1878,17 @@ connectivity_cluster_t::connectivity_cluster_t() THROWS_NOTHING :
     }),
     current_run(nullptr),
     connectivity_collection(),
-    stats_membership(&get_global_perfmon_collection(), &connectivity_collection, "connectivity")
+    stats_membership(&get_global_perfmon_collection(), &connectivity_collection, "connectivity"),
+    lanes_collection(),
+    lanes_membership(&connectivity_collection, &lanes_collection, "lanes")
 {
     for (int i = 0; i < max_message_tag; i++) {
         message_handlers[i] = nullptr;
     }
+    for (int i = 0; i < num_cluster_message_lanes; ++i) {
+        lane_stats[i].init(new lane_stats_t(
+            &lanes_collection, static_cast<cluster_message_lane_t>(i)));
+    }
 }
 
 connectivity_cluster_t::~connectivity_cluster_t() THROWS_NOTHING {
@@ -1442,6 +1920,15 @@ connectivity_cluster_t::~connectivity_cluster_t() THROWS_NOTHING {
 #endif
 }
 
+connectivity_cluster_t::lane_stats_t::lane_stats_t(
+        perfmon_collection_t *parent, cluster_message_lane_t lane) :
+    collection(),
+    queue_depth(),
+    latency(secs_to_ticks(1), true),
+    collection_membership(parent, &collection, cluster_message_lane_name(lane)),
+    queue_depth_membership(&collection, &queue_depth, "queue_depth"),
+    latency_membership(&collection, &latency, "latency") { }
+
 peer_id_t connectivity_cluster_t::get_me() THROWS_NOTHING {
     return me;
 }
@@ -1469,7 +1956,9 @@ connectivity_cluster_t::connection_t *connectivity_cluster_t::get_connection(
 void connectivity_cluster_t::send_message(connection_t *connection,
                                      auto_drainer_t::lock_t connection_keepalive,
                                      message_tag_t tag,
-                                     cluster_send_message_write_callback_t *callback) {
+                                     cluster_send_message_write_callback_t *callback,
+                                     cluster_message_lane_t lane,
+                                     uint64_t order_key) {
     // We could be on _any_ thread.
 
     /* If the connection is being closed, just drop the message now. It's not going
@@ -1529,62 +2018,25 @@ void connectivity_cluster_t::send_message(connection_t *connection,
         message_handlers[tag]->on_local_message(connection, connection_keepalive,
             std::move(buffer_data));
     } else {
-        on_thread_t threader(connection->conn->home_thread());
-
-        /* Acquire the send-mutex so we don't collide with other things trying
-        to send on the same connection. */
+        if (bytes_sent >= static_cast<size_t>(CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE)) {
+            lane = cluster_message_lane_t::BULK;
+        }
+        lane_stats_t *stats = lane_stats[static_cast<int>(lane)].get();
+        const ticks_t start_time = get_ticks();
+        size_t wire_bytes_sent;
         {
-            /* The `true` is for eager waiting, which is a significant performance
-            optimization in this case. */
-            mutex_t::acq_t acq(&connection->send_mutex, true);
-
-            /* Write the tag to the network */
-            {
-                // All cluster versions use a uint8_t tag here.
-                write_message_t wm;
-                static_assert(std::is_same<message_tag_t, uint8_t>::value,
-                              "We expect to be serializing a uint8_t -- if this has "
-                              "changed, the cluster communication format has changed and "
-                              "you need to ask yourself whether live cluster upgrades work."
-                              );
-                serialize_universal(&wm, tag);
-                make_buffered_tcp_conn_stream_wrapper_t buffered_conn(connection->conn);
-                int res = send_write_message(&buffered_conn, &wm);
-                if (res == -1) {
-                    /* Close the other half of the connection to make sure that
-                       `connectivity_cluster_t::run_t::handle()` notices that something is
-                       up */
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                }
-            }
-
-            /* Write the message itself to the network */
-            {
-                int64_t res = connection->conn->write_buffered(buffer.vector().data(),
-                                                               buffer.vector().size());
-                if (res == -1) {
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                } else {
-                    guarantee(res == static_cast<int64_t>(buffer.vector().size()));
-                }
-            }
-        } /* Releases the send_mutex */
-
-        connection->flusher.notify();
-        cond_t dummy_interruptor;
-        connection->flusher.flush(&dummy_interruptor);
-        if (!connection->conn->is_write_open()) {
-            if (connection->conn->is_read_open()) {
-                connection->conn->shutdown_read();
+            scoped_perfmon_counter_t queue_depth(&stats->queue_depth);
+            on_thread_t threader(connection->conn->home_thread());
+
+            auto_drainer_t::lock_t stream_keepalive;
+            stream_t *stream = connection->choose_stream(lane, order_key,
+                                                          &stream_keepalive);
+            if (!stream->send(tag, lane, buffer.vector(), &wire_bytes_sent)) {
+                return;
             }
-            return;
+            connection->pm_wire_bytes_sent.record(wire_bytes_sent);
         }
+        stats->latency.record(ticks_to_secs(get_ticks() - start_time));
     }
 
     connection->pm_bytes_sent.record(bytes_sent);
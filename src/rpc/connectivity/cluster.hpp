@@ -16,9 +16,11 @@
 #include "concurrency/watchable_map.hpp"
 #include "containers/archive/tcp_conn_stream.hpp"
 #include "containers/map_sentries.hpp"
+#include "containers/scoped.hpp"
 #include "concurrency/pump_coro.hpp"
 #include "perfmon/perfmon.hpp"
 #include "random.hpp"
+#include "rpc/connectivity/message_lanes.hpp"
 #include "rpc/connectivity/peer_id.hpp"
 #include "rpc/connectivity/server_id.hpp"
 #include "utils.hpp"
@@ -28,6 +30,7 @@ template <class> class optional;
 }
 
 class auth_semilattice_metadata_t;
+class cluster_deflater_t;
 class cluster_message_handler_t;
 class co_semaphore_t;
 class heartbeat_semilattice_metadata_t;
@@ -42,6 +45,24 @@ enum class join_result_t {
 
 typedef std::map<ip_and_port_t, join_result_t> join_results_t;
 
+/* How we would like our TCP connections to other servers to be set up. Both servers
+announce their configuration during the handshake, and each connection uses what the
+two of them have in common. */
+enum class cluster_compression_t { NONE, ZLIB };
+
+class cluster_connection_config_t {
+public:
+    cluster_connection_config_t() :
+        compression(cluster_compression_t::NONE), connections_per_peer(1) { }
+
+    /* If this is `ZLIB`, we compress everything we send to servers that support it. */
+    cluster_compression_t compression;
+
+    /* If this is more than one, we open additional TCP connections to each peer and
+    send large messages over those, so that they don't hold up small messages. */
+    int connections_per_peer;
+};
+
 /* Uncomment this to enable message profiling. Message profiling will keep track of how
 many messages of each type are sent over the network; it will dump the results to a file
 named `msg_profiler_out_PID.txt` on shutdown. Each line of that file will be of the
@@ -81,9 +102,17 @@ connection. Once a connection is established, messages can be sent across it in
 directions. Every message is guaranteed to eventually arrive unless the connection goes
 down. Messages cannot be duplicated.
 
-Can messages be reordered? I think the current implementation doesn't ever reorder
-messages, but don't rely on this guarantee. However, some old code may rely on this
-guarantee (I'm not sure) so don't break this property without checking first. */
+Can messages be reordered? Don't rely on them not being reordered. However, some old code
+may rely on the order of messages (I'm not sure) so don't make reordering more likely
+without checking first. Messages that are sent in the same lane (see `cluster_message_lane_t`) are never reordered, but
+a message can overtake messages in lower-priority lanes that are being sent at the same
+time. Since `send_message()` only returns once the message has been written, that doesn't
+affect messages that a coroutine sends one after the other. The exception is
+`cluster_connection_config_t::connections_per_peer`: if it's more than one, the bulk lane
+travels over different TCP connections than the other lanes, so a large message can
+arrive after a small one that was sent after it. That's why it's off by default. Large
+messages to the same mailbox always share one connection, so they still arrive in the
+order they were sent. */
 
 class connectivity_cluster_t :
     public home_thread_mixin_debug_only_t
@@ -107,6 +136,57 @@ public:
 
     class run_t;
 
+    /* `stream_t` is one TCP connection that messages to a peer are sent over. Every
+    `connection_t` has at least one; see `cluster_connection_config_t`. */
+    class stream_t {
+    public:
+        /* If `fragment` is true, messages are cut into fragments so that the messages
+        in different lanes can interleave. Otherwise the lanes only determine the
+        order in which whole messages are written. */
+        stream_t(keepalive_tcp_conn_stream_t *conn, bool compress, bool fragment);
+        ~stream_t();
+
+        /* Writes the message to the network. Returns `false` if that failed, in which
+        case the stream has been shut down. Must be called on `conn`'s home thread. */
+        bool send(message_tag_t tag, cluster_message_lane_t lane,
+                  const std::vector<char> &message, size_t *wire_bytes_out);
+
+    private:
+        friend class connectivity_cluster_t;
+
+        /* Writes `size` bytes to `conn`, compressing them if necessary. `end_of_unit`
+        should be set on the last write for a message or fragment, so that the receiver
+        can decompress it right away. Must be called while holding `send_mutex`. */
+        bool write(const void *data, size_t size, bool end_of_unit,
+                   size_t *wire_bytes_inout);
+
+        keepalive_tcp_conn_stream_t *conn;
+
+        const bool fragment;
+
+        /* Held while writing to `conn`. Senders only hold it for one fragment at a
+        time, and it goes to the highest-priority lane first. */
+        lane_mutex_t send_mutex;
+
+        /* When fragmenting, the fragments of one message must not be interleaved with
+        those of another message in the same lane. A sender holds the mutex for its
+        lane until it has written all of its fragments. */
+        mutex_t lane_mutexes[num_cluster_message_lanes];
+
+        /* Calls `conn->flush_buffer()`. Can be used for making sure that a
+        buffered write makes it to the TCP stack. */
+        pump_coro_t flusher;
+
+        /* `NULL` unless we compress what we send over this stream. Protected by
+        `send_mutex`. */
+        scoped_ptr_t<cluster_deflater_t> deflater;
+
+        /* Senders hold a lock on this while they use a bulk stream. */
+        auto_drainer_t drainer;
+
+        DISABLE_COPYING(stream_t);
+    };
+
     /* `connection_t` represents an open connection to another server. If we lose
     contact with another server and then regain it, then a new `connection_t` will be
     created. Generally, any code that handles a `connection_t *` will also carry around a
@@ -154,9 +234,20 @@ public:
             const peer_id_t &peer_id,
             const server_id_t &server_id,
             keepalive_tcp_conn_stream_t *,
+            bool compress,
+            bool fragment,
+            int num_bulk_streams,
             const peer_address_t &peer_address) THROWS_NOTHING;
         ~connection_t() THROWS_NOTHING;
 
+        /* Returns the stream that a message in the given lane should be sent over, and
+        sets `*keepalive_out` to keep it alive. Bulk messages with the same
+        `order_key` always go over the same stream once it's attached. Must be called
+        on `conn`'s home thread. */
+        stream_t *choose_stream(cluster_message_lane_t lane,
+                                uint64_t order_key,
+                                auto_drainer_t::lock_t *keepalive_out);
+
         /* NULL for the loopback connection (i.e. our "connection" to ourself) */
         keepalive_tcp_conn_stream_t *conn;
 
@@ -165,16 +256,18 @@ public:
         cross-thread to access the routing table. */
         peer_address_t peer_address;
 
-        /* Unused for our connection to ourself */
-        mutex_t send_mutex;
+        /* The stream for `conn`. Unused for our connection to ourself. */
+        stream_t primary_stream;
 
-        /* Calls `conn->flush_buffer()`. Can be used for making sure that a
-        buffered write makes it to the TCP stack. */
-        pump_coro_t flusher;
+        /* Additional TCP connections that carry the bulk lane. An entry is `NULL`
+        until the corresponding connection has been established. These are only
+        accessed on `conn`'s home thread. */
+        std::vector<stream_t *> bulk_streams;
 
         perfmon_collection_t pm_collection;
-        perfmon_sampler_t pm_bytes_sent;
-        perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership;
+        perfmon_sampler_t pm_bytes_sent, pm_wire_bytes_sent;
+        perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership,
+            pm_wire_bytes_sent_membership;
 
         /* We only hold this information so we can deregister ourself */
         run_t *parent;
@@ -203,7 +296,9 @@ public:
                   heartbeat_semilattice_metadata_t> > heartbeat_sl_view,
               std::shared_ptr<semilattice_read_view_t<
                   auth_semilattice_metadata_t> > auth_sl_view,
-              tls_ctx_t *tls_ctx)
+              tls_ctx_t *tls_ctx,
+              const cluster_connection_config_t &connection_config =
+                  cluster_connection_config_t())
             THROWS_ONLY(address_in_use_exc_t, tcp_socket_exc_t);
 
         ~run_t();
@@ -287,7 +382,40 @@ public:
             boost::optional<server_id_t> expected_server_id,
             auto_drainer_t::lock_t,
             bool *successful_join_inout,
-            const int join_delay_secs) THROWS_NOTHING;
+            const int join_delay_secs,
+            int bulk_stream_index = 0) THROWS_NOTHING;
+
+        /* `connect_bulk_stream()` is spawned by `handle()` on one side of each new
+        connection for every additional TCP connection that the two servers agreed on.
+        It connects to the peer and runs `handle()` with a non-zero
+        `bulk_stream_index`. */
+        void connect_bulk_stream(const peer_address_t &peer_address,
+                                 const peer_id_t &peer_id,
+                                 const server_id_t &peer_server_id,
+                                 int bulk_stream_index,
+                                 const int join_delay_secs,
+                                 auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING;
+
+        /* `handle_bulk_stream()` is what `handle()` turns into once the handshake for
+        an additional TCP connection is done. It attaches the connection to the
+        `connection_t` for the peer and receives messages from it. */
+        join_result_t handle_bulk_stream(keepalive_tcp_conn_stream_t *conn,
+                                         const peer_id_t &peer_id,
+                                         const server_id_t &peer_server_id,
+                                         int bulk_stream_index,
+                                         bool compress,
+                                         bool decompress,
+                                         bool fragment,
+                                         const int join_delay_secs,
+                                         auto_drainer_t::lock_t drainer_lock);
+
+        /* Reads messages off `stream` and passes them to the message handlers until
+        the stream is closed or delivers invalid data. If `fragmented` is true, the
+        messages arrive as fragments and are reassembled before they are passed on. */
+        void handle_messages(connection_t *connection,
+                             auto_drainer_t::lock_t connection_keepalive,
+                             read_stream_t *stream,
+                             bool fragmented);
 
         connectivity_cluster_t *parent;
 
@@ -298,6 +426,8 @@ public:
 
         tls_ctx_t *tls_ctx;
 
+        cluster_connection_config_t connection_config;
+
         /* `attempt_table` is a table of all the host:port pairs we're currently
         trying to connect to or have connected to. If we are told to connect to
         an address already in this table, we'll just ignore it. That's important
@@ -359,11 +489,16 @@ public:
 
     /* Sends a message to the other server. The message is associated with a "tag",
     which determines which message handler on the other server will receive the message.
-    */
+    A message that turns out to be large is sent in the bulk lane, no matter which lane
+    was asked for. If there are several bulk streams, bulk messages with the same
+    `order_key` (the mailbox manager uses the destination mailbox) stay in order
+    relative to each other. */
     void send_message(connection_t *connection,
                       auto_drainer_t::lock_t connection_keepalive,
                       message_tag_t tag,
-                      cluster_send_message_write_callback_t *callback);
+                      cluster_send_message_write_callback_t *callback,
+                      cluster_message_lane_t lane = cluster_message_lane_t::NORMAL,
+                      uint64_t order_key = 0);
 
 private:
     friend class cluster_message_handler_t;
@@ -371,6 +506,19 @@ private:
 
     class heartbeat_manager_t;
 
+    /* How many messages are waiting to be sent in a lane, summed up over all
+    connections, and how long it took to send them. */
+    class lane_stats_t {
+    public:
+        lane_stats_t(perfmon_collection_t *parent, cluster_message_lane_t lane);
+
+        perfmon_collection_t collection;
+        perfmon_counter_t queue_depth;
+        perfmon_sampler_t latency;
+        perfmon_membership_t collection_membership, queue_depth_membership,
+            latency_membership;
+    };
+
     /* `me` is our `peer_id_t`. */
     const peer_id_t me;
 
@@ -401,6 +549,10 @@ private:
     perfmon_collection_t connectivity_collection;
     perfmon_membership_t stats_membership;
 
+    perfmon_collection_t lanes_collection;
+    perfmon_membership_t lanes_membership;
+    scoped_ptr_t<lane_stats_t> lane_stats[num_cluster_message_lanes];
+
     DISABLE_COPYING(connectivity_cluster_t);
 };
 
@@ -0,0 +1,105 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rpc/connectivity/compression.hpp"
+
+#include <algorithm>
+
+#include "errors.hpp"
+
+// zlib counts bytes in `uInt`s, so larger inputs are fed to it in pieces
+#define MAX_ZLIB_CHUNK_SIZE (1 << 30)
+
+// How much compressed data `cluster_inflate_read_stream_t` reads from the network at once
+#define INFLATE_READ_BUFFER_SIZE 65536
+
+cluster_deflater_t::cluster_deflater_t() {
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    /* We care more about latency than about the compression ratio, so we use the
+    fastest compression level. */
+    int zres = deflateInit(&zstream, Z_BEST_SPEED);
+    guarantee(zres == Z_OK, "Failed to initialize zlib deflate stream (%d)", zres);
+}
+
+cluster_deflater_t::~cluster_deflater_t() {
+    deflateEnd(&zstream);
+}
+
+void cluster_deflater_t::compress(const void *data, size_t size, bool flush,
+                                  std::vector<char> *out) {
+    const char *remaining = static_cast<const char *>(data);
+    do {
+        const size_t chunk_size = std::min<size_t>(size, MAX_ZLIB_CHUNK_SIZE);
+        const bool last_chunk = chunk_size == size;
+        zstream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(remaining));
+        zstream.avail_in = chunk_size;
+        const int mode = (flush && last_chunk) ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+
+        /* Keep calling `deflate()` until it leaves some output space unused; only
+        then has it consumed all the input and written out everything it had to. */
+        do {
+            const size_t offset = out->size();
+            const size_t space = std::max<size_t>(zstream.avail_in / 2, 1024);
+            out->resize(offset + space);
+            zstream.next_out = reinterpret_cast<Bytef *>(out->data() + offset);
+            zstream.avail_out = space;
+            int zres = deflate(&zstream, mode);
+            guarantee(zres == Z_OK || zres == Z_BUF_ERROR,
+                      "zlib deflate failed (%d)", zres);
+            out->resize(offset + space - zstream.avail_out);
+        } while (zstream.avail_out == 0);
+        guarantee(zstream.avail_in == 0);
+
+        remaining += chunk_size;
+        size -= chunk_size;
+    } while (size > 0);
+}
+
+cluster_inflate_read_stream_t::cluster_inflate_read_stream_t(read_stream_t *_inner) :
+    inner(_inner), in_buffer(INFLATE_READ_BUFFER_SIZE), failed(false) {
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    zstream.next_in = Z_NULL;
+    zstream.avail_in = 0;
+    int zres = inflateInit(&zstream);
+    guarantee(zres == Z_OK, "Failed to initialize zlib inflate stream (%d)", zres);
+}
+
+cluster_inflate_read_stream_t::~cluster_inflate_read_stream_t() {
+    inflateEnd(&zstream);
+}
+
+int64_t cluster_inflate_read_stream_t::read(void *p, int64_t n) {
+    if (failed) {
+        return -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    zstream.next_out = static_cast<Bytef *>(p);
+    zstream.avail_out = std::min<int64_t>(n, MAX_ZLIB_CHUNK_SIZE);
+    const uInt requested = zstream.avail_out;
+
+    /* Return as soon as we have produced anything at all, so that we never block on
+    the network while there is data for the caller. */
+    while (zstream.avail_out == requested) {
+        if (zstream.avail_in == 0) {
+            int64_t res = inner->read(in_buffer.data(), in_buffer.size());
+            if (res <= 0) {
+                failed = res < 0;
+                return res;
+            }
+            zstream.next_in = reinterpret_cast<Bytef *>(in_buffer.data());
+            zstream.avail_in = res;
+        }
+        int zres = inflate(&zstream, Z_SYNC_FLUSH);
+        if (zres != Z_OK && zres != Z_BUF_ERROR) {
+            /* This includes `Z_STREAM_END`; the sender never ends its stream. */
+            failed = true;
+            return -1;
+        }
+    }
+    return requested - zstream.avail_out;
+}
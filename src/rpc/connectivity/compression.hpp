@@ -0,0 +1,49 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef RPC_CONNECTIVITY_COMPRESSION_HPP_
+#define RPC_CONNECTIVITY_COMPRESSION_HPP_
+
+#include <zlib.h>
+
+#include <vector>
+
+#include "containers/archive/archive.hpp"
+#include "containers/scoped.hpp"
+
+/* `cluster_deflater_t` compresses the messages that are written to one intra-cluster
+TCP stream. All messages on a stream share a single zlib stream, so that small messages
+benefit from the dictionary built up by the ones before them. Whenever `compress()` is
+called with `flush` set, the output ends on a sync flush point so that the receiver can
+decode everything that was compressed so far without waiting for more data. */
+class cluster_deflater_t {
+public:
+    cluster_deflater_t();
+    ~cluster_deflater_t();
+
+    /* Appends the compressed form of `data` to `out`. */
+    void compress(const void *data, size_t size, bool flush, std::vector<char> *out);
+
+private:
+    z_stream zstream;
+
+    DISABLE_COPYING(cluster_deflater_t);
+};
+
+/* `cluster_inflate_read_stream_t` decompresses the data that a `cluster_deflater_t` on
+the other end of `inner` produced. A corrupted stream is reported as a read error. */
+class cluster_inflate_read_stream_t : public read_stream_t {
+public:
+    explicit cluster_inflate_read_stream_t(read_stream_t *inner);
+    ~cluster_inflate_read_stream_t();
+
+    MUST_USE int64_t read(void *p, int64_t n);
+
+private:
+    read_stream_t *inner;
+    z_stream zstream;
+    scoped_array_t<char> in_buffer;
+    bool failed;
+
+    DISABLE_COPYING(cluster_inflate_read_stream_t);
+};
+
+#endif  // RPC_CONNECTIVITY_COMPRESSION_HPP_
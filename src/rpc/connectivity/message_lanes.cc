@@ -0,0 +1,100 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rpc/connectivity/message_lanes.hpp"
+
+#include "arch/runtime/coroutines.hpp"
+#include "config/args.hpp"
+
+// Set in the second byte of a fragment header if the fragment ends its message
+#define FRAGMENT_LAST_FLAG 0x80
+
+const char *cluster_message_lane_name(cluster_message_lane_t lane) {
+    switch (lane) {
+    case cluster_message_lane_t::INTERACTIVE: return "interactive";
+    case cluster_message_lane_t::NORMAL: return "normal";
+    case cluster_message_lane_t::BULK: return "bulk";
+    default: unreachable();
+    }
+}
+
+void cluster_fragment_header_t::encode(char *out) const {
+    out[0] = static_cast<char>(tag);
+    out[1] = static_cast<char>(static_cast<uint8_t>(lane) | (last ? FRAGMENT_LAST_FLAG : 0));
+    for (size_t i = 0; i < 4; ++i) {
+        out[2 + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+}
+
+bool cluster_fragment_header_t::decode(const char *in) {
+    const uint8_t lane_and_flags = static_cast<uint8_t>(in[1]);
+    const uint8_t lane_number = lane_and_flags & ~FRAGMENT_LAST_FLAG;
+    if (lane_number >= num_cluster_message_lanes) {
+        return false;
+    }
+    tag = static_cast<uint8_t>(in[0]);
+    lane = static_cast<cluster_message_lane_t>(lane_number);
+    last = (lane_and_flags & FRAGMENT_LAST_FLAG) != 0;
+    size = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        size |= static_cast<uint32_t>(static_cast<uint8_t>(in[2 + i])) << (8 * i);
+    }
+    return size <= static_cast<uint32_t>(CLUSTER_MESSAGE_FRAGMENT_SIZE);
+}
+
+lane_mutex_t::acq_t::acq_t(lane_mutex_t *_mutex, cluster_message_lane_t lane) :
+    mutex(_mutex) {
+    mutex->lock(lane);
+}
+
+lane_mutex_t::acq_t::~acq_t() {
+    mutex->unlock();
+}
+
+lane_mutex_t::lane_mutex_t() : locked(false) {
+    for (int i = 0; i < num_cluster_message_lanes; ++i) {
+        bypasses[i] = 0;
+    }
+}
+
+lane_mutex_t::~lane_mutex_t() {
+    rassert(!locked);
+}
+
+void lane_mutex_t::lock(cluster_message_lane_t lane) {
+    if (locked) {
+        waiters[static_cast<int>(lane)].push_back(coro_t::self());
+        /* `unlock()` leaves `locked` set when it hands the lock to us. */
+        coro_t::wait();
+    } else {
+        locked = true;
+    }
+}
+
+void lane_mutex_t::unlock() {
+    rassert(locked);
+
+    /* Lanes are numbered in order of decreasing priority. */
+    int next_lane = -1;
+    for (int i = 0; i < num_cluster_message_lanes; ++i) {
+        if (!waiters[i].empty()) {
+            if (next_lane == -1 || bypasses[i] >= CLUSTER_LANE_MAX_BYPASSES) {
+                next_lane = i;
+            }
+        }
+    }
+    if (next_lane == -1) {
+        locked = false;
+        return;
+    }
+
+    for (int i = 0; i < num_cluster_message_lanes; ++i) {
+        if (i == next_lane) {
+            bypasses[i] = 0;
+        } else if (!waiters[i].empty()) {
+            ++bypasses[i];
+        }
+    }
+
+    coro_t *next = waiters[next_lane].front();
+    waiters[next_lane].pop_front();
+    next->notify_now_deprecated();
+}
@@ -0,0 +1,97 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef RPC_CONNECTIVITY_MESSAGE_LANES_HPP_
+#define RPC_CONNECTIVITY_MESSAGE_LANES_HPP_
+
+#include <stdint.h>
+
+#include <deque>
+
+#include "errors.hpp"
+
+class coro_t;
+
+/* Every intra-cluster message is sent in one of these lanes. Each TCP connection to a
+peer writes the messages of a lane in order, but a message in a higher-priority lane can
+overtake the ones in lower-priority lanes. Large messages are cut into fragments so that
+a multi-megabyte backfill chunk doesn't hold up a heartbeat for the whole time it takes
+to write it out.
+
+The numeric values are sent over the network, so don't change them. */
+enum class cluster_message_lane_t {
+    /* Heartbeats, Raft and primary queries; messages that something is waiting on */
+    INTERACTIVE = 0,
+    /* Everything else */
+    NORMAL = 1,
+    /* Large messages such as backfill chunks and range read responses. Every message
+    that is at least `CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE` bytes large ends up here. */
+    BULK = 2
+};
+
+static const int num_cluster_message_lanes = 3;
+
+const char *cluster_message_lane_name(cluster_message_lane_t lane);
+
+/* If two servers agree to use fragments (see `handshake_options_t` in `cluster.cc`),
+every message that they send each other is written as one or more fragments. Each
+fragment starts with this header and is followed by `size` bytes of the message. The
+fragments of a message all carry its tag and its lane; the last one has `last` set. */
+class cluster_fragment_header_t {
+public:
+    static const size_t serialized_size = 6;
+
+    cluster_fragment_header_t() :
+        tag(0), lane(cluster_message_lane_t::NORMAL), last(false), size(0) { }
+
+    void encode(char *out) const;
+
+    /* Returns `false` if `in` isn't a valid header. */
+    MUST_USE bool decode(const char *in);
+
+    uint8_t tag;
+    cluster_message_lane_t lane;
+    bool last;
+    uint32_t size;
+};
+
+/* `lane_mutex_t` is like a `mutex_t`, except that a waiter in a higher-priority lane
+gets the lock before waiters in lower-priority lanes. To make sure that the bulk lane
+still makes progress under a steady stream of small messages, a lane that has been passed
+over `CLUSTER_LANE_MAX_BYPASSES` times in a row gets the lock next. Within a lane, the
+waiters get the lock in the order in which they asked for it.
+
+The lock is always handed over eagerly, because the senders that use it hold it only for
+as long as it takes to write a single fragment. */
+class lane_mutex_t {
+public:
+    class acq_t {
+    public:
+        acq_t(lane_mutex_t *mutex, cluster_message_lane_t lane);
+        ~acq_t();
+
+    private:
+        lane_mutex_t *mutex;
+
+        DISABLE_COPYING(acq_t);
+    };
+
+    lane_mutex_t();
+    ~lane_mutex_t();
+
+    bool is_locked() const {
+        return locked;
+    }
+
+private:
+    void lock(cluster_message_lane_t lane);
+    void unlock();
+
+    bool locked;
+    std::deque<coro_t *> waiters[num_cluster_message_lanes];
+
+    /* How many times the lock went to another lane while this lane had waiters */
+    int bypasses[num_cluster_message_lanes];
+
+    DISABLE_COPYING(lane_mutex_t);
+};
+
+#endif  // RPC_CONNECTIVITY_MESSAGE_LANES_HPP_
@@ -113,10 +113,14 @@ private:
 };
 
 void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
-                mailbox_write_callback_t *callback) {
+                mailbox_write_callback_t *callback, cluster_message_lane_t lane) {
     guarantee(src);
     guarantee(!dest.is_nil());
-    new_semaphore_in_line_t acq(src->semaphores.get(), 1);
+    new_semaphore_in_line_t acq(
+        lane == cluster_message_lane_t::INTERACTIVE
+            ? src->interactive_semaphores.get()
+            : src->semaphores.get(),
+        1);
     acq.acquisition_signal()->wait();
     connectivity_cluster_t::connection_t *connection;
     auto_drainer_t::lock_t connection_keepalive;
@@ -126,7 +130,7 @@ void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
     }
     raw_mailbox_writer_t writer(dest.thread, dest.mailbox_id, callback);
     src->get_connectivity_cluster()->send_message(connection, connection_keepalive,
-        src->get_message_tag(), &writer);
+        src->get_message_tag(), &writer, lane, dest.mailbox_id);
 }
 
 static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
@@ -134,7 +138,8 @@ static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
 mailbox_manager_t::mailbox_manager_t(connectivity_cluster_t *_connectivity_cluster,
         connectivity_cluster_t::message_tag_t message_tag) :
     cluster_message_handler_t(_connectivity_cluster, message_tag),
-    semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD)
+    semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD),
+    interactive_semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD)
     { }
 
 mailbox_manager_t::mailbox_table_t::mailbox_table_t() {
@@ -53,7 +53,8 @@ public:
 private:
     friend class mailbox_manager_t;
     friend class raw_mailbox_writer_t;
-    friend void send_write(mailbox_manager_t *, address_t, mailbox_write_callback_t *);
+    friend void send_write(mailbox_manager_t *, address_t, mailbox_write_callback_t *,
+                           cluster_message_lane_t);
 
     mailbox_manager_t *manager;
 
@@ -98,7 +99,7 @@ public:
         RDB_MAKE_ME_SERIALIZABLE_3(address_t, peer, thread, mailbox_id);
 
     private:
-        friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+        friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback, cluster_message_lane_t lane);
         friend struct raw_mailbox_t;
         friend class mailbox_manager_t;
 
@@ -127,11 +128,20 @@ public:
 
 /* `send_write()` sends a message to a mailbox. `send_write()` can block and must be called
 in a coroutine. If the mailbox does not exist or the peer is disconnected, `send_write()`
-will silently fail. Mailbox messages are not necessarily delivered in order. */
+will silently fail. Mailbox messages are not necessarily delivered in order. `lane`
+determines the priority of the message on its way over the network; see
+`cluster_message_lane_t`. */
 
 void send_write(mailbox_manager_t *src,
                 raw_mailbox_t::address_t dest,
-                mailbox_write_callback_t *callback);
+                mailbox_write_callback_t *callback,
+                cluster_message_lane_t lane);
+
+inline void send_write(mailbox_manager_t *src,
+                       raw_mailbox_t::address_t dest,
+                       mailbox_write_callback_t *callback) {
+    send_write(src, dest, callback, cluster_message_lane_t::NORMAL);
+}
 
 /* `mailbox_manager_t` is a `cluster_message_handler_t` that takes care
 of actually routing messages to mailboxes. */
@@ -143,7 +153,7 @@ public:
 
 private:
     friend struct raw_mailbox_t;
-    friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+    friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback, cluster_message_lane_t lane);
 
     struct mailbox_table_t {
         mailbox_table_t();
@@ -157,8 +167,10 @@ private:
 
     /* We must acquire one of these semaphores whenever we want to send a message over a
     mailbox. This prevents mailbox messages from starving directory and semilattice
-    messages. */
+    messages. Messages in the interactive lane have their own semaphores, so that they
+    don't have to wait for large messages to be sent. */
     one_per_thread_t<new_semaphore_t> semaphores;
+    one_per_thread_t<new_semaphore_t> interactive_semaphores;
 
     raw_mailbox_t::id_t generate_mailbox_id();
 
@@ -133,6 +133,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_0_SINCE_v2_4(type_t) \
     RDB_IMPL_SERIALIZABLE_0(type_t); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_0_SINCE_v2_5(type_t) \
+    RDB_IMPL_SERIALIZABLE_0(type_t); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_0(type_t) \
     template <cluster_version_t W> \
     friend void serialize(UNUSED write_message_t *wm, UNUSED const type_t &thing) { \
@@ -203,6 +207,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_1_SINCE_v2_4(type_t, field1) \
     RDB_IMPL_SERIALIZABLE_1(type_t, field1); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_1_SINCE_v2_5(type_t, field1) \
+    RDB_IMPL_SERIALIZABLE_1(type_t, field1); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_1(type_t, field1) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -283,6 +291,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_2_SINCE_v2_4(type_t, field1, field2) \
     RDB_IMPL_SERIALIZABLE_2(type_t, field1, field2); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_2_SINCE_v2_5(type_t, field1, field2) \
+    RDB_IMPL_SERIALIZABLE_2(type_t, field1, field2); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_2(type_t, field1, field2) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -373,6 +385,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_3_SINCE_v2_4(type_t, field1, field2, field3) \
     RDB_IMPL_SERIALIZABLE_3(type_t, field1, field2, field3); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_3_SINCE_v2_5(type_t, field1, field2, field3) \
+    RDB_IMPL_SERIALIZABLE_3(type_t, field1, field2, field3); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_3(type_t, field1, field2, field3) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -473,6 +489,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_4_SINCE_v2_4(type_t, field1, field2, field3, field4) \
     RDB_IMPL_SERIALIZABLE_4(type_t, field1, field2, field3, field4); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_4_SINCE_v2_5(type_t, field1, field2, field3, field4) \
+    RDB_IMPL_SERIALIZABLE_4(type_t, field1, field2, field3, field4); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_4(type_t, field1, field2, field3, field4) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -583,6 +603,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_5_SINCE_v2_4(type_t, field1, field2, field3, field4, field5) \
     RDB_IMPL_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_5_SINCE_v2_5(type_t, field1, field2, field3, field4, field5) \
+    RDB_IMPL_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -703,6 +727,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_6_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6) \
     RDB_IMPL_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_6_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6) \
+    RDB_IMPL_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -833,6 +861,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_7_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7) \
     RDB_IMPL_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_7_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7) \
+    RDB_IMPL_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -973,6 +1005,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_8_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
     RDB_IMPL_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_8_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
+    RDB_IMPL_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1123,6 +1159,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_9_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
     RDB_IMPL_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_9_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
+    RDB_IMPL_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1283,6 +1323,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_10_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
     RDB_IMPL_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_10_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
+    RDB_IMPL_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1453,6 +1497,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_11_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
     RDB_IMPL_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_11_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
+    RDB_IMPL_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1633,6 +1681,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_12_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
     RDB_IMPL_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_12_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
+    RDB_IMPL_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1823,6 +1875,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_13_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
     RDB_IMPL_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_13_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
+    RDB_IMPL_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2023,6 +2079,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_14_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
     RDB_IMPL_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_14_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
+    RDB_IMPL_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2233,6 +2293,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_15_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
     RDB_IMPL_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_15_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
+    RDB_IMPL_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2453,6 +2517,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_16_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
     RDB_IMPL_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_16_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
+    RDB_IMPL_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2683,6 +2751,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_17_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
     RDB_IMPL_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_17_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
+    RDB_IMPL_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2923,6 +2995,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_18_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
     RDB_IMPL_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_18_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
+    RDB_IMPL_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -3173,6 +3249,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_19_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
     RDB_IMPL_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_19_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
+    RDB_IMPL_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
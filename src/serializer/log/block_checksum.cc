@@ -0,0 +1,85 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "serializer/log/block_checksum.hpp"
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+// The CRC32C (Castagnoli) polynomial, bit-reversed.
+const uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+class crc32c_table_t {
+public:
+    crc32c_table_t() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLYNOMIAL : 0);
+            }
+            table_[i] = crc;
+        }
+    }
+
+    uint32_t update(uint32_t crc, const uint8_t *data, size_t size) const {
+        for (size_t i = 0; i < size; ++i) {
+            crc = table_[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+private:
+    uint32_t table_[256];
+};
+
+uint32_t crc32c_software(uint32_t crc, const uint8_t *data, size_t size) {
+    static const crc32c_table_t table;
+    return table.update(crc, data, size);
+}
+
+#if defined(__x86_64__)
+// We don't compile with -msse4.2, so this function gets to use the instruction on its
+// own and must only be called if the CPU supports it.
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t *data, size_t size) {
+    uint64_t crc64 = crc;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(word);
+        size -= sizeof(word);
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    for (; size > 0; --size, ++data) {
+        crc32 = _mm_crc32_u8(crc32, *data);
+    }
+    return crc32;
+}
+
+bool cpu_has_sse42() {
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+    return has_sse42;
+}
+#endif
+
+uint32_t compute_block_checksum(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint32_t crc;
+#if defined(__x86_64__)
+    if (cpu_has_sse42()) {
+        crc = ~crc32c_sse42(~0u, bytes, size);
+    } else {
+        crc = ~crc32c_software(~0u, bytes, size);
+    }
+#else
+    crc = ~crc32c_software(~0u, bytes, size);
+#endif
+    return crc == NO_BLOCK_CHECKSUM ? 1 : crc;
+}
+
+bool block_checksum_matches(const void *data, size_t size, uint32_t checksum) {
+    return checksum == NO_BLOCK_CHECKSUM
+        || compute_block_checksum(data, size) == checksum;
+}
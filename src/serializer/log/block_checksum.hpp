@@ -0,0 +1,24 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_BLOCK_CHECKSUM_HPP_
+#define SERIALIZER_LOG_BLOCK_CHECKSUM_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The LBA stores a CRC32C checksum for each data block, computed over the bytes that
+the block takes up on disk (so over the compressed form of a compressed block, without
+the padding). Reads verify it, and the serializer's scrub (see
+`log_serializer_t::scrub()`) goes over all live blocks to check it.
+
+A checksum of 0 means that the block doesn't have one, because it was written before
+the LBA stored checksums. Blocks whose CRC happens to be 0 are stored with a checksum
+of 1 instead. */
+const uint32_t NO_BLOCK_CHECKSUM = 0;
+
+// Uses the SSE 4.2 CRC32 instruction if the CPU has it.
+uint32_t compute_block_checksum(const void *data, size_t size);
+
+// Also true if there is no checksum to compare against.
+bool block_checksum_matches(const void *data, size_t size, uint32_t checksum);
+
+#endif  // SERIALIZER_LOG_BLOCK_CHECKSUM_HPP_
@@ -0,0 +1,69 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "serializer/log/block_compression.hpp"
+
+#include <zlib.h>
+
+#include "config/args.hpp"
+#include "math.hpp"
+
+buf_ptr_t compress_block(const ser_buffer_t *buf, block_size_t block_size) {
+    // The compressed block has to fit into at least one device block less than the
+    // original, otherwise it would take up just as much space on disk.
+    const uint32_t aligned_size = buf_ptr_t::compute_aligned_block_size(block_size);
+    if (aligned_size <= DEVICE_BLOCK_SIZE + sizeof(compressed_block_header_t)) {
+        return buf_ptr_t();
+    }
+    const uint32_t max_disk_size = aligned_size - DEVICE_BLOCK_SIZE;
+
+    buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(
+        block_size_t::unsafe_make(max_disk_size));
+    compressed_block_header_t *header
+        = reinterpret_cast<compressed_block_header_t *>(ret.ser_buffer());
+    header->ser_header = buf->ser_header;
+    header->ser_block_size = block_size.ser_value();
+
+    uLongf compressed_size = max_disk_size - sizeof(compressed_block_header_t);
+    /* We favor speed over the compression ratio, since this happens on every block
+    write. */
+    int zres = compress2(reinterpret_cast<Bytef *>(header + 1), &compressed_size,
+                         reinterpret_cast<const Bytef *>(buf->cache_data),
+                         block_size.value(), Z_BEST_SPEED);
+    if (zres == Z_BUF_ERROR) {
+        // The block doesn't compress well enough.
+        return buf_ptr_t();
+    }
+    guarantee(zres == Z_OK, "zlib compress failed (%d)", zres);
+
+    ret.resize_fill_zero(block_size_t::unsafe_make(
+        sizeof(compressed_block_header_t) + compressed_size));
+    return ret;
+}
+
+block_size_t compressed_block_original_size(const ser_buffer_t *compressed) {
+    return block_size_t::unsafe_make(
+        reinterpret_cast<const compressed_block_header_t *>(compressed)->ser_block_size);
+}
+
+buf_ptr_t decompress_block(const ser_buffer_t *compressed,
+                           block_size_t disk_block_size) {
+    guarantee(disk_block_size.ser_value() > sizeof(compressed_block_header_t));
+    const compressed_block_header_t *header
+        = reinterpret_cast<const compressed_block_header_t *>(compressed);
+    const block_size_t block_size = compressed_block_original_size(compressed);
+    guarantee(block_size.ser_value() > disk_block_size.ser_value(),
+              "Compressed block %" PR_BLOCK_ID " has an invalid size (%" PRIu32
+              " bytes, %" PRIu32 " compressed).", header->ser_header.block_id,
+              block_size.ser_value(), disk_block_size.ser_value());
+
+    buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
+    ret.ser_buffer()->ser_header = header->ser_header;
+    uLongf size = block_size.value();
+    int zres = uncompress(reinterpret_cast<Bytef *>(ret.cache_data()), &size,
+                          reinterpret_cast<const Bytef *>(header + 1),
+                          disk_block_size.ser_value() - sizeof(compressed_block_header_t));
+    guarantee(zres == Z_OK && size == block_size.value(),
+              "Compressed block %" PR_BLOCK_ID " is corrupted (zlib returned %d).",
+              header->ser_header.block_id, zres);
+    ret.fill_padding_zero();
+    return ret;
+}
@@ -0,0 +1,34 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
+#define SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
+
+#include "serializer/buf_ptr.hpp"
+#include "serializer/types.hpp"
+
+/* With `block_compression_t::ZLIB`, the log serializer writes a block in compressed
+form if that makes it take up fewer device blocks on disk. A compressed block starts
+with this header, followed by the block's `cache_data` as a zlib stream. The block ID
+stays uncompressed in front, because the GC and read-ahead look at it before they know
+whether the block needs to be decompressed.
+
+The LBA records the compressed size of each such block, so a compressed block is
+recognized by being stored with a size other than its block size. */
+ATTR_PACKED(struct compressed_block_header_t {
+    ls_buf_data_t ser_header;
+    // The block's ser size before compression.
+    uint32_t ser_block_size;
+});
+
+// Returns `buf` in compressed form, or an empty `buf_ptr_t` if compressing it wouldn't
+// save any space on disk. The block ID must already be set in `buf`.
+buf_ptr_t compress_block(const ser_buffer_t *buf, block_size_t block_size);
+
+// Returns the size of a compressed block before compression.
+block_size_t compressed_block_original_size(const ser_buffer_t *compressed);
+
+// The inverse of `compress_block()`. Crashes if `compressed` is not a valid compressed
+// block of `disk_block_size` bytes.
+buf_ptr_t decompress_block(const ser_buffer_t *compressed,
+                           block_size_t disk_block_size);
+
+#endif  // SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
@@ -9,12 +9,19 @@
 #include "serializer/types.hpp"
 #include "rpc/serialize_macros.hpp"
 
+/* How the serializer compresses the blocks that it writes. See
+serializer/log/block_compression.hpp. */
+enum class block_compression_t { NONE, ZLIB };
+
 /* Configuration for the serializer that can change from run to run */
 
 struct log_serializer_dynamic_config_t {
     log_serializer_dynamic_config_t() {
         read_ahead = true;
         io_batch_factor = DEFAULT_IO_BATCH_FACTOR;
+        block_compression = block_compression_t::NONE;
+        scrub_interval_secs = DEFAULT_SERIALIZER_SCRUB_INTERVAL_SECS;
+        gc_temperature_tiers = 1;
     }
 
     /* The (minimal) batch size of i/o requests being taken from a single i/o account.
@@ -24,6 +31,21 @@ struct log_serializer_dynamic_config_t {
 
     /* Enable reading more data than requested to let the cache warmup more quickly esp. on rotational drives */
     bool read_ahead;
+
+    /* Applies to blocks written from now on. Blocks that are already on disk are
+    read back in whichever form they were written in, so this can be switched freely
+    between runs. */
+    block_compression_t block_compression;
+
+    /* How long the serializer waits before each scrub of its blocks, see
+    `log_serializer_t::scrub()`. 0 turns off scrubbing in the background. */
+    int64_t scrub_interval_secs;
+
+    /* Into how many groups of extents the GC sorts the blocks that it moves, by how
+    long ago they were last written (their recency). Between 1 and
+    `MAX_GC_TEMPERATURE_TIERS`, set by `--gc-temperature-tiers`. See
+    serializer/log/data_block_manager.cc. */
+    int32_t gc_temperature_tiers;
 };
 
 /* This is equivalent to log_serializer_static_config_t below, but is an on-disk
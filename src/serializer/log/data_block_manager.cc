@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <sys/uio.h>
 
+#include <algorithm>
 #include <functional>
 
 #include "arch/arch.hpp"
@@ -13,6 +14,8 @@
 #include "errors.hpp"
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
+#include "serializer/log/block_checksum.hpp"
+#include "serializer/log/block_compression.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "stl_utils.hpp"
 
@@ -51,6 +54,35 @@ const size_t GC_YOUNG_EXTENT_MAX_SIZE = 50;
 // What's the definition of a "young" extent in microseconds?
 const microtime_t GC_YOUNG_EXTENT_TIMELIMIT_MICROS = 50000;
 
+// The write stream for new writes.  The GC's streams follow it, from the hottest
+// temperature tier to the coldest.
+const size_t NEW_WRITES_STREAM = 0;
+
+// How the GC sorts the blocks it moves into temperature tiers, if there is more than
+// one.  Within a table, the recency goes up by one with every write.  The first tier
+// takes blocks written less than GC_TEMPERATURE_TIER_BASE_AGE writes before the
+// newest block, and each tier after that blocks up to GC_TEMPERATURE_TIER_AGE_FACTOR
+// times older than that.  The last tier takes everything older.
+const uint64_t GC_TEMPERATURE_TIER_BASE_AGE = 4096;
+const uint64_t GC_TEMPERATURE_TIER_AGE_FACTOR = 16;
+
+// How often we recompute the age of the GC candidates, in microseconds.
+const microtime_t GC_PRIORITY_REFRESH_INTERVAL_MICROS = 1000000;
+
+// How much slower than without GC foreground reads may get while the GC is running,
+// before the rate controller backs off.
+constexpr double GC_READ_LATENCY_TOLERANCE = 2.0;
+// The weight of a new sample in the moving averages of the read latency.
+constexpr double GC_READ_LATENCY_EWMA_WEIGHT = 0.05;
+// While the GC is running, we can't measure the read latency without it.  So that
+// a baseline from long ago doesn't stay around forever when the workload changes,
+// it follows the latency we see with GC with this much smaller weight.
+constexpr double GC_READ_LATENCY_BASELINE_DECAY_WEIGHT = 0.001;
+// How the rate controller changes its throttle after each read (see
+// `gc_rate_controller_t::record_read_latency()`).
+constexpr double GC_THROTTLE_DECREASE_FACTOR = 0.9;
+constexpr double GC_THROTTLE_INCREASE = 0.01;
+
 
 // Identifies an extent, the time we started writing to the
 // extent, whether it's the extent we're currently writing to, and
@@ -59,17 +91,20 @@ class gc_entry_t : public intrusive_list_node_t<gc_entry_t> {
 private:
     struct block_info_t {
         uint32_t relative_offset;
+        // The size of the block on disk.
         block_size_t block_size;
         bool token_referenced;
         bool index_referenced;
+        bool compressed;
     };
 
 public:
     /* This constructor is for starting a new active extent. */
-    explicit gc_entry_t(data_block_manager_t *_parent)
+    gc_entry_t(data_block_manager_t *_parent, extent_temperature_t temperature)
         : parent(_parent),
-          extent_ref(parent->extent_manager->gen_extent()),
+          extent_ref(parent->extent_manager->gen_extent(temperature)),
           timestamp(current_microtime()),
+          data_timestamp(timestamp),
           was_written(false),
           state(state_active),
           garbage_bytes_stat(_parent->static_config->extent_size()),
@@ -84,6 +119,7 @@ public:
         : parent(_parent),
           extent_ref(parent->extent_manager->reserve_extent(_offset)),
           timestamp(current_microtime()),
+          data_timestamp(timestamp),
           was_written(false),
           state(state_reconstructing),
           garbage_bytes_stat(_parent->static_config->extent_size()),
@@ -136,6 +172,14 @@ public:
         return block_infos[_block_index].block_size;
     }
 
+    // True if the block_index'th block is stored compressed, in which case
+    // `block_size()` is its compressed size.
+    bool block_is_compressed(unsigned int _block_index) const {
+        guarantee(state != state_reconstructing);
+        guarantee(_block_index < block_infos.size());
+        return block_infos[_block_index].compressed;
+    }
+
     // Returns block_boundaries()[block_index].
     uint32_t relative_offset(unsigned int _block_index) const {
         guarantee(state != state_reconstructing);
@@ -155,6 +199,7 @@ public:
     }
 
     bool new_offset(block_size_t _block_size,
+                    bool compressed,
                     uint32_t *relative_offset_out,
                     unsigned int *block_index_out) {
         // Returns true if there's enough room at the end of the extent for the new
@@ -170,7 +215,8 @@ public:
         } else {
             *relative_offset_out = offset;
             *block_index_out = block_infos.size();
-            block_infos.push_back(block_info_t{offset, _block_size, false, false});
+            block_infos.push_back(
+                block_info_t{offset, _block_size, false, false, compressed});
             update_stats(nullptr, &block_infos.back());
             return true;
         }
@@ -195,6 +241,15 @@ public:
         return garbage_bytes_stat;
     }
 
+    // How much we want to GC the extent.  This only changes when the extent's
+    // garbage does, or in `data_block_manager_t::refresh_gc_priorities()`.
+    double gc_priority() const {
+        return gc_extent_priority(garbage_bytes(),
+                                  parent->static_config->extent_size(),
+                                  data_timestamp,
+                                  parent->gc_priority_time);
+    }
+
     bool block_is_garbage(unsigned int _block_index) const {
         guarantee(state != state_reconstructing);
         guarantee(_block_index < block_infos.size());
@@ -239,22 +294,26 @@ public:
                                 &gc_entry_t::info_less);
     }
 
-    void mark_live_indexwise_with_offset(int64_t offset, block_size_t _block_size) {
+    void mark_live_indexwise_with_offset(int64_t offset, block_size_t _block_size,
+                                         bool compressed) {
         guarantee(offset >= extent_ref.offset() && offset < extent_ref.offset() + UINT32_MAX);
 
         uint32_t _relative_offset = offset - extent_ref.offset();
 
         auto it = find_lower_bound_iter(_relative_offset);
         if (it == block_infos.end()) {
-            block_infos.push_back(block_info_t{_relative_offset, _block_size, false, true});
+            block_infos.push_back(
+                block_info_t{_relative_offset, _block_size, false, true, compressed});
             update_stats(nullptr, &block_infos.back());
         } else if (it->relative_offset > _relative_offset) {
             guarantee(it->relative_offset >= _relative_offset + aligned_value(_block_size));
-            auto new_block = block_infos.insert(it, block_info_t{_relative_offset, _block_size, false, true});
+            auto new_block = block_infos.insert(
+                it, block_info_t{_relative_offset, _block_size, false, true, compressed});
             update_stats(nullptr, &*new_block);
         } else {
             guarantee(it->relative_offset == _relative_offset);
             guarantee(it->block_size == _block_size);
+            guarantee(it->compressed == compressed);
             const block_info_t old_info = *it;
             it->index_referenced = true;
             update_stats(&old_info, &*it);
@@ -293,11 +352,12 @@ public:
         const int64_t offset = extent_ref.offset();
         std::string ret;
         for (auto it = block_infos.begin(); it != block_infos.end(); ++it) {
-            ret += strprintf("%s[%" PRIi64 "..+%" PRIu32 ") %c%c",
+            ret += strprintf("%s[%" PRIi64 "..+%" PRIu32 ") %c%c%c",
                              it == block_infos.begin() ? "" : separator,
                              offset + it->relative_offset, it->block_size.ser_value(),
                              it->token_referenced ? 'T' : ' ',
-                             it->index_referenced ? 'I' : ' ');
+                             it->index_referenced ? 'I' : ' ',
+                             it->compressed ? 'C' : ' ');
         }
         return ret;
     }
@@ -349,6 +409,11 @@ public:
     // When we started writing to the extent (this time).
     const microtime_t timestamp;
 
+    // When the newest block in the extent was written, not counting the GC moving
+    // it around.  We don't know this for extents from before a restart, and use
+    // the time we started up instead.
+    microtime_t data_timestamp;
+
     // The PQ entry pointing to us.
     priority_queue_t<gc_entry_t *, gc_entry_less_t>::entry_t *our_pq_entry;
 
@@ -358,8 +423,8 @@ public:
     enum state_t {
         // It has been, or is being, reconstructed from data on disk.
         state_reconstructing,
-        // We are currently putting things on this extent. It is equal to
-        // last_data_extent.
+        // We are currently putting things on this extent. It is in
+        // active_extents.
         state_active,
         // Not active, but not a GC candidate yet. It is in young_extent_queue.
         state_young,
@@ -391,6 +456,7 @@ data_block_manager_t::data_block_manager_t(
     : stats(_stats), shutdown_callback(nullptr), state(state_unstarted),
       gc_enabled(true), static_config(_static_config), extent_manager(em),
       serializer(_serializer),
+      gc_priority_time(current_microtime()),
       gc_index_write_pumper(std::bind(
           &data_block_manager_t::flush_gc_index_writes, this, std::placeholders::_1)),
       /* The capacity of the gc_index_write_semaphore will be scaled
@@ -411,38 +477,46 @@ void data_block_manager_t::prepare_initial_metablock(data_block_manager::metablo
     mb->active_extent = NULL_OFFSET;
 }
 
-void data_block_manager_t::start_reconstruct() {
+void data_block_manager_t::start_reconstruct(file_t *file) {
     guarantee(state == state_unstarted);
+    dbfile = file;
+    state = state_reconstructing;
 }
 
 // Marks the block at the given offset as alive, in the appropriate
 // gc_entry_t in the entries table.  (This is used when we start up, when
 // everything is presumed to be garbage, until we mark it as
 // non-garbage.)
-void data_block_manager_t::mark_live(int64_t offset, block_size_t ser_block_size) {
+void data_block_manager_t::mark_live(int64_t offset, block_size_t ser_block_size,
+                                     block_size_t disk_block_size) {
     uint64_t extent_id = static_config->extent_index(offset);
 
     if (entries.get(extent_id) == nullptr) {
-        guarantee(state == state_unstarted); // This is called at startup.
+        guarantee(state == state_reconstructing); // This is called at startup.
 
         gc_entry_t *entry = new gc_entry_t(this, extent_id * extent_manager->extent_size);
         reconstructed_extents.push_back(entry);
     }
 
     gc_entry_t *entry = entries.get(extent_id);
-    entry->mark_live_indexwise_with_offset(offset, ser_block_size);
+    entry->mark_live_indexwise_with_offset(offset, disk_block_size,
+                                           disk_block_size != ser_block_size);
 }
 
 void data_block_manager_t::end_reconstruct() {
-    guarantee(state == state_unstarted);
+    guarantee(state == state_reconstructing);
 }
 
-void data_block_manager_t::start_existing(file_t *file,
-                                          data_block_manager::metablock_mixin_t *last_metablock) {
-    guarantee(state == state_unstarted);
-    dbfile = file;
-    gc_io_account_nice.init(new file_account_t(file, GC_IO_PRIORITY_NICE));
-    gc_io_account_high.init(new file_account_t(file, GC_IO_PRIORITY_HIGH));
+void data_block_manager_t::start_existing(
+        data_block_manager::metablock_mixin_t *last_metablock) {
+    guarantee(state == state_reconstructing);
+    gc_io_account_nice.init(new file_account_t(dbfile, GC_IO_PRIORITY_NICE));
+    gc_io_account_high.init(new file_account_t(dbfile, GC_IO_PRIORITY_HIGH));
+
+    const size_t num_gc_tiers = std::min<size_t>(
+        std::max<int32_t>(1, serializer->dynamic_config.gc_temperature_tiers),
+        MAX_GC_TEMPERATURE_TIERS);
+    active_extents.assign(1 + num_gc_tiers, nullptr);
 
     /* Reconstruct the active data block extents from the metablock. */
     const int64_t offset = last_metablock->active_extent;
@@ -456,7 +530,7 @@ void data_block_manager_t::start_existing(file_t *file,
             reconstructed_extents.push_back(e);
         }
 
-        active_extent = entries.get(offset / extent_manager->extent_size);
+        gc_entry_t *active_extent = entries.get(offset / extent_manager->extent_size);
         guarantee(active_extent != nullptr);
 
         /* Turn the extent from a reconstructing extent into an active extent */
@@ -464,8 +538,7 @@ void data_block_manager_t::start_existing(file_t *file,
         reconstructed_extents.remove(active_extent);
 
         active_extent->make_active();
-    } else {
-        active_extent = nullptr;
+        active_extents[NEW_WRITES_STREAM] = active_extent;
     }
 
     /* Convert any extents that we found live blocks in, but that are not active
@@ -483,6 +556,13 @@ void data_block_manager_t::start_existing(file_t *file,
     }
 
     state = state_ready;
+
+    // Blocks that got read while we were reconstructing already have tokens.
+    for (auto it = serializer->offset_tokens.begin();
+         it != serializer->offset_tokens.end();
+         it = serializer->offset_tokens.upper_bound(it->first)) {
+        mark_live_tokenwise_with_offset(it->first);
+    }
 }
 
 // Computes an offset and end offset for the purposes of readahead.  Returns an interval
@@ -651,14 +731,30 @@ public:
                 }
 
                 const block_size_t block_size = block_size_t::unsafe_make(info.ser_block_size);
-                buf_ptr_t buf = buf_ptr_t::alloc_uninitialized(block_size);
-                memcpy(buf.ser_buffer(), current_buf, info.ser_block_size);
-                buf.fill_padding_zero();
-                guarantee(info.ser_block_size <= *(lower_it + 1) - *lower_it);
+                const block_size_t disk_block_size
+                    = block_size_t::unsafe_make(info.disk_block_size());
+                guarantee(info.disk_block_size() <= *(lower_it + 1) - *lower_it);
+                if (!block_checksum_matches(current_buf, info.disk_block_size(),
+                                            info.checksum)) {
+                    // We leave it to the actual read of the block to report this.
+                    continue;
+                }
+                buf_ptr_t buf;
+                if (disk_block_size != block_size) {
+                    buf = decompress_block(
+                        reinterpret_cast<const ser_buffer_t *>(current_buf),
+                        disk_block_size);
+                } else {
+                    buf = buf_ptr_t::alloc_uninitialized(block_size);
+                    memcpy(buf.ser_buffer(), current_buf, info.ser_block_size);
+                    buf.fill_padding_zero();
+                }
 
                 counted_t<ls_block_token_pointee_t> ls_token
                     = parent->serializer->generate_block_token(current_offset,
-                                                               block_size);
+                                                               block_size,
+                                                               disk_block_size,
+                                                               info.checksum);
 
                 counted_t<standard_block_token_t> token
                     = to_standard_block_token(block_id, std::move(ls_token));
@@ -686,9 +782,30 @@ bool data_block_manager_t::should_perform_read_ahead(int64_t offset) {
 }
 
 buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
-                                   file_account_t *io_account) {
-    guarantee(state == state_ready);
-    if (should_perform_read_ahead(off_in)) {
+                                     block_size_t disk_block_size,
+                                     uint32_t checksum,
+                                     file_account_t *io_account) {
+    guarantee(state == state_ready || state == state_reconstructing);
+    const ticks_t start_ticks = get_ticks();
+    buf_ptr_t ret = read_from_disk(off_in, disk_block_size, io_account);
+    record_read_latency(ticks_to_secs(get_ticks() - start_ticks));
+    guarantee(block_checksum_matches(ret.ser_buffer(), disk_block_size.ser_value(),
+                                     checksum),
+              "Block %" PR_BLOCK_ID " at offset %" PRIi64 " of the database file is "
+              "corrupted (its checksum doesn't match).",
+              ret.ser_buffer()->ser_header.block_id, off_in);
+    if (disk_block_size != block_size) {
+        ret = decompress_block(ret.ser_buffer(), disk_block_size);
+        guarantee(ret.block_size() == block_size);
+    }
+    return ret;
+}
+
+buf_ptr_t data_block_manager_t::read_from_disk(int64_t off_in, block_size_t block_size,
+                                               file_account_t *io_account) {
+    // Read-ahead needs to know where the blocks are, which we only know once we are
+    // done reconstructing.
+    if (state == state_ready && should_perform_read_ahead(off_in)) {
         buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
         dbm_read_ahead_t::perform_read_ahead(this, off_in, block_size.ser_value(),
                                              ret.ser_buffer(), io_account, stats);
@@ -697,31 +814,45 @@ buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
         ret.fill_padding_zero();
         return ret;
     } else {
-        if (divides(DEVICE_BLOCK_SIZE, off_in)) {
-            buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
-            co_read(dbfile, off_in, ret.aligned_block_size(),
-                    ret.ser_buffer(), io_account);
-            stats->bytes_read(ret.aligned_block_size());
-            // Blocks are written DEVICE_BLOCK_SIZE-aligned -- so the block on disk
-            // should have been written with zero padding.
-            ret.assert_padding_zero();
-            return ret;
-        } else {
-            int64_t floor_off_in = floor_aligned(off_in, DEVICE_BLOCK_SIZE);
-            int64_t ceil_off_end = ceil_aligned(off_in + block_size.ser_value(),
-                                                DEVICE_BLOCK_SIZE);
-            scoped_device_block_aligned_ptr_t<char> buf(ceil_off_end - floor_off_in);
-            co_read(dbfile, floor_off_in, ceil_off_end - floor_off_in,
-                    buf.get(), io_account);
-
-            buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
-            memcpy(ret.ser_buffer(), buf.get() + (off_in - floor_off_in),
-                   block_size.ser_value());
-            stats->bytes_read(ret.aligned_block_size());
-            // We have to fill the padding to zero, in this case.
-            ret.fill_padding_zero();
-            return ret;
-        }
+        return read_from_disk_without_read_ahead(off_in, block_size, io_account);
+    }
+}
+
+bool data_block_manager_t::verify(int64_t off_in, block_size_t disk_block_size,
+                                  uint32_t checksum, file_account_t *io_account) {
+    guarantee(state == state_ready);
+    buf_ptr_t buf = read_from_disk_without_read_ahead(off_in, disk_block_size,
+                                                      io_account);
+    return block_checksum_matches(buf.ser_buffer(), disk_block_size.ser_value(),
+                                  checksum);
+}
+
+buf_ptr_t data_block_manager_t::read_from_disk_without_read_ahead(
+        int64_t off_in, block_size_t block_size, file_account_t *io_account) {
+    if (divides(DEVICE_BLOCK_SIZE, off_in)) {
+        buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
+        co_read(dbfile, off_in, ret.aligned_block_size(),
+                ret.ser_buffer(), io_account);
+        stats->bytes_read(ret.aligned_block_size());
+        // Blocks are written DEVICE_BLOCK_SIZE-aligned -- so the block on disk
+        // should have been written with zero padding.
+        ret.assert_padding_zero();
+        return ret;
+    } else {
+        int64_t floor_off_in = floor_aligned(off_in, DEVICE_BLOCK_SIZE);
+        int64_t ceil_off_end = ceil_aligned(off_in + block_size.ser_value(),
+                                            DEVICE_BLOCK_SIZE);
+        scoped_device_block_aligned_ptr_t<char> buf(ceil_off_end - floor_off_in);
+        co_read(dbfile, floor_off_in, ceil_off_end - floor_off_in,
+                buf.get(), io_account);
+
+        buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
+        memcpy(ret.ser_buffer(), buf.get() + (off_in - floor_off_in),
+               block_size.ser_value());
+        stats->bytes_read(ret.aligned_block_size());
+        // We have to fill the padding to zero, in this case.
+        ret.fill_padding_zero();
+        return ret;
     }
 }
 
@@ -729,14 +860,54 @@ std::vector<counted_t<ls_block_token_pointee_t> >
 data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
                                   file_account_t *io_account,
                                   iocallback_t *cb) {
-    // These tokens are grouped by extent.  You can do a contiguous write in each
-    // extent.
-    std::vector<std::vector<counted_t<ls_block_token_pointee_t> > > token_groups
-        = gimme_some_new_offsets(writes);
-
+    std::vector<block_write_t> block_writes;
+    block_writes.reserve(writes.size());
+    std::vector<buf_ptr_t> compressed_bufs;
     for (auto it = writes.begin(); it != writes.end(); ++it) {
         it->buf->ser_header.block_id = it->block_id;
+        block_writes.push_back(
+            prepare_block_write(it->buf, it->block_size, &compressed_bufs));
+    }
+
+    return write_blocks(block_writes, std::move(compressed_bufs), current_microtime(),
+                        io_account, cb);
+}
+
+data_block_manager_t::block_write_t data_block_manager_t::prepare_block_write(
+        ser_buffer_t *buf, block_size_t block_size,
+        std::vector<buf_ptr_t> *compressed_bufs_out) {
+    if (serializer->dynamic_config.block_compression == block_compression_t::ZLIB) {
+        buf_ptr_t compressed = compress_block(buf, block_size);
+        if (compressed.has()) {
+            ++stats->pm_serializer_compressed_block_writes;
+            stats->pm_serializer_compression_saved_bytes_total
+                += buf_ptr_t::compute_aligned_block_size(block_size)
+                - compressed.aligned_block_size();
+            block_write_t ret{compressed.ser_buffer(), block_size,
+                              compressed.block_size(),
+                              compute_block_checksum(
+                                  compressed.ser_buffer(),
+                                  compressed.block_size().ser_value()),
+                              NEW_WRITES_STREAM};
+            compressed_bufs_out->push_back(std::move(compressed));
+            return ret;
+        }
     }
+    return block_write_t{buf, block_size, block_size,
+                         compute_block_checksum(buf, block_size.ser_value()),
+                         NEW_WRITES_STREAM};
+}
+
+std::vector<counted_t<ls_block_token_pointee_t> >
+data_block_manager_t::write_blocks(const std::vector<block_write_t> &writes,
+                                   std::vector<buf_ptr_t> &&compressed_bufs,
+                                   microtime_t data_timestamp,
+                                   file_account_t *io_account,
+                                   iocallback_t *cb) {
+    // These tokens are grouped by extent.  You can do a contiguous write in each
+    // extent.
+    std::vector<std::vector<counted_t<ls_block_token_pointee_t> > > token_groups
+        = gimme_some_new_offsets(writes, data_timestamp);
 
     struct intermediate_cb_t : public iocallback_t {
         virtual void on_io_complete() {
@@ -750,6 +921,8 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
 
         size_t ops_remaining;
         iocallback_t *cb;
+        // Kept alive until the writes are complete.
+        std::vector<buf_ptr_t> compressed_bufs;
     };
 
     intermediate_cb_t *const intermediate_cb = new intermediate_cb_t;
@@ -757,13 +930,16 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
     // intermediate_cb->on_io_complete later.
     intermediate_cb->ops_remaining = token_groups.size() + 1;
     intermediate_cb->cb = cb;
+    intermediate_cb->compressed_bufs = std::move(compressed_bufs);
 
     size_t write_number = 0;
     for (size_t i = 0; i < token_groups.size(); ++i) {
+        // All writes in a group go to the same extent, and so to the same stream.
+        const write_stream_t stream = writes[write_number].stream;
 
         const int64_t front_offset = token_groups[i].front()->offset();
         const int64_t back_offset = token_groups[i].back()->offset()
-            + gc_entry_t::aligned_value(token_groups[i].back()->block_size());
+            + gc_entry_t::aligned_value(token_groups[i].back()->disk_block_size());
 
         guarantee(divides(DEVICE_BLOCK_SIZE, front_offset));
 
@@ -776,14 +952,14 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
 
         for (size_t j = 0; j < token_groups[i].size(); ++j) {
             const int64_t j_offset = token_groups[i][j]->offset();
-            const block_size_t j_block_size = token_groups[i][j]->block_size();
+            const block_size_t j_block_size = token_groups[i][j]->disk_block_size();
             guarantee(j_offset == last_written_offset);
             const size_t j_aligned_size = gc_entry_t::aligned_value(j_block_size);
             total_aligned_size += j_aligned_size;
 
             // The behavior of gimme_some_new_offsets is supposed to retain order, so
             // we expect writes[write_number] to have the currently-relevant write.
-            guarantee(writes[write_number].block_size == j_block_size);
+            guarantee(writes[write_number].disk_block_size == j_block_size);
 
             iovecs[j].iov_base = writes[write_number].buf;
             iovecs[j].iov_len = j_aligned_size;
@@ -798,6 +974,11 @@ data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
                              std::move(iovecs), io_account, intermediate_cb);
 
         stats->bytes_written(total_aligned_size);
+        if (stream == NEW_WRITES_STREAM) {
+            stats->pm_serializer_block_written_bytes_total += total_aligned_size;
+        } else {
+            stats->pm_serializer_gc_written_bytes_total += total_aligned_size;
+        }
     }
 
     // Call on_io_complete for degenerate case (we added 1 to ops_remaining
@@ -887,6 +1068,8 @@ size_t data_block_manager_t::compute_gc_concurrency() const {
     // the maximum at GC_HIGH_RATIO.
     // (If the GC ratio still keeps growing at that point, there's probably
     // not much we can do. Unless we would be ok with throttling writes.)
+    // Below GC_HIGH_RATIO, the rate controller scales that number down further
+    // if the GC slows down foreground reads too much.
     //
     // Also see `choose_gc_io_account()` for the second component in the automatic
     // GC scaling process.
@@ -906,7 +1089,8 @@ size_t data_block_manager_t::compute_gc_concurrency() const {
         double linear_factor = (gc_ratio - GC_START_RATIO)
             / (GC_HIGH_RATIO - GC_START_RATIO);
         size_t total_concurrency =
-            1 + static_cast<size_t>(linear_factor * MAX_CONCURRENT_GCS);
+            1 + static_cast<size_t>(linear_factor * gc_rate_controller.throttle()
+                                    * MAX_CONCURRENT_GCS);
         // std::min to avoid rounding errors leading to illegal return values
         return std::min(total_concurrency, MAX_CONCURRENT_GCS);
     }
@@ -922,6 +1106,8 @@ file_account_t *data_block_manager_t::choose_gc_io_account() {
 
     // Note that this means that we can end up oscillating between both accounts,
     // which is fine.
+    // The rate controller only ever lowers the GC's concurrency, so it doesn't
+    // affect the account.
     if (garbage_ratio() > GC_HIGH_RATIO) {
         return gc_io_account_high.get();
     } else {
@@ -929,6 +1115,57 @@ file_account_t *data_block_manager_t::choose_gc_io_account() {
     }
 }
 
+double read_latency_moving_average(double average, double sample, double weight) {
+    return average == 0.0 ? sample : (1.0 - weight) * average + weight * sample;
+}
+
+gc_rate_controller_t::gc_rate_controller_t()
+    : latency_without_gc_secs_(0.0),
+      latency_with_gc_secs_(0.0),
+      throttle_(1.0) { }
+
+bool gc_rate_controller_t::record_read_latency(double secs, bool gc_active) {
+    if (!gc_active) {
+        latency_without_gc_secs_ = read_latency_moving_average(
+            latency_without_gc_secs_, secs, GC_READ_LATENCY_EWMA_WEIGHT);
+        return false;
+    }
+
+    latency_with_gc_secs_ = read_latency_moving_average(
+        latency_with_gc_secs_, secs, GC_READ_LATENCY_EWMA_WEIGHT);
+
+    // Without a baseline we can't tell whether the GC is to blame.
+    if (latency_without_gc_secs_ == 0.0) {
+        return false;
+    }
+    latency_without_gc_secs_ = read_latency_moving_average(
+        latency_without_gc_secs_, secs, GC_READ_LATENCY_BASELINE_DECAY_WEIGHT);
+
+    if (latency_with_gc_secs_ > GC_READ_LATENCY_TOLERANCE * latency_without_gc_secs_) {
+        throttle_ = std::max(1.0 / MAX_CONCURRENT_GCS,
+                             throttle_ * GC_THROTTLE_DECREASE_FACTOR);
+        return true;
+    } else {
+        throttle_ = std::min(1.0, throttle_ + GC_THROTTLE_INCREASE);
+        return false;
+    }
+}
+
+void data_block_manager_t::record_read_latency(double secs) {
+    if (gc_rate_controller.record_read_latency(secs, !active_gcs.empty())) {
+        ++stats->pm_serializer_gc_backoffs;
+    }
+}
+
+void data_block_manager_t::refresh_gc_priorities() {
+    ASSERT_NO_CORO_WAITING;
+    const microtime_t now = current_microtime();
+    if (now > gc_priority_time + GC_PRIORITY_REFRESH_INTERVAL_MICROS) {
+        gc_priority_time = now;
+        gc_pq.rebuild();
+    }
+}
+
 void data_block_manager_t::mark_garbage(int64_t offset, extent_transaction_t *txn) {
     uint64_t extent_id = static_config->extent_index(offset);
     gc_entry_t *entry = entries.get(extent_id);
@@ -951,6 +1188,10 @@ void data_block_manager_t::mark_garbage(int64_t offset, extent_transaction_t *tx
 }
 
 void data_block_manager_t::mark_live_tokenwise_with_offset(int64_t offset) {
+    if (state == state_reconstructing) {
+        // `start_existing()` takes care of this.
+        return;
+    }
     uint64_t extent_id = static_config->extent_index(offset);
     gc_entry_t *entry = entries.get(extent_id);
     rassert(entry != nullptr);
@@ -960,6 +1201,9 @@ void data_block_manager_t::mark_live_tokenwise_with_offset(int64_t offset) {
 }
 
 void data_block_manager_t::mark_garbage_tokenwise_with_offset(int64_t offset) {
+    if (state == state_reconstructing) {
+        return;
+    }
     uint64_t extent_id = static_config->extent_index(offset);
     gc_entry_t *entry = entries.get(extent_id);
 
@@ -1065,6 +1309,7 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
         /* grab the entry */
         guarantee (!gc_pq.empty());
         guarantee(gc_state->current_entry == nullptr);
+        refresh_gc_priorities();
         gc_state->current_entry = gc_pq.pop();
         gc_state->current_entry->our_pq_entry = nullptr;
 
@@ -1177,8 +1422,30 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
                     gc_state->current_entry->extent_ref.offset()
                     + gc_state->current_entry->relative_offset(i);
 
+                const block_size_t disk_block_size
+                    = gc_state->current_entry->block_size(i);
+                const block_size_t block_size
+                    = gc_state->current_entry->block_is_compressed(i)
+                    ? compressed_block_original_size(block)
+                    : disk_block_size;
+
+                // We don't want to spread a corrupted block any further.  Blocks
+                // that don't have a checksum yet get one now.
+                uint32_t checksum = live_block_checksum(block_offset, block);
+                if (checksum == NO_BLOCK_CHECKSUM) {
+                    checksum = compute_block_checksum(block,
+                                                      disk_block_size.ser_value());
+                } else {
+                    guarantee(block_checksum_matches(block,
+                                                     disk_block_size.ser_value(),
+                                                     checksum),
+                              "Block %" PR_BLOCK_ID " at offset %" PRIi64 " of the "
+                              "database file is corrupted (its checksum doesn't "
+                              "match).", block->ser_header.block_id, block_offset);
+                }
                 gc_writes.push_back(gc_write_t(block, block_offset,
-                    gc_state->current_entry->block_size(i)));
+                    block_size, disk_block_size, checksum,
+                    gc_write_stream(block->ser_header.block_id)));
             }
             guarantee(gc_writes.size() == num_writes);
         }
@@ -1235,19 +1502,30 @@ void data_block_manager_t::write_gcs(
         // Step 1: Write buffers to disk and assemble index operations
         ASSERT_NO_CORO_WAITING;
 
-        std::vector<buf_write_info_t> the_writes;
+        // The blocks for each stream have to be next to each other.
+        std::stable_sort(writes.begin(), writes.end(),
+                         [](const gc_write_t &x, const gc_write_t &y) {
+                             return x.stream < y.stream;
+                         });
+
+        std::vector<block_write_t> the_writes;
         the_writes.reserve(writes.size());
         for (size_t i = 0; i < writes.size(); ++i) {
             old_block_tokens.push_back(serializer->generate_block_token(writes[i].old_offset,
-                                                                        writes[i].block_size));
-
-            the_writes.push_back(buf_write_info_t(writes[i].buf,
-                                                  writes[i].block_size,
-                                                  writes[i].buf->ser_header.block_id));
+                                                                        writes[i].block_size,
+                                                                        writes[i].disk_block_size,
+                                                                        writes[i].checksum));
+
+            the_writes.push_back(block_write_t{writes[i].buf,
+                                               writes[i].block_size,
+                                               writes[i].disk_block_size,
+                                               writes[i].checksum,
+                                               writes[i].stream});
         }
 
-        new_block_tokens = many_writes(the_writes, choose_gc_io_account(),
-                                       &block_write_cond);
+        new_block_tokens = write_blocks(the_writes, std::vector<buf_ptr_t>(),
+                                        gc_state->current_entry->data_timestamp,
+                                        choose_gc_io_account(), &block_write_cond);
 
         guarantee(new_block_tokens.size() == writes.size());
     }
@@ -1278,6 +1556,45 @@ void data_block_manager_t::write_gcs(
     // `write_gcs` steps continue in `flush_gc_index_writes`
 }
 
+data_block_manager_t::write_stream_t
+data_block_manager_t::gc_write_stream(block_id_t block_id) const {
+    const size_t num_tiers = active_extents.size() - 1;
+    const repli_timestamp_t newest = serializer->lba_index->newest_recency();
+    // Aux blocks don't have a recency, and end up in the first tier.
+    const repli_timestamp_t recency = serializer->lba_index->get_block_recency(block_id);
+    if (num_tiers == 1
+        || newest == repli_timestamp_t::invalid
+        || recency == repli_timestamp_t::invalid
+        || recency >= newest) {
+        return NEW_WRITES_STREAM + 1;
+    }
+
+    const uint64_t age = newest.longtime - recency.longtime;
+    size_t tier = 0;
+    uint64_t tier_end_age = GC_TEMPERATURE_TIER_BASE_AGE;
+    while (tier + 1 < num_tiers && age >= tier_end_age) {
+        ++tier;
+        tier_end_age *= GC_TEMPERATURE_TIER_AGE_FACTOR;
+    }
+    return NEW_WRITES_STREAM + 1 + tier;
+}
+
+uint32_t data_block_manager_t::live_block_checksum(int64_t offset,
+                                                   const ser_buffer_t *buf) const {
+    auto token_it = serializer->offset_tokens.find(offset);
+    if (token_it != serializer->offset_tokens.end()) {
+        return token_it->second->checksum();
+    }
+    // Without any tokens, the block must be referenced by the index.
+    const index_block_info_t info
+        = serializer->lba_index->get_block_info(buf->ser_header.block_id);
+    guarantee(info.offset.has_value() && info.offset.get_value() == offset,
+              "Block at offset %" PRIi64 " of the database file is corrupted (its "
+              "block ID %" PR_BLOCK_ID " isn't in the index).",
+              offset, buf->ser_header.block_id);
+    return info.checksum;
+}
+
 void data_block_manager_t::flush_gc_index_writes(signal_t *) {
     // Acquire half the tickets from the `index_write_semaphore`.
     // This means that if all tickets in the semaphore are currently
@@ -1363,8 +1680,9 @@ void data_block_manager_t::flush_gc_index_writes(signal_t *) {
 void data_block_manager_t::prepare_metablock(data_block_manager::metablock_mixin_t *metablock) {
     guarantee(state == state_ready || state == state_shutting_down);
 
-    if (active_extent != nullptr) {
-        metablock->active_extent = active_extent->extent_ref.offset();
+    if (active_extents[NEW_WRITES_STREAM] != nullptr) {
+        metablock->active_extent
+            = active_extents[NEW_WRITES_STREAM]->extent_ref.offset();
     } else {
         metablock->active_extent = NULL_OFFSET;
     }
@@ -1395,10 +1713,12 @@ void data_block_manager_t::actually_shutdown() {
 
     guarantee(reconstructed_extents.head() == nullptr);
 
-    if (active_extent != nullptr) {
-        UNUSED int64_t extent = active_extent->extent_ref.release();
-        delete active_extent;
-        active_extent = nullptr;
+    for (gc_entry_t *&active_extent : active_extents) {
+        if (active_extent != nullptr) {
+            UNUSED int64_t extent = active_extent->extent_ref.release();
+            delete active_extent;
+            active_extent = nullptr;
+        }
     }
 
     while (gc_entry_t *entry = young_extent_queue.head()) {
@@ -1419,41 +1739,60 @@ void data_block_manager_t::actually_shutdown() {
 }
 
 std::vector<std::vector<counted_t<ls_block_token_pointee_t> > >
-data_block_manager_t::gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes) {
+data_block_manager_t::gimme_some_new_offsets(const std::vector<block_write_t> &writes,
+                                             microtime_t data_timestamp) {
     ASSERT_NO_CORO_WAITING;
 
-    // Start a new extent if necessary.
-    if (active_extent == nullptr) {
-        active_extent = new gc_entry_t(this);
-        ++stats->pm_serializer_data_extents_allocated;
-    }
-
-
-    guarantee(active_extent->state == gc_entry_t::state_active);
-
     std::vector<std::vector<counted_t<ls_block_token_pointee_t> > > ret;
 
     std::vector<counted_t<ls_block_token_pointee_t> > tokens;
     for (auto it = writes.begin(); it != writes.end(); ++it) {
+        guarantee(it->stream < active_extents.size());
+        gc_entry_t *&active_extent = active_extents[it->stream];
+        // With a single GC tier, we keep all extents at the start of the file so
+        // that it can shrink, as hot extents at its end would prevent that.
+        const extent_temperature_t temperature =
+            it->stream == NEW_WRITES_STREAM && active_extents.size() > 2
+            ? extent_temperature_t::hot
+            : extent_temperature_t::cold;
+
+        // Blocks for different streams go to different extents.
+        if (it != writes.begin() && it->stream != (it - 1)->stream) {
+            guarantee(it->stream > (it - 1)->stream);
+            if (!tokens.empty()) {
+                ret.push_back(std::move(tokens));
+                tokens.clear();
+            }
+        }
+
+        // Start a new extent if necessary.
+        if (active_extent == nullptr) {
+            active_extent = new gc_entry_t(this, temperature);
+            ++stats->pm_serializer_data_extents_allocated;
+        }
+        guarantee(active_extent->state == gc_entry_t::state_active);
+
         uint32_t relative_offset = valgrind_undefined<uint32_t>(UINT32_MAX);
         unsigned int block_index = valgrind_undefined<unsigned int>(UINT_MAX);
-        if (!active_extent->new_offset(it->block_size,
+        const bool compressed = it->disk_block_size != it->block_size;
+        if (!active_extent->new_offset(it->disk_block_size, compressed,
                                        &relative_offset, &block_index)) {
             // Move the active_extent gc_entry_t to the young extent queue (if it's
             // not already empty), and make a new gc_entry_t.
             if (active_extent->num_live_blocks() == 0) {
                 gc_entry_t *old_active_extent = active_extent;
-                active_extent = new gc_entry_t(this);
+                active_extent = new gc_entry_t(this, temperature);
                 destroy_entry(old_active_extent);
             } else {
                 active_extent->state = gc_entry_t::state_young;
                 young_extent_queue.push_back(active_extent);
                 mark_unyoung_entries();
-                active_extent = new gc_entry_t(this);
+                active_extent = new gc_entry_t(this, temperature);
             }
 
             ++stats->pm_serializer_data_extents_allocated;
-            const bool succeeded = active_extent->new_offset(it->block_size,
+            const bool succeeded = active_extent->new_offset(it->disk_block_size,
+                                                             compressed,
                                                              &relative_offset,
                                                              &block_index);
             guarantee(succeeded);
@@ -1466,10 +1805,15 @@ data_block_manager_t::gimme_some_new_offsets(const std::vector<buf_write_info_t>
         }
 
         const int64_t offset = active_extent->extent_ref.offset() + relative_offset;
+        active_extent->data_timestamp = active_extent->was_written
+            ? std::max(active_extent->data_timestamp, data_timestamp)
+            : data_timestamp;
         active_extent->was_written = true;
         active_extent->mark_live_tokenwise(block_index);
 
-        tokens.push_back(serializer->generate_block_token(offset, it->block_size));
+        tokens.push_back(serializer->generate_block_token(offset, it->block_size,
+                                                          it->disk_block_size,
+                                                          it->checksum));
     }
 
     if (!tokens.empty()) {
@@ -1536,8 +1880,21 @@ bool data_block_manager_t::do_we_want_to_start_gcing() const {
     return gc_enabled && garbage_ratio() > GC_START_RATIO;
 }
 
+// The cost-benefit policy of the LFS cleaner: the space we free up, times the age of
+// the data that stays live (older data is less likely to turn into garbage soon
+// anyway), divided by the cost of reading the extent and writing back its live
+// blocks.
+double gc_extent_priority(uint32_t garbage_bytes,
+                          uint64_t extent_size,
+                          microtime_t data_timestamp,
+                          microtime_t now) {
+    const double live_ratio = 1.0 - static_cast<double>(garbage_bytes) / extent_size;
+    const double age = 1.0 + (now > data_timestamp ? now - data_timestamp : 0);
+    return (1.0 - live_ratio) * age / (1.0 + live_ratio);
+}
+
 bool gc_entry_less_t::operator()(const gc_entry_t *x, const gc_entry_t *y) {
-    return x->garbage_bytes() < y->garbage_bytes();
+    return x->gc_priority() < y->gc_priority();
 }
 
 /****************
@@ -15,6 +15,7 @@
 #include "serializer/log/config.hpp"
 #include "serializer/log/extent_manager.hpp"
 #include "serializer/types.hpp"
+#include "time.hpp"
 
 class buf_ptr_t;
 class log_serializer_t;
@@ -30,6 +31,25 @@ struct shutdown_callback_t;  // see log_serializer.hpp.
 struct metablock_mixin_t;  // see log_serializer.hpp.
 }  // namespace data_block_manager
 
+/* The GC's rate controller.  It keeps a moving average of the latency of
+foreground reads while no GC is running and another one while it is.  If the GC
+slows reads down by too much, `throttle()` (between 1 / MAX_CONCURRENT_GCS and 1)
+goes down multiplicatively, otherwise it creeps back up. */
+class gc_rate_controller_t {
+public:
+    gc_rate_controller_t();
+
+    // Returns true if the controller backed off.
+    bool record_read_latency(double secs, bool gc_active);
+
+    double throttle() const { return throttle_; }
+
+private:
+    double latency_without_gc_secs_;
+    double latency_with_gc_secs_;
+    double throttle_;
+};
+
 class data_block_manager_t {
     friend class gc_entry_t;
     friend class dbm_read_ahead_t;
@@ -45,18 +65,29 @@ public:
     metablock. */
 
     static void prepare_initial_metablock(data_block_manager::metablock_mixin_t *mb);
-    void start_existing(file_t *dbfile, data_block_manager::metablock_mixin_t *last_metablock);
+    void start_existing(data_block_manager::metablock_mixin_t *last_metablock);
 
+    // `disk_block_size` is less than `block_size` if the block is stored compressed.
+    // Crashes if the block doesn't match its `checksum`.
     buf_ptr_t read(int64_t off_in, block_size_t block_size,
-                 file_account_t *io_account);
+                   block_size_t disk_block_size, uint32_t checksum,
+                   file_account_t *io_account);
+
+    // Reads the block as it is on disk, without read-ahead, and returns whether it
+    // matches its checksum. Used by the serializer's scrub.
+    bool verify(int64_t off_in, block_size_t disk_block_size, uint32_t checksum,
+                file_account_t *io_account);
 
     /* exposed gc api */
     /* mark a buffer as garbage */
     void mark_garbage(int64_t offset, extent_transaction_t *txn);  // Takes a real int64_t.
 
-    /* r{start,end}_reconstruct functions for safety */
-    void start_reconstruct();
-    void mark_live(int64_t offset, block_size_t block_size);
+    /* r{start,end}_reconstruct functions for safety. Blocks can already be read
+    (without read-ahead) after `start_reconstruct()`, while the serializer is still
+    loading the LBA. */
+    void start_reconstruct(file_t *dbfile);
+    void mark_live(int64_t offset, block_size_t block_size,
+                   block_size_t disk_block_size);
     void end_reconstruct();
 
     /* We must make sure that blocks which have tokens pointing to them don't
@@ -81,17 +112,65 @@ public:
     // ratio of garbage to blocks in the system
     double garbage_ratio() const;
 
+    // Called after a foreground block read, with how long it took.  Feeds the GC's
+    // rate controller, see `compute_gc_concurrency()`.
+    void record_read_latency(double secs);
+
+    /* Writes the blocks, compressing them first if the serializer is configured to
+    do so. */
     std::vector<counted_t<ls_block_token_pointee_t> >
     many_writes(const std::vector<buf_write_info_t> &writes,
                 file_account_t *io_account,
                 iocallback_t *cb);
 
-    std::vector<std::vector<counted_t<ls_block_token_pointee_t> > >
-    gimme_some_new_offsets(const std::vector<buf_write_info_t> &writes);
-
     bool is_gc_active() const;
 
 private:
+    /* Every write stream has its own active extent.  Stream 0 takes newly written
+    blocks.  Blocks that the GC moves have survived at least one extent's worth of
+    writes, so they are likely to stay live for a while longer.  They go into the
+    other streams, one for each temperature tier (see `gc_write_stream()`), so that
+    the GC doesn't have to keep moving them along with the garbage that hot blocks
+    leave behind. */
+    typedef size_t write_stream_t;
+
+    // A block as it gets written to disk: `buf` holds `disk_block_size` bytes, which
+    // are the block in compressed form if that is less than `block_size`, and which
+    // have the given checksum.
+    struct block_write_t {
+        ser_buffer_t *buf;
+        block_size_t block_size;
+        block_size_t disk_block_size;
+        uint32_t checksum;
+        write_stream_t stream;
+    };
+
+    // Compresses `buf` if compression is enabled and it saves space. The compressed
+    // buffer is added to `compressed_bufs_out`, which must outlive the write.
+    block_write_t prepare_block_write(ser_buffer_t *buf, block_size_t block_size,
+                                      std::vector<buf_ptr_t> *compressed_bufs_out);
+
+    // `compressed_bufs` is freed once the writes are complete.  `data_timestamp` is
+    // when the data was last written by anyone but the GC (see
+    // `gc_entry_t::data_timestamp`).
+    std::vector<counted_t<ls_block_token_pointee_t> >
+    write_blocks(const std::vector<block_write_t> &writes,
+                 std::vector<buf_ptr_t> &&compressed_bufs,
+                 microtime_t data_timestamp,
+                 file_account_t *io_account,
+                 iocallback_t *cb);
+
+    // Writes to the same stream must be next to each other in `writes`.
+    std::vector<std::vector<counted_t<ls_block_token_pointee_t> > >
+    gimme_some_new_offsets(const std::vector<block_write_t> &writes,
+                           microtime_t data_timestamp);
+
+    // Reads the block as it is on disk.
+    buf_ptr_t read_from_disk(int64_t off_in, block_size_t block_size,
+                             file_account_t *io_account);
+    buf_ptr_t read_from_disk_without_read_ahead(int64_t off_in, block_size_t block_size,
+                                                file_account_t *io_account);
+
     void actually_shutdown();
 
     struct gc_state_t : public intrusive_list_node_t<gc_state_t>{
@@ -106,16 +185,33 @@ private:
             : current_entry(nullptr) { }
     };
 
+    /* The GC moves blocks as they are on disk, without decompressing or compressing
+    them. Otherwise the block tokens that it remaps to the new offset would no longer
+    match the block. For the same reason their checksums stay the same, except for
+    blocks that didn't have one yet. */
     struct gc_write_t {
         ser_buffer_t *buf;
         int64_t old_offset;
         block_size_t block_size;
+        block_size_t disk_block_size;
+        uint32_t checksum;
+        write_stream_t stream;
         gc_write_t(ser_buffer_t *b, int64_t _old_offset,
-                   block_size_t _block_size)
+                   block_size_t _block_size, block_size_t _disk_block_size,
+                   uint32_t _checksum, write_stream_t _stream)
             : buf(b), old_offset(_old_offset),
-              block_size(_block_size) { }
+              block_size(_block_size), disk_block_size(_disk_block_size),
+              checksum(_checksum), stream(_stream) { }
     };
 
+    // Returns the checksum that the block at `offset` was written with, as known by
+    // its block tokens or the LBA.
+    uint32_t live_block_checksum(int64_t offset, const ser_buffer_t *buf) const;
+
+    // The stream that the GC writes the block to, by the temperature tier that its
+    // recency puts it in.
+    write_stream_t gc_write_stream(block_id_t block_id) const;
+
     /* Runs in a coroutine and keeps calling `gc_one_extent()` for as long as
     we should keep GCing. */
     void run_gc(gc_state_t *gc_state);
@@ -137,6 +233,10 @@ private:
     // Picks an i/o account for GC to use, based on the current garbage rate
     file_account_t *choose_gc_io_account();
 
+    // Moves `gc_priority_time` forward if it has gotten too old, and reorders
+    // `gc_pq` accordingly.
+    void refresh_gc_priorities();
+
     // Checks whether the extent is empty and if it is, notifies the extent manager
     // and cleans up
     void check_and_handle_empty_extent(uint64_t extent_id);
@@ -166,6 +266,7 @@ private:
 
     enum state_t {
         state_unstarted,
+        state_reconstructing,
         state_ready,
         state_shutting_down,
         state_shut_down
@@ -191,8 +292,10 @@ private:
     /* Contains every extent in the gc_entry_t::state_reconstructing state */
     intrusive_list_t<gc_entry_t> reconstructed_extents;
 
-    /* Contains the extent in the gc_entry_t::state_active state. */
-    gc_entry_t *active_extent;
+    /* Contains the extents in the gc_entry_t::state_active state, indexed by
+    `write_stream_t`.  Only the one for new writes is stored in the metablock; after
+    a restart, the blocks in the GC's active extents are treated like any others. */
+    std::vector<gc_entry_t *> active_extents;
 
     /* Contains every extent in the gc_entry_t::state_young state */
     intrusive_list_t<gc_entry_t> young_extent_queue;
@@ -200,6 +303,15 @@ private:
     /* Contains every extent in the gc_entry_t::state_old state */
     priority_queue_t<gc_entry_t *, gc_entry_less_t> gc_pq;
 
+    /* The time that `gc_entry_t::gc_priority()` computes the age of the extents in
+    `gc_pq` against.  It only moves forward in `refresh_gc_priorities()`, so that
+    the order of `gc_pq` stays valid in between. */
+    microtime_t gc_priority_time;
+
+    /* Scales down the number of concurrent GCs if they slow down foreground reads
+    too much, unless the garbage ratio is too high for us to back off. */
+    gc_rate_controller_t gc_rate_controller;
+
     /* \brief structure to keep track of global stats about the data blocks
      */
     class gc_stat_t {
@@ -276,4 +388,12 @@ void unaligned_read_ahead_interval(const int64_t block_offset,
                                    int64_t *const offset_out,
                                    int64_t *const end_offset_out);
 
+// Exposed for unit tests.  How much we want to GC an extent with `garbage_bytes`
+// of garbage, whose data was last written at `data_timestamp`, as of `now` (see
+// `gc_entry_t::gc_priority()`).
+double gc_extent_priority(uint32_t garbage_bytes,
+                          uint64_t extent_size,
+                          microtime_t data_timestamp,
+                          microtime_t now);
+
 #endif /* SERIALIZER_LOG_DATA_BLOCK_MANAGER_HPP_ */
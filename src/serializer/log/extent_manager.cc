@@ -1,7 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "serializer/log/extent_manager.hpp"
 
-#include <queue>
+#include <iterator>
+#include <set>
 
 #include "arch/arch.hpp"
 #include "logger.hpp"
@@ -51,33 +52,27 @@ class extent_zone_t {
 
     /* free-list and extent map. Contains one entry per extent.  During the
     state_reserving_extents phase, each extent has state state_unreserved or
-    state state_in_use. When we transition to the state_running phase, we link
-    all of the state_unreserved entries in each zone together into extent free
-    queue.  The free queue can contain entries that point past the end of
-    extents, if the file size ever gets shrunk. */
+    state state_in_use. When we transition to the state_running phase, we put
+    all of the state_unreserved entries into the set of free extents. */
 
     std::vector<extent_info_t> extents;
 
-    // We want to remove the minimum element from the free_queue first, leaving
-    // free extents at the end of the file.
-    std::priority_queue<size_t,
-                        std::vector<size_t>,
-                        std::greater<size_t> > free_queue;
+    // Cold extents come from the start of the set and hot ones from the end, see
+    // `extent_temperature_t`.
+    std::set<size_t> free_extents;
 
     file_t *const dbfile;
 
     log_serializer_stats_t *stats;
 
-    // The number of free extents in the file.
-    size_t held_extents_;
-
 public:
+    // The number of free extents in the file.
     size_t held_extents() const {
-        return held_extents_;
+        return free_extents.size();
     }
 
     extent_zone_t(file_t *_dbfile, uint64_t _extent_size, log_serializer_stats_t *_stats)
-        : extent_size(_extent_size), dbfile(_dbfile), stats(_stats), held_extents_(0) {
+        : extent_size(_extent_size), dbfile(_dbfile), stats(_stats) {
         // (Avoid a bunch of reallocations by resize calls (avoiding O(n log n)
         // work on average).)
         extents.reserve(dbfile->get_file_size() / extent_size);
@@ -105,31 +100,24 @@ public:
         for (size_t extent_id = 0; extent_id < extents.size(); ++extent_id) {
             if (extents[extent_id].state() == extent_info_t::state_unreserved) {
                 extents[extent_id].set_state(extent_info_t::state_free);
-                free_queue.push(extent_id);
-                ++held_extents_;
+                free_extents.insert(free_extents.end(), extent_id);
             }
         }
     }
 
-    extent_reference_t gen_extent() {
+    extent_reference_t gen_extent(extent_temperature_t temperature) {
         int64_t extent;
 
-        if (free_queue.empty()) {
-            rassert(held_extents_ == 0);
-            extent = extents.size() * extent_size;
-            extents.push_back(extent_info_t());
-        } else if (free_queue.top() >= extents.size()) {
-            rassert(held_extents_ == 0);
-            std::priority_queue<size_t,
-                                std::vector<size_t>,
-                                std::greater<size_t> > tmp;
-            free_queue = tmp;
+        if (free_extents.empty()) {
             extent = extents.size() * extent_size;
             extents.push_back(extent_info_t());
+        } else if (temperature == extent_temperature_t::cold) {
+            extent = *free_extents.begin() * extent_size;
+            free_extents.erase(free_extents.begin());
         } else {
-            extent = free_queue.top() * extent_size;
-            free_queue.pop();
-            --held_extents_;
+            auto last = std::prev(free_extents.end());
+            extent = *last * extent_size;
+            free_extents.erase(last);
         }
 
         extent_info_t *info = &extents[offset_to_id(extent)];
@@ -164,7 +152,7 @@ public:
         bool shrink_file = false;
         while (!extents.empty() && extents.back().state() == extent_info_t::state_free) {
             shrink_file = true;
-            --held_extents_;
+            free_extents.erase(extents.size() - 1);
             extents.pop_back();
         }
 
@@ -178,26 +166,6 @@ public:
                 dbfile->set_file_size(extents.size() * extent_size);
                 stats->pm_file_size_bytes += dbfile->get_file_size() - old_file_size;
             }
-
-            // Prevent the existence of a relatively large free queue after the file
-            // size shrinks.
-            if (held_extents_ < free_queue.size() / 2) {
-                std::priority_queue<size_t,
-                                    std::vector<size_t>,
-                                    std::greater<size_t> > tmp;
-                for (size_t i = 0; i < held_extents_; ++i) {
-                    tmp.push(free_queue.top());
-                    free_queue.pop();
-                }
-
-                // held_extents_ was and will be the number of entries in the free_queue
-                // that _didn't_ point off the end of the file.  We just moved those
-                // entries to tmp.  The remaining entries must therefore point off the
-                // end of the file.  Check that no remaining entries point within the
-                // file.
-                guarantee(free_queue.top() >= extents.size(), "Tried to discard valid held extents.");
-                free_queue = std::move(tmp);
-            }
         }
     }
 
@@ -209,8 +177,7 @@ public:
         --info->extent_use_refcount;
         if (info->extent_use_refcount == 0) {
             info->set_state(extent_info_t::state_free);
-            free_queue.push(offset_to_id(extent));
-            ++held_extents_;
+            free_extents.insert(offset_to_id(extent));
             try_shrink_file();
         }
     }
@@ -270,12 +237,12 @@ void extent_manager_t::begin_transaction(extent_transaction_t *out) {
     out->init();
 }
 
-extent_reference_t extent_manager_t::gen_extent() {
+extent_reference_t extent_manager_t::gen_extent(extent_temperature_t temperature) {
     assert_thread();
     rassert(state == state_running);
     ++stats->pm_extents_in_use;
 
-    return zone->gen_extent();
+    return zone->gen_extent(temperature);
 }
 
 extent_reference_t
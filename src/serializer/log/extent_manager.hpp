@@ -20,6 +20,15 @@ class extent_zone_t;
 
 struct log_serializer_stats_t;
 
+/* Where in the file `extent_manager_t::gen_extent()` puts a new extent.  Cold
+extents come from the start of the free space, which packs them towards the start
+of the file and lets the file shrink once the extents at its end are freed.  Hot
+extents come from the end of the free space, so that they don't leave holes between
+the cold extents when they get freed.  But the file can't shrink past them, so the
+data block manager only asks for them if the GC sorts the blocks it moves into more
+than one temperature tier. */
+enum class extent_temperature_t { hot, cold };
+
 // A reference to an extent in the extent manager.  An extent may not be freed until
 // all of the references go away (unless the server is shutting down).
 class extent_reference_t {
@@ -123,7 +132,7 @@ public:
     MUST_USE extent_reference_t copy_extent_reference(const extent_reference_t &copyee);
 
     void begin_transaction(extent_transaction_t *out);
-    MUST_USE extent_reference_t gen_extent();
+    MUST_USE extent_reference_t gen_extent(extent_temperature_t temperature);
     void release_extent_into_transaction(extent_reference_t &&extent_ref,
                                          extent_transaction_t *txn);
     void release_extent(extent_reference_t &&extent_ref);
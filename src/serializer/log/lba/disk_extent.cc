@@ -57,15 +57,12 @@ void lba_disk_extent_t::read_step_2(read_info_t *info, in_memory_index_t *index)
     lba_extent_t *extent = info->buffer.get();
     guarantee(memcmp(extent->header.magic, lba_magic, LBA_MAGIC_SIZE) == 0);
 
-    for (int i = 0; i < info->count; i++) {
+    for (int i = info->count - 1; i >= 0; i--) {
         lba_entry_t *e = &extent->entries[i];
         if (!lba_entry_t::is_padding(e)) {
-            // The on-disk format still stores 32 bit block sizes.
-            // We've never actually used them, and we now use 16 bit block sizes
-            // for the in-memory index to save a few bytes.
-            guarantee(e->ser_block_size <= std::numeric_limits<uint16_t>::max());
-            index->set_block_info(e->block_id, e->recency, e->offset,
-                                  static_cast<uint16_t>(e->ser_block_size));
+            index->load_block_info(e->block_id, e->recency, e->offset,
+                                   e->ser_block_size, e->compressed_block_size,
+                                   e->checksum);
         }
     }
 
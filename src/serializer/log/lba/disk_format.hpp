@@ -5,6 +5,7 @@
 #include <limits.h>
 
 #include "serializer/serializer.hpp"
+#include "serializer/log/block_checksum.hpp"
 #include "config/args.hpp"
 
 
@@ -64,13 +65,19 @@ ATTR_PACKED(struct lba_entry_t {
     // (It probably assumes that sizeof(lba_entry_t) evenly divides
     // DEVICE_BLOCK_SIZE).
 
-    // Put the zero-padding at the beginning of the LBA entry.  We could use this, or
-    // the first 16 bits, perhaps, as a version flag.
-    uint32_t zero_reserved;
+    // The CRC32C checksum of the block as it is on disk, or `NO_BLOCK_CHECKSUM`. See
+    // serializer/log/block_checksum.hpp.  Before serializer version 2.5 this was
+    // zero-padding, so older LBAs have no checksums.
+    uint32_t checksum;
 
-    // This could be a uint16_t if you wanted it to be, as long as block sizes are
-    // all less than or equal to 4K (which is less than 64K).
-    uint32_t ser_block_size;
+    uint16_t ser_block_size;
+
+    // The size of the block on disk if it's stored compressed, or 0 if it's stored
+    // as is.  Before serializer version 2.5 these were the upper bytes of a 32 bit
+    // `ser_block_size`, which were always zero because block sizes are less than
+    // 64K.  Only files with the 2.5 static header (see static_header.cc) have
+    // compressed blocks or checksums.
+    uint16_t compressed_block_size;
 
     block_id_t block_id;
 
@@ -80,11 +87,14 @@ ATTR_PACKED(struct lba_entry_t {
     flagged_off64_t offset;
 
     static lba_entry_t make(block_id_t block_id, repli_timestamp_t recency,
-                            flagged_off64_t offset, uint32_t ser_block_size) {
+                            flagged_off64_t offset, uint16_t ser_block_size,
+                            uint16_t compressed_block_size, uint32_t checksum) {
         guarantee(ser_block_size != 0 || !offset.has_value());
+        guarantee(compressed_block_size < ser_block_size || compressed_block_size == 0);
         lba_entry_t entry;
-        entry.zero_reserved = 0;
+        entry.checksum = checksum;
         entry.ser_block_size = ser_block_size;
+        entry.compressed_block_size = compressed_block_size;
         entry.block_id = block_id;
         entry.recency = recency;
         entry.offset = offset;
@@ -96,7 +106,8 @@ ATTR_PACKED(struct lba_entry_t {
     }
 
     static lba_entry_t make_padding_entry() {
-        return make(PADDING_BLOCK_ID, repli_timestamp_t::invalid, flagged_off64_t::padding(), 0);
+        return make(PADDING_BLOCK_ID, repli_timestamp_t::invalid, flagged_off64_t::padding(), 0, 0,
+                    NO_BLOCK_CHECKSUM);
     }
 });
 
@@ -5,12 +5,13 @@
 #include "math.hpp"
 
 lba_disk_structure_t::lba_disk_structure_t(extent_manager_t *_em, file_t *_file)
-    : em(_em), file(_file), superblock_extent(nullptr), last_extent(nullptr)
+    : em(_em), file(_file), superblock_extent(nullptr), last_extent(nullptr),
+      read_aborted(false)
 {
 }
 
 lba_disk_structure_t::lba_disk_structure_t(extent_manager_t *_em, file_t *_file, lba_shard_metablock_t *metablock)
-    : em(_em), file(_file)
+    : em(_em), file(_file), read_aborted(false)
 {
     if (metablock->last_lba_extent_offset != NULL_OFFSET) {
         last_extent = new lba_disk_extent_t(em, file, metablock->last_lba_extent_offset, metablock->last_lba_extent_entries_count);
@@ -65,7 +66,8 @@ void lba_disk_structure_t::on_extent_read() {
 }
 
 void lba_disk_structure_t::add_entry(block_id_t block_id, repli_timestamp_t recency,
-                                     flagged_off64_t offset, uint32_t ser_block_size,
+                                     flagged_off64_t offset, uint16_t ser_block_size,
+                                     uint16_t compressed_block_size, uint32_t checksum,
                                      file_account_t *io_account, extent_transaction_t *txn) {
     if (last_extent && last_extent->full()) {
         /* We have filled up an extent. Transfer it to the superblock. */
@@ -84,7 +86,9 @@ void lba_disk_structure_t::add_entry(block_id_t block_id, repli_timestamp_t rece
 
     rassert(!last_extent->full());
 
-    last_extent->add_entry(lba_entry_t::make(block_id, recency, offset, ser_block_size), io_account);
+    last_extent->add_entry(lba_entry_t::make(block_id, recency, offset, ser_block_size,
+                                             compressed_block_size, checksum),
+                           io_account);
 }
 
 std::set<lba_disk_extent_t *> lba_disk_structure_t::get_inactive_extents() const {
@@ -209,7 +213,7 @@ struct reader_t
 
         /* true if the extent before us called read_step_2(). We keep track of this
         because we must be sure to call read_step_2() in the right order at all times;
-        otherwise more recent LBA data would be applied after less recent LBA data
+        otherwise less recent LBA data would be applied before more recent LBA data
         and the LBA would be corrupted. */
         bool prev_done;
 
@@ -244,7 +248,10 @@ struct reader_t
             extent->read_step_2(&read_info, parent->index);
             parent->active_readers--;
             parent->start_more_readers();
-            if (index == static_cast<int>(parent->readers.size()) - 1) {
+            if (index == static_cast<int>(parent->readers.size()) - 1
+                || index + 1 == parent->next_reader) {
+                // Either we were the oldest extent, or the read got aborted and
+                // nobody is reading the next one.
                 parent->done();
             } else {
                 parent->readers[index+1]->on_prev_done();
@@ -261,28 +268,30 @@ struct reader_t
     int active_readers;
 
     reader_t(lba_disk_structure_t *_ds, in_memory_index_t *_index, lba_disk_structure_t::read_callback_t *cb)
-        : ds(_ds), index(_index), rcb(cb)
+        : ds(_ds), index(_index), rcb(cb), next_reader(0), active_readers(0)
     {
-        for (lba_disk_extent_t *e = ds->extents_in_superblock.head();
-             e != nullptr; e = ds->extents_in_superblock.next(e)) {
+        // From the newest extent to the oldest one
+        if (ds->last_extent) new extent_reader_t(this, ds->last_extent);
+        for (lba_disk_extent_t *e = ds->extents_in_superblock.tail();
+             e != nullptr; e = ds->extents_in_superblock.prev(e)) {
             new extent_reader_t(this, e);
         }
-        if (ds->last_extent) new extent_reader_t(this, ds->last_extent);
 
         /* The constructor for extent_reader_t pushed them onto our 'readers' vector. So now we
         have a vector with an extent_reader_t object for each extent we need to read, but none
         of them have been started yet. */
 
-        if (readers.empty()) {
+        if (readers.empty() || ds->read_aborted) {
             done();
         } else {
-            next_reader = 0;
-            active_readers = 0;
             start_more_readers();
         }
     }
 
     void start_more_readers() {
+        if (ds->read_aborted) {
+            return;
+        }
         int limit = std::max<int>(LBA_READ_BUFFER_SIZE / ds->em->extent_size / LBA_SHARD_FACTOR, 1);
         while (next_reader != static_cast<int>(readers.size()) && active_readers < limit) {
             readers[next_reader++]->start_reading();
@@ -290,6 +299,10 @@ struct reader_t
     }
 
     void done() {
+        // If the read got aborted, some of the readers never got started.
+        for (size_t i = next_reader; i < readers.size(); ++i) {
+            delete readers[i];
+        }
         rcb->on_lba_extents_read();
         delete this;
     }
@@ -299,6 +312,10 @@ void lba_disk_structure_t::read(in_memory_index_t *index, read_callback_t *cb) {
     new reader_t(this, index, cb);
 }
 
+void lba_disk_structure_t::abort_read() {
+    read_aborted = true;
+}
+
 void lba_disk_structure_t::prepare_metablock(lba_shard_metablock_t *mb_out) {
     if (last_extent) {
         mb_out->last_lba_extent_offset = last_extent->data->extent_ref.offset();
@@ -32,7 +32,8 @@ public:
 
     // Put entries in an LBA and then call sync() to write to disk
     void add_entry(block_id_t block_id, repli_timestamp_t recency,
-                   flagged_off64_t offset, uint32_t ser_block_size,
+                   flagged_off64_t offset, uint16_t ser_block_size,
+                   uint16_t compressed_block_size, uint32_t checksum,
                    file_account_t *io_account,
                    extent_transaction_t *txn);
     struct sync_callback_t {
@@ -54,12 +55,17 @@ public:
                          file_account_t *io_account, extent_transaction_t *txn);
 
     // If you call read(), then the in_memory_index_t will be populated and then the read_callback_t
-    // will be called when it is done.
+    // will be called when it is done. The extents get read from the newest to the oldest
+    // one, see `in_memory_index_t::load_block_info()`.
     struct read_callback_t {
         virtual void on_lba_extents_read() = 0;
         virtual ~read_callback_t() {}
     };
     void read(in_memory_index_t *index, read_callback_t *cb);
+    // Makes a read() that is in progress stop after the extents that it is already
+    // reading. It still calls the read_callback_t, but the in_memory_index_t will be
+    // missing entries.
+    void abort_read();
 
     void prepare_metablock(lba_shard_metablock_t *mb_out);
 
@@ -76,6 +82,9 @@ public:
     intrusive_list_t<lba_disk_extent_t> extents_in_superblock;
     lba_disk_extent_t *last_extent;
 
+    // Set by `abort_read()`.
+    bool read_aborted;
+
 private:
     /* Prepares and writes a new superblock. */
     void write_superblock(file_account_t *io_account, extent_transaction_t *txn);
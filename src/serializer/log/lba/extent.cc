@@ -62,7 +62,8 @@ struct extent_block_t :
 extent_t::extent_t(extent_manager_t *_em, file_t *_file)
     : amount_filled(0), em(_em),
       file(_file), last_block(nullptr), current_block(nullptr) {
-    extent_ref = em->gen_extent();
+    // LBA extents stay around until the LBA gets compacted.
+    extent_ref = em->gen_extent(extent_temperature_t::cold);
     ++em->stats->pm_serializer_lba_extents;
 }
 
@@ -6,7 +6,8 @@
 #include "serializer/log/lba/disk_format.hpp"
 
 in_memory_index_t::in_memory_index_t()
-    : end_block_id_(0), end_aux_block_id_(FIRST_AUX_BLOCK_ID) { }
+    : end_block_id_(0), end_aux_block_id_(FIRST_AUX_BLOCK_ID),
+      newest_recency_(repli_timestamp_t::invalid) { }
 
 block_id_t in_memory_index_t::end_block_id() {
     return end_block_id_;
@@ -21,14 +22,18 @@ index_block_info_t in_memory_index_t::get_block_info(block_id_t id) {
         index_aux_block_info_t aux_info = aux_infos_.get(make_aux_block_id_relative(id));
         return index_block_info_t(aux_info.offset,
                                   repli_timestamp_t::invalid,
-                                  aux_info.ser_block_size);
+                                  aux_info.ser_block_size,
+                                  aux_info.compressed_block_size,
+                                  aux_info.checksum);
     } else {
         return infos_.get(id);
     }
 }
 
 void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
-                                       flagged_off64_t offset, uint16_t ser_block_size) {
+                                       flagged_off64_t offset, uint16_t ser_block_size,
+                                       uint16_t compressed_block_size,
+                                       uint32_t checksum) {
     if (is_aux_block_id(id)) {
         if (id >= end_aux_block_id_) {
             end_aux_block_id_ = id + 1;
@@ -37,14 +42,56 @@ void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
         // other than `invalid`, you might be doing something wrong. It will be
         // discarded anyway.
         rassert(recency == repli_timestamp_t::invalid);
-        index_aux_block_info_t info(offset, ser_block_size);
+        index_aux_block_info_t info(offset, ser_block_size, compressed_block_size,
+                                    checksum);
         aux_infos_.set(make_aux_block_id_relative(id), info);
     } else {
         if (id >= end_block_id_) {
             end_block_id_ = id + 1;
         }
-        index_block_info_t info(offset, recency, ser_block_size);
+        newest_recency_ = superceding_recency(newest_recency_, recency);
+        index_block_info_t info(offset, recency, ser_block_size, compressed_block_size,
+                                checksum);
         infos_.set(id, info);
     }
 }
 
+
+void in_memory_index_t::start_loading() {
+    guarantee(!loaded_.has());
+    loaded_.init(new two_level_array_t<bool>());
+    aux_loaded_.init(new two_level_array_t<bool>());
+}
+
+void in_memory_index_t::load_block_info(block_id_t id, repli_timestamp_t recency,
+                                        flagged_off64_t offset, uint16_t ser_block_size,
+                                        uint16_t compressed_block_size,
+                                        uint32_t checksum) {
+    rassert(loaded_.has());
+    if (is_block_info_loaded(id)) {
+        // We already have a newer entry for this block.
+        return;
+    }
+    if (is_aux_block_id(id)) {
+        aux_loaded_->set(make_aux_block_id_relative(id), true);
+    } else {
+        loaded_->set(id, true);
+    }
+    set_block_info(id, recency, offset, ser_block_size, compressed_block_size,
+                   checksum);
+}
+
+bool in_memory_index_t::is_block_info_loaded(block_id_t id) const {
+    if (!loaded_.has()) {
+        return true;
+    }
+    return is_aux_block_id(id)
+        ? aux_loaded_->get(make_aux_block_id_relative(id))
+        : loaded_->get(id);
+}
+
+void in_memory_index_t::finish_loading() {
+    rassert(loaded_.has());
+    loaded_.reset();
+    aux_loaded_.reset();
+}
@@ -3,6 +3,7 @@
 #define SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
 
 #include "arch/compiler.hpp"
+#include "containers/scoped.hpp"
 #include "containers/two_level_array.hpp"
 #include "config/args.hpp"
 #include "serializer/serializer.hpp"
@@ -12,25 +13,42 @@ ATTR_PACKED(struct index_block_info_t {
     index_block_info_t()
         : offset(flagged_off64_t::unused()),
           recency(repli_timestamp_t::invalid),
-          ser_block_size(0) { }
+          ser_block_size(0),
+          compressed_block_size(0),
+          checksum(NO_BLOCK_CHECKSUM) { }
 
     index_block_info_t(flagged_off64_t _offset,
                        repli_timestamp_t _recency,
-                       uint16_t _ser_block_size)
+                       uint16_t _ser_block_size,
+                       uint16_t _compressed_block_size,
+                       uint32_t _checksum)
         : offset(_offset),
           recency(_recency),
-          ser_block_size(_ser_block_size) { }
+          ser_block_size(_ser_block_size),
+          compressed_block_size(_compressed_block_size),
+          checksum(_checksum) { }
 
     // For two_level_array_t.
     bool operator==(const index_block_info_t &other) const {
         return offset == other.offset &&
             recency == other.recency &&
-            ser_block_size == other.ser_block_size;
+            ser_block_size == other.ser_block_size &&
+            compressed_block_size == other.compressed_block_size &&
+            checksum == other.checksum;
+    }
+
+    // The number of bytes the block takes up on disk.
+    uint16_t disk_block_size() const {
+        return compressed_block_size != 0 ? compressed_block_size : ser_block_size;
     }
 
     flagged_off64_t offset;
     repli_timestamp_t recency;
     uint16_t ser_block_size;
+    // See `lba_entry_t::compressed_block_size`.
+    uint16_t compressed_block_size;
+    // See `lba_entry_t::checksum`.
+    uint32_t checksum;
 });
 
 /* This is a reduced-size block info for auxiliary blocks (currently
@@ -39,21 +57,31 @@ timestamp, because we don't need it for those blocks. */
 ATTR_PACKED(struct index_aux_block_info_t {
     index_aux_block_info_t()
         : offset(flagged_off64_t::unused()),
-          ser_block_size(0) { }
+          ser_block_size(0),
+          compressed_block_size(0),
+          checksum(NO_BLOCK_CHECKSUM) { }
 
     index_aux_block_info_t(flagged_off64_t _offset,
-                           uint16_t _ser_block_size)
+                           uint16_t _ser_block_size,
+                           uint16_t _compressed_block_size,
+                           uint32_t _checksum)
         : offset(_offset),
-          ser_block_size(_ser_block_size) { }
+          ser_block_size(_ser_block_size),
+          compressed_block_size(_compressed_block_size),
+          checksum(_checksum) { }
 
     // For two_level_array_t.
     bool operator==(const index_aux_block_info_t &other) const {
         return offset == other.offset &&
-            ser_block_size == other.ser_block_size;
+            ser_block_size == other.ser_block_size &&
+            compressed_block_size == other.compressed_block_size &&
+            checksum == other.checksum;
     }
 
     flagged_off64_t offset;
     uint16_t ser_block_size;
+    uint16_t compressed_block_size;
+    uint32_t checksum;
 });
 
 
@@ -63,6 +91,12 @@ class in_memory_index_t {
     block_id_t end_block_id_;
     two_level_array_t<index_aux_block_info_t> aux_infos_;
     block_id_t end_aux_block_id_;
+    repli_timestamp_t newest_recency_;
+
+    // While the index is being loaded, these record which blocks we have already
+    // loaded an entry for.
+    scoped_ptr_t<two_level_array_t<bool> > loaded_;
+    scoped_ptr_t<two_level_array_t<bool> > aux_loaded_;
 
 public:
     in_memory_index_t();
@@ -71,10 +105,25 @@ public:
     block_id_t end_block_id();
     block_id_t end_aux_block_id();
 
+    // The newest recency that any block has had, or `invalid` if none has.
+    repli_timestamp_t newest_recency() const { return newest_recency_; }
+
     index_block_info_t get_block_info(block_id_t id);
     void set_block_info(block_id_t id, repli_timestamp_t recency,
-                        flagged_off64_t offset, uint16_t ser_block_size);
-
+                        flagged_off64_t offset, uint16_t ser_block_size,
+                        uint16_t compressed_block_size, uint32_t checksum);
+
+    /* The LBA gets loaded from the newest entries to the oldest ones, so the first
+    entry that gets loaded for a block is the one that counts, and we can answer
+    lookups for that block right away. Between `start_loading()` and
+    `finish_loading()`, use `load_block_info()` instead of `set_block_info()`. */
+    void start_loading();
+    void load_block_info(block_id_t id, repli_timestamp_t recency,
+                         flagged_off64_t offset, uint16_t ser_block_size,
+                         uint16_t compressed_block_size, uint32_t checksum);
+    // Always true when we are not loading.
+    bool is_block_info_loaded(block_id_t id) const;
+    void finish_loading();
 };
 
 #endif  // SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
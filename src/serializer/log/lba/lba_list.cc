@@ -72,6 +72,22 @@ public:
                last_metablock->inline_lba_entries,
                last_metablock->inline_lba_entries_count * sizeof(lba_entry_t));
 
+        // We load the LBA from the newest entries to the oldest ones, so that
+        // lookups can be answered before the whole LBA is in memory. The inlined
+        // entries are the most recent ones.
+        owner->in_memory_index.start_loading();
+        for (int32_t i = owner->inline_lba_entries_count - 1; i >= 0; --i) {
+            lba_entry_t *e = &owner->inline_lba_entries[i];
+            owner->in_memory_index.load_block_info(
+                    e->block_id,
+                    e->recency,
+                    e->offset,
+                    e->ser_block_size,
+                    e->compressed_block_size,
+                    e->checksum);
+        }
+        owner->state = lba_list_t::state_loading;
+
         cbs_out = LBA_SHARD_FACTOR;
         for (int i = 0; i < LBA_SHARD_FACTOR; i++) {
             owner->disk_structures[i] = new lba_disk_structure_t(
@@ -97,20 +113,7 @@ public:
         cbs_out--;
         if (cbs_out == 0) {
             // All LBA entries from the LBA extents have been read.
-            // Now we can load the (more recent) inlined entries from
-            // the metablock into the index:
-            for (int32_t i = 0; i < owner->inline_lba_entries_count; ++i) {
-                lba_entry_t *e = &owner->inline_lba_entries[i];
-                // The on-disk format still stores 32 bit block sizes.
-                // We've never actually used them, and we now use 16 bit block sizes
-                // for the in-memory index to save a few bytes.
-                guarantee(e->ser_block_size <= std::numeric_limits<uint16_t>::max());
-                owner->in_memory_index.set_block_info(
-                        e->block_id,
-                        e->recency,
-                        e->offset,
-                        static_cast<uint16_t>(e->ser_block_size));
-            }
+            owner->in_memory_index.finish_loading();
 
             owner->state = lba_list_t::state_ready;
             if (callback) callback->on_lba_ready();
@@ -135,6 +138,15 @@ bool lba_list_t::start_existing(file_t *file, metablock_mixin_t *last_metablock,
     }
 }
 
+void lba_list_t::abort_loading() {
+    if (state != state_loading) {
+        return;
+    }
+    for (int i = 0; i < LBA_SHARD_FACTOR; i++) {
+        disk_structures[i]->abort_read();
+    }
+}
+
 block_id_t lba_list_t::end_block_id() {
     rassert(state == state_ready || state == state_gc_shutting_down);
 
@@ -152,6 +164,17 @@ index_block_info_t lba_list_t::get_block_info(block_id_t block) {
     return in_memory_index.get_block_info(block);
 }
 
+bool lba_list_t::get_block_info_if_loaded(block_id_t block,
+                                          index_block_info_t *info_out) {
+    rassert(state == state_loading || state == state_ready
+            || state == state_gc_shutting_down);
+    if (!in_memory_index.is_block_info_loaded(block)) {
+        return false;
+    }
+    *info_out = in_memory_index.get_block_info(block);
+    return true;
+}
+
 flagged_off64_t lba_list_t::get_block_offset(block_id_t block) {
     return get_block_info(block).offset;
 }
@@ -164,10 +187,19 @@ block_size_t lba_list_t::get_block_size(block_id_t block) {
     return block_size_t::unsafe_make(get_block_info(block).ser_block_size);
 }
 
+block_size_t lba_list_t::get_disk_block_size(block_id_t block) {
+    return block_size_t::unsafe_make(get_block_info(block).disk_block_size());
+}
+
 repli_timestamp_t lba_list_t::get_block_recency(block_id_t block) {
     return get_block_info(block).recency;
 }
 
+repli_timestamp_t lba_list_t::newest_recency() {
+    rassert(state == state_ready || state == state_gc_shutting_down);
+    return in_memory_index.newest_recency();
+}
+
 segmented_vector_t<repli_timestamp_t> lba_list_t::get_block_recencies(block_id_t first,
                                                                       block_id_t step) {
     guarantee(coro_t::self() != nullptr);
@@ -192,13 +224,17 @@ segmented_vector_t<repli_timestamp_t> lba_list_t::get_block_recencies(block_id_t
 
 void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
                                 flagged_off64_t offset, uint32_t ser_block_size,
+                                uint32_t compressed_block_size, uint32_t checksum,
                                 file_account_t *io_account, extent_transaction_t *txn) {
     rassert(state == state_ready || state == state_gc_shutting_down);
 
     guarantee(ser_block_size <= std::numeric_limits<uint16_t>::max());
+    guarantee(compressed_block_size < ser_block_size || compressed_block_size == 0);
     uint16_t ser_block_size_16 = static_cast<uint16_t>(ser_block_size);
+    uint16_t compressed_block_size_16 = static_cast<uint16_t>(compressed_block_size);
 
-    in_memory_index.set_block_info(block, recency, offset, ser_block_size_16);
+    in_memory_index.set_block_info(block, recency, offset, ser_block_size_16,
+                                   compressed_block_size_16, checksum);
 
     // If the inline LBA is full, free it up first by moving its entries to
     // the LBA extents
@@ -207,7 +243,8 @@ void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
         rassert(!check_inline_lba_full());
     }
     // Then store the entry inline
-    add_inline_entry(block, recency, offset, ser_block_size_16);
+    add_inline_entry(block, recency, offset, ser_block_size_16,
+                     compressed_block_size_16, checksum);
 }
 
 bool lba_list_t::check_inline_lba_full() const {
@@ -245,6 +282,8 @@ void lba_list_t::move_inline_entries_to_extents(file_account_t *io_account, exte
                 e.recency,
                 e.offset,
                 e.ser_block_size,
+                e.compressed_block_size,
+                e.checksum,
                 io_account,
                 txn);
     }
@@ -253,11 +292,13 @@ void lba_list_t::move_inline_entries_to_extents(file_account_t *io_account, exte
 }
 
 void lba_list_t::add_inline_entry(block_id_t block, repli_timestamp_t recency,
-                                flagged_off64_t offset, uint16_t ser_block_size) {
+                                flagged_off64_t offset, uint16_t ser_block_size,
+                                uint16_t compressed_block_size, uint32_t checksum) {
 
     rassert(!check_inline_lba_full());
     inline_lba_entries[inline_lba_entries_count++] =
-            lba_entry_t::make(block, recency, offset, ser_block_size);
+            lba_entry_t::make(block, recency, offset, ser_block_size,
+                              compressed_block_size, checksum);
 }
 
 class lba_syncer_t :
@@ -348,11 +389,13 @@ void lba_list_t::gc(int lba_shard, auto_drainer_t::lock_t) {
 
         flagged_off64_t off = get_block_offset(id);
         if (off.has_value()) {
-            uint32_t ser_block_size = get_ser_block_size(id);
+            const index_block_info_t info = get_block_info(id);
             disk_structures[lba_shard]->add_entry(id,
-                                                  get_block_recency(id),
+                                                  info.recency,
                                                   off,
-                                                  ser_block_size,
+                                                  info.ser_block_size,
+                                                  info.compressed_block_size,
+                                                  info.checksum,
                                                   gc_io_account.get(),
                                                   txns.back().get());
         }
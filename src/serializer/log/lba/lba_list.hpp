@@ -33,6 +33,10 @@ public:
     static void prepare_initial_metablock(metablock_mixin_t *mb_out);
     void prepare_metablock(metablock_mixin_t *mb_out);
 
+    /* Starts loading the LBA from disk. `get_block_info_if_loaded()` works as soon
+    as this returns, the rest of the methods have to wait until the whole LBA is in
+    memory, which is when `cb` gets called. Returns true instead of calling `cb` if
+    that is the case right away. */
     struct ready_callback_t {
         virtual void on_lba_ready() = 0;
         virtual ~ready_callback_t() {}
@@ -40,13 +44,26 @@ public:
     bool start_existing(file_t *dbfile, metablock_mixin_t *last_metablock,
                         ready_callback_t *cb);
 
+    // Stops loading the LBA early, when we are shutting down before it has finished.
+    // The callback passed to `start_existing()` still gets called, but some blocks
+    // will be missing from the LBA. Does nothing if the LBA is already loaded.
+    void abort_loading();
+
     index_block_info_t get_block_info(block_id_t block);
 
+    // Returns false if the LBA is still loading and we don't know about the block yet.
+    bool get_block_info_if_loaded(block_id_t block, index_block_info_t *info_out);
+
     // These return individual fields of get_block_info.
     flagged_off64_t get_block_offset(block_id_t block);
     uint32_t get_ser_block_size(block_id_t block);
     block_size_t get_block_size(block_id_t block);
+    // The size of the block on disk, which is less than `get_block_size()` if the
+    // block is stored compressed.
+    block_size_t get_disk_block_size(block_id_t block);
     repli_timestamp_t get_block_recency(block_id_t block);
+    // See `in_memory_index_t::newest_recency()`.
+    repli_timestamp_t newest_recency();
     segmented_vector_t<repli_timestamp_t> get_block_recencies(block_id_t first,
                                                               block_id_t step);
 
@@ -63,6 +80,7 @@ public:
 
     void set_block_info(block_id_t block, repli_timestamp_t recency,
                         flagged_off64_t offset, uint32_t ser_block_size,
+                        uint32_t compressed_block_size, uint32_t checksum,
                         file_account_t *io_account,
                         extent_transaction_t *txn);
 
@@ -98,6 +116,7 @@ private:
     enum state_t {
         state_unstarted,
         state_starting_up,
+        state_loading,
         state_ready,
         state_gc_shutting_down,
         state_shut_down
@@ -117,7 +136,8 @@ private:
     bool check_inline_lba_full() const;
     void move_inline_entries_to_extents(file_account_t *io_account, extent_transaction_t *txn);
     void add_inline_entry(block_id_t block, repli_timestamp_t recency,
-                                flagged_off64_t offset, uint16_t ser_block_size);
+                                flagged_off64_t offset, uint16_t ser_block_size,
+                                uint16_t compressed_block_size, uint32_t checksum);
 
     lba_disk_structure_t *disk_structures[LBA_SHARD_FACTOR];
 
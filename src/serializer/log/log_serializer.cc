@@ -6,16 +6,20 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <functional>
 
 #include "arch/io/disk.hpp"
 #include "arch/runtime/runtime.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "arch/timing.hpp"
 #include "buffer_cache/types.hpp"
+#include "concurrency/interruptor.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "logger.hpp"
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
+#include "serializer/log/block_checksum.hpp"
 #include "serializer/log/data_block_manager.hpp"
 
 filepath_file_opener_t::filepath_file_opener_t(const serializer_filepath_t &filepath,
@@ -114,6 +118,7 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
     : serializer_collection(),
       pm_serializer_block_reads(secs_to_ticks(1)),
       pm_serializer_index_reads(),
+      pm_serializer_index_reads_waiting_for_lba(),
       pm_serializer_block_writes(),
       pm_serializer_index_writes(secs_to_ticks(1)),
       pm_serializer_index_writes_size(secs_to_ticks(1), false),
@@ -121,6 +126,11 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_read_bytes_total(),
       pm_serializer_written_bytes_per_sec(secs_to_ticks(1)),
       pm_serializer_written_bytes_total(),
+      pm_serializer_scrubs(),
+      pm_serializer_scrub_blocks_verified(),
+      pm_serializer_scrub_checksum_errors(),
+      pm_serializer_compressed_block_writes(),
+      pm_serializer_compression_saved_bytes_total(),
       pm_extents_in_use(),
       pm_file_size_bytes(),
       pm_serializer_lba_extents(),
@@ -129,11 +139,16 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_data_extents_gced(),
       pm_serializer_old_garbage_block_bytes(),
       pm_serializer_old_total_block_bytes(),
+      pm_serializer_block_written_bytes_total(),
+      pm_serializer_gc_written_bytes_total(),
+      pm_serializer_gc_backoffs(),
       pm_serializer_lba_gcs(),
       parent_collection_membership(parent, &serializer_collection, "serializer"),
       stats_membership(&serializer_collection,
           &pm_serializer_block_reads, "serializer_block_reads",
           &pm_serializer_index_reads, "serializer_index_reads",
+          &pm_serializer_index_reads_waiting_for_lba,
+          "serializer_index_reads_waiting_for_lba",
           &pm_serializer_block_writes, "serializer_block_writes",
           &pm_serializer_index_writes, "serializer_index_writes",
           &pm_serializer_index_writes_size, "serializer_index_writes_size",
@@ -141,6 +156,12 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_read_bytes_total, "serializer_read_bytes_total",
           &pm_serializer_written_bytes_per_sec, "serializer_written_bytes_per_sec",
           &pm_serializer_written_bytes_total, "serializer_written_bytes_total",
+          &pm_serializer_scrubs, "serializer_scrubs",
+          &pm_serializer_scrub_blocks_verified, "serializer_scrub_blocks_verified",
+          &pm_serializer_scrub_checksum_errors, "serializer_scrub_checksum_errors",
+          &pm_serializer_compressed_block_writes, "serializer_compressed_block_writes",
+          &pm_serializer_compression_saved_bytes_total,
+          "serializer_compression_saved_bytes_total",
           &pm_extents_in_use, "serializer_extents_in_use",
           &pm_file_size_bytes, "serializer_file_size_bytes",
           &pm_serializer_lba_extents, "serializer_lba_extents",
@@ -149,6 +170,10 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_data_extents_gced, "serializer_data_extents_gced",
           &pm_serializer_old_garbage_block_bytes, "serializer_old_garbage_block_bytes",
           &pm_serializer_old_total_block_bytes, "serializer_old_total_block_bytes",
+          &pm_serializer_block_written_bytes_total,
+          "serializer_block_written_bytes_total",
+          &pm_serializer_gc_written_bytes_total, "serializer_gc_written_bytes_total",
+          &pm_serializer_gc_backoffs, "serializer_gc_backoffs",
           &pm_serializer_lba_gcs, "serializer_lba_gcs")
 { }
 
@@ -273,7 +298,20 @@ struct ls_start_existing_fsm_t :
             guarantee(metablock_found, "Could not find any valid metablock.");
 
             // STATE H
-            if (ser->lba_index->start_existing(ser->dbfile, &metablock_buffer.lba_index_part, this)) {
+            ser->data_block_manager->start_reconstruct(ser->dbfile);
+            const bool lba_loaded = ser->lba_index->start_existing(
+                ser->dbfile, &metablock_buffer.lba_index_part, this);
+
+            // We can serve reads while the LBA is loading, so the constructor can
+            // return now. Everything else waits for `index_loaded`.
+            rassert(ser->state == log_serializer_t::state_starting_up);
+            ser->state = log_serializer_t::state_ready;
+            if (to_signal_when_done) {
+                to_signal_when_done->pulse();
+                to_signal_when_done = nullptr;
+            }
+
+            if (lba_loaded) {
                 start_existing_state = state_reconstruct;
                 // STATE J
             } else {
@@ -285,7 +323,6 @@ struct ls_start_existing_fsm_t :
         }
 
         if (start_existing_state == state_reconstruct) {
-            ser->data_block_manager->start_reconstruct();
             start_existing_state = state_reconstruct_ongoing;
             next_block_to_reconstruct = 0;
             // Fall through into state_reconstruct_ongoing
@@ -307,7 +344,8 @@ struct ls_start_existing_fsm_t :
                     ser->lba_index->get_block_offset(next_block_to_reconstruct);
                 if (offset.has_value()) {
                     ser->data_block_manager->mark_live(offset.get_value(),
-                        ser->lba_index->get_block_size(next_block_to_reconstruct));
+                        ser->lba_index->get_block_size(next_block_to_reconstruct),
+                        ser->lba_index->get_disk_block_size(next_block_to_reconstruct));
                 }
 
                 ++next_block_to_reconstruct;
@@ -318,7 +356,7 @@ struct ls_start_existing_fsm_t :
                 }
             }
             ser->data_block_manager->end_reconstruct();
-            ser->data_block_manager->start_existing(ser->dbfile, &metablock_buffer.data_block_manager_part);
+            ser->data_block_manager->start_existing(&metablock_buffer.data_block_manager_part);
 
             ser->extent_manager->start_existing(&metablock_buffer.extent_manager_part);
 
@@ -327,10 +365,7 @@ struct ls_start_existing_fsm_t :
 
         if (start_existing_state == state_finish) {
             start_existing_state = state_done;
-            rassert(ser->state == log_serializer_t::state_starting_up);
-            ser->state = log_serializer_t::state_ready;
-
-            if (to_signal_when_done) to_signal_when_done->pulse();
+            ser->index_loaded.pulse();
 
             delete this;
             return true;
@@ -412,12 +447,21 @@ log_serializer_t::log_serializer_t(dynamic_config_t _dynamic_config, serializer_
       metablock_manager(nullptr),
       lba_index(nullptr),
       data_block_manager(nullptr),
-      active_write_count(0) {
+      active_write_count(0),
+      scrub_active(false) {
     // STATE A
     /* This is because the serializer is not completely converted to coroutines yet. */
     ls_start_existing_fsm_t *s = new ls_start_existing_fsm_t(this);
     cond_t cond;
     if (!s->run(&cond, file_opener)) cond.wait();
+
+    scrub_drainer.init(new auto_drainer_t);
+    if (dynamic_config.scrub_interval_secs > 0) {
+        coro_t *scrub_coro = coro_t::spawn_sometime(std::bind(
+            &log_serializer_t::run_scrubs, this,
+            auto_drainer_t::lock_t(scrub_drainer.get())));
+        scrub_coro->set_priority(CORO_PRIORITY_SERIALIZER_SCRUB);
+    }
 }
 
 log_serializer_t::~log_serializer_t() {
@@ -448,7 +492,8 @@ buf_ptr_t log_serializer_t::block_read(const counted_t<ls_block_token_pointee_t>
     stats->pm_serializer_block_reads.begin(&pm_time);
 
     buf_ptr_t ret = data_block_manager->read(token->offset_, token->block_size(),
-                                           io_account);
+                                             token->disk_block_size(),
+                                             token->checksum(), io_account);
 
     stats->pm_serializer_block_reads.end(&pm_time);
     return ret;
@@ -476,6 +521,7 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
                                    const std::function<void()> &on_writes_reflected,
                                    const std::vector<index_write_op_t> &write_ops) {
     assert_thread();
+    index_loaded.wait();
     ticks_t pm_time;
     stats->pm_serializer_index_writes.begin(&pm_time);
     stats->pm_serializer_index_writes_size.record(write_ops.size());
@@ -493,8 +539,11 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
              write_op_it != write_ops.end();
              ++write_op_it) {
             const index_write_op_t &op = *write_op_it;
-            flagged_off64_t offset = lba_index->get_block_offset(op.block_id);
-            uint32_t ser_block_size = lba_index->get_ser_block_size(op.block_id);
+            const index_block_info_t old_info = lba_index->get_block_info(op.block_id);
+            flagged_off64_t offset = old_info.offset;
+            uint32_t ser_block_size = old_info.ser_block_size;
+            uint32_t compressed_block_size = old_info.compressed_block_size;
+            uint32_t checksum = old_info.checksum;
 
             if (op.token) {
                 // Update the offset pointed to, and mark garbage/liveness as necessary.
@@ -510,21 +559,29 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
                 if (token.has()) {
                     offset = flagged_off64_t::make(token->offset_);
                     ser_block_size = token->block_size().ser_value();
+                    compressed_block_size
+                        = token->disk_block_size() != token->block_size()
+                        ? token->disk_block_size().ser_value()
+                        : 0;
+                    checksum = token->checksum();
 
                     /* mark the life */
-                    data_block_manager->mark_live(offset.get_value(), token->block_size());
+                    data_block_manager->mark_live(offset.get_value(), token->block_size(),
+                                                  token->disk_block_size());
                 } else {
                     offset = flagged_off64_t::unused();
                     ser_block_size = 0;
+                    compressed_block_size = 0;
+                    checksum = NO_BLOCK_CHECKSUM;
                 }
             }
 
             repli_timestamp_t recency = op.recency ? op.recency.get()
-                : lba_index->get_block_recency(op.block_id);
+                : old_info.recency;
 
             lba_index->set_block_info(op.block_id, recency,
-                                      offset, ser_block_size,
-                                      index_writes_io_account.get(), &txn);
+                                      offset, ser_block_size, compressed_block_size,
+                                      checksum, index_writes_io_account.get(), &txn);
         }
     }
 
@@ -534,7 +591,10 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
     // Before we fully commit the write to disk, we must migrate the static header
     // if necessary.
     // Note that this is early enough for upgrading from the 1.13 serializer
-    // version to 2.2, since only the format of the LBA changed.
+    // version to 2.2, since only the format of the LBA changed.  The same goes for
+    // 2.2 to 2.5: blocks written before this point can be compressed and have
+    // checksums, but only the LBA entries that `index_write_finish` writes below
+    // say so, so a file with the 2.2 header never refers to them.
     // Future serializer format changes might require this step to happen earlier.
     {
         new_mutex_acq_t acq(&static_header_migration_mutex);
@@ -651,9 +711,13 @@ void log_serializer_t::write_metablock_sans_pipelining(const signal_t *safe_to_w
 }
 
 counted_t<ls_block_token_pointee_t>
-log_serializer_t::generate_block_token(int64_t offset, block_size_t block_size) {
+log_serializer_t::generate_block_token(int64_t offset, block_size_t block_size,
+                                       block_size_t disk_block_size,
+                                       uint32_t checksum) {
     assert_thread();
-    counted_t<ls_block_token_pointee_t> ret(new ls_block_token_pointee_t(this, offset, block_size));
+    counted_t<ls_block_token_pointee_t> ret(
+        new ls_block_token_pointee_t(this, offset, block_size, disk_block_size,
+                                     checksum));
     return ret;
 }
 
@@ -661,6 +725,7 @@ std::vector<counted_t<ls_block_token_pointee_t> >
 log_serializer_t::block_writes(const std::vector<buf_write_info_t> &write_infos,
                                file_account_t *io_account, iocallback_t *cb) {
     assert_thread();
+    index_loaded.wait();
     stats->pm_serializer_block_writes += write_infos.size();
 
     std::vector<counted_t<ls_block_token_pointee_t> > result
@@ -770,9 +835,108 @@ bool log_serializer_t::is_gc_active() const {
     return data_block_manager->is_gc_active() || lba_index->is_any_gc_active();
 }
 
+uint64_t log_serializer_t::scrub(signal_t *interruptor) {
+    assert_thread();
+    guarantee(state == state_ready);
+    guarantee(!scrub_active, "Only one scrub can run at a time.");
+    assignment_sentry_t<bool> active_sentry(&scrub_active, true);
+    wait_interruptible(&index_loaded, interruptor);
+
+    const block_id_t end_block_id = lba_index->end_block_id();
+    const block_id_t end_aux_block_id = lba_index->end_aux_block_id();
+    scrub_progress = scrub_progress_t();
+    scrub_progress.blocks_total
+        = end_block_id + (end_aux_block_id - FIRST_AUX_BLOCK_ID);
+
+    scoped_ptr_t<file_account_t> io_account(
+        make_io_account(SERIALIZER_SCRUB_IO_PRIORITY, 1));
+
+    block_id_t next_block_id = 0;
+    bool done = false;
+    while (!done) {
+        // We take tokens for a batch of blocks and read them in the order of their
+        // offsets, so that the reads are mostly sequential.  The tokens keep the
+        // blocks from getting garbage collected in the meantime.
+        std::vector<std::pair<block_id_t, counted_t<ls_block_token_pointee_t> > >
+            batch;
+        for (int i = 0; i < SERIALIZER_SCRUB_BATCH_SIZE; ++i) {
+            if (!is_aux_block_id(next_block_id) && next_block_id >= end_block_id) {
+                next_block_id = FIRST_AUX_BLOCK_ID;
+            }
+            if (next_block_id >= end_aux_block_id) {
+                done = true;
+                break;
+            }
+            const index_block_info_t info = lba_index->get_block_info(next_block_id);
+            if (info.offset.has_value() && info.checksum != NO_BLOCK_CHECKSUM) {
+                batch.push_back(std::make_pair(next_block_id, generate_block_token(
+                    info.offset.get_value(),
+                    block_size_t::unsafe_make(info.ser_block_size),
+                    block_size_t::unsafe_make(info.disk_block_size()),
+                    info.checksum)));
+            }
+            ++next_block_id;
+        }
+        std::sort(batch.begin(), batch.end(),
+            [](const std::pair<block_id_t, counted_t<ls_block_token_pointee_t> > &x,
+               const std::pair<block_id_t, counted_t<ls_block_token_pointee_t> > &y) {
+                return x.second->offset() < y.second->offset();
+            });
+
+        for (const auto &block : batch) {
+            if (interruptor->is_pulsed()) {
+                throw interrupted_exc_t();
+            }
+            const counted_t<ls_block_token_pointee_t> &token = block.second;
+            const bool ok = data_block_manager->verify(token->offset(),
+                                                       token->disk_block_size(),
+                                                       token->checksum(),
+                                                       io_account.get());
+            ++stats->pm_serializer_scrub_blocks_verified;
+            if (!ok) {
+                ++scrub_progress.errors;
+                ++stats->pm_serializer_scrub_checksum_errors;
+                logERR("Block %" PR_BLOCK_ID " at offset %" PRIi64 " of the database "
+                       "file is corrupted (its checksum doesn't match).",
+                       block.first, token->offset());
+            }
+        }
+        batch.clear();
+
+        scrub_progress.blocks_done = is_aux_block_id(next_block_id)
+            ? end_block_id + (next_block_id - FIRST_AUX_BLOCK_ID)
+            : next_block_id;
+        coro_t::yield();
+    }
+
+    ++stats->pm_serializer_scrubs;
+    return scrub_progress.errors;
+}
+
+bool log_serializer_t::get_scrub_progress(scrub_progress_t *progress_out) const {
+    if (!scrub_active) {
+        return false;
+    }
+    *progress_out = scrub_progress;
+    return true;
+}
+
+void log_serializer_t::run_scrubs(auto_drainer_t::lock_t keepalive) {
+    try {
+        while (true) {
+            nap(dynamic_config.scrub_interval_secs * THOUSAND,
+                keepalive.get_drain_signal());
+            scrub(keepalive.get_drain_signal());
+        }
+    } catch (const interrupted_exc_t &) {
+        // We're shutting down.
+    }
+}
+
 block_id_t log_serializer_t::end_block_id() {
     assert_thread();
     rassert(state == state_ready);
+    index_loaded.wait();
 
     return lba_index->end_block_id();
 }
@@ -780,6 +944,7 @@ block_id_t log_serializer_t::end_block_id() {
 block_id_t log_serializer_t::end_aux_block_id() {
     assert_thread();
     rassert(state == state_ready);
+    index_loaded.wait();
 
     return lba_index->end_aux_block_id();
 }
@@ -790,14 +955,24 @@ counted_t<ls_block_token_pointee_t> log_serializer_t::index_read(block_id_t bloc
 
     rassert(state == state_ready);
 
-    if ((is_aux_block_id(block_id) && block_id >= lba_index->end_aux_block_id())
-        || (!is_aux_block_id(block_id) && block_id >= lba_index->end_block_id())) {
-        return counted_t<ls_block_token_pointee_t>();
+    index_block_info_t info;
+    if (!lba_index->get_block_info_if_loaded(block_id, &info)) {
+        // The LBA is still loading, and the block's entry hasn't shown up yet.
+        ++stats->pm_serializer_index_reads_waiting_for_lba;
+        index_loaded.wait();
+
+        if ((is_aux_block_id(block_id) && block_id >= lba_index->end_aux_block_id())
+            || (!is_aux_block_id(block_id) && block_id >= lba_index->end_block_id())) {
+            return counted_t<ls_block_token_pointee_t>();
+        }
+        info = lba_index->get_block_info(block_id);
     }
 
-    index_block_info_t info = lba_index->get_block_info(block_id);
     if (info.offset.has_value()) {
-        return generate_block_token(info.offset.get_value(), block_size_t::unsafe_make(info.ser_block_size));
+        return generate_block_token(info.offset.get_value(),
+                                    block_size_t::unsafe_make(info.ser_block_size),
+                                    block_size_t::unsafe_make(info.disk_block_size()),
+                                    info.checksum);
     } else {
         return counted_t<ls_block_token_pointee_t>();
     }
@@ -806,6 +981,7 @@ counted_t<ls_block_token_pointee_t> log_serializer_t::index_read(block_id_t bloc
 bool log_serializer_t::get_delete_bit(block_id_t id) {
     assert_thread();
     rassert(state == state_ready);
+    index_loaded.wait();
 
     flagged_off64_t offset = lba_index->get_block_offset(id);
     return !offset.has_value();
@@ -814,6 +990,7 @@ bool log_serializer_t::get_delete_bit(block_id_t id) {
 segmented_vector_t<repli_timestamp_t>
 log_serializer_t::get_all_recencies(block_id_t first, block_id_t step) {
     assert_thread();
+    index_loaded.wait();
     return lba_index->get_block_recencies(first, step);
 }
 
@@ -828,6 +1005,17 @@ void log_serializer_t::shutdown(cond_t *cb) {
     rassert(shutdown_state == shutdown_not_started);
     shutdown_state = shutdown_begin;
 
+    // The scrub holds block tokens and uses the data block manager, so we stop it
+    // first.
+    scrub_drainer.reset();
+
+    // We don't wait for the rest of the LBA if it's still loading. Nothing writes to
+    // the serializer anymore, so it doesn't matter that the LBA will be incomplete.
+    if (!index_loaded.is_pulsed()) {
+        lba_index->abort_loading();
+        index_loaded.wait();
+    }
+
     // We must shutdown the LBA GC before we shut down
     // the data_block_manager or metablock_manager, because the LBA GC
     // uses our `write_metablock()` method which depends on those.
@@ -982,9 +1170,15 @@ bool log_serializer_t::should_perform_read_ahead() {
 
 ls_block_token_pointee_t::ls_block_token_pointee_t(log_serializer_t *serializer,
                                                    int64_t initial_offset,
-                                                   block_size_t initial_block_size)
+                                                   block_size_t initial_block_size,
+                                                   block_size_t initial_disk_block_size,
+                                                   uint32_t initial_checksum)
     : serializer_(serializer), ref_count_(0),
-      block_size_(initial_block_size), offset_(initial_offset) {
+      block_size_(initial_block_size),
+      disk_block_size_(initial_disk_block_size),
+      checksum_(initial_checksum),
+      offset_(initial_offset) {
+    rassert(disk_block_size_.ser_value() <= block_size_.ser_value());
     serializer_->assert_thread();
     serializer_->register_block_token(this, initial_offset);
 }
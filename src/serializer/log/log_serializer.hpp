@@ -12,6 +12,7 @@
 #include "serializer/serializer.hpp"
 #include "serializer/log/config.hpp"
 #include "utils.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/mutex_assertion.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "concurrency/signal.hpp"
@@ -127,7 +128,8 @@ public:
     /* Blocks. Does not check for an existing database--use check_existing for that. */
     static void create(serializer_file_opener_t *file_opener, static_config_t static_config);
 
-    /* Blocks. */
+    /* Blocks until blocks can be read. The LBA keeps loading in the background after
+    that, see `index_loaded_signal()`. */
     log_serializer_t(dynamic_config_t dynamic_config, serializer_file_opener_t *file_opener, perfmon_collection_t *perfmon_collection);
 
     /* Blocks. */
@@ -164,13 +166,29 @@ public:
 
     virtual bool is_gc_active() const;
 
+    /* Reads back every live block that has a checksum and verifies it, through a
+    low-priority i/o account. Unlike a regular read, this logs and counts corrupted
+    blocks instead of crashing, so that one scrub finds all of them. Returns how many
+    it found. The serializer scrubs itself every `scrub_interval_secs`; this must not
+    be called while that is happening. */
+    uint64_t scrub(signal_t *interruptor);
+
+    bool get_scrub_progress(scrub_progress_t *progress_out) const;
+
+    /* Pulsed once the whole LBA is in memory. Before that, `index_read()` can only
+    answer right away for blocks whose LBA entries have already been loaded (it loads
+    the most recent entries first), and everything else that needs the LBA waits. */
+    const signal_t *index_loaded_signal() const { return &index_loaded; }
+
 private:
     void register_block_token(ls_block_token_pointee_t *token, int64_t offset);
     bool tokens_exist_for_offset(int64_t off);
     void unregister_block_token(ls_block_token_pointee_t *token);
     void remap_block_to_new_offset(int64_t current_offset, int64_t new_offset);
     counted_t<ls_block_token_pointee_t> generate_block_token(int64_t offset,
-                                                             block_size_t block_size);
+                                                             block_size_t block_size,
+                                                             block_size_t disk_block_size,
+                                                             uint32_t checksum);
 
     void offer_buf_to_read_ahead_callbacks(
             block_id_t block_id,
@@ -216,6 +234,8 @@ private:
 
     void consider_start_gc();
 
+    void run_scrubs(auto_drainer_t::lock_t keepalive);
+
     std::multimap<int64_t, ls_block_token_pointee_t *> offset_tokens;
     scoped_ptr_t<log_serializer_stats_t> stats;
     perfmon_collection_t disk_stats_collection;
@@ -272,6 +292,13 @@ private:
 
     int active_write_count;
 
+    cond_t index_loaded;
+
+    bool scrub_active;
+    scrub_progress_t scrub_progress;
+    // Stops the background scrubs when we shut down.
+    scoped_ptr_t<auto_drainer_t> scrub_drainer;
+
     DISABLE_COPYING(log_serializer_t);
 };
 
@@ -13,6 +13,7 @@ struct log_serializer_stats_t {
 
     perfmon_duration_sampler_t pm_serializer_block_reads;
     perfmon_counter_t pm_serializer_index_reads;
+    perfmon_counter_t pm_serializer_index_reads_waiting_for_lba;
     perfmon_counter_t pm_serializer_block_writes;
     perfmon_duration_sampler_t pm_serializer_index_writes;
     perfmon_sampler_t pm_serializer_index_writes_size;
@@ -22,6 +23,14 @@ struct log_serializer_stats_t {
     perfmon_rate_monitor_t pm_serializer_written_bytes_per_sec;
     perfmon_counter_t pm_serializer_written_bytes_total;
 
+    perfmon_counter_t pm_serializer_scrubs;
+    perfmon_counter_t pm_serializer_scrub_blocks_verified;
+    perfmon_counter_t pm_serializer_scrub_checksum_errors;
+
+    /* used in serializer/log/data_block_manager.cc */
+    perfmon_counter_t pm_serializer_compressed_block_writes;
+    perfmon_counter_t pm_serializer_compression_saved_bytes_total;
+
     /* used in serializer/log/extent_manager.cc */
     perfmon_counter_t pm_extents_in_use;
     perfmon_counter_t pm_file_size_bytes;
@@ -35,6 +44,12 @@ struct log_serializer_stats_t {
     perfmon_counter_t pm_serializer_data_extents_gced;
     perfmon_counter_t pm_serializer_old_garbage_block_bytes;
     perfmon_counter_t pm_serializer_old_total_block_bytes;
+    /* The write amplification is `pm_serializer_written_bytes_total` (which also
+    counts the LBA and the metablocks) divided by the bytes of the data blocks that
+    we were asked to write. */
+    perfmon_counter_t pm_serializer_block_written_bytes_total;
+    perfmon_counter_t pm_serializer_gc_written_bytes_total;
+    perfmon_counter_t pm_serializer_gc_backoffs;
 
     /* used in serializer/log/lba/lba_list.cc */
     perfmon_counter_t pm_serializer_lba_gcs;
@@ -114,6 +114,10 @@ public:
         return inner->is_gc_active();
     }
 
+    bool get_scrub_progress(scrub_progress_t *progress_out) const {
+        return inner->get_scrub_progress(progress_out);
+    }
+
 private:
     // Adds `op` to `outstanding_index_write_ops`, using `merge_index_write_op()` if
     // necessary
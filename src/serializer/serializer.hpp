@@ -33,6 +33,17 @@ struct index_write_op_t {
 
 void debug_print(printf_buffer_t *buf, const index_write_op_t &write_op);
 
+/* How far the serializer has gotten in scrubbing its blocks, i.e. reading them back to
+verify their checksums. */
+struct scrub_progress_t {
+    scrub_progress_t() : blocks_done(0), blocks_total(0), errors(0) { }
+    // Counts block IDs, whether or not they are in use.
+    uint64_t blocks_done;
+    uint64_t blocks_total;
+    // Blocks that turned out to be corrupted.
+    uint64_t errors;
+};
+
 /* serializer_t is an abstract interface that describes how each serializer should
 behave. It is implemented by merger_serializer_t, log_serializer_t, and
 translator_serializer_t. */
@@ -125,6 +136,9 @@ public:
     /* Return true if the garbage collector is active */
     virtual bool is_gc_active() const = 0;
 
+    /* Return true and the progress if the serializer is scrubbing its blocks */
+    virtual bool get_scrub_progress(scrub_progress_t *progress_out) const = 0;
+
 private:
     DISABLE_COPYING(serializer_t);
 };
@@ -283,6 +283,10 @@ bool translator_serializer_t::is_gc_active() const {
     return inner->is_gc_active();
 }
 
+bool translator_serializer_t::get_scrub_progress(scrub_progress_t *progress_out) const {
+    return inner->get_scrub_progress(progress_out);
+}
+
 // A helper function for `end_block_id` and `end_aux_block_id`
 // `first_block_id` is the lowest block ID in the range, either 0 for regular block
 // IDs or FIRST_AUX_BLOCK_ID for aux blocks.
@@ -126,6 +126,8 @@ public:
 
     bool is_gc_active() const;
 
+    bool get_scrub_progress(scrub_progress_t *progress_out) const;
+
     block_id_t end_block_id();
     block_id_t end_aux_block_id();
 
@@ -136,6 +136,10 @@ class ls_block_token_pointee_t {
 public:
     int64_t offset() const { return offset_; }
     block_size_t block_size() const { return block_size_; }
+    // Less than `block_size()` if the block is stored compressed.
+    block_size_t disk_block_size() const { return disk_block_size_; }
+    // See serializer/log/block_checksum.hpp.
+    uint32_t checksum() const { return checksum_; }
 
 private:
     friend class log_serializer_t;
@@ -146,7 +150,9 @@ private:
 
     ls_block_token_pointee_t(log_serializer_t *serializer,
                              int64_t initial_offset,
-                             block_size_t initial_ser_block_size);
+                             block_size_t initial_ser_block_size,
+                             block_size_t initial_disk_block_size,
+                             uint32_t initial_checksum);
 
     log_serializer_t *serializer_;
     std::atomic<intptr_t> ref_count_;
@@ -154,6 +160,12 @@ private:
     // The block's size.
     block_size_t block_size_;
 
+    // The number of bytes the block takes up on disk.
+    block_size_t disk_block_size_;
+
+    // The checksum of the block as it is on disk.
+    uint32_t checksum_;
+
     // The block's offset on disk.
     int64_t offset_;
 
@@ -0,0 +1,135 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include <string>
+#include <vector>
+
+#include "arch/runtime/coroutines.hpp"
+#include "containers/arena.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "time.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+ql::datum_t make_temporary_row(int i) {
+    ql::datum_object_builder_t builder;
+    builder.overwrite("id", ql::datum_t(static_cast<double>(i)));
+    builder.overwrite("name", ql::datum_t(datum_string_t(strprintf("row %d", i))));
+    builder.overwrite("tags", ql::datum_t(std::vector<ql::datum_t>{
+        ql::datum_t("a"), ql::datum_t("b")}, ql::configured_limits_t()));
+    return std::move(builder).to_datum();
+}
+
+TPTEST(ArenaTest, OnlyServesItsCoroutine) {
+    arena_t arena;
+    ql::datum_t d("some string");
+    EXPECT_LT(0u, arena.bytes_allocated());
+    EXPECT_EQ(arena.bytes_allocated(), arena.bytes_allocated_in_chunks());
+
+    size_t bytes_before = arena.bytes_allocated();
+    coro_t::spawn_now_dangerously([]() {
+        ql::datum_t other("allocated by another coroutine");
+    });
+    EXPECT_EQ(bytes_before, arena.bytes_allocated());
+
+    // Too large to come from a chunk
+    ql::datum_t large(datum_string_t(std::string(10000, 'x')));
+    EXPECT_LT(bytes_before + 10000, arena.bytes_allocated());
+    EXPECT_GT(bytes_before + 1000, arena.bytes_allocated_in_chunks());
+}
+
+TPTEST(ArenaTest, NestedArenas) {
+    arena_t outer;
+    size_t outer_bytes;
+    {
+        arena_t inner;
+        ql::datum_t d("inner");
+        outer_bytes = outer.bytes_allocated();
+        EXPECT_LT(0u, inner.bytes_allocated());
+    }
+    EXPECT_EQ(outer_bytes, outer.bytes_allocated());
+    ql::datum_t d("outer");
+    EXPECT_LT(outer_bytes, outer.bytes_allocated());
+}
+
+TPTEST(ArenaTest, ArenasDestroyedOutOfOrder) {
+    scoped_ptr_t<arena_t> outer(new arena_t());
+    scoped_ptr_t<arena_t> middle(new arena_t());
+    arena_t inner;
+    middle.reset();
+    {
+        ql::datum_t d("inner");
+    }
+    EXPECT_EQ(0u, outer->bytes_allocated());
+    size_t inner_bytes = inner.bytes_allocated();
+    EXPECT_LT(0u, inner_bytes);
+    outer.reset();
+    ql::datum_t d("still inner");
+    EXPECT_LT(inner_bytes, inner.bytes_allocated());
+}
+
+TPTEST(ArenaTest, ArenaOutlivesItsCoroutine) {
+    scoped_ptr_t<arena_t> arena;
+    coro_t::spawn_now_dangerously([&]() {
+        arena.init(new arena_t());
+    });
+    ASSERT_TRUE(arena.has());
+    size_t bytes_before = arena->bytes_allocated();
+    // The next coroutine usually runs on the same `coro_t`, but the arena must not
+    // serve it.
+    coro_t::spawn_now_dangerously([]() {
+        ql::datum_t other("allocated by another coroutine");
+    });
+    EXPECT_EQ(bytes_before, arena->bytes_allocated());
+    arena.reset();
+}
+
+TPTEST(ArenaTest, EscapingValuesOutliveArena, 2) {
+    std::vector<ql::datum_t> escaped;
+    {
+        arena_t arena;
+        for (int i = 0; i < 10000; ++i) {
+            ql::datum_t row = make_temporary_row(i);
+            if (i % 1000 == 0) {
+                escaped.push_back(row);
+            }
+        }
+        EXPECT_LT(0u, arena.bytes_allocated_in_chunks());
+    }
+    // These are still in the arena's chunks.
+    for (size_t i = 0; i < escaped.size(); ++i) {
+        EXPECT_EQ(make_temporary_row(i * 1000), escaped[i]);
+    }
+    // Freeing them on another thread is fine too.
+    on_thread_t thread_switcher(threadnum_t(1));
+    escaped.clear();
+}
+
+// This is not really a unit test, but a micro benchmark of creating and dropping
+// small temporary datums with and without an arena. No need to run this in debug mode.
+#ifdef NDEBUG
+TPTEST(ArenaTest, TemporaryDatumBenchmark) {
+    const int NUM_ROWS = 1000000;
+
+    ticks_t start_ticks = get_ticks();
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        make_temporary_row(i);
+    }
+    double dur_heap = ticks_to_secs(get_ticks() - start_ticks);
+
+    arena_t arena;
+    start_ticks = get_ticks();
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        make_temporary_row(i);
+    }
+    double dur_arena = ticks_to_secs(get_ticks() - start_ticks);
+
+    printf("temporary rows: malloc %.0f rows/s, arena %.0f rows/s "
+           "(%zu bytes, %zu of them in the arena)\n",
+           NUM_ROWS / dur_heap, NUM_ROWS / dur_arena,
+           arena.bytes_allocated(), arena.bytes_allocated_in_chunks());
+}
+#endif
+
+}  // namespace unittest
@@ -0,0 +1,198 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+#include <vector>
+
+#include "arch/io/disk.hpp"
+#include "buffer_cache/cache_balancer.hpp"
+#include "config/args.hpp"
+#include "rdb_protocol/changefeed.hpp"
+#include "rdb_protocol/store.hpp"
+#include "rpc/mailbox/typed.hpp"
+#include "serializer/log/log_serializer.hpp"
+#include "unittest/clustering_utils.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+using ql::changefeed::msg_t;
+using ql::changefeed::stamped_msg_queue_t;
+using ql::changefeed::stamped_msg_t;
+using ql::changefeed::stamped_msgs_t;
+
+namespace {
+
+// We tell the messages apart by the `old_key` of a `limit_change_t`.
+msg_t numbered_msg(int i) {
+    msg_t::limit_change_t change;
+    change.old_key = std::to_string(i);
+    return msg_t(std::move(change));
+}
+
+int msg_number(const msg_t &msg) {
+    const msg_t::limit_change_t *change =
+        boost::get<msg_t::limit_change_t>(&msg.op);
+    guarantee(change != nullptr && static_cast<bool>(change->old_key));
+    return std::stoi(*change->old_key);
+}
+
+/* Runs a `server_t` for a single client and records the batches that the client
+receives. */
+class batching_test_t {
+public:
+    batching_test_t()
+        : mailbox_manager(&cluster, 'M'),
+          cluster_run(&cluster),
+          io_backender(file_direct_io_mode_t::buffered_desired),
+          balancer(GIGABYTE),
+          file_opener(temp_file.name(), &io_backender),
+          serializer(create_and_construct_serializer(&file_opener)),
+          store(region_t::universe(),
+                serializer.get(),
+                &balancer,
+                "unit_test_store",
+                true,
+                &get_global_perfmon_collection(),
+                nullptr,
+                &io_backender,
+                base_path_t("."),
+                generate_uuid(),
+                update_sindexes_t::UPDATE),
+          client(&mailbox_manager,
+                 [this](signal_t *, const stamped_msgs_t &msgs) {
+                     batches.push_back(msgs);
+                 }),
+          server(&mailbox_manager, &store),
+          keepalive(server.get_keepalive()) {
+        server.add_client(client.get_address(), region_t::universe(), keepalive);
+    }
+
+    // Sends the messages numbered [`begin`, `end`) without giving anything else a
+    // chance to run in between.
+    void send(int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            rwlock_in_line_t stamp_spot(&store.cfeed_stamp_lock, access_t::write);
+            server.send_all(numbered_msg(i), store_key_t(), &stamp_spot, keepalive);
+        }
+    }
+
+    // Checks that the batches we received hold the messages [0, `end`) in order.
+    void check_received(int end) {
+        uint64_t stamp = 0;
+        for (const stamped_msgs_t &batch : batches) {
+            EXPECT_EQ(server.get_uuid(), batch.server_uuid);
+            EXPECT_EQ(stamp, batch.first_stamp);
+            for (const msg_t &msg : batch.msgs) {
+                EXPECT_EQ(static_cast<int>(stamp), msg_number(msg));
+                ++stamp;
+            }
+        }
+        EXPECT_EQ(static_cast<uint64_t>(end), stamp);
+    }
+
+    std::vector<stamped_msgs_t> batches;
+
+private:
+    static scoped_ptr_t<log_serializer_t> create_and_construct_serializer(
+            filepath_file_opener_t *opener) {
+        log_serializer_t::create(opener, log_serializer_t::static_config_t());
+        return make_scoped<log_serializer_t>(
+            log_serializer_t::dynamic_config_t(),
+            opener,
+            &get_global_perfmon_collection());
+    }
+
+    connectivity_cluster_t cluster;
+    mailbox_manager_t mailbox_manager;
+    test_cluster_run_t cluster_run;
+    temp_file_t temp_file;
+    io_backender_t io_backender;
+    dummy_cache_balancer_t balancer;
+    filepath_file_opener_t file_opener;
+    scoped_ptr_t<log_serializer_t> serializer;
+    store_t store;
+    mailbox_t<void(stamped_msgs_t)> client;
+    ql::changefeed::server_t server;
+    auto_drainer_t::lock_t keepalive;
+};
+
+}  // namespace
+
+TPTEST(ChangefeedBatching, FlushWhenFull) {
+    recreate_temporary_directory(base_path_t("."));
+    batching_test_t test;
+    // Nothing yields while we send, so only the batch size can split these up.
+    const int num_msgs = 2 * CHANGEFEED_BATCH_MAX_MSGS + 1;
+    test.send(0, num_msgs);
+    let_stuff_happen();
+    ASSERT_EQ(3u, test.batches.size());
+    EXPECT_EQ(static_cast<size_t>(CHANGEFEED_BATCH_MAX_MSGS),
+              test.batches[0].msgs.size());
+    EXPECT_EQ(static_cast<size_t>(CHANGEFEED_BATCH_MAX_MSGS),
+              test.batches[1].msgs.size());
+    EXPECT_EQ(1u, test.batches[2].msgs.size());
+    test.check_received(num_msgs);
+}
+
+TPTEST(ChangefeedBatching, FlushAfterDelay) {
+    recreate_temporary_directory(base_path_t("."));
+    batching_test_t test;
+    test.send(0, 3);
+    let_stuff_happen();
+    ASSERT_EQ(1u, test.batches.size());
+    EXPECT_EQ(3u, test.batches[0].msgs.size());
+
+    // A new flush is scheduled for the next batch.
+    test.send(3, 5);
+    let_stuff_happen();
+    ASSERT_EQ(2u, test.batches.size());
+    EXPECT_EQ(2u, test.batches[1].msgs.size());
+    test.check_received(5);
+}
+
+TEST(ChangefeedBatching, QueueUnpacksBatchesInOrder) {
+    uuid_u server_uuid = generate_uuid();
+    stamped_msg_queue_t queue(0);
+
+    // The second batch arrives first, so nothing can be popped yet.
+    queue.push(stamped_msgs_t(
+        server_uuid, 3, std::vector<msg_t>{numbered_msg(3), numbered_msg(4)}));
+    EXPECT_TRUE(queue.peek() == nullptr);
+
+    queue.push(stamped_msgs_t(
+        server_uuid, 0,
+        std::vector<msg_t>{numbered_msg(0), numbered_msg(1), numbered_msg(2)}));
+    for (uint64_t stamp = 0; stamp < 5; ++stamp) {
+        const stamped_msg_t *msg = queue.peek();
+        ASSERT_TRUE(msg != nullptr);
+        EXPECT_EQ(server_uuid, msg->server_uuid);
+        EXPECT_EQ(stamp, msg->stamp);
+        EXPECT_EQ(static_cast<int>(stamp), msg_number(msg->submsg));
+        queue.pop();
+    }
+    EXPECT_TRUE(queue.peek() == nullptr);
+    EXPECT_EQ(5u, queue.get_next());
+}
+
+TEST(ChangefeedBatching, QueueWaitsForMissingStamp) {
+    uuid_u server_uuid = generate_uuid();
+    stamped_msg_queue_t queue(0);
+    queue.push(stamped_msgs_t(server_uuid, 0, std::vector<msg_t>{numbered_msg(0)}));
+    queue.push(stamped_msgs_t(server_uuid, 2, std::vector<msg_t>{numbered_msg(2)}));
+
+    ASSERT_TRUE(queue.peek() != nullptr);
+    queue.pop();
+    // Stamp 1 is still on its way.
+    EXPECT_TRUE(queue.peek() == nullptr);
+
+    queue.push(stamped_msgs_t(server_uuid, 1, std::vector<msg_t>{numbered_msg(1)}));
+    for (int i = 1; i <= 2; ++i) {
+        const stamped_msg_t *msg = queue.peek();
+        ASSERT_TRUE(msg != nullptr);
+        EXPECT_EQ(i, msg_number(msg->submsg));
+        queue.pop();
+    }
+    EXPECT_TRUE(queue.peek() == nullptr);
+}
+
+}  // namespace unittest
@@ -0,0 +1,250 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+#include <vector>
+
+#include "rdb_protocol/changefeed.hpp"
+#include "rdb_protocol/func.hpp"
+#include "rdb_protocol/minidriver.hpp"
+#include "rdb_protocol/protocol.hpp"
+#include "rdb_protocol/term.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+using ql::changefeed::change_filter_t;
+using ql::changefeed::change_filters_t;
+using ql::changefeed::msg_t;
+
+const ql::sym_t row_var(1);
+
+store_key_t pkey_of(double id) {
+    return store_key_t(ql::datum_t(id).print_primary());
+}
+
+ql::datum_t row_with_a(double id, double a) {
+    ql::datum_object_builder_t builder;
+    builder.overwrite("id", ql::datum_t(id));
+    builder.overwrite("a", ql::datum_t(a));
+    return std::move(builder).to_datum();
+}
+
+msg_t::change_t make_change(double id, ql::datum_t old_val, ql::datum_t new_val) {
+    return msg_t::change_t{
+        index_vals_t(), index_vals_t(), pkey_of(id), old_val, new_val};
+}
+
+changefeed_filter_t point_filter(double id) {
+    return changefeed_filter_t{
+        generate_uuid(), boost::none, pkey_of(id), serializable_env_t()};
+}
+
+// A range subscription on the primary keys in [0, 10).
+changefeed_filter_t range_filter(std::vector<ql::transform_variant_t> transforms) {
+    return changefeed_filter_t{
+        generate_uuid(),
+        ql::changefeed::keyspec_t::range_t{
+            std::move(transforms),
+            boost::optional<std::string>(),
+            sorting_t::UNORDERED,
+            ql::datumspec_t(
+                ql::datum_range_t(
+                    ql::datum_t(0.0),
+                    key_range_t::closed,
+                    ql::datum_t(10.0),
+                    key_range_t::open)),
+            boost::optional<ql::datum_t>()},
+        boost::none,
+        serializable_env_t()};
+}
+
+// `body` has to outlive the function.
+std::vector<ql::transform_variant_t> filter_transform(
+        ql::minidriver_t::reql_t *body) {
+    ql::compile_env_t compile_env(
+        ql::var_visibility_t().with_func_arg_name_list(make_vector(row_var)));
+    counted_t<const ql::func_t> func = make_counted<ql::reql_func_t>(
+        ql::var_scope_t(),
+        make_vector(row_var),
+        ql::compile_term(&compile_env, body->root_term()));
+    return std::vector<ql::transform_variant_t>{
+        ql::filter_wire_func_t(func, boost::none)};
+}
+
+bool accepts(change_filter_t *filter, const msg_t::change_t &change) {
+    auto_drainer_t::lock_t keepalive = filter->get_keepalive();
+    return filter->accepts(change, keepalive);
+}
+
+// What `server_t::send_all` checks for each client.
+bool any_accepts(change_filters_t *filters, const msg_t::change_t &change) {
+    std::vector<auto_drainer_t::lock_t> keepalives;
+    std::vector<change_filter_t *> fs = filters->get_filters(&keepalives);
+    for (size_t i = 0; i < fs.size(); ++i) {
+        if (fs[i]->accepts(change, keepalives[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TPTEST(ChangefeedFilters, Point) {
+    change_filter_t filter(nullptr, point_filter(5.0));
+    EXPECT_TRUE(accepts(&filter, make_change(5.0, row_with_a(5.0, 1.0),
+                                             row_with_a(5.0, 2.0))));
+    EXPECT_FALSE(accepts(&filter, make_change(6.0, row_with_a(6.0, 1.0),
+                                              row_with_a(6.0, 2.0))));
+}
+
+TPTEST(ChangefeedFilters, Range) {
+    change_filter_t filter(nullptr, range_filter({}));
+    EXPECT_FALSE(filter.evaluates_transforms());
+    EXPECT_TRUE(accepts(&filter, make_change(0.0, ql::datum_t(),
+                                             row_with_a(0.0, 1.0))));
+    EXPECT_TRUE(accepts(&filter, make_change(9.0, row_with_a(9.0, 1.0),
+                                             ql::datum_t())));
+    EXPECT_FALSE(accepts(&filter, make_change(10.0, ql::datum_t(),
+                                              row_with_a(10.0, 1.0))));
+    EXPECT_FALSE(accepts(&filter, make_change(-1.0, row_with_a(-1.0, 1.0),
+                                              row_with_a(-1.0, 2.0))));
+}
+
+TPTEST(ChangefeedFilters, DeterministicTransform) {
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t body = r.var(row_var)["a"] > 5;
+    change_filter_t filter(nullptr, range_filter(filter_transform(&body)));
+    EXPECT_TRUE(filter.evaluates_transforms());
+    // The row enters the selection.
+    EXPECT_TRUE(accepts(&filter, make_change(1.0, row_with_a(1.0, 1.0),
+                                             row_with_a(1.0, 7.0))));
+    // The row leaves the selection.
+    EXPECT_TRUE(accepts(&filter, make_change(1.0, row_with_a(1.0, 7.0),
+                                             row_with_a(1.0, 1.0))));
+    // The row changes inside the selection.
+    EXPECT_TRUE(accepts(&filter, make_change(1.0, row_with_a(1.0, 7.0),
+                                             row_with_a(1.0, 8.0))));
+    // The row stays outside of the selection.
+    EXPECT_FALSE(accepts(&filter, make_change(1.0, row_with_a(1.0, 1.0),
+                                              row_with_a(1.0, 2.0))));
+    EXPECT_FALSE(accepts(&filter, make_change(1.0, ql::datum_t(),
+                                              row_with_a(1.0, 2.0))));
+    // The transform doesn't matter outside of the range.
+    EXPECT_FALSE(accepts(&filter, make_change(20.0, row_with_a(20.0, 1.0),
+                                              row_with_a(20.0, 7.0))));
+}
+
+TPTEST(ChangefeedFilters, NonDeterministicTransform) {
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t body =
+        r.var(row_var)["a"] > r.expr(5.0).call(Term::RANDOM);
+    change_filter_t filter(nullptr, range_filter(filter_transform(&body)));
+    // Only the client evaluates the transform, so everything in the range passes.
+    EXPECT_FALSE(filter.evaluates_transforms());
+    EXPECT_TRUE(accepts(&filter, make_change(1.0, row_with_a(1.0, 1.0),
+                                             row_with_a(1.0, 2.0))));
+    EXPECT_FALSE(accepts(&filter, make_change(20.0, row_with_a(20.0, 1.0),
+                                              row_with_a(20.0, 7.0))));
+}
+
+TPTEST(ChangefeedFilters, Remove) {
+    change_filters_t filters;
+    changefeed_filter_t point = point_filter(5.0);
+    changefeed_filter_t range = range_filter({});
+    filters.add(nullptr, point);
+    filters.add(nullptr, range);
+    EXPECT_EQ(2u, filters.num_filters());
+    EXPECT_EQ(2u, filters.get_generation());
+
+    // Adding the same subscription again (e.g. when oversharded) does nothing.
+    filters.add(nullptr, point);
+    EXPECT_EQ(2u, filters.num_filters());
+    EXPECT_EQ(2u, filters.num_subs());
+    EXPECT_EQ(2u, filters.get_generation());
+
+    EXPECT_TRUE(filters.remove(point.sub).has());
+    EXPECT_EQ(1u, filters.num_filters());
+    EXPECT_EQ(1u, filters.num_subs());
+    // The subscription is gone, so removing it again does nothing.
+    EXPECT_FALSE(filters.remove(point.sub).has());
+    EXPECT_FALSE(filters.remove(generate_uuid()).has());
+    EXPECT_EQ(1u, filters.num_filters());
+
+    // A filter whose keepalive is held survives until the keepalive goes away.
+    std::vector<auto_drainer_t::lock_t> keepalives;
+    std::vector<change_filter_t *> remaining = filters.get_filters(&keepalives);
+    ASSERT_EQ(1u, remaining.size());
+    ASSERT_EQ(1u, keepalives.size());
+    EXPECT_TRUE(remaining[0]->accepts(
+        make_change(1.0, ql::datum_t(), row_with_a(1.0, 1.0)), keepalives[0]));
+    scoped_ptr_t<change_filter_t> removed = filters.remove(range.sub);
+    EXPECT_EQ(remaining[0], removed.get());
+    EXPECT_EQ(0u, filters.num_filters());
+    EXPECT_EQ(0u, filters.num_subs());
+    keepalives.clear();
+    removed.reset();
+}
+
+TPTEST(ChangefeedFilters, IdenticalFiltersAreShared) {
+    change_filters_t filters;
+    changefeed_filter_t a = point_filter(5.0), b = point_filter(5.0);
+    changefeed_filter_t c = range_filter({}), d = range_filter({});
+    for (const changefeed_filter_t *f : {&a, &b, &c, &d}) {
+        filters.add(nullptr, *f);
+    }
+    EXPECT_EQ(4u, filters.num_subs());
+    EXPECT_EQ(2u, filters.num_filters());
+    EXPECT_EQ(2u, filters.get_generation());
+
+    // Different specs get different filters.
+    changefeed_filter_t e = point_filter(6.0);
+    filters.add(nullptr, e);
+    EXPECT_EQ(3u, filters.num_filters());
+
+    // Transforms are evaluated in the subscription's environment, so the same
+    // transform with a different environment isn't shared.
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t body = r.var(row_var)["a"] > 5;
+    changefeed_filter_t f = range_filter(filter_transform(&body));
+    f.serializable_env.deterministic_time = ql::datum_t(0.0);
+    changefeed_filter_t g = f;
+    g.sub = generate_uuid();
+    g.serializable_env.deterministic_time = ql::datum_t(1.0);
+    filters.add(nullptr, f);
+    filters.add(nullptr, g);
+    EXPECT_EQ(5u, filters.num_filters());
+    EXPECT_EQ(7u, filters.num_subs());
+}
+
+TPTEST(ChangefeedFilters, SharedFilterRemovedWithLastSubscription) {
+    change_filters_t filters;
+    std::vector<changefeed_filter_t> subs;
+    for (size_t i = 0; i < 3; ++i) {
+        subs.push_back(point_filter(5.0));
+        filters.add(nullptr, subs.back());
+    }
+    changefeed_filter_t other = point_filter(6.0);
+    filters.add(nullptr, other);
+    EXPECT_EQ(2u, filters.num_filters());
+
+    // The filter stays as long as one of its subscriptions does.
+    EXPECT_FALSE(filters.remove(subs[1].sub).has());
+    EXPECT_FALSE(filters.remove(subs[0].sub).has());
+    EXPECT_EQ(2u, filters.num_filters());
+    EXPECT_EQ(2u, filters.num_subs());
+    msg_t::change_t change =
+        make_change(5.0, row_with_a(5.0, 1.0), row_with_a(5.0, 2.0));
+    EXPECT_TRUE(any_accepts(&filters, change));
+
+    EXPECT_TRUE(filters.remove(subs[2].sub).has());
+    EXPECT_EQ(1u, filters.num_filters());
+    EXPECT_EQ(1u, filters.num_subs());
+    EXPECT_FALSE(any_accepts(&filters, change));
+
+    // A new identical subscription gets a new filter.
+    subs.push_back(point_filter(5.0));
+    filters.add(nullptr, subs.back());
+    EXPECT_EQ(2u, filters.num_filters());
+    EXPECT_EQ(3u, filters.get_generation());
+}
+
+}  // namespace unittest
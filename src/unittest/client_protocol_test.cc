@@ -0,0 +1,315 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+
+#include "arch/timing.hpp"
+#include "client_protocol/protocols.hpp"
+#include "config/args.hpp"
+#include "containers/archive/scatter_gather_message.hpp"
+#include "containers/archive/string_stream.hpp"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/response.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+#include "utils.hpp"
+
+namespace unittest {
+
+std::string to_string(const write_message_t &wm) {
+    string_stream_t stream;
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    return stream.str();
+}
+
+std::string to_string(scatter_gather_message_t *msg) {
+    std::vector<iovec> iovecs;
+    msg->append_iovecs(&iovecs);
+    std::string res;
+    for (const iovec &vec : iovecs) {
+        res.append(static_cast<const char *>(vec.iov_base), vec.iov_len);
+    }
+    guarantee(res.size() == msg->size());
+    return res;
+}
+
+std::string to_json_string(const rapidjson::Value &value) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    value.Accept(writer);
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+// Serializes `datum` the way a client would, using the plain formats for arrays and
+// objects.
+void serialize_plain(write_message_t *wm, const ql::datum_t &datum) {
+    if (datum.get_type() == ql::datum_t::R_ARRAY) {
+        ql::datum_serialize_array_header(wm, datum.arr_size());
+        for (size_t i = 0; i < datum.arr_size(); ++i) {
+            serialize_plain(wm, datum.get(i));
+        }
+    } else if (datum.get_type() == ql::datum_t::R_OBJECT) {
+        ql::datum_serialize_object_header(wm, datum.obj_size());
+        for (size_t i = 0; i < datum.obj_size(); ++i) {
+            auto pair = datum.get_pair(i);
+            ql::datum_serialize(wm, pair.first);
+            serialize_plain(wm, pair.second);
+        }
+    } else {
+        ql::datum_serialize(wm, datum, ql::check_datum_serialization_errors_t::NO);
+    }
+}
+
+// A row as it comes out of the btree, backed by its serialized representation.
+ql::datum_t make_row(int i, size_t padding = 0) {
+    ql::datum_object_builder_t builder;
+    builder.overwrite("id", ql::datum_t(static_cast<double>(i)));
+    builder.overwrite("name", ql::datum_t(datum_string_t(
+        strprintf("user %d", i) + std::string(padding, ' '))));
+    builder.overwrite("score", ql::datum_t(i * 0.25));
+    builder.overwrite("tags", ql::datum_t(
+        std::vector<ql::datum_t>{ql::datum_t("a"), ql::datum_t("b"), ql::datum_t("c")},
+        ql::configured_limits_t::unlimited));
+    write_message_t wm;
+    ql::datum_serialize(&wm, std::move(builder).to_datum(),
+                        ql::check_datum_serialization_errors_t::NO);
+    string_read_stream_t stream(to_string(wm), 0);
+    ql::datum_t row;
+    guarantee_deserialization(ql::datum_deserialize(&stream, &row), "row");
+    return row;
+}
+
+std::vector<ql::datum_t> make_rows(int count, size_t padding = 0) {
+    std::vector<ql::datum_t> rows;
+    for (int i = 0; i < count; ++i) {
+        rows.push_back(make_row(i, padding));
+    }
+    return rows;
+}
+
+ql::datum_t decode_response(scatter_gather_message_t *msg) {
+    string_read_stream_t stream(to_string(msg), 0);
+    ql::datum_t response;
+    guarantee_deserialization(ql::datum_deserialize(&stream, &response), "response");
+    return response;
+}
+
+TEST(ClientProtocolTest, BinaryResponseMatchesJson) {
+    ql::response_t response;
+    response.set_type(Response::SUCCESS_PARTIAL);
+    response.set_data(make_rows(100));
+    response.add_note(Response::SEQUENCE_FEED);
+
+    scatter_gather_message_t msg;
+    ASSERT_TRUE(binary_protocol_t::write_response_to_message(response, &msg));
+    ql::datum_t binary_response = decode_response(&msg);
+
+    rapidjson::StringBuffer buffer;
+    json_protocol_t::write_response_to_buffer(&response, &buffer);
+    rapidjson::Document doc;
+    doc.Parse(buffer.GetString());
+    ASSERT_FALSE(doc.HasParseError());
+    ql::datum_t json_response = ql::to_datum(
+        doc, ql::configured_limits_t::unlimited, reql_version_t::LATEST);
+
+    EXPECT_EQ(json_response, binary_response);
+}
+
+TEST(ClientProtocolTest, BinaryResponseRejectsExtrema) {
+    ql::response_t response;
+    response.set_type(Response::SUCCESS_ATOM);
+    response.set_data(ql::datum_t(
+        std::vector<ql::datum_t>{ql::datum_t::minval()},
+        ql::configured_limits_t::unlimited));
+
+    scatter_gather_message_t msg;
+    EXPECT_FALSE(binary_protocol_t::write_response_to_message(response, &msg));
+}
+
+TEST(ClientProtocolTest, BinaryResponseReferencesLargeRows) {
+    // Small rows are copied, large ones are sent from the buffers they were read into.
+    std::vector<ql::datum_t> rows{make_row(0), make_row(1, 1000), make_row(2)};
+    ql::response_t response;
+    response.set_type(Response::SUCCESS_SEQUENCE);
+    response.set_data(std::vector<ql::datum_t>(rows));
+
+    scatter_gather_message_t msg;
+    ASSERT_TRUE(binary_protocol_t::write_response_to_message(response, &msg));
+    std::vector<iovec> iovecs;
+    msg.append_iovecs(&iovecs);
+    size_t referenced = 0;
+    for (const iovec &vec : iovecs) {
+        for (const auto &row : rows) {
+            if (vec.iov_base == row.get_buf_ref()->get()) {
+                EXPECT_LT(1000u, vec.iov_len);
+                ++referenced;
+            }
+        }
+    }
+    EXPECT_EQ(1u, referenced);
+
+    ql::datum_t binary_response = decode_response(&msg);
+    ql::datum_t data = binary_response.get_field("r");
+    ASSERT_EQ(rows.size(), data.arr_size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(rows[i], data.get(i));
+    }
+}
+
+TEST(ClientProtocolTest, BinaryQueryMatchesJson) {
+    // r.table("test").insert(rows)
+    const std::string json_query = strprintf(
+        "[1,[56,[[15,[\"test\"]],[2,[{\"id\":1,\"n\":-0.5,\"s\":\"x\"}]]]],"
+        "{\"db\":[14,[\"test\"]]}]");
+    rapidjson::Document json_doc;
+    json_doc.Parse(json_query.c_str());
+    ASSERT_FALSE(json_doc.HasParseError());
+
+    write_message_t wm;
+    serialize_plain(&wm, ql::to_datum(
+        json_doc, ql::configured_limits_t::unlimited, reql_version_t::LATEST));
+    const std::string binary_query = to_string(wm);
+
+    rapidjson::Document binary_doc;
+    ASSERT_EQ(archive_result_t::SUCCESS, ql::datum_deserialize_to_json(
+        binary_query.data(), binary_query.size(), &binary_doc));
+    EXPECT_EQ(to_json_string(json_doc), to_json_string(binary_doc));
+
+    // Integers must come out as integers for the term parser.
+    EXPECT_TRUE(binary_doc[0].IsInt());
+
+    // Trailing garbage and truncated queries are rejected.
+    rapidjson::Document bad_doc;
+    const std::string long_query = binary_query + '\0';
+    EXPECT_NE(archive_result_t::SUCCESS, ql::datum_deserialize_to_json(
+        long_query.data(), long_query.size(), &bad_doc));
+    EXPECT_NE(archive_result_t::SUCCESS, ql::datum_deserialize_to_json(
+        binary_query.data(), binary_query.size() - 1, &bad_doc));
+}
+
+TEST(ClientProtocolTest, BinaryQueryRejectsBufferBackedDatums) {
+    // `datum_serialize()` writes arrays with an offset table, which we don't accept
+    // from clients.
+    write_message_t wm;
+    ql::datum_serialize(&wm, ql::datum_t(
+        std::vector<ql::datum_t>{ql::datum_t(1.0)},
+        ql::configured_limits_t::unlimited),
+        ql::check_datum_serialization_errors_t::NO);
+    const std::string query = to_string(wm);
+    rapidjson::Document doc;
+    EXPECT_EQ(archive_result_t::RANGE_ERROR, ql::datum_deserialize_to_json(
+        query.data(), query.size(), &doc));
+}
+
+// This is not really a unit test, but a micro benchmark comparing the throughput of
+// the JSON and the binary client protocol. No need to run this in debug mode.
+#ifdef NDEBUG
+TPTEST(ClientProtocolTest, BinaryProtocolBenchmark) {
+    const int num_rows = 1000;
+    const int num_iterations = 200;
+
+    ql::response_t response;
+    response.set_type(Response::SUCCESS_PARTIAL);
+    response.set_data(make_rows(num_rows));
+
+    ticks_t start_ticks = get_ticks();
+    size_t json_size = 0;
+    for (int i = 0; i < num_iterations; ++i) {
+        rapidjson::StringBuffer buffer;
+        json_protocol_t::write_response_to_buffer(&response, &buffer);
+        json_size = buffer.GetSize();
+    }
+    double json_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    start_ticks = get_ticks();
+    size_t binary_size = 0;
+    for (int i = 0; i < num_iterations; ++i) {
+        scatter_gather_message_t msg;
+        guarantee(binary_protocol_t::write_response_to_message(response, &msg));
+        binary_size = msg.size();
+    }
+    double binary_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    printf("Responses: JSON %.0f rows/s (%zu bytes), binary %.0f rows/s (%zu bytes)\n",
+           num_rows * num_iterations / json_dur, json_size,
+           num_rows * num_iterations / binary_dur, binary_size);
+
+    // The same rows as the documents of an insert query.
+    write_message_t query_wm;
+    serialize_plain(&query_wm, ql::datum_t(std::vector<ql::datum_t>(response.data()),
+                                           ql::configured_limits_t::unlimited));
+    const std::string binary_query = to_string(query_wm);
+    rapidjson::StringBuffer json_query;
+    {
+        rapidjson::Writer<rapidjson::StringBuffer> writer(json_query);
+        writer.StartArray();
+        for (const auto &row : response.data()) {
+            row.write_json(&writer);
+        }
+        writer.EndArray();
+    }
+
+    start_ticks = get_ticks();
+    for (int i = 0; i < num_iterations; ++i) {
+        // Like `json_protocol_t`, parse a mutable copy of the query in place.
+        scoped_array_t<char> data(json_query.GetSize() + 1);
+        memcpy(data.data(), json_query.GetString(), json_query.GetSize() + 1);
+        rapidjson::Document doc;
+        doc.ParseInsitu(data.data());
+        guarantee(!doc.HasParseError());
+    }
+    json_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    start_ticks = get_ticks();
+    for (int i = 0; i < num_iterations; ++i) {
+        rapidjson::Document doc;
+        guarantee(!bad(ql::datum_deserialize_to_json(
+            binary_query.data(), binary_query.size(), &doc)));
+    }
+    binary_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    printf("Queries: JSON %.0f rows/s (%zu bytes), binary %.0f rows/s (%zu bytes)\n",
+           num_rows * num_iterations / json_dur, json_query.GetSize(),
+           num_rows * num_iterations / binary_dur, binary_query.size());
+
+    // Large rows, as returned by a `between()` over big documents, either copied into
+    // the message or referenced by it.
+    ql::response_t large_response;
+    large_response.set_type(Response::SUCCESS_PARTIAL);
+    large_response.set_data(make_rows(num_rows, 4000));
+
+    start_ticks = get_ticks();
+    size_t copied_size = 0;
+    for (int i = 0; i < num_iterations; ++i) {
+        write_message_t wm;
+        for (const auto &row : large_response.data()) {
+            ql::datum_serialize(&wm, row, ql::check_datum_serialization_errors_t::NO);
+        }
+        copied_size = wm.size();
+    }
+    double copied_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    start_ticks = get_ticks();
+    size_t referenced_size = 0;
+    for (int i = 0; i < num_iterations; ++i) {
+        scatter_gather_message_t msg;
+        guarantee(binary_protocol_t::write_response_to_message(large_response, &msg));
+        std::vector<iovec> iovecs;
+        msg.append_iovecs(&iovecs);
+        referenced_size = msg.size();
+    }
+    double referenced_dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    printf("Large responses: copied %.0f MB/s, referenced %.0f MB/s\n",
+           copied_size * num_iterations / copied_dur / MEGABYTE,
+           referenced_size * num_iterations / referenced_dur / MEGABYTE);
+}
+#endif  // NDEBUG
+
+}  // namespace unittest
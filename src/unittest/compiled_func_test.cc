@@ -0,0 +1,254 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "concurrency/cond_var.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/func.hpp"
+#include "rdb_protocol/minidriver.hpp"
+#include "rdb_protocol/term.hpp"
+#include "random.hpp"
+#include "time.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+const ql::sym_t row_var(1);
+
+// A one-argument function, together with its body so that we can evaluate it with
+// the interpreter as well.
+class test_func_t {
+public:
+    explicit test_func_t(ql::minidriver_t::reql_t _body_term)
+        : body_term(std::move(_body_term)) {
+        ql::compile_env_t compile_env(
+            ql::var_visibility_t().with_func_arg_name_list(make_vector(row_var)));
+        body = ql::compile_term(&compile_env, body_term.root_term());
+        func = make_counted<ql::reql_func_t>(
+            ql::var_scope_t(), make_vector(row_var), body);
+    }
+
+    // What `reql_func_t::call()` used to do.
+    ql::datum_t interpret(ql::env_t *env, ql::datum_t row) const {
+        ql::scope_env_t scope_env(
+            env,
+            ql::var_scope_t().with_func_arg_list(make_vector(row_var),
+                                                 make_vector(row)));
+        return body->eval(&scope_env)->as_datum();
+    }
+
+    ql::datum_t call(ql::env_t *env, ql::datum_t row) const {
+        return func->call(env, row)->as_datum();
+    }
+
+    ql::minidriver_t::reql_t body_term;
+    counted_t<const ql::term_t> body;
+    counted_t<const ql::func_t> func;
+};
+
+ql::datum_t random_value(rng_t *rng) {
+    switch (rng->randint(6)) {
+    case 0: return ql::datum_t(static_cast<double>(rng->randint(10)));
+    case 1: return ql::datum_t(rng->randdouble() * 10 - 5);
+    case 2: return ql::datum_t(rng->randint(2) == 0 ? "x" : "y");
+    case 3: return ql::datum_t::null();
+    case 4: return ql::datum_t::boolean(rng->randint(2) == 0);
+    case 5: return ql::datum_t(0.0);
+    default: unreachable();
+    }
+}
+
+ql::datum_t random_row(rng_t *rng) {
+    ql::datum_object_builder_t builder;
+    const char *fields[] = {"a", "b", "c"};
+    for (const char *field : fields) {
+        // Leave out some of the fields to exercise the non-existence errors.
+        if (rng->randint(8) != 0) {
+            builder.overwrite(field, random_value(rng));
+        }
+    }
+    return std::move(builder).to_datum();
+}
+
+// Evaluates `f` on `row` either way and records the result or the error.
+std::string describe_result(const test_func_t &f, ql::env_t *env, ql::datum_t row,
+                            bool compiled) {
+    try {
+        ql::datum_t res = compiled ? f.call(env, row) : f.interpret(env, row);
+        return res.print();
+    } catch (const ql::base_exc_t &e) {
+        return strprintf("error %d: %s", static_cast<int>(e.get_type()), e.what());
+    }
+}
+
+TPTEST(CompiledFunc, MatchesInterpreter) {
+    cond_t interruptor;
+    ql::env_t env(&interruptor,
+                  ql::return_empty_normal_batches_t::NO,
+                  reql_version_t::LATEST);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t row = r.var(row_var);
+
+    std::vector<test_func_t> funcs;
+    funcs.emplace_back((row["a"] > 5) && (row["b"] == "x"));
+    funcs.emplace_back(!(row["a"] + 1 <= row.bracket("c")));
+    funcs.emplace_back(row["a"] / row["c"]);
+    funcs.emplace_back(row["b"] + row["b"]);
+    funcs.emplace_back(row["a"].call(Term::LT, row["b"], row["c"]));
+    funcs.emplace_back(row["a"].call(Term::OR, row["b"], row["c"]));
+    funcs.emplace_back(row["a"].call(Term::SUB, 2.5).call(Term::MUL, row["c"]));
+    // `coerce_to` has to be evaluated by the interpreter.
+    funcs.emplace_back(row["a"].coerce_to("STRING") == "7");
+    funcs.emplace_back(row.bracket(0.0));
+    funcs.emplace_back(row);
+
+    rng_t rng(0);
+    for (int i = 0; i < 2000; ++i) {
+        ql::datum_t d = random_row(&rng);
+        for (size_t j = 0; j < funcs.size(); ++j) {
+            EXPECT_EQ(describe_result(funcs[j], &env, d, false),
+                      describe_result(funcs[j], &env, d, true))
+                << "function " << j << " on " << d.print();
+        }
+    }
+}
+
+// Applies `filter_batch()` or `map_batch()` to `rows` and records the result or the error.
+std::string describe_batch_result(const test_func_t &f, ql::env_t *env,
+                                  std::vector<ql::datum_t> rows, bool filter) {
+    try {
+        if (filter) {
+            f.func->filter_batch(env, &rows, counted_t<const ql::func_t>());
+        } else {
+            f.func->map_batch(env, &rows);
+        }
+        return ql::datum_t(std::move(rows), env->limits()).print();
+    } catch (const ql::base_exc_t &e) {
+        return strprintf("error %d: %s", static_cast<int>(e.get_type()), e.what());
+    }
+}
+
+// The same, but calling `filter_call()` or `call()` on each row in turn.
+std::string describe_row_by_row_result(const test_func_t &f, ql::env_t *env,
+                                       const std::vector<ql::datum_t> &rows,
+                                       bool filter) {
+    try {
+        std::vector<ql::datum_t> res;
+        for (const ql::datum_t &row : rows) {
+            if (!filter) {
+                res.push_back(f.call(env, row));
+            } else if (f.func->filter_call(env, row, counted_t<const ql::func_t>())) {
+                res.push_back(row);
+            }
+        }
+        return ql::datum_t(std::move(res), env->limits()).print();
+    } catch (const ql::base_exc_t &e) {
+        return strprintf("error %d: %s", static_cast<int>(e.get_type()), e.what());
+    }
+}
+
+TPTEST(CompiledFunc, BatchMatchesRowByRow) {
+    cond_t interruptor;
+    ql::env_t env(&interruptor,
+                  ql::return_empty_normal_batches_t::NO,
+                  reql_version_t::LATEST);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t row = r.var(row_var);
+
+    std::vector<test_func_t> funcs;
+    funcs.emplace_back((row["a"] > 5) && (row["b"] == "x"));
+    funcs.emplace_back(row["a"].call(Term::LT, row["b"], row["c"]));
+    funcs.emplace_back(row["a"].call(Term::OR, row["b"], row["c"]));
+    funcs.emplace_back(!(row["a"] + 1 <= row.bracket("c")));
+    funcs.emplace_back(row["a"].call(Term::SUB, 2.5).call(Term::MUL, row["c"]));
+    funcs.emplace_back(row["a"].coerce_to("STRING") == "7");
+    funcs.emplace_back(row["a"] == row["c"]);
+
+    rng_t rng(0);
+    for (int i = 0; i < 500; ++i) {
+        // Mostly rows without missing fields, so that batches don't always fail.
+        std::vector<ql::datum_t> rows;
+        size_t num_rows = rng.randint(40);
+        for (size_t j = 0; j < num_rows; ++j) {
+            rows.push_back(rng.randint(20) == 0
+                ? random_row(&rng)
+                : ql::datum_t(std::map<datum_string_t, ql::datum_t>{
+                      {datum_string_t("a"), random_value(&rng)},
+                      {datum_string_t("b"), random_value(&rng)},
+                      {datum_string_t("c"), random_value(&rng)}}));
+        }
+        for (size_t j = 0; j < funcs.size(); ++j) {
+            for (bool filter : {true, false}) {
+                EXPECT_EQ(describe_row_by_row_result(funcs[j], &env, rows, filter),
+                          describe_batch_result(funcs[j], &env, rows, filter))
+                    << "function " << j << (filter ? " in filter" : " in map");
+            }
+        }
+    }
+}
+
+// This is not really a unit test, but a micro benchmark of the filter throughput of an
+// interpreted and a compiled row predicate. No need to run this in debug mode.
+#ifdef NDEBUG
+TPTEST(CompiledFunc, FilterBenchmark) {
+    const int NUM_ROWS = 1000000;
+
+    cond_t interruptor;
+    ql::env_t env(&interruptor,
+                  ql::return_empty_normal_batches_t::NO,
+                  reql_version_t::LATEST);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    ql::minidriver_t::reql_t row = r.var(row_var);
+    test_func_t f((row["a"] > 5) && (row["b"] == "x"));
+
+    rng_t rng(0);
+    std::vector<ql::datum_t> table;
+    table.reserve(NUM_ROWS);
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        ql::datum_object_builder_t builder;
+        builder.overwrite("id", ql::datum_t(static_cast<double>(i)));
+        builder.overwrite("a", ql::datum_t(static_cast<double>(rng.randint(10))));
+        builder.overwrite("b", ql::datum_t(rng.randint(2) == 0 ? "x" : "y"));
+        builder.overwrite("payload", ql::datum_t(std::string(100, 'p')));
+        table.push_back(std::move(builder).to_datum());
+    }
+
+    int matched_interpreted = 0;
+    ticks_t start_ticks = get_ticks();
+    for (const ql::datum_t &d : table) {
+        matched_interpreted += f.interpret(&env, d).as_bool();
+    }
+    double dur_interpreted = ticks_to_secs(get_ticks() - start_ticks);
+
+    int matched_compiled = 0;
+    start_ticks = get_ticks();
+    for (const ql::datum_t &d : table) {
+        matched_compiled += f.func->filter_call(&env, d, counted_t<const ql::func_t>());
+    }
+    double dur_compiled = ticks_to_secs(get_ticks() - start_ticks);
+    EXPECT_EQ(matched_interpreted, matched_compiled);
+
+    // In batches of the size that datum streams usually read.
+    const size_t BATCH_SIZE = 1000;
+    size_t matched_batched = 0;
+    start_ticks = get_ticks();
+    for (size_t i = 0; i < table.size(); i += BATCH_SIZE) {
+        std::vector<ql::datum_t> batch(
+            table.begin() + i, table.begin() + std::min(i + BATCH_SIZE, table.size()));
+        f.func->filter_batch(&env, &batch, counted_t<const ql::func_t>());
+        matched_batched += batch.size();
+    }
+    double dur_batched = ticks_to_secs(get_ticks() - start_ticks);
+    EXPECT_EQ(static_cast<size_t>(matched_interpreted), matched_batched);
+
+    printf("filter on %d rows: interpreted %.0f rows/s, compiled %.0f rows/s, "
+           "batched %.0f rows/s\n",
+           NUM_ROWS, NUM_ROWS / dur_interpreted, NUM_ROWS / dur_compiled,
+           NUM_ROWS / dur_batched);
+}
+#endif
+
+}  // namespace unittest
@@ -2,7 +2,9 @@
 
 #include "arch/runtime/coroutines.hpp"
 #include "arch/runtime/runtime.hpp"
+#include "arch/timing.hpp"
 #include "concurrency/auto_drainer.hpp"
+#include "concurrency/pmap.hpp"
 #include "config/args.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/unittest_utils.hpp"
@@ -106,6 +108,86 @@ TEST(CoroutinesTest, NotifyNow) {
     });
 }
 
+TEST(CoroutinesTest, StackSizes) {
+    run_in_thread_pool([&]() {
+        coro_t::spawn_now_dangerously([&]() {
+            EXPECT_TRUE(has_n_bytes_free_stack_space(COROUTINE_SMALL_STACK_SIZE / 2));
+            EXPECT_FALSE(has_n_bytes_free_stack_space(COROUTINE_SMALL_STACK_SIZE));
+        }, coro_stack_size_t::SMALL);
+        coro_t::spawn_now_dangerously([&]() {
+            EXPECT_TRUE(has_n_bytes_free_stack_space(COROUTINE_STACK_SIZE / 2));
+            EXPECT_FALSE(has_n_bytes_free_stack_space(COROUTINE_STACK_SIZE));
+        });
+        coro_t::spawn_now_dangerously([&]() {
+            EXPECT_TRUE(has_n_bytes_free_stack_space(COROUTINE_LARGE_STACK_SIZE / 2));
+            EXPECT_FALSE(has_n_bytes_free_stack_space(COROUTINE_LARGE_STACK_SIZE));
+        }, coro_stack_size_t::LARGE);
+    });
+}
+
+TEST(CoroutinesTest, StackReuse) {
+    // Finished coroutines go back to a free list for their stack size, and the most
+    // recently finished one gets reused first.
+    run_in_thread_pool([&]() {
+        coro_t *small = nullptr;
+        coro_t *large = nullptr;
+        coro_t::spawn_now_dangerously([&]() { small = coro_t::self(); },
+                                      coro_stack_size_t::SMALL);
+        coro_t::spawn_now_dangerously([&]() { large = coro_t::self(); },
+                                      coro_stack_size_t::LARGE);
+        coro_t::yield();
+        coro_t::spawn_now_dangerously([&]() {
+            EXPECT_EQ(large, coro_t::self());
+        }, coro_stack_size_t::LARGE);
+        coro_t::spawn_now_dangerously([&]() {
+            EXPECT_EQ(small, coro_t::self());
+        }, coro_stack_size_t::SMALL);
+    });
+}
+
+TEST(CoroutinesTest, StackMemoryRelease) {
+    // More finished coroutines than the free list keeps the memory of. Each of them
+    // finishes with data on its stack, and goes on running on that stack after it
+    // has been put on the free list.
+    run_in_thread_pool([&]() {
+        const int num_coros = 64;
+        cond_t done;
+        int num_running = num_coros;
+        for (int i = 0; i < num_coros; ++i) {
+            coro_t::spawn_sometime([&, i]() {
+                char data[COROUTINE_LARGE_STACK_SIZE / 4];
+                memset(data, i, sizeof(data));
+                coro_t::yield();
+                for (size_t j = 0; j < sizeof(data); ++j) {
+                    ASSERT_EQ(static_cast<char>(i), data[j]);
+                }
+                --num_running;
+                if (num_running == 0) {
+                    done.pulse();
+                }
+            }, coro_stack_size_t::LARGE);
+        }
+        done.wait_lazily_unordered();
+
+        // The free stacks can be used again, even the ones without memory.
+        num_running = num_coros;
+        cond_t done_again;
+        for (int i = 0; i < num_coros; ++i) {
+            coro_t::spawn_sometime([&]() {
+                char data[COROUTINE_LARGE_STACK_SIZE / 4];
+                memset(data, 1, sizeof(data));
+                coro_t::yield();
+                EXPECT_EQ(1, data[sizeof(data) - 1]);
+                --num_running;
+                if (num_running == 0) {
+                    done_again.pulse();
+                }
+            }, coro_stack_size_t::LARGE);
+        }
+        done_again.wait_lazily_unordered();
+    });
+}
+
 // The following test does not work on 32 bit architectures because it will exceed
 // their virtual memory.
 #if defined (__x86_64__) || defined (_WIN64)
@@ -130,4 +212,46 @@ TEST(CoroutinesTest, LotsOfCoroutines) {
 }
 #endif
 
+// This is not really a unit test, but a micro benchmark of the throughput of
+// cross-thread messages. Every `on_thread_t` sends one message to the other thread
+// and one back. No need to run this in debug mode.
+#ifdef NDEBUG
+void run_cross_thread_benchmark(
+        const char *name,
+        int num_threads,
+        const std::function<threadnum_t(int, int)> &destination) {
+    const int coros_per_thread = 16;
+    const int hops_per_coro = 20000;
+    run_in_thread_pool([&]() {
+        ticks_t start_ticks = get_ticks();
+        pmap(num_threads, [&](int t) {
+            on_thread_t thread_switcher((threadnum_t(t)));
+            pmap(coros_per_thread, [&](int) {
+                for (int i = 0; i < hops_per_coro; ++i) {
+                    on_thread_t hop(destination(t, i));
+                }
+            });
+        });
+        double dur = ticks_to_secs(get_ticks() - start_ticks);
+        double num_messages = 2.0 * num_threads * coros_per_thread * hops_per_coro;
+        printf("%s, %d threads: %.0f messages/s\n",
+               name, num_threads, num_messages / dur);
+    }, num_threads);
+}
+
+TEST(CoroutinesTest, CrossThreadMessageBenchmark) {
+    for (int num_threads : {2, 8, 32}) {
+        // Every thread sends to all the other threads in turn.
+        run_cross_thread_benchmark("All to all", num_threads, [&](int t, int i) {
+            return threadnum_t((t + 1 + i % (num_threads - 1)) % num_threads);
+        });
+        // Every thread sends to thread 0, which is where contention on a single
+        // message hub is the highest.
+        run_cross_thread_benchmark("All to one", num_threads, [&](int, int) {
+            return threadnum_t(0);
+        });
+    }
+}
+#endif  // NDEBUG
+
 }   /* namespace unittest */
@@ -1,9 +1,14 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
 
+#include <map>
+
 #include "containers/archive/string_stream.hpp"
+#include "random.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/datum_string.hpp"
 #include "rdb_protocol/env.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+#include "time.hpp"
 #include "unittest/gtest.hpp"
 
 
@@ -205,4 +210,205 @@ TEST(DatumTest, OffsetScaling) {
     }
 }
 
+ql::datum_t serialize_and_deserialize(const ql::datum_t &datum) {
+    string_stream_t write_stream;
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, datum);
+    int write_res = send_write_message(&write_stream, &wm);
+    guarantee(write_res == 0);
+
+    string_read_stream_t read_stream(std::move(write_stream.str()), 0);
+    ql::datum_t res;
+    archive_result_t deser_res
+        = deserialize<cluster_version_t::LATEST_OVERALL>(&read_stream, &res);
+    guarantee(deser_res == archive_result_t::SUCCESS);
+    return res;
+}
+
+TEST(DatumTest, BufferBackedFieldAccess) {
+    std::map<datum_string_t, ql::datum_t> fields;
+    for (int i = 0; i < 100; i += 2) {
+        fields[datum_string_t(strprintf("field%03d", i))] =
+            ql::datum_t(static_cast<double>(i));
+    }
+    fields[datum_string_t("nested")] = ql::datum_t(std::map<datum_string_t, ql::datum_t>
+        {std::make_pair(datum_string_t("a"), ql::datum_t("x"))});
+    const ql::datum_t object(std::move(fields));
+
+    const ql::datum_t buf_object = serialize_and_deserialize(object);
+    ASSERT_TRUE(buf_object.get_buf_ref() != NULL);
+
+    for (int i = 0; i < 101; ++i) {
+        datum_string_t key(strprintf("field%03d", i));
+        ASSERT_EQ(object.get_field(key, ql::NOTHROW).has(),
+                  buf_object.get_field(key, ql::NOTHROW).has());
+        if (i % 2 == 0) {
+            ASSERT_EQ(object.get_field(key), buf_object.get_field(key));
+        }
+    }
+    ASSERT_FALSE(buf_object.get_field("a", ql::NOTHROW).has());
+    ASSERT_FALSE(buf_object.get_field("zzz", ql::NOTHROW).has());
+
+    // Nested objects are accessed in place as well.
+    ql::datum_t nested = buf_object.get_field("nested");
+    ASSERT_TRUE(nested.get_buf_ref() != NULL);
+    ASSERT_EQ(ql::datum_t("x"), nested.get_field("a"));
+
+    // Two copies of the same serialization compare equal, different ones compare
+    // like the in-memory objects do.
+    ASSERT_EQ(0, buf_object.cmp(serialize_and_deserialize(object)));
+    ql::datum_object_builder_t builder(object);
+    builder.overwrite("field050", ql::datum_t(-1.0));
+    const ql::datum_t changed = std::move(builder).to_datum();
+    ASSERT_EQ(object.cmp(changed), buf_object.cmp(serialize_and_deserialize(changed)));
+    ASSERT_EQ(changed.cmp(object), serialize_and_deserialize(changed).cmp(buf_object));
+}
+
+ql::datum_t make_wide_object(size_t num_fields) {
+    std::map<datum_string_t, ql::datum_t> fields;
+    for (size_t i = 0; i < num_fields; ++i) {
+        fields[datum_string_t(strprintf("field%zu", i))] =
+            ql::datum_t(static_cast<double>(i));
+    }
+    return ql::datum_t(std::move(fields));
+}
+
+// Turns on the field index for as long as it exists.
+class field_index_enabler_t {
+public:
+    field_index_enabler_t() { ql::set_datum_field_index_enabled(true); }
+    ~field_index_enabler_t() { ql::set_datum_field_index_enabled(false); }
+};
+
+std::string serialize_to_string(const ql::datum_t &datum) {
+    string_stream_t write_stream;
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, datum);
+    int write_res = send_write_message(&write_stream, &wm);
+    guarantee(write_res == 0);
+    return std::move(write_stream.str());
+}
+
+// Serializes `datum`, which must be an object with a field index, and reads it back as
+// a plain BUF_R_OBJECT. That format is the same apart from the index at the end, which
+// then doesn't get used.
+ql::datum_t deserialize_without_field_index(const ql::datum_t &datum) {
+    std::string serialized = serialize_to_string(datum);
+    guarantee(serialized[0] == 15);  // BUF_R_OBJECT_INDEXED
+    serialized[0] = 11;  // BUF_R_OBJECT
+
+    string_read_stream_t read_stream(std::move(serialized), 0);
+    ql::datum_t res;
+    archive_result_t deser_res
+        = deserialize<cluster_version_t::LATEST_OVERALL>(&read_stream, &res);
+    guarantee(deser_res == archive_result_t::SUCCESS);
+    return res;
+}
+
+TEST(DatumTest, FieldIndex) {
+    field_index_enabler_t field_index_enabler;
+    // Small objects don't get an index.
+    ASSERT_FALSE(serialize_and_deserialize(make_wide_object(10))
+                 .buf_ref_has_field_index());
+
+    for (size_t num_fields : {64, 100, 1000}) {
+        const ql::datum_t object = make_wide_object(num_fields);
+        test_datum_serialization(object);
+
+        const ql::datum_t indexed = serialize_and_deserialize(object);
+        ASSERT_TRUE(indexed.buf_ref_has_field_index());
+        ASSERT_EQ(num_fields, indexed.obj_size());
+        for (size_t i = 0; i < num_fields + 10; ++i) {
+            datum_string_t key(strprintf("field%zu", i));
+            ASSERT_EQ(i < num_fields, indexed.get_field(key, ql::NOTHROW).has());
+            if (i < num_fields) {
+                ASSERT_EQ(ql::datum_t(static_cast<double>(i)), indexed.get_field(key));
+            }
+        }
+        ASSERT_FALSE(indexed.get_field("", ql::NOTHROW).has());
+
+        // The index is just skipped by readers that don't know about it.
+        const ql::datum_t plain = deserialize_without_field_index(object);
+        ASSERT_FALSE(plain.buf_ref_has_field_index());
+        ASSERT_EQ(object, plain);
+        ASSERT_EQ(object.get_field("field7"), plain.get_field("field7"));
+
+        // Nested in another object
+        ql::datum_t outer(std::map<datum_string_t, ql::datum_t>
+            {std::make_pair(datum_string_t("inner"), object)});
+        const ql::datum_t nested = serialize_and_deserialize(outer).get_field("inner");
+        ASSERT_TRUE(nested.buf_ref_has_field_index());
+        ASSERT_EQ(object, nested);
+    }
+}
+
+TEST(DatumTest, FieldIndexDisabled) {
+    // Without the option, even wide objects are written as plain BUF_R_OBJECTs.
+    ASSERT_FALSE(ql::datum_field_index_enabled());
+    const ql::datum_t object = make_wide_object(100);
+    ASSERT_EQ(11, serialize_to_string(object)[0]);  // BUF_R_OBJECT
+    ASSERT_FALSE(serialize_and_deserialize(object).buf_ref_has_field_index());
+
+    // Objects that were written with an index while it was turned on can still be
+    // read, but they get written without it.
+    ql::datum_t indexed;
+    {
+        field_index_enabler_t field_index_enabler;
+        indexed = serialize_and_deserialize(object);
+    }
+    ASSERT_TRUE(indexed.buf_ref_has_field_index());
+    ASSERT_EQ(object, indexed);
+    ASSERT_EQ(ql::datum_t(7.0), indexed.get_field("field7"));
+    ASSERT_EQ(serialize_to_string(object), serialize_to_string(indexed));
+    const ql::datum_t rewritten = serialize_and_deserialize(indexed);
+    ASSERT_FALSE(rewritten.buf_ref_has_field_index());
+    ASSERT_EQ(object, rewritten);
+
+    write_message_t wm;
+    shared_buf_ref_t<char> body;
+    size_t body_size;
+    ASSERT_FALSE(ql::datum_serialize_by_reference(&wm, indexed, 0, &body, &body_size));
+    ASSERT_TRUE(ql::datum_serialize_by_reference(&wm, rewritten, 0, &body, &body_size));
+}
+
+// This is not really a unit test, but a micro benchmark of random field access on a
+// wide document with and without its field index. No need to run this in debug mode.
+#ifdef NDEBUG
+TEST(DatumTest, FieldIndexBenchmark) {
+    const size_t NUM_FIELDS = 10000;
+    const int NUM_LOOKUPS = 1000000;
+
+    field_index_enabler_t field_index_enabler;
+    const ql::datum_t object = make_wide_object(NUM_FIELDS);
+    const ql::datum_t indexed = serialize_and_deserialize(object);
+    const ql::datum_t plain = deserialize_without_field_index(object);
+
+    rng_t rng(0);
+    std::vector<datum_string_t> keys;
+    keys.reserve(NUM_LOOKUPS);
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        keys.push_back(datum_string_t(strprintf("field%d", rng.randint(NUM_FIELDS))));
+    }
+
+    double sum_plain = 0;
+    ticks_t start_ticks = get_ticks();
+    for (const datum_string_t &key : keys) {
+        sum_plain += plain.get_field(key).as_num();
+    }
+    double dur_plain = ticks_to_secs(get_ticks() - start_ticks);
+
+    double sum_indexed = 0;
+    start_ticks = get_ticks();
+    for (const datum_string_t &key : keys) {
+        sum_indexed += indexed.get_field(key).as_num();
+    }
+    double dur_indexed = ticks_to_secs(get_ticks() - start_ticks);
+    ASSERT_EQ(sum_plain, sum_indexed);
+
+    printf("get_field on %zu fields: binary search %.0f lookups/s, "
+           "field index %.0f lookups/s\n",
+           NUM_FIELDS, NUM_LOOKUPS / dur_plain, NUM_LOOKUPS / dur_indexed);
+}
+#endif
+
 }  // namespace unittest
@@ -48,6 +48,115 @@ TEST(DBMTest, ReadAheadInterval) {
     ASSERT_EQ(100, end_offset);
 }
 
+struct test_extent_t {
+    uint32_t garbage_bytes;
+    microtime_t data_timestamp;
+};
 
+const uint64_t TEST_EXTENT_SIZE = 1000;
+const microtime_t SECOND_MICROS = 1000000;
+
+// Like `gc_entry_less_t`, with `now` in the role of `gc_priority_time`.
+microtime_t test_gc_priority_time;
+
+struct test_extent_less_t {
+    bool operator()(const test_extent_t *x, const test_extent_t *y) {
+        return gc_extent_priority(x->garbage_bytes, TEST_EXTENT_SIZE,
+                                  x->data_timestamp, test_gc_priority_time)
+            < gc_extent_priority(y->garbage_bytes, TEST_EXTENT_SIZE,
+                                 y->data_timestamp, test_gc_priority_time);
+    }
+};
+
+TEST(DBMTest, GCPriority) {
+    const microtime_t now = 1000 * SECOND_MICROS;
+    // More garbage comes first.
+    EXPECT_GT(gc_extent_priority(600, TEST_EXTENT_SIZE, now - SECOND_MICROS, now),
+              gc_extent_priority(300, TEST_EXTENT_SIZE, now - SECOND_MICROS, now));
+    // Older data comes first.
+    EXPECT_GT(gc_extent_priority(300, TEST_EXTENT_SIZE, now - 2 * SECOND_MICROS, now),
+              gc_extent_priority(300, TEST_EXTENT_SIZE, now - SECOND_MICROS, now));
+    // Data from the future (after a clock change) counts as new.
+    EXPECT_EQ(gc_extent_priority(300, TEST_EXTENT_SIZE, now, now),
+              gc_extent_priority(300, TEST_EXTENT_SIZE, now + SECOND_MICROS, now));
+    // An extent without any live data is always worth GCing.
+    EXPECT_GT(gc_extent_priority(TEST_EXTENT_SIZE, TEST_EXTENT_SIZE, now, now), 0.0);
+}
+
+TEST(DBMTest, GCPriorityOrderAcrossRefresh) {
+    test_gc_priority_time = 1000 * SECOND_MICROS;
+    // `old_extent` has less garbage, but its data is much older.
+    test_extent_t young_extent{600, test_gc_priority_time - SECOND_MICROS};
+    test_extent_t old_extent{300, test_gc_priority_time - 10 * SECOND_MICROS};
+    test_extent_t new_extent{100, test_gc_priority_time};
+
+    priority_queue_t<test_extent_t *, test_extent_less_t> pq;
+    pq.push(&young_extent);
+    pq.push(&old_extent);
+    pq.push(&new_extent);
+    pq.validate();
+    EXPECT_EQ(&old_extent, pq.peak());
+
+    // As both extents get older, the difference in their age matters less, so
+    // the one with more garbage overtakes the other once the priorities are
+    // refreshed.
+    test_gc_priority_time += 100 * SECOND_MICROS;
+    pq.rebuild();
+    pq.validate();
+    EXPECT_EQ(&young_extent, pq.pop());
+    EXPECT_EQ(&old_extent, pq.pop());
+    EXPECT_EQ(&new_extent, pq.pop());
+}
+
+const double READ_SECS = 0.001;
+
+TEST(DBMTest, GCRateControllerBacksOffAndRecovers) {
+    gc_rate_controller_t controller;
+    EXPECT_EQ(1.0, controller.throttle());
+
+    // Without a baseline, the controller doesn't back off.
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(controller.record_read_latency(10 * READ_SECS, true));
+    }
+    EXPECT_EQ(1.0, controller.throttle());
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(controller.record_read_latency(READ_SECS, false));
+    }
+
+    // The GC makes reads much slower, so the controller backs off, but not all
+    // the way to zero.
+    bool backed_off = false;
+    for (int i = 0; i < 200; ++i) {
+        backed_off |= controller.record_read_latency(5 * READ_SECS, true);
+    }
+    EXPECT_TRUE(backed_off);
+    const double min_throttle = controller.throttle();
+    EXPECT_LT(min_throttle, 0.1);
+    EXPECT_GT(min_throttle, 0.0);
+
+    // Once reads are fast again, it recovers.
+    for (int i = 0; i < 1000; ++i) {
+        controller.record_read_latency(READ_SECS, true);
+    }
+    EXPECT_EQ(1.0, controller.throttle());
+}
+
+TEST(DBMTest, GCRateControllerBaselineFollowsWorkload) {
+    gc_rate_controller_t controller;
+    for (int i = 0; i < 100; ++i) {
+        controller.record_read_latency(READ_SECS, false);
+    }
+
+    // The reads get slower for a reason that has nothing to do with the GC, while
+    // the GC keeps running.  The controller first blames the GC, but its baseline
+    // catches up and it recovers.
+    bool backed_off = false;
+    for (int i = 0; i < 10000; ++i) {
+        backed_off |= controller.record_read_latency(3 * READ_SECS, true);
+    }
+    EXPECT_TRUE(backed_off);
+    EXPECT_EQ(1.0, controller.throttle());
+}
 
 }  // namespace unittest
@@ -0,0 +1,170 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <algorithm>
+#include <vector>
+
+#include "arch/io/disk.hpp"
+#include "arch/io/disk/uring.hpp"
+#include "concurrency/cond_var.hpp"
+#include "concurrency/pmap.hpp"
+#include "containers/scoped.hpp"
+#include "random.hpp"
+#include "time.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+const int64_t BLOCK_SIZE = 4 * KILOBYTE;
+
+struct io_waiter_t : public iocallback_t, public cond_t {
+    void on_io_complete() {
+        pulse();
+    }
+};
+
+void open_test_file(const temp_file_t &temp_file, io_backender_t *backender,
+                    scoped_ptr_t<file_t> *file_out) {
+    file_open_result_t res = open_file(temp_file.name().permanent_path().c_str(),
+                                       linux_file_t::mode_read
+                                       | linux_file_t::mode_write
+                                       | linux_file_t::mode_create
+                                       | linux_file_t::mode_truncate,
+                                       backender, file_out);
+    ASSERT_NE(file_open_result_t::ERROR, res.outcome);
+}
+
+// Fills the first `num_blocks` blocks of `file` with blocks whose bytes are all
+// equal to the block's index modulo 256. The first write is wrapped in datasyncs, to
+// also cover that code path.
+void fill_test_file(file_t *file, int64_t num_blocks) {
+    file->set_file_size_at_least(num_blocks * BLOCK_SIZE);
+    scoped_device_block_aligned_ptr_t<char> buf(BLOCK_SIZE);
+    for (int64_t i = 0; i < num_blocks; ++i) {
+        memset(buf.get(), static_cast<char>(i % 256), BLOCK_SIZE);
+        io_waiter_t waiter;
+        file->write_async(i * BLOCK_SIZE, BLOCK_SIZE, buf.get(), DEFAULT_DISK_ACCOUNT,
+                          &waiter,
+                          i == 0 ? file_t::WRAP_IN_DATASYNCS : file_t::NO_DATASYNCS);
+        waiter.wait();
+    }
+}
+
+void run_read_write_test(file_io_backend_t io_backend) {
+    const int64_t num_blocks = 64;
+    io_backender_t backender(file_direct_io_mode_t::buffered_desired,
+                             DEFAULT_MAX_CONCURRENT_IO_REQUESTS, io_backend);
+    temp_file_t temp_file;
+    scoped_ptr_t<file_t> file;
+    open_test_file(temp_file, &backender, &file);
+    fill_test_file(file.get(), num_blocks);
+
+    // Read the blocks back concurrently, so several requests are in flight at once.
+    pmap(num_blocks, [&](int64_t i) {
+        scoped_device_block_aligned_ptr_t<char> buf(BLOCK_SIZE);
+        io_waiter_t waiter;
+        file->read_async(i * BLOCK_SIZE, BLOCK_SIZE, buf.get(), DEFAULT_DISK_ACCOUNT,
+                         &waiter);
+        waiter.wait();
+        for (int64_t j = 0; j < BLOCK_SIZE; ++j) {
+            ASSERT_EQ(static_cast<char>(i % 256), buf.get()[j]);
+        }
+    });
+
+    // Vectored writes go through a different code path in both backends.
+    scoped_device_block_aligned_ptr_t<char> first(BLOCK_SIZE);
+    scoped_device_block_aligned_ptr_t<char> second(BLOCK_SIZE);
+    memset(first.get(), 'a', BLOCK_SIZE);
+    memset(second.get(), 'b', BLOCK_SIZE);
+    scoped_array_t<iovec> iovecs(2);
+    iovecs[0].iov_base = first.get();
+    iovecs[0].iov_len = BLOCK_SIZE;
+    iovecs[1].iov_base = second.get();
+    iovecs[1].iov_len = BLOCK_SIZE;
+    {
+        io_waiter_t waiter;
+        file->writev_async(0, 2 * BLOCK_SIZE, std::move(iovecs), DEFAULT_DISK_ACCOUNT,
+                           &waiter);
+        waiter.wait();
+    }
+    scoped_device_block_aligned_ptr_t<char> buf(2 * BLOCK_SIZE);
+    {
+        io_waiter_t waiter;
+        file->read_async(0, 2 * BLOCK_SIZE, buf.get(), DEFAULT_DISK_ACCOUNT, &waiter);
+        waiter.wait();
+    }
+    ASSERT_EQ('a', buf.get()[0]);
+    ASSERT_EQ('a', buf.get()[BLOCK_SIZE - 1]);
+    ASSERT_EQ('b', buf.get()[BLOCK_SIZE]);
+    ASSERT_EQ('b', buf.get()[2 * BLOCK_SIZE - 1]);
+}
+
+TPTEST(DiskIoBackend, PoolReadWrite) {
+    run_read_write_test(file_io_backend_t::pool);
+}
+
+TPTEST(DiskIoBackend, UringReadWrite) {
+    // Falls back to the pool backend if the kernel doesn't support io_uring, in
+    // which case this test is the same as the one above.
+    run_read_write_test(file_io_backend_t::uring_desired);
+}
+
+// This is not really a unit test, but a micro benchmark comparing random 4K read
+// IOPS and latency of the two disk backends. No need to run this in debug mode.
+#ifdef NDEBUG
+void run_random_read_benchmark(file_io_backend_t io_backend, const char *name) {
+    const int64_t num_blocks = 16384;  // 64 MB
+    const int concurrency = DEFAULT_MAX_CONCURRENT_IO_REQUESTS;
+    const int reads_per_coro = 2000;
+
+    io_backender_t backender(file_direct_io_mode_t::direct_desired,
+                             DEFAULT_MAX_CONCURRENT_IO_REQUESTS, io_backend);
+    temp_file_t temp_file;
+    scoped_ptr_t<file_t> file;
+    open_test_file(temp_file, &backender, &file);
+    fill_test_file(file.get(), num_blocks);
+
+    std::vector<std::vector<ticks_t> > latencies(concurrency);
+    ticks_t start_ticks = get_ticks();
+    pmap(concurrency, [&](int c) {
+        rng_t rng(c);
+        scoped_device_block_aligned_ptr_t<char> buf(BLOCK_SIZE);
+        latencies[c].reserve(reads_per_coro);
+        for (int i = 0; i < reads_per_coro; ++i) {
+            int64_t block = rng.randuint64(num_blocks);
+            ticks_t read_start = get_ticks();
+            io_waiter_t waiter;
+            file->read_async(block * BLOCK_SIZE, BLOCK_SIZE, buf.get(),
+                             DEFAULT_DISK_ACCOUNT, &waiter);
+            waiter.wait();
+            latencies[c].push_back(get_ticks() - read_start);
+        }
+    });
+    double dur = ticks_to_secs(get_ticks() - start_ticks);
+
+    std::vector<ticks_t> all;
+    for (const auto &l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+    ticks_t sum = 0;
+    for (ticks_t t : all) {
+        sum += t;
+    }
+    printf("%s: %.0f IOPS, mean latency %.1f us, p99 latency %.1f us\n",
+           name,
+           all.size() / dur,
+           ticks_to_secs(sum) / all.size() * 1000000,
+           ticks_to_secs(all[all.size() * 99 / 100]) * 1000000);
+}
+
+TPTEST(DiskIoBackend, RandomReadBenchmark) {
+    run_random_read_benchmark(file_io_backend_t::pool, "pool");
+    if (uring_diskmgr_t::is_supported()) {
+        run_random_read_benchmark(file_io_backend_t::uring_desired, "uring");
+    } else {
+        printf("uring: not supported on this system\n");
+    }
+}
+#endif
+
+}  // namespace unittest
@@ -1,11 +1,14 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "unittest/gtest.hpp"
 
 #include "btree/internal_node.hpp"
 #include "btree/node.hpp"
+#include "containers/scoped.hpp"
+#include "utils.hpp"
 
 namespace unittest {
 
@@ -15,9 +18,6 @@ void verify(block_size_t block_size, const internal_node_t *buf) {
     // Internal nodes must have at least one pair.
     ASSERT_LE(1, buf->npairs);
 
-    // Thus buf->npairs - 1 >= 0.
-    const uint16_t last_pair_offset = buf->pair_offsets[buf->npairs - 1];
-
     ASSERT_LE(buf->npairs, block_size.value());  // sanity checking to prevent overflow
     ASSERT_LE(offsetof(internal_node_t, pair_offsets) + sizeof(*buf->pair_offsets) * buf->npairs, buf->frontmost_offset);
     ASSERT_LE(buf->frontmost_offset, block_size.value());
@@ -33,19 +33,17 @@ void verify(block_size_t block_size, const internal_node_t *buf) {
     }
     ASSERT_EQ(block_size.value(), expected);
 
-    const btree_key_t *last_key = nullptr;
-    for (const uint16_t *p = buf->pair_offsets, *e = p + buf->npairs - 1; p < e; ++p) {
-        const btree_internal_pair *pair = internal_node::get_pair(buf, *p);
-        const btree_key_t *next_key = &pair->key;
+    store_key_t last_key;
+    for (int i = 0; i < buf->npairs - 1; ++i) {
+        store_key_t next_key;
+        internal_node::get_key_by_index(buf, i, &next_key);
 
-        if (last_key != nullptr) {
-            EXPECT_LT(internal_key_comp::compare(last_key, next_key), 0);
+        if (i > 0) {
+            EXPECT_LT(internal_key_comp::compare(last_key.btree_key(), next_key.btree_key()), 0);
         }
 
         last_key = next_key;
     }
-
-    EXPECT_EQ(0, internal_node::get_pair(buf, last_pair_offset)->key.size);
 }
 
 TEST(InternalNodeTest, Offsets) {
@@ -61,6 +59,157 @@ TEST(InternalNodeTest, Offsets) {
     EXPECT_EQ(9u, sizeof(btree_internal_pair));
 }
 
+// Keys of the form `<prefix><number>`, which share a long prefix like secondary index
+// keys do.
+store_key_t prefixed_key(const std::string &prefix, int i) {
+    return store_key_t(strprintf("%s%06d", prefix.c_str(), i));
+}
+
+// Fills `node` with the keys `prefixed_key(prefix, first)`, ..., in order, until it
+// is full. The children are numbered so that the child to the left of the `i`th key
+// is `first + i`. Returns the number of keys.
+int fill(internal_node_t *node, const std::string &prefix, int first) {
+    int i = 0;
+    while (internal_node::insert(node, prefixed_key(prefix, first + i).btree_key(),
+                                 first + i, first + i + 1)) {
+        ++i;
+    }
+    return i;
+}
+
+// Checks that every key in `[first, first + count)` finds the right child.
+void check_lookups(const internal_node_t *node, const std::string &prefix,
+                   int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+        EXPECT_EQ(static_cast<block_id_t>(i), internal_node::lookup(node, prefixed_key(prefix, i).btree_key()));
+    }
+}
+
+TEST(InternalNodeTest, SplitCompressesPrefix) {
+    block_size_t bs = block_size_t::unsafe_make(4096);
+    const std::string prefix(100, 'p');
+
+    scoped_malloc_t<internal_node_t> node(bs.value());
+    internal_node::init(bs, node.get());
+    const int count = fill(node.get(), prefix, 0);
+    verify(bs, node.get());
+    check_lookups(node.get(), prefix, 0, count + 1);
+    EXPECT_EQ(0, internal_node::get_prefix(node.get())->size);
+
+    // Split it as if its parent's neighboring keys were just outside of the range of
+    // keys with the prefix.
+    const store_key_t left_bound(prefix + "-");
+    const store_key_t right_bound(prefix + "~");
+    scoped_malloc_t<internal_node_t> rnode(bs.value());
+    store_key_t median;
+    internal_node::split(bs, node.get(), rnode.get(), median.btree_key(),
+                         left_bound.btree_key(), right_bound.btree_key());
+    verify(bs, node.get());
+    verify(bs, rnode.get());
+
+    // Both halves only store the part of each key after the shared prefix.
+    EXPECT_EQ(prefix.size(), internal_node::get_prefix(node.get())->size);
+    EXPECT_EQ(prefix.size(), internal_node::get_prefix(rnode.get())->size);
+
+    const int split_at = internal_node::lookup(node.get(), median.btree_key());
+    check_lookups(node.get(), prefix, 0, split_at + 1);
+    check_lookups(rnode.get(), prefix, split_at + 1, count - split_at);
+
+    // Keys that don't have the prefix go to the first or last child.
+    EXPECT_EQ(static_cast<block_id_t>(split_at + 1), internal_node::lookup(rnode.get(), store_key_t("a").btree_key()));
+    EXPECT_EQ(static_cast<block_id_t>(count), internal_node::lookup(rnode.get(), store_key_t("z").btree_key()));
+
+    // Each half can now take more keys than the uncompressed node could.
+    const int more = fill(rnode.get(), prefix, count);
+    EXPECT_LT(count, rnode->npairs - 1);
+    check_lookups(rnode.get(), prefix, split_at + 1, count + more - split_at);
+    verify(bs, rnode.get());
+}
+
+TEST(InternalNodeTest, MergeAndLevelKeepKeys) {
+    block_size_t bs = block_size_t::unsafe_make(4096);
+    const std::string prefix(150, 'p');
+
+    scoped_malloc_t<internal_node_t> node(bs.value());
+    internal_node::init(bs, node.get());
+    const int count = fill(node.get(), prefix, 0);
+    scoped_malloc_t<internal_node_t> rnode(bs.value());
+    store_key_t median;
+    internal_node::split(bs, node.get(), rnode.get(), median.btree_key(),
+                         nullptr, store_key_t(prefix + "~").btree_key());
+    // The left node is the leftmost one in the tree, so it keeps an empty prefix.
+    EXPECT_EQ(0, internal_node::get_prefix(node.get())->size);
+    EXPECT_EQ(prefix.size(), internal_node::get_prefix(rnode.get())->size);
+    const int total = count + fill(rnode.get(), prefix, count);
+
+    scoped_malloc_t<internal_node_t> parent(bs.value());
+    internal_node::init(bs, parent.get());
+    ASSERT_TRUE(internal_node::insert(parent.get(), median.btree_key(), 1000, 1001));
+
+    // Take keys away from `node` until it's underfull, then level it with `rnode`.
+    while (!internal_node::is_underfull(bs, node.get())) {
+        store_key_t key;
+        internal_node::get_key_by_index(node.get(), 0, &key);
+        internal_node::remove(bs, node.get(), key.btree_key());
+    }
+    int removed = internal_node::lookup(node.get(), store_key_t().btree_key());
+    ASSERT_FALSE(internal_node::is_mergable(bs, node.get(), rnode.get(), parent.get()));
+
+    store_key_t replacement;
+    std::vector<block_id_t> moved;
+    ASSERT_TRUE(internal_node::level(bs, node.get(), rnode.get(), replacement.btree_key(),
+                                     parent.get(), &moved));
+    EXPECT_FALSE(moved.empty());
+    verify(bs, node.get());
+    verify(bs, rnode.get());
+    internal_node::update_key(parent.get(), median.btree_key(), replacement.btree_key());
+    const int split_at = internal_node::lookup(node.get(), replacement.btree_key());
+    check_lookups(node.get(), prefix, removed, split_at + 1 - removed);
+    check_lookups(rnode.get(), prefix, split_at + 1, total - split_at);
+
+    // Now empty the nodes until they can be merged.
+    while (!internal_node::is_mergable(bs, node.get(), rnode.get(), parent.get())) {
+        store_key_t key;
+        if (rnode->npairs > 2) {
+            internal_node::get_key_by_index(rnode.get(), rnode->npairs - 2, &key);
+            internal_node::remove(bs, rnode.get(), key.btree_key());
+        } else {
+            internal_node::get_key_by_index(node.get(), 0, &key);
+            internal_node::remove(bs, node.get(), key.btree_key());
+            ++removed;
+        }
+    }
+    const int last_key = split_at + rnode->npairs - 1;
+    internal_node::merge(bs, node.get(), rnode.get(), parent.get());
+    verify(bs, rnode.get());
+    EXPECT_EQ(0, internal_node::get_prefix(rnode.get())->size);
+    check_lookups(rnode.get(), prefix, removed, last_key + 1 - removed);
+    EXPECT_EQ(static_cast<block_id_t>(total), internal_node::lookup(rnode.get(), store_key_t("z").btree_key()));
+}
+
+TEST(InternalNodeTest, LegacyNode) {
+    block_size_t bs = block_size_t::unsafe_make(4096);
+    const std::string prefix(100, 'p');
+
+    // Nodes in the old format are nodes with an empty prefix.
+    scoped_malloc_t<internal_node_t> node(bs.value());
+    internal_node::init(bs, node.get());
+    node->magic = internal_node_t::legacy_magic;
+    EXPECT_TRUE(node::is_internal(reinterpret_cast<const node_t *>(node.get())));
+    const int count = fill(node.get(), prefix, 0);
+    check_lookups(node.get(), prefix, 0, count + 1);
+
+    // Splitting them rewrites them in the new format.
+    scoped_malloc_t<internal_node_t> rnode(bs.value());
+    store_key_t median;
+    internal_node::split(bs, node.get(), rnode.get(), median.btree_key(),
+                         nullptr, nullptr);
+    verify(bs, node.get());
+    verify(bs, rnode.get());
+    const int split_at = internal_node::lookup(node.get(), median.btree_key());
+    check_lookups(node.get(), prefix, 0, split_at + 1);
+    check_lookups(rnode.get(), prefix, split_at + 1, count - split_at);
+}
 
 }  // namespace unittest
 
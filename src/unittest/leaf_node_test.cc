@@ -1,10 +1,15 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "btree/leaf_node.hpp"
 #include "btree/node.hpp"
 #include "containers/scoped.hpp"
+#include "random.hpp"
 #include "repli_timestamp.hpp"
+#include "time.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/unittest_utils.hpp"
 #include "utils.hpp"
@@ -711,4 +716,152 @@ TEST(LeafNodeTest, Fullness) {
     ASSERT_TRUE(node.IsFull(store_key_t(strprintf("a%d", i)), strprintf("A%d", i)));
 }
 
+// Key distributions for the search tests below. `PRIMARY` keys look like the
+// primary keys of a table with UUID keys. `SECONDARY` keys look like the keys of a
+// secondary index, which share a long truncated index value and end with the
+// primary key.
+enum class search_keys_t { PRIMARY, SECONDARY };
+
+store_key_t random_search_key(search_keys_t type, rng_t *rng) {
+    std::string uuid;
+    for (int i = 0; i < 32; ++i) {
+        uuid.push_back("0123456789abcdef"[rng->randint(16)]);
+    }
+    if (type == search_keys_t::PRIMARY) {
+        return store_key_t("S" + uuid);
+    } else {
+        return store_key_t("Scustomers_by_region_and_signup_date:europe-west:2016-"
+                           + strprintf("%02d", rng->randint(3)) + ":" + uuid);
+    }
+}
+
+// Fills `node` with random keys until it's full, and returns the keys.
+std::vector<store_key_t> fill_for_search(value_sizer_t *sizer, leaf_node_t *node,
+                                         search_keys_t type, rng_t *rng) {
+    leaf::init(sizer, node);
+    std::vector<store_key_t> keys;
+    short_value_buffer_t value(std::string("v"));
+    for (;;) {
+        store_key_t key = random_search_key(type, rng);
+        if (leaf::is_full(sizer, node, key.btree_key(), value.data())) {
+            break;
+        }
+        leaf::insert(sizer, node, key.btree_key(), value.data(),
+                     repli_timestamp_t::distant_past, repli_timestamp_t::distant_past,
+                     key_modification_proof_t::real_proof());
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+// `leaf::find_key()` as it was before it skipped known common prefixes, as a
+// reference to test and benchmark against.
+bool reference_find_key(const leaf_node_t *node, const btree_key_t *key, int *index_out) {
+    int beg = 0;
+    int end = node->num_pairs;
+    while (beg < end) {
+        int test_point = beg + (end - beg) / 2;
+        int res = btree_key_cmp(key, (*leaf::iterator(node, test_point)).first);
+        if (res < 0) {
+            end = test_point;
+        } else if (res > 0) {
+            beg = test_point + 1;
+        } else {
+            *index_out = test_point;
+            return true;
+        }
+    }
+    *index_out = beg;
+    return false;
+}
+
+void test_find_key(search_keys_t type) {
+    max_block_size_t bs = max_block_size_t::unsafe_make(4096);
+    short_value_sizer_t sizer(bs);
+    scoped_malloc_t<leaf_node_t> node(bs.value());
+    rng_t rng(0);
+    std::vector<store_key_t> keys = fill_for_search(&sizer, node.get(), type, &rng);
+    ASSERT_LT(10u, keys.size());
+
+    for (int i = 0; i < 1000; ++i) {
+        // Half of the lookups are for keys that exist.
+        store_key_t key = i % 2 == 0
+            ? keys[rng.randsize(keys.size())]
+            : random_search_key(type, &rng);
+        int index, reference_index;
+        bool found = leaf::find_key(node.get(), key.btree_key(), &index);
+        bool reference_found
+            = reference_find_key(node.get(), key.btree_key(), &reference_index);
+        ASSERT_EQ(reference_found, found);
+        ASSERT_EQ(reference_index, index);
+        ASSERT_EQ(i % 2 == 0, found);
+    }
+}
+
+TEST(LeafNodeTest, FindKeyPrimary) {
+    test_find_key(search_keys_t::PRIMARY);
+}
+
+TEST(LeafNodeTest, FindKeySecondary) {
+    test_find_key(search_keys_t::SECONDARY);
+}
+
+// This is not really a unit test, but a micro benchmark comparing lookups per second
+// of `leaf::find_key()` and the plain binary search it replaced. No need to run this
+// in debug mode.
+#ifdef NDEBUG
+void run_find_key_benchmark(search_keys_t type, const char *name) {
+    const int NUM_NODES = 64;
+    const int NUM_LOOKUPS = 2000000;
+
+    max_block_size_t bs = max_block_size_t::unsafe_make(4096);
+    short_value_sizer_t sizer(bs);
+    rng_t rng(0);
+    std::vector<scoped_malloc_t<leaf_node_t> > nodes;
+    std::vector<std::vector<store_key_t> > keys;
+    for (int i = 0; i < NUM_NODES; ++i) {
+        nodes.emplace_back(bs.value());
+        keys.push_back(fill_for_search(&sizer, nodes.back().get(), type, &rng));
+    }
+    // Pairs of a node and the index of a key in it.
+    std::vector<std::pair<int, size_t> > lookups;
+    lookups.reserve(NUM_LOOKUPS);
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        int n = rng.randint(NUM_NODES);
+        lookups.push_back(std::make_pair(n, rng.randsize(keys[n].size())));
+    }
+
+    int found = 0;
+    ticks_t start_ticks = get_ticks();
+    for (const auto &lookup : lookups) {
+        int index;
+        found += reference_find_key(nodes[lookup.first].get(),
+                                    keys[lookup.first][lookup.second].btree_key(),
+                                    &index);
+    }
+    double dur_reference = ticks_to_secs(get_ticks() - start_ticks);
+    EXPECT_EQ(NUM_LOOKUPS, found);
+
+    found = 0;
+    start_ticks = get_ticks();
+    for (const auto &lookup : lookups) {
+        int index;
+        found += leaf::find_key(nodes[lookup.first].get(),
+                                keys[lookup.first][lookup.second].btree_key(),
+                                &index);
+    }
+    double dur = ticks_to_secs(get_ticks() - start_ticks);
+    EXPECT_EQ(NUM_LOOKUPS, found);
+
+    printf("%s keys (%zu per node): binary search %.0f lookups/s, "
+           "find_key %.0f lookups/s\n",
+           name, keys[0].size(), NUM_LOOKUPS / dur_reference, NUM_LOOKUPS / dur);
+}
+
+TEST(LeafNodeTest, FindKeyBenchmark) {
+    run_find_key_benchmark(search_keys_t::PRIMARY, "primary");
+    run_find_key_benchmark(search_keys_t::SECONDARY, "secondary");
+}
+#endif
+
 }  // namespace unittest
@@ -7,6 +7,7 @@
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/pmap.hpp"
 #include "containers/scoped.hpp"
+#include "random.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/mock_file.hpp"
@@ -54,7 +55,11 @@ public:
                  cache_balancer_t *balancer,
                  alt_txn_throttler_t *throttler)
         : page_cache_t(_serializer, balancer, throttler),
-          throttler_(throttler) { }
+          throttler_(throttler) {
+        // The tests create write transactions directly, so they need to wait for
+        // this like `txn_t` does.
+        index_loaded_signal()->wait();
+    }
 
     void flush(scoped_ptr_t<test_txn_t> txn) {
         flush_and_destroy_txn(std::move(txn), &reset_throttler_acq);
@@ -218,6 +223,40 @@ TPTEST(PageTest, OneWriteAcqWait, 4) {
     page_cache.flush(std::move(txn));
 }
 
+TPTEST(PageTest, ReadBeforeIndexLoaded, 4) {
+    mock_ser_t mock;
+    dummy_cache_balancer_t balancer(GIGABYTE);
+    block_id_t block_id;
+    {
+        test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_id = acq.block_id();
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            memset(page_acq.get_buf_write(), 'x', 10);
+            acq.set_recency(repli_timestamp_t::distant_past.next());
+        }
+        page_cache.flush(std::move(txn));
+    }
+
+    // Reads don't wait for the page cache to load the recencies and the free list.
+    page_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+    ASSERT_FALSE(page_cache.index_loaded_signal()->is_pulsed());
+    current_test_acq_t acq(&page_cache, block_id, read_access_t());
+    acq.declare_snapshotted();
+    {
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_read(), &page_cache);
+        page_acq.buf_ready_signal()->wait();
+        ASSERT_EQ('x', *static_cast<const char *>(page_acq.get_buf_read()));
+    }
+    // Only the recency has to wait for them.
+    ASSERT_EQ(repli_timestamp_t::distant_past.next(), acq.recency());
+    ASSERT_TRUE(page_cache.index_loaded_signal()->is_pulsed());
+}
+
 struct ReadAfterWrite_state_t {
     block_id_t block_id;
     cond_t write_acquired;
@@ -1181,4 +1220,100 @@ TPTEST(PageTest, BiggerTestNoMemory, 4) {
     test.run();
 }
 
+// Reads the block through the cache and returns true if its page was already in
+// memory.
+bool replay_read(test_cache_t *cache, block_id_t block_id) {
+    const int64_t bytes_loaded = cache->evicter().get_bytes_loaded();
+    current_test_acq_t acq(cache, block_id, read_access_t::read);
+    test_acq_t page_acq;
+    page_acq.init(acq.current_page_for_read(), cache);
+    page_acq.get_buf_read();
+    return cache->evicter().get_bytes_loaded() == bytes_loaded;
+}
+
+struct replay_result_t {
+    int point_reads;
+    int point_read_hits;
+    int reads;
+    int hits;
+};
+
+// Replays a trace of point reads of a few hot blocks, mixed with sequential scans
+// over all of the blocks, against a cache that holds an eighth of the blocks.
+replay_result_t replay_point_reads_and_scans(cache_eviction_policy_t policy) {
+    const int NUM_BLOCKS = 2000;
+    const int NUM_CACHED_BLOCKS = NUM_BLOCKS / 8;
+    const int NUM_HOT_BLOCKS = 100;
+    const int NUM_ROUNDS = 4;
+    const int POINT_READS_PER_ROUND = 1000;
+    // During a scan, there's a point read after every SCAN_STRIDE blocks.
+    const int SCAN_STRIDE = 4;
+
+    mock_ser_t mock;
+    dummy_cache_balancer_t balancer(GIGABYTE, policy);
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+
+    std::vector<block_id_t> block_ids;
+    while (block_ids.size() < static_cast<size_t>(NUM_BLOCKS)) {
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        for (int i = 0; i < 100; ++i) {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_ids.push_back(acq.block_id());
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            memset(page_acq.get_buf_write(), 0,
+                   page_cache.max_block_size().value());
+        }
+        page_cache.flush(std::move(txn));
+    }
+
+    uint64_t page_usage;
+    {
+        current_test_acq_t acq(&page_cache, block_ids[0], read_access_t::read);
+        page_usage = acq.current_page_for_read()->hypothetical_memory_usage(
+            &page_cache);
+    }
+    page_cache.evicter().update_memory_limit(page_usage * NUM_CACHED_BLOCKS,
+                                             0, 0, false);
+
+    rng_t rng(0);
+    replay_result_t result = { 0, 0, 0, 0 };
+    auto point_read = [&]() {
+        bool hit = replay_read(&page_cache, block_ids[rng.randint(NUM_HOT_BLOCKS)]);
+        ++result.point_reads;
+        result.point_read_hits += hit;
+        ++result.reads;
+        result.hits += hit;
+    };
+    for (int round = 0; round < NUM_ROUNDS; ++round) {
+        for (int i = 0; i < POINT_READS_PER_ROUND; ++i) {
+            point_read();
+        }
+        for (int i = 0; i < NUM_BLOCKS; ++i) {
+            ++result.reads;
+            result.hits += replay_read(&page_cache, block_ids[i]);
+            if (i % SCAN_STRIDE == 0) {
+                point_read();
+            }
+        }
+    }
+    return result;
+}
+
+TPTEST(PageTest, ReplayPointReadsAndScans, 4) {
+    replay_result_t two_queue
+        = replay_point_reads_and_scans(cache_eviction_policy_t::TWO_QUEUE);
+    replay_result_t sampled
+        = replay_point_reads_and_scans(cache_eviction_policy_t::SAMPLED_LRU);
+    printf("2q: %.1f%% of point reads, %.1f%% of all reads hit the cache\n",
+           100.0 * two_queue.point_read_hits / two_queue.point_reads,
+           100.0 * two_queue.hits / two_queue.reads);
+    printf("sampled: %.1f%% of point reads, %.1f%% of all reads hit the cache\n",
+           100.0 * sampled.point_read_hits / sampled.point_reads,
+           100.0 * sampled.hits / sampled.reads);
+    // The scans shouldn't push the hot blocks out of the cache.
+    EXPECT_GT(two_queue.point_read_hits, sampled.point_read_hits);
+    EXPECT_GT(two_queue.point_read_hits, two_queue.point_reads * 9 / 10);
+}
+
 }  // namespace unittest
@@ -1,5 +1,6 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include <functional>
+#include <set>
 
 #include "arch/io/disk.hpp"
 #include "arch/runtime/coroutines.hpp"
@@ -451,4 +452,161 @@ TPTEST(RDBBtree, SindexInterruptionViaStoreDelete) {
     store.reset();
 }
 
+class eval_counter_t : public ql::env_t::eval_callback_t {
+public:
+    eval_counter_t() : count(0) { }
+    void eval_callback() {
+        ++count;
+    }
+    size_t count;
+};
+
+// Scans the primary index of `store` for the rows that pass `filter`, which is a
+// function of `row`.  Counts the function evaluations in `evals_out`.
+rget_read_response_t scan_with_filter(
+        store_t *store,
+        const ql::sym_t &row,
+        ql::minidriver_t::reql_t filter,
+        const ql::batchspec_t &batchspec,
+        size_t *evals_out) {
+    ql::compile_env_t compile_env(
+        ql::var_visibility_t().with_func_arg_name_list(make_vector(row)));
+    counted_t<const ql::func_t> func = make_counted<ql::reql_func_t>(
+        ql::var_scope_t(),
+        make_vector(row),
+        ql::compile_term(&compile_env, filter.root_term()));
+    std::vector<ql::transform_variant_t> transforms{
+        ql::filter_wire_func_t(func, boost::none)};
+
+    cond_t dummy_interruptor;
+    read_token_t token;
+    store->new_read_token(&token);
+    scoped_ptr_t<txn_t> txn;
+    scoped_ptr_t<real_superblock_t> superblock;
+    store->acquire_superblock_for_read(
+            &token, &txn, &superblock,
+            &dummy_interruptor, true);
+
+    ql::env_t env(&dummy_interruptor,
+                  ql::return_empty_normal_batches_t::NO,
+                  reql_version_t::LATEST);
+    eval_counter_t counter;
+    env.set_eval_callback(&counter);
+
+    rget_read_response_t res;
+    rdb_rget_slice(
+        store->btree.get(),
+        region_t::universe(),
+        key_range_t::universe(),
+        boost::none,
+        superblock.get(),
+        &env,
+        batchspec,
+        transforms,
+        boost::optional<ql::terminal_variant_t>(),
+        sorting_t::ASCENDING,
+        &res,
+        release_superblock_t::RELEASE);
+    *evals_out = counter.count;
+    return res;
+}
+
+// The ids of the rows in the response to `scan_with_filter`.
+std::set<int> scanned_ids(rget_read_response_t *res, store_key_t *last_key_out) {
+    ql::grouped_t<ql::stream_t> *groups =
+        boost::get<ql::grouped_t<ql::stream_t> >(&res->result);
+    guarantee(groups != nullptr);
+    std::set<int> ids;
+    for (const auto &group : *groups) {
+        for (const auto &substream : group.second.substreams) {
+            *last_key_out = substream.second.last_key;
+            for (const ql::rget_item_t &item : substream.second.stream) {
+                ids.insert(static_cast<int>(item.data.get_field("id").as_num()));
+            }
+        }
+    }
+    return ids;
+}
+
+TPTEST(RDBBtree, ScanEvaluatesFilterInBatches) {
+    recreate_temporary_directory(base_path_t("."));
+    temp_file_t temp_file;
+
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    dummy_cache_balancer_t balancer(GIGABYTE);
+
+    filepath_file_opener_t file_opener(temp_file.name(), &io_backender);
+    log_serializer_t::create(
+        &file_opener,
+        log_serializer_t::static_config_t());
+
+    log_serializer_t serializer(
+        log_serializer_t::dynamic_config_t(),
+        &file_opener,
+        &get_global_perfmon_collection());
+
+    store_t store(
+            region_t::universe(),
+            &serializer,
+            &balancer,
+            "unit_test_store",
+            true,
+            &get_global_perfmon_collection(),
+            nullptr,
+            &io_backender,
+            base_path_t("."),
+            generate_uuid(),
+            update_sindexes_t::UPDATE);
+
+    insert_rows(0, TOTAL_KEYS_TO_INSERT, &store);
+
+    ql::sym_t row(1);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    std::set<int> first_ten;
+    for (int i = 0; i < 10; ++i) {
+        first_ten.insert(i);
+    }
+
+    {
+        // Row by row, every row would take an evaluation of its own.
+        size_t evals;
+        rget_read_response_t res = scan_with_filter(
+            &store, row, r.var(row)["sid"] < 100, ql::batchspec_t::all(), &evals);
+        store_key_t last_key;
+        EXPECT_EQ(first_ten, scanned_ids(&res, &last_key));
+        EXPECT_LT(evals, static_cast<size_t>(TOTAL_KEYS_TO_INSERT / 10));
+    }
+
+    {
+        // The scan stops at the fifth row that passes, even though the rest of its
+        // batch has been filtered too.
+        size_t evals;
+        rget_read_response_t res = scan_with_filter(
+            &store, row, r.var(row)["sid"] < 100,
+            ql::batchspec_t::all().with_at_most(5), &evals);
+        store_key_t last_key;
+        EXPECT_EQ(std::set<int>({0, 1, 2, 3, 4}), scanned_ids(&res, &last_key));
+        EXPECT_EQ(store_key_t(ql::datum_t(4.0).print_primary()), last_key);
+    }
+
+    // Dividing by zero fails on the row with id 10.
+    ql::minidriver_t::reql_t failing_filter =
+        r.expr(1.0) / (r.var(row)["id"] + -10.0) < 0;
+    {
+        size_t evals;
+        rget_read_response_t res = scan_with_filter(
+            &store, row, failing_filter, ql::batchspec_t::all(), &evals);
+        EXPECT_TRUE(boost::get<ql::exc_t>(&res.result) != nullptr);
+    }
+    {
+        // The scan stops before it gets to the row that fails, so there's no error.
+        size_t evals;
+        rget_read_response_t res = scan_with_filter(
+            &store, row, failing_filter,
+            ql::batchspec_t::all().with_at_most(5), &evals);
+        store_key_t last_key;
+        EXPECT_EQ(std::set<int>({0, 1, 2, 3, 4}), scanned_ids(&res, &last_key));
+    }
+}
+
 } //namespace unittest
@@ -11,6 +11,7 @@
 #include "arch/timing.hpp"
 #include "containers/scoped.hpp"
 #include "containers/archive/socket_stream.hpp"
+#include "concurrency/cond_var.hpp"
 #include "unittest/clustering_utils.hpp"
 #include "unittest/unittest_utils.hpp"
 #include "rpc/connectivity/cluster.hpp"
@@ -32,23 +33,30 @@ public:
         cluster_message_handler_t(cm, _tag),
         sequence_number(0)
         { }
-    void send(int message, peer_id_t peer) {
+    /* `padding` makes the message that many bytes larger. */
+    void send(int message, peer_id_t peer, size_t padding = 0,
+              cluster_message_lane_t lane = cluster_message_lane_t::NORMAL,
+              uint64_t order_key = 0) {
         auto_drainer_t::lock_t connection_keepalive;
         connectivity_cluster_t::connection_t *connection =
             get_connectivity_cluster()->get_connection(peer, &connection_keepalive);
         if (connection) {
-            send(message, connection, connection_keepalive);
+            send(message, connection, connection_keepalive, padding, lane,
+                 order_key);
         }
     }
     void send(int message, connectivity_cluster_t::connection_t *connection,
-            auto_drainer_t::lock_t connection_keepalive) {
+            auto_drainer_t::lock_t connection_keepalive, size_t padding = 0,
+            cluster_message_lane_t lane = cluster_message_lane_t::NORMAL,
+            uint64_t order_key = 0) {
         class writer_t : public cluster_send_message_write_callback_t {
         public:
-            explicit writer_t(int _data) : data(_data) { }
+            writer_t(int _data, size_t padding) : data(_data), pad(padding, 'p') { }
             virtual ~writer_t() { }
             void write(write_stream_t *stream) {
                 write_message_t wm;
                 serialize<cluster_version_t::CLUSTER>(&wm, data);
+                serialize<cluster_version_t::CLUSTER>(&wm, pad);
                 int res = send_write_message(stream, &wm);
                 if (res) { throw fake_archive_exc_t(); }
             }
@@ -58,9 +66,10 @@ public:
             }
 #endif
             int32_t data;
-        } writer(message);
+            std::string pad;
+        } writer(message, padding);
         get_connectivity_cluster()->send_message(connection, connection_keepalive,
-            get_message_tag(), &writer);
+            get_message_tag(), &writer, lane, order_key);
     }
     void expect(int message, peer_id_t peer) {
         expect_delivered(message);
@@ -90,6 +99,9 @@ private:
         archive_result_t res
             = deserialize<cluster_version_t::CLUSTER>(stream, &i);
         if (bad(res)) { throw fake_archive_exc_t(); }
+        std::string pad;
+        res = deserialize<cluster_version_t::CLUSTER>(stream, &pad);
+        if (bad(res)) { throw fake_archive_exc_t(); }
         on_thread_t th(home_thread());
         inbox[i] = connection->get_peer_id();
         timing[i] = sequence_number++;
@@ -139,6 +151,227 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, Message, 3) {
     a3.expect(999, c3.get_me());
 }
 
+/* `Compression` sends messages between a server that compresses what it sends and
+two that don't, one of which is also sent compressed messages. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, Compression, 3) {
+    cluster_connection_config_t zlib_config;
+    zlib_config.compression = cluster_compression_t::ZLIB;
+
+    connectivity_cluster_t c1, c2, c3;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T'), a3(&c3, 'T');
+    test_cluster_run_t cr1(&c1, peer_address_t(), zlib_config);
+    test_cluster_run_t cr2(&c2, peer_address_t(), zlib_config);
+    test_cluster_run_t cr3(&c3);
+    cr2.join(get_cluster_local_address(&c1), 0);
+    cr3.join(get_cluster_local_address(&c1), 0);
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 100; ++i) {
+        a1.send(i, c2.get_me(), i * 1000);
+        a2.send(1000 + i, c1.get_me(), i * 1000);
+        a1.send(2000 + i, c3.get_me(), i);
+        a3.send(3000 + i, c1.get_me(), i);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 100; ++i) {
+        a2.expect(i, c1.get_me());
+        a1.expect(1000 + i, c2.get_me());
+        a3.expect(2000 + i, c1.get_me());
+        a1.expect(3000 + i, c3.get_me());
+    }
+    for (int i = 1; i < 100; ++i) {
+        a2.expect_order(i - 1, i);
+        a1.expect_order(1000 + i - 1, 1000 + i);
+    }
+}
+
+/* `BulkStreams` sends large and small messages between servers that use several TCP
+connections for each other. Messages of different sizes may overtake each other, but
+all of them must arrive. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, BulkStreams, 3) {
+    cluster_connection_config_t striped_config;
+    striped_config.connections_per_peer = 3;
+    cluster_connection_config_t compressed_striped_config = striped_config;
+    compressed_striped_config.compression = cluster_compression_t::ZLIB;
+
+    connectivity_cluster_t c1, c2, c3;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T'), a3(&c3, 'T');
+    test_cluster_run_t cr1(&c1, peer_address_t(), striped_config);
+    test_cluster_run_t cr2(&c2, peer_address_t(), compressed_striped_config);
+    /* This one doesn't want additional connections, so it shouldn't get any. */
+    test_cluster_run_t cr3(&c3);
+    cr2.join(get_cluster_local_address(&c1), 0);
+    cr3.join(get_cluster_local_address(&c1), 0);
+
+    let_stuff_happen();
+
+    const size_t large = 2 * CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE;
+    for (int i = 0; i < 20; ++i) {
+        a1.send(i, c2.get_me(), i % 2 == 0 ? large : 0);
+        a2.send(100 + i, c1.get_me(), i % 2 == 0 ? large : 0);
+        a1.send(200 + i, c3.get_me(), i % 2 == 0 ? large : 0);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 20; ++i) {
+        a2.expect(i, c1.get_me());
+        a1.expect(100 + i, c2.get_me());
+        a3.expect(200 + i, c1.get_me());
+    }
+
+    /* Losing the servers' connection must not leave anything behind. */
+    auto_drainer_t::lock_t connection_keepalive;
+    connectivity_cluster_t::connection_t *connection =
+        c1.get_connection(c2.get_me(), &connection_keepalive);
+    ASSERT_TRUE(connection != nullptr);
+    connection->kill_connection();
+    connection_keepalive.reset();
+
+    let_stuff_happen();
+}
+
+/* `BulkStreamsKeepOrder` checks that large messages with the same order key (as sent
+to the same mailbox) arrive in order, even though they aren't sent over the primary
+TCP connection. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, BulkStreamsKeepOrder, 3) {
+    cluster_connection_config_t striped_config;
+    striped_config.connections_per_peer = 3;
+
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+    test_cluster_run_t cr1(&c1, peer_address_t(), striped_config);
+    test_cluster_run_t cr2(&c2, peer_address_t(), striped_config);
+    cr2.join(get_cluster_local_address(&c1), 0);
+
+    let_stuff_happen();
+
+    const size_t large = 2 * CLUSTER_BULK_LANE_MIN_MESSAGE_SIZE;
+    for (int i = 0; i < 20; ++i) {
+        a1.send(i, c2.get_me(), large, cluster_message_lane_t::NORMAL, 7);
+        a1.send(100 + i, c2.get_me(), large, cluster_message_lane_t::NORMAL, 8);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 19; ++i) {
+        a2.expect_order(i, i + 1);
+        a2.expect_order(100 + i, 100 + i + 1);
+    }
+}
+
+/* `MessageLanes` checks that a small message in the interactive lane doesn't have to
+wait for a large message that was sent before it, and that messages in all lanes
+arrive. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, MessageLanes, 3) {
+    cluster_connection_config_t compressed_config;
+    compressed_config.compression = cluster_compression_t::ZLIB;
+
+    connectivity_cluster_t c1, c2, c3;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T'), a3(&c3, 'T');
+    test_cluster_run_t cr1(&c1);
+    test_cluster_run_t cr2(&c2);
+    test_cluster_run_t cr3(&c3, peer_address_t(), compressed_config);
+    cr2.join(get_cluster_local_address(&c1), 0);
+    cr3.join(get_cluster_local_address(&c1), 0);
+
+    let_stuff_happen();
+
+    /* The large message is too big to fit into the socket buffers, so it has to wait
+    for the network, and the small one gets to go in between its fragments. */
+    cond_t large_sent;
+    coro_t::spawn_sometime([&]() {
+        a1.send(1, c2.get_me(), 16 * MEGABYTE);
+        large_sent.pulse();
+    });
+    coro_t::yield();
+    a1.send(2, c2.get_me(), 0, cluster_message_lane_t::INTERACTIVE);
+    large_sent.wait();
+
+    for (int i = 0; i < 30; ++i) {
+        a1.send(100 + i, c3.get_me(),
+                i % 3 == 0 ? 2 * CLUSTER_MESSAGE_FRAGMENT_SIZE + 1 : 0,
+                static_cast<cluster_message_lane_t>(i % num_cluster_message_lanes));
+        a3.send(200 + i, c1.get_me(), i % 2 == 0 ? CLUSTER_MESSAGE_FRAGMENT_SIZE : 0,
+                static_cast<cluster_message_lane_t>(i % num_cluster_message_lanes));
+    }
+
+    let_stuff_happen();
+
+    a2.expect_order(2, 1);
+    for (int i = 0; i < 30; ++i) {
+        a3.expect(100 + i, c1.get_me());
+        a1.expect(200 + i, c3.get_me());
+    }
+}
+
+/* `LaneMutex` checks that `lane_mutex_t` serves the lanes in order of priority, but
+doesn't let the bulk lane starve. */
+
+TPTEST(RPCConnectivityTest, LaneMutex) {
+    lane_mutex_t mutex;
+    std::vector<cluster_message_lane_t> order;
+    {
+        lane_mutex_t::acq_t acq(&mutex, cluster_message_lane_t::NORMAL);
+        for (int i = num_cluster_message_lanes - 1; i >= 0; --i) {
+            coro_t::spawn_now_dangerously([&mutex, &order, i]() {
+                lane_mutex_t::acq_t waiter_acq(
+                    &mutex, static_cast<cluster_message_lane_t>(i));
+                order.push_back(static_cast<cluster_message_lane_t>(i));
+            });
+        }
+        EXPECT_TRUE(order.empty());
+    }
+    ASSERT_EQ(3u, order.size());
+    EXPECT_EQ(cluster_message_lane_t::INTERACTIVE, order[0]);
+    EXPECT_EQ(cluster_message_lane_t::NORMAL, order[1]);
+    EXPECT_EQ(cluster_message_lane_t::BULK, order[2]);
+
+    /* Keep the interactive lane busy; the bulk waiter must still get its turn. */
+    order.clear();
+    {
+        lane_mutex_t::acq_t acq(&mutex, cluster_message_lane_t::INTERACTIVE);
+        coro_t::spawn_now_dangerously([&]() {
+            lane_mutex_t::acq_t waiter_acq(&mutex, cluster_message_lane_t::BULK);
+            order.push_back(cluster_message_lane_t::BULK);
+        });
+        for (int i = 0; i < 2 * CLUSTER_LANE_MAX_BYPASSES; ++i) {
+            coro_t::spawn_now_dangerously([&]() {
+                lane_mutex_t::acq_t waiter_acq(
+                    &mutex, cluster_message_lane_t::INTERACTIVE);
+                order.push_back(cluster_message_lane_t::INTERACTIVE);
+            });
+        }
+    }
+    ASSERT_EQ(static_cast<size_t>(2 * CLUSTER_LANE_MAX_BYPASSES + 1), order.size());
+    EXPECT_EQ(cluster_message_lane_t::BULK, order[CLUSTER_LANE_MAX_BYPASSES]);
+
+    /* Fragment headers survive the trip over the network. */
+    cluster_fragment_header_t header;
+    header.tag = 'T';
+    header.lane = cluster_message_lane_t::BULK;
+    header.last = true;
+    header.size = CLUSTER_MESSAGE_FRAGMENT_SIZE;
+    char buf[cluster_fragment_header_t::serialized_size];
+    header.encode(buf);
+    cluster_fragment_header_t decoded;
+    ASSERT_TRUE(decoded.decode(buf));
+    EXPECT_EQ(header.tag, decoded.tag);
+    EXPECT_EQ(header.lane, decoded.lane);
+    EXPECT_EQ(header.last, decoded.last);
+    EXPECT_EQ(header.size, decoded.size);
+    header.size = CLUSTER_MESSAGE_FRAGMENT_SIZE + 1;
+    header.encode(buf);
+    EXPECT_FALSE(decoded.decode(buf));
+}
+
 /* `UnreachablePeer` tests that messages sent to unreachable peers silently
 fail. */
 
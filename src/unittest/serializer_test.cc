@@ -1,9 +1,20 @@
+#include <algorithm>
 #include <functional>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "arch/runtime/starter.hpp"
+#include "arch/timing.hpp"
+#include "buffer_cache/alt.hpp"
+#include "buffer_cache/cache_balancer.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "perfmon/perfmon.hpp"
+#include "rdb_protocol/datum.hpp"
 #include "serializer/buf_ptr.hpp"
 #include "serializer/log/log_serializer.hpp"
+#include "serializer/log/static_header.hpp"
+#include "time.hpp"
 #include "unittest/mock_file.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/unittest_utils.hpp"
@@ -90,5 +101,636 @@ TEST(SerializerTest, AddDeleteRepeatedlyWithIndex) {
     run_in_thread_pool(std::bind(run_AddDeleteRepeatedly, true), 4);
 }
 
+// Fills the block either with something that compresses about as well as our
+// documents do, or with pseudo-random bytes.
+void fill_block(buf_ptr_t *buf, int seed, bool compressible) {
+    char *data = static_cast<char *>(buf->cache_data());
+    const uint32_t size = buf->block_size().value();
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t i = 0; i < size;) {
+        if (compressible) {
+            std::string row = strprintf(
+                "{\"id\":%d,\"name\":\"user %" PRIu32 "\",\"active\":%s},",
+                seed, i, i % 3 == 0 ? "true" : "false");
+            const uint32_t n = std::min<uint32_t>(row.size(), size - i);
+            memcpy(data + i, row.data(), n);
+            i += n;
+        } else {
+            state = state * 1103515245u + 12345u;
+            data[i] = static_cast<char>(state >> 16);
+            ++i;
+        }
+    }
+}
+
+void write_and_index_blocks(log_serializer_t *ser, block_id_t first_block_id,
+                            const std::vector<buf_ptr_t> &bufs,
+                            file_account_t *account,
+                            repli_timestamp_t recency = repli_timestamp_t::distant_past) {
+    std::vector<buf_write_info_t> infos;
+    for (size_t i = 0; i < bufs.size(); ++i) {
+        infos.push_back(buf_write_info_t(bufs[i].ser_buffer(), bufs[i].block_size(),
+                                         first_block_id + i));
+    }
+
+    struct : public iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } cb;
+    std::vector<counted_t<standard_block_token_t> > tokens
+        = ser->block_writes(infos, account, &cb);
+    cb.wait();
+
+    std::vector<index_write_op_t> write_ops;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        write_ops.push_back(index_write_op_t(first_block_id + i, tokens[i], recency));
+    }
+    new_mutex_in_line_t dummy_acq;
+    ser->index_write(&dummy_acq, []{ }, write_ops);
+}
+
+void check_blocks(log_serializer_t *ser, const std::vector<buf_ptr_t> &expected,
+                  file_account_t *account) {
+    for (size_t i = 0; i < expected.size(); ++i) {
+        counted_t<standard_block_token_t> token = ser->index_read(i);
+        ASSERT_TRUE(token.has());
+        EXPECT_EQ(expected[i].block_size(), token->block_size());
+        // Only the blocks with even IDs are compressible.
+        if (i % 2 == 0) {
+            EXPECT_LT(token->disk_block_size().ser_value(),
+                      token->block_size().ser_value());
+        } else {
+            EXPECT_EQ(token->block_size(), token->disk_block_size());
+        }
+
+        buf_ptr_t buf = ser->block_read(token, account);
+        ASSERT_EQ(expected[i].block_size(), buf.block_size());
+        EXPECT_EQ(i, buf.ser_buffer()->ser_header.block_id);
+        EXPECT_EQ(0, memcmp(expected[i].cache_data(), buf.cache_data(),
+                            buf.block_size().value()));
+    }
+}
+
+TPTEST(SerializerTest, CompressedBlocks) {
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    log_serializer_t::dynamic_config_t config;
+    config.block_compression = block_compression_t::ZLIB;
+
+    std::vector<buf_ptr_t> expected;
+    {
+        log_serializer_t ser(config, &file_opener, &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        for (int i = 0; i < 100; ++i) {
+            expected.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&expected.back(), i, i % 2 == 0);
+        }
+        write_and_index_blocks(&ser, 0, expected, account.get());
+        check_blocks(&ser, expected, account.get());
+    }
+    {
+        // The LBA remembers which blocks are compressed, and reading them doesn't
+        // depend on compression being enabled.
+        log_serializer_t ser(log_serializer_t::dynamic_config_t(),
+                             &file_opener,
+                             &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        check_blocks(&ser, expected, account.get());
+    }
+}
+
+// Flips a bit in the first device block of the block that `token` points to, by
+// writing to the file behind the serializer's back.
+void corrupt_block(mock_file_opener_t *file_opener,
+                   const counted_t<standard_block_token_t> &token) {
+    scoped_ptr_t<file_t> file;
+    file_opener->open_serializer_file_existing(&file);
+    scoped_device_block_aligned_ptr_t<char> data(DEVICE_BLOCK_SIZE);
+
+    struct : public linux_iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } read_cb, write_cb;
+    file->read_async(token->offset(), DEVICE_BLOCK_SIZE, data.get(), nullptr, &read_cb);
+    read_cb.wait();
+    data.get()[DEVICE_BLOCK_SIZE - 1] ^= 1;
+    file->write_async(token->offset(), DEVICE_BLOCK_SIZE, data.get(), nullptr,
+                      &write_cb, file_t::NO_DATASYNCS);
+    write_cb.wait();
+}
+
+TPTEST(SerializerTest, ScrubFindsCorruptedBlocks) {
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    log_serializer_t::dynamic_config_t config;
+    // We scrub by hand.
+    config.scrub_interval_secs = 0;
+    perfmon_collection_t stats_collection;
+    log_serializer_t ser(config, &file_opener, &stats_collection);
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+    std::vector<buf_ptr_t> bufs;
+    for (int i = 0; i < 10; ++i) {
+        bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+        fill_block(&bufs.back(), i, false);
+    }
+    write_and_index_blocks(&ser, 0, bufs, account.get());
+
+    cond_t non_interruptor;
+    EXPECT_EQ(0u, ser.scrub(&non_interruptor));
+    scrub_progress_t progress;
+    EXPECT_FALSE(ser.get_scrub_progress(&progress));
+
+    corrupt_block(&file_opener, ser.index_read(3));
+    EXPECT_EQ(1u, ser.scrub(&non_interruptor));
+
+    void *ctx = stats_collection.begin_stats();
+    stats_collection.visit_stats(ctx);
+    ql::datum_t stats = stats_collection.end_stats(ctx).get_field("serializer");
+    EXPECT_EQ(2, stats.get_field("serializer_scrubs").as_num());
+    EXPECT_EQ(20, stats.get_field("serializer_scrub_blocks_verified").as_num());
+    EXPECT_EQ(1, stats.get_field("serializer_scrub_checksum_errors").as_num());
+
+    // The other blocks still read fine.
+    counted_t<standard_block_token_t> token = ser.index_read(4);
+    buf_ptr_t buf = ser.block_read(token, account.get());
+    EXPECT_EQ(0, memcmp(bufs[4].cache_data(), buf.cache_data(),
+                        buf.block_size().value()));
+}
+
+// Writes an LBA entry for each of the blocks in [first_block_id, end_block_id) that
+// only sets its recency.
+void touch_blocks(log_serializer_t *ser, block_id_t first_block_id,
+                  block_id_t end_block_id, repli_timestamp_t recency) {
+    std::vector<index_write_op_t> write_ops;
+    for (block_id_t id = first_block_id; id < end_block_id; ++id) {
+        write_ops.push_back(index_write_op_t(id, boost::none, recency));
+    }
+    new_mutex_in_line_t dummy_acq;
+    ser->index_write(&dummy_acq, []{ }, write_ops);
+}
+
+// Reads or overwrites the serializer version in the static header of the file.
+std::string serializer_file_version(mock_file_opener_t *file_opener,
+                                    const char *new_version = nullptr) {
+    scoped_ptr_t<file_t> file;
+    file_opener->open_serializer_file_existing(&file);
+    scoped_device_block_aligned_ptr_t<static_header_t> header(DEVICE_BLOCK_SIZE);
+
+    struct : public linux_iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } read_cb, write_cb;
+    file->read_async(0, DEVICE_BLOCK_SIZE, header.get(), nullptr, &read_cb);
+    read_cb.wait();
+    if (new_version != nullptr) {
+        memset(header->version, 0, sizeof(header->version));
+        strncpy(header->version, new_version, sizeof(header->version) - 1);
+        file->write_async(0, DEVICE_BLOCK_SIZE, header.get(), nullptr, &write_cb,
+                          file_t::NO_DATASYNCS);
+        write_cb.wait();
+    }
+    return std::string(header->version);
+}
+
+TPTEST(SerializerTest, MigratesV2_2Files) {
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    EXPECT_EQ("2.5", serializer_file_version(&file_opener));
+
+    std::vector<buf_ptr_t> bufs;
+    {
+        log_serializer_t ser(log_serializer_t::dynamic_config_t(),
+                             &file_opener,
+                             &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        for (int i = 0; i < 10; ++i) {
+            bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&bufs.back(), i, false);
+        }
+        write_and_index_blocks(&ser, 0, bufs, account.get());
+    }
+    // Pretend that the file comes from serializer version 2.2.  Its LBA entries
+    // have checksums, but that's fine since we're only testing the header here.
+    serializer_file_version(&file_opener, "2.2");
+
+    {
+        log_serializer_t ser(log_serializer_t::dynamic_config_t(),
+                             &file_opener,
+                             &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        for (size_t i = 0; i < bufs.size(); ++i) {
+            buf_ptr_t buf = ser.block_read(ser.index_read(i), account.get());
+            EXPECT_EQ(0, memcmp(bufs[i].cache_data(), buf.cache_data(),
+                                buf.block_size().value()));
+        }
+        // Reading doesn't migrate the file, but the first index write does, before
+        // it writes any LBA entries.
+        EXPECT_EQ("2.2", serializer_file_version(&file_opener));
+        touch_blocks(&ser, 0, 1, repli_timestamp_t::distant_past.next());
+        EXPECT_EQ("2.5", serializer_file_version(&file_opener));
+    }
+}
+
+TPTEST(SerializerTest, LoadsLbaNewestFirst) {
+    mock_file_opener_t file_opener;
+    log_serializer_t::static_config_t static_config;
+    // Small extents, so that the LBA takes up several extents in each shard.
+    static_config.extent_size_ = 256 * KILOBYTE;
+    log_serializer_t::create(&file_opener, static_config);
+    log_serializer_t::dynamic_config_t config;
+    config.scrub_interval_secs = 0;
+
+    const block_id_t NUM_BLOCKS = 200;
+    const block_id_t NUM_TOUCHED = 160;
+    const block_id_t NUM_REWRITTEN = 10;
+    const block_id_t NUM_DELETED = 10;
+    repli_timestamp_t last_recency;
+    std::vector<buf_ptr_t> expected;
+    {
+        log_serializer_t ser(config, &file_opener, &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        for (block_id_t i = 0; i < NUM_BLOCKS; ++i) {
+            expected.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&expected.back(), i, false);
+        }
+        write_and_index_blocks(&ser, 0, expected, account.get());
+        for (uint64_t round = 1; round <= 400; ++round) {
+            last_recency.longtime = round;
+            touch_blocks(&ser, 0, NUM_TOUCHED, last_recency);
+        }
+
+        // The newest entries for these blocks are the ones that count.
+        std::vector<buf_ptr_t> rewritten;
+        for (block_id_t i = 0; i < NUM_REWRITTEN; ++i) {
+            rewritten.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&rewritten.back(), i + 1000, false);
+        }
+        write_and_index_blocks(&ser, 0, rewritten, account.get());
+        for (block_id_t i = 0; i < NUM_REWRITTEN; ++i) {
+            expected[i] = std::move(rewritten[i]);
+        }
+        std::vector<index_write_op_t> write_ops;
+        for (block_id_t i = NUM_BLOCKS - NUM_DELETED; i < NUM_BLOCKS; ++i) {
+            write_ops.push_back(
+                index_write_op_t(i, counted_t<standard_block_token_t>()));
+        }
+        new_mutex_in_line_t dummy_acq;
+        ser.index_write(&dummy_acq, []{ }, write_ops);
+    }
+
+    {
+        // Shutting down while the LBA is still loading mustn't lose anything.
+        log_serializer_t ser(config, &file_opener, &get_global_perfmon_collection());
+    }
+
+    log_serializer_t ser(config, &file_opener, &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+    for (block_id_t i = 0; i < NUM_BLOCKS; ++i) {
+        counted_t<standard_block_token_t> token = ser.index_read(i);
+        if (i >= NUM_BLOCKS - NUM_DELETED) {
+            EXPECT_FALSE(token.has());
+            continue;
+        }
+        ASSERT_TRUE(token.has());
+        buf_ptr_t buf = ser.block_read(token, account.get());
+        EXPECT_EQ(i, buf.ser_buffer()->ser_header.block_id);
+        EXPECT_EQ(0, memcmp(expected[i].cache_data(), buf.cache_data(),
+                            buf.block_size().value()));
+    }
+
+    EXPECT_EQ(NUM_BLOCKS, ser.end_block_id());
+    EXPECT_TRUE(ser.index_loaded_signal()->is_pulsed());
+    segmented_vector_t<repli_timestamp_t> recencies = ser.get_all_recencies(0, 1);
+    ASSERT_EQ(NUM_BLOCKS, recencies.size());
+    for (block_id_t i = 0; i < NUM_BLOCKS; ++i) {
+        const bool touched_last = i >= NUM_REWRITTEN && i < NUM_TOUCHED;
+        EXPECT_EQ(touched_last ? last_recency : repli_timestamp_t::distant_past,
+                  recencies[i]);
+    }
+}
+
+TPTEST(SerializerTest, GcSeparatesBlocksByTemperature) {
+    mock_file_opener_t file_opener;
+    log_serializer_t::static_config_t static_config;
+    static_config.extent_size_ = 256 * KILOBYTE;
+    log_serializer_t::create(&file_opener, static_config);
+    log_serializer_t::dynamic_config_t config;
+    config.scrub_interval_secs = 0;
+    config.gc_temperature_tiers = 2;
+    perfmon_collection_t stats_collection;
+    log_serializer_t ser(config, &file_opener, &stats_collection);
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+    // Blocks with odd IDs are hot and get rewritten over and over, so the extents
+    // that we first write them to end up half garbage. Of the other blocks, the ones
+    // with IDs 2 mod 4 are warm: they don't change, but they keep getting touched.
+    // The rest are cold.
+    const int NUM_BLOCKS = 1280;
+    const int NUM_ROUNDS = 20;
+    const uint64_t FIRST_RECENT_RECENCY = 100000;
+    repli_timestamp_t cold_recency;
+    cold_recency.longtime = 1;
+    std::vector<buf_ptr_t> expected;
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        expected.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+        fill_block(&expected.back(), i, false);
+    }
+    write_and_index_blocks(&ser, 0, expected, account.get(), cold_recency);
+    std::vector<int64_t> first_offsets;
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        first_offsets.push_back(ser.index_read(i)->offset());
+    }
+    int64_t num_blocks_written = NUM_BLOCKS;
+
+    for (int round = 1; round <= NUM_ROUNDS; ++round) {
+        repli_timestamp_t recency;
+        recency.longtime = FIRST_RECENT_RECENCY + round;
+        for (int i = 2; i < NUM_BLOCKS; i += 4) {
+            touch_blocks(&ser, i, i + 1, recency);
+        }
+        for (int i = 1; i < NUM_BLOCKS; i += 2) {
+            std::vector<buf_ptr_t> bufs;
+            bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&bufs.back(), i + round * NUM_BLOCKS, false);
+            write_and_index_blocks(&ser, i, bufs, account.get(), recency);
+            expected[i] = std::move(bufs[0]);
+            ++num_blocks_written;
+        }
+    }
+    while (ser.is_gc_active()) {
+        nap(10);
+    }
+
+    std::set<int64_t> hot_extents;
+    std::set<int64_t> moved_warm_extents;
+    std::set<int64_t> moved_cold_extents;
+    for (int i = 0; i < NUM_BLOCKS; ++i) {
+        counted_t<standard_block_token_t> token = ser.index_read(i);
+        ASSERT_TRUE(token.has());
+        buf_ptr_t buf = ser.block_read(token, account.get());
+        EXPECT_EQ(0, memcmp(expected[i].cache_data(), buf.cache_data(),
+                            buf.block_size().value()));
+
+        const int64_t extent = token->offset() / static_config.extent_size();
+        if (i % 2 == 1) {
+            hot_extents.insert(extent);
+        } else if (token->offset() != first_offsets[i]) {
+            (i % 4 == 2 ? moved_warm_extents : moved_cold_extents).insert(extent);
+        }
+    }
+    // Hot blocks that the GC moves end up with the warm ones, but nothing else
+    // shares an extent with the cold blocks.
+    EXPECT_FALSE(moved_cold_extents.empty());
+    for (int64_t extent : moved_cold_extents) {
+        EXPECT_EQ(0u, hot_extents.count(extent));
+        EXPECT_EQ(0u, moved_warm_extents.count(extent));
+    }
+
+    void *ctx = stats_collection.begin_stats();
+    stats_collection.visit_stats(ctx);
+    ql::datum_t stats = stats_collection.end_stats(ctx).get_field("serializer");
+    EXPECT_EQ(num_blocks_written
+              * buf_ptr_t::compute_aligned_block_size(ser.max_block_size()),
+              stats.get_field("serializer_block_written_bytes_total").as_num());
+    EXPECT_LT(0, stats.get_field("serializer_gc_written_bytes_total").as_num());
+    EXPECT_LT(0, stats.get_field("serializer_data_extents_gced").as_num());
+}
+
+// This is not really a unit test, but a micro benchmark of how long it takes until a
+// serializer with a large LBA can serve the first read, compared to how long loading
+// all of the LBA takes. Most of the LBA entries are for blocks without any data, so
+// that the file fits into memory. No need to run this in debug mode.
+#ifdef NDEBUG
+// Writes an LBA with `num_entries` entries that only set a recency, and then writes
+// `*hot_block_out` as block `num_entries`.
+void write_large_lba(mock_file_opener_t *file_opener,
+                     const log_serializer_t::dynamic_config_t &config,
+                     block_id_t num_entries,
+                     buf_ptr_t *hot_block_out) {
+    const block_id_t BATCH_SIZE = 100000;
+    log_serializer_t ser(config, file_opener, &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+    repli_timestamp_t recency;
+    recency.longtime = 1;
+    for (block_id_t i = 0; i < num_entries; i += BATCH_SIZE) {
+        touch_blocks(&ser, i, std::min(i + BATCH_SIZE, num_entries), recency);
+    }
+    std::vector<buf_ptr_t> bufs;
+    bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+    fill_block(&bufs.back(), 0, false);
+    write_and_index_blocks(&ser, num_entries, bufs, account.get());
+    *hot_block_out = std::move(bufs[0]);
+}
+
+TPTEST(SerializerTest, LbaLoadingBenchmark) {
+    const block_id_t NUM_ENTRIES = 2000000;
+
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    log_serializer_t::dynamic_config_t config;
+    config.scrub_interval_secs = 0;
+
+    const block_id_t hot_block_id = NUM_ENTRIES;
+    buf_ptr_t hot_block;
+    write_large_lba(&file_opener, config, NUM_ENTRIES, &hot_block);
+
+    perfmon_collection_t stats_collection;
+    ticks_t start_ticks = get_ticks();
+    log_serializer_t ser(config, &file_opener, &stats_collection);
+    double dur_constructed = ticks_to_secs(get_ticks() - start_ticks);
+
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+    counted_t<standard_block_token_t> token = ser.index_read(hot_block_id);
+    buf_ptr_t buf = ser.block_read(token, account.get());
+    double dur_first_read = ticks_to_secs(get_ticks() - start_ticks);
+    EXPECT_EQ(0, memcmp(hot_block.cache_data(), buf.cache_data(),
+                        buf.block_size().value()));
+
+    ser.end_block_id();
+    double dur_loaded = ticks_to_secs(get_ticks() - start_ticks);
+
+    void *ctx = stats_collection.begin_stats();
+    stats_collection.visit_stats(ctx);
+    ql::datum_t stats = stats_collection.end_stats(ctx).get_field("serializer");
+    printf("LBA with %" PR_BLOCK_ID " entries: constructed after %.1f ms, first read "
+           "after %.1f ms (%.0f reads waited), fully loaded after %.1f ms\n",
+           NUM_ENTRIES + 1, dur_constructed * 1000, dur_first_read * 1000,
+           stats.get_field("serializer_index_reads_waiting_for_lba").as_num(),
+           dur_loaded * 1000);
+}
+#endif
+
+// The same as above, but through a `cache_t`: how long it takes until the first
+// query can read a recently written block, compared to when the first write
+// transaction can start, which needs the page cache's free list and recencies. No
+// need to run this in debug mode.
+#ifdef NDEBUG
+TPTEST(SerializerTest, CacheTimeToFirstQueryBenchmark) {
+    const block_id_t NUM_ENTRIES = 2000000;
+
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    log_serializer_t::dynamic_config_t config;
+    config.scrub_interval_secs = 0;
+
+    const block_id_t hot_block_id = NUM_ENTRIES;
+    buf_ptr_t hot_block;
+    write_large_lba(&file_opener, config, NUM_ENTRIES, &hot_block);
+
+    ticks_t start_ticks = get_ticks();
+    log_serializer_t ser(config, &file_opener, &get_global_perfmon_collection());
+    dummy_cache_balancer_t balancer(GIGABYTE);
+    cache_t cache(&ser, &balancer, &get_global_perfmon_collection());
+    cache_conn_t cache_conn(&cache);
+    double dur_constructed = ticks_to_secs(get_ticks() - start_ticks);
+
+    {
+        txn_t txn(&cache_conn, read_access_t());
+        buf_lock_t lock(buf_parent_t(&txn), hot_block_id, access_t::read);
+        buf_read_t read(&lock);
+        uint32_t block_size;
+        const void *data = read.get_data_read(&block_size);
+        EXPECT_EQ(0, memcmp(hot_block.cache_data(), data, block_size));
+    }
+    double dur_first_read = ticks_to_secs(get_ticks() - start_ticks);
+
+    {
+        txn_t txn(&cache_conn, write_durability_t::SOFT, 0);
+        txn.commit();
+    }
+    double dur_first_write = ticks_to_secs(get_ticks() - start_ticks);
+
+    printf("Cache on an LBA with %" PR_BLOCK_ID " entries: constructed after %.1f "
+           "ms, first read after %.1f ms, first write transaction after %.1f ms\n",
+           NUM_ENTRIES + 1, dur_constructed * 1000, dur_first_read * 1000,
+           dur_first_write * 1000);
+}
+#endif
+
+// This is not really a unit test, but a micro benchmark of how block compression
+// affects the bytes we write to disk and the time a point read takes. The file is in
+// memory, so the latter only shows the CPU cost of decompressing. No need to run this
+// in debug mode.
+#ifdef NDEBUG
+TPTEST(SerializerTest, CompressionBenchmark) {
+    const int NUM_BLOCKS = 20000;
+    const int BATCH_SIZE = 100;
+    const int NUM_READS = 100000;
+
+    for (block_compression_t compression
+             : {block_compression_t::NONE, block_compression_t::ZLIB}) {
+        mock_file_opener_t file_opener;
+        log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+        log_serializer_t::dynamic_config_t config;
+        config.block_compression = compression;
+        perfmon_collection_t stats_collection;
+        log_serializer_t ser(config, &file_opener, &stats_collection);
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+        for (int i = 0; i < NUM_BLOCKS; i += BATCH_SIZE) {
+            std::vector<buf_ptr_t> bufs;
+            for (int j = 0; j < BATCH_SIZE; ++j) {
+                bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+                fill_block(&bufs.back(), i + j, true);
+            }
+            write_and_index_blocks(&ser, i, bufs, account.get());
+        }
+
+        void *ctx = stats_collection.begin_stats();
+        stats_collection.visit_stats(ctx);
+        ql::datum_t stats = stats_collection.end_stats(ctx).get_field("serializer");
+        const double bytes_written
+            = stats.get_field("serializer_written_bytes_total").as_num();
+
+        ticks_t start_ticks = get_ticks();
+        for (int i = 0; i < NUM_READS; ++i) {
+            counted_t<standard_block_token_t> token
+                = ser.index_read((i * 7919) % NUM_BLOCKS);
+            buf_ptr_t buf = ser.block_read(token, account.get());
+        }
+        double dur = ticks_to_secs(get_ticks() - start_ticks);
+
+        printf("block compression %s: %.2f bytes written per block byte, "
+               "%.2f us per point read\n",
+               compression == block_compression_t::NONE ? "none" : "zlib",
+               bytes_written
+                   / (static_cast<double>(NUM_BLOCKS) * ser.max_block_size().ser_value()),
+               dur * 1000000 / NUM_READS);
+    }
+}
+#endif
+
+// This is not really a unit test, but a micro benchmark of the write amplification
+// of the GC, with and without sorting the blocks it moves into temperature tiers. Most
+// updates go to a small set of hot blocks, and each update bumps the recency. No need
+// to run this in debug mode.
+#ifdef NDEBUG
+TPTEST(SerializerTest, GcTemperatureTiersBenchmark) {
+    const int NUM_BLOCKS = 20000;
+    const int NUM_HOT_BLOCKS = NUM_BLOCKS / 10;
+    const int NUM_UPDATES = 200000;
+    const int BATCH_SIZE = 100;
+
+    for (int32_t tiers : {1, 3}) {
+        mock_file_opener_t file_opener;
+        log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+        log_serializer_t::dynamic_config_t config;
+        config.scrub_interval_secs = 0;
+        config.gc_temperature_tiers = tiers;
+        perfmon_collection_t stats_collection;
+        log_serializer_t ser(config, &file_opener, &stats_collection);
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+        repli_timestamp_t recency;
+        recency.longtime = 0;
+        for (int i = 0; i < NUM_BLOCKS; i += BATCH_SIZE) {
+            std::vector<buf_ptr_t> bufs;
+            for (int j = 0; j < BATCH_SIZE; ++j) {
+                bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+                fill_block(&bufs.back(), i + j, false);
+            }
+            recency.longtime += BATCH_SIZE;
+            write_and_index_blocks(&ser, i, bufs, account.get(), recency);
+        }
+
+        // 90% of the updates go to the hot blocks.
+        uint32_t state = 1;
+        ticks_t start_ticks = get_ticks();
+        for (int i = 0; i < NUM_UPDATES; ++i) {
+            state = state * 1103515245u + 12345u;
+            const uint32_t r = state >> 8;
+            const block_id_t block_id = r % 10 == 0
+                ? (r / 10) % NUM_BLOCKS
+                : (r / 10) % NUM_HOT_BLOCKS;
+            std::vector<buf_ptr_t> bufs;
+            bufs.push_back(buf_ptr_t::alloc_zeroed(ser.max_block_size()));
+            fill_block(&bufs.back(), i, false);
+            ++recency.longtime;
+            write_and_index_blocks(&ser, block_id, bufs, account.get(), recency);
+        }
+        while (ser.is_gc_active()) {
+            nap(10);
+        }
+        double dur = ticks_to_secs(get_ticks() - start_ticks);
+
+        void *ctx = stats_collection.begin_stats();
+        stats_collection.visit_stats(ctx);
+        ql::datum_t stats = stats_collection.end_stats(ctx).get_field("serializer");
+        const double block_bytes
+            = stats.get_field("serializer_block_written_bytes_total").as_num();
+        const double gc_bytes
+            = stats.get_field("serializer_gc_written_bytes_total").as_num();
+        printf("%" PRIi32 " GC temperature tier(s): write amplification %.2f "
+               "(%.2f including the LBA and metablock), %.1f s for %d updates\n",
+               tiers, (block_bytes + gc_bytes) / block_bytes,
+               stats.get_field("serializer_written_bytes_total").as_num() / block_bytes,
+               dur, NUM_UPDATES);
+    }
+}
+#endif
 
 }  // namespace unittest
@@ -0,0 +1,44 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/runtime.hpp"
+#include "arch/runtime/thread_utilization.hpp"
+#include "arch/timing.hpp"
+#include "config/args.hpp"
+#include "time.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+// Keeps the CPU busy for a little more than a utilization window.
+void spin_for_a_window() {
+    ticks_t end = get_ticks() + (THREAD_UTILIZATION_WINDOW_MS + 100) * MILLION;
+    while (get_ticks() < end) { }
+}
+
+TPTEST(ThreadUtilizationTest, BusyAndIdle) {
+    thread_utilization_t utilization;
+
+    // A thread that hasn't waited for a whole window is fully busy.
+    spin_for_a_window();
+    EXPECT_EQ(1.0, utilization.get());
+    utilization.on_wait_begin();
+    EXPECT_LT(0.9, utilization.get());
+
+    // A thread that has waited for a whole window is idle.
+    nap(THREAD_UTILIZATION_WINDOW_MS + 100);
+    EXPECT_EQ(0.0, utilization.get());
+    utilization.on_wait_end();
+    EXPECT_GT(0.1, utilization.get());
+}
+
+TEST(ThreadUtilizationTest, EventLoop) {
+    run_in_thread_pool([&]() {
+        // This thread's event loop doesn't get to wait while we spin, while the other
+        // one has nothing to do.
+        spin_for_a_window();
+        EXPECT_LT(0.9, get_thread_utilization(get_thread_id()));
+        EXPECT_GT(0.1, get_thread_utilization(threadnum_t(1)));
+    }, 2);
+}
+
+}  // namespace unittest
@@ -120,6 +120,30 @@ TEST(BtreeUtilsTest, SizedStrcmp) {
     ASSERT_NE(0, sized_strcmp(test3, 11, test1, 14));
 }
 
+TEST(BtreeUtilsTest, SizedStrcmpCommonPrefix) {
+    std::string a(100, 'x');
+    for (size_t len = 0; len < a.size(); ++len) {
+        for (int known = 0; known <= static_cast<int>(len); known += 7) {
+            std::string b = a.substr(0, len) + "y";
+            const uint8_t *a_bytes = reinterpret_cast<const uint8_t *>(a.data());
+            const uint8_t *b_bytes = reinterpret_cast<const uint8_t *>(b.data());
+            int common;
+            ASSERT_GT(0, sized_strcmp_common_prefix(a_bytes, a.size(), b_bytes, b.size(),
+                                                    known, &common));
+            ASSERT_EQ(static_cast<int>(len), common);
+            ASSERT_LT(0, sized_strcmp_common_prefix(b_bytes, b.size(), a_bytes, a.size(),
+                                                    known, &common));
+            ASSERT_EQ(static_cast<int>(len), common);
+            ASSERT_LT(0, sized_strcmp_common_prefix(a_bytes, a.size(), a_bytes, len,
+                                                    known, &common));
+            ASSERT_EQ(static_cast<int>(len), common);
+            ASSERT_EQ(0, sized_strcmp_common_prefix(a_bytes, len, a_bytes, len,
+                                                    known, &common));
+            ASSERT_EQ(static_cast<int>(len), common);
+        }
+    }
+}
+
 /* This doesn't quite belong in `utils_test.cc`, but I don't want to create a
 new file just for it. */
 